@@ -64,6 +64,11 @@ if(ozz_build_simd_ref)
   set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_BUILD_SIMD_REF)
 endif()
 
+# Sampling statistics
+if(ozz_build_sampling_stats)
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_BUILD_SAMPLING_STATS)
+endif()
+
 #--------------------------------------
 # Modify default MSVC compilation flags
 if(MSVC)
@@ -82,6 +87,12 @@ if(MSVC)
   # Adds support for multiple processes builds
   set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "/MP")
 
+  # Enables AVX instruction set
+  set(ozz_simd_avx_flag "/arch:AVX")
+  if(ozz_build_simd_avx AND NOT ozz_build_simd_ref)
+    set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS ${ozz_simd_avx_flag})
+  endif()
+
   #---------------
   # For all builds
   foreach(flag ${cxx_all_flags})
@@ -119,6 +130,12 @@ else()
   # Automatically selects native architecture optimizations (sse...)
   #set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "-march=native")
 
+  # Enables AVX instruction set
+  set(ozz_simd_avx_flag "-mavx")
+  if(ozz_build_simd_avx AND NOT ozz_build_simd_ref)
+    set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS ${ozz_simd_avx_flag})
+  endif()
+
   #----------------------
   # Enables debug glibcxx if NDebug isn't defined, not supported by APPLE
   if(NOT APPLE)
@@ -160,6 +177,32 @@ else()
 
 endif()
 
+#--------------------------------------------------------------------
+# Detects if AVX code can be built and run on this host, which allows
+# testing AVX code paths even if ozz_build_simd_avx is disabled.
+set(ozz_simd_avx_host OFF)
+if(NOT ozz_build_simd_ref AND NOT CMAKE_CROSSCOMPILING AND NOT EMSCRIPTEN)
+  file(WRITE "${CMAKE_BINARY_DIR}/avx_host_check.cc"
+    "#include <immintrin.h>\n"
+    "#if !defined(__AVX__)\n"
+    "#error AVX isn't enabled\n"
+    "#endif\n"
+    "int main() {\n"
+    "  volatile float in = 1.f;\n"
+    "  float out[8];\n"
+    "  const __m256 a = _mm256_set1_ps(in);\n"
+    "  _mm256_storeu_ps(out, _mm256_add_ps(a, a));\n"
+    "  return out[7] == 2.f ? 0 : 1;\n"
+    "}\n")
+  try_run(ozz_avx_host_run ozz_avx_host_compile
+    "${CMAKE_BINARY_DIR}"
+    "${CMAKE_BINARY_DIR}/avx_host_check.cc"
+    COMPILE_DEFINITIONS ${ozz_simd_avx_flag})
+  if(ozz_avx_host_compile AND ozz_avx_host_run EQUAL 0)
+    set(ozz_simd_avx_host ON)
+  endif()
+endif()
+
 #---------------------
 # Prints all the flags
 message(STATUS "---------------------------------------------------------")
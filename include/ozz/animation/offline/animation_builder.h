@@ -41,15 +41,45 @@ struct RawAnimation;
 
 // Defines the class responsible of building runtime animation instances from
 // offline raw animations.
-// No optimization at all is performed on the raw animation.
+// Soa tracks (4 consecutive tracks) whose value is constant for a
+// transformation type, typically the bind pose, are detected and stored
+// without any key frame. No other optimization is performed on the raw
+// animation.
 class AnimationBuilder {
  public:
+  // Initializes the builder with default parameters.
+  AnimationBuilder();
+
   // Creates an Animation based on _raw_animation and *this builder parameters.
   // Returns a valid Animation on success
   // The returned animation will then need to be deleted using the default
   // allocator Delete() function.
   // See RawAnimation::Validate() for more details about failure reasons.
   Animation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Time interval (in seconds) between two consecutive seek points. Seek points
+  // allow the SamplingJob to rewind (or jump forward) to any time in
+  // O(tracks), instead of walking all key frames from the beginning. Every seek
+  // point costs 8 bytes per animated track per transformation type, so this
+  // interval should be tuned according to the number of key frames of the
+  // animation.
+  // Set to 0 (default) to disable seek points.
+  float seek_interval;
+
+  // Builds reverse keys, the key frames order used by the SamplingJob to play
+  // the animation backward without restarting its cache. They cost 2 bytes per
+  // key frame, and can only be built if no transformation type has more than
+  // Animation::kMaxReverseKeys key frames. Otherwise the builder logs a
+  // warning and doesn't build them. Without reverse keys, sampling backward
+  // restarts the cache from the closest seek point (or from the beginning).
+  // Defaults to false.
+  bool reverse_keys;
+
+  // Builds per-track key indices, which list the key frames of every track in
+  // time order. They're required by the RandomAccessSamplingJob to binary
+  // search key frames, and cost 4 bytes per key frame plus 4 bytes per
+  // animated track. Defaults to false.
+  bool track_keys;
 };
 }  // offline
 }  // animation
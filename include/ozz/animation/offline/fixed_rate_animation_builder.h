@@ -0,0 +1,68 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_FIXED_RATE_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_FIXED_RATE_ANIMATION_BUILDER_H_
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime fixed rate animation type.
+class FixedRateAnimation;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime fixed rate animation
+// instances from offline raw animations.
+// The raw animation is uniformly sampled at the builder frequency, so it's
+// best suited for raw animations that are already uniformly sampled (baked).
+class FixedRateAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  FixedRateAnimationBuilder();
+
+  // Creates a FixedRateAnimation based on _raw_animation and *this builder
+  // parameters.
+  // Returns a valid FixedRateAnimation on success.
+  // The returned animation will then need to be deleted using the default
+  // allocator Delete() function.
+  // See RawAnimation::Validate() for more details about failure reasons. The
+  // builder also fails if frequency isn't strictly positive.
+  FixedRateAnimation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Sampling frequency, in hertz. The frame interval is adjusted so that the
+  // animation duration is a whole number of frames, the first frame being at
+  // time 0 and the last one at time duration. Defaults to 30.
+  float frequency;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_FIXED_RATE_ANIMATION_BUILDER_H_
@@ -36,6 +36,10 @@ namespace io {
 class IArchive;
 class OArchive;
 }
+namespace math {
+struct SoaFloat3;
+struct SoaQuaternion;
+}
 namespace animation {
 
 // Forward declares the AnimationBuilder, used to instantiate an Animation.
@@ -57,9 +61,24 @@ struct ScaleKey;
 // required to animate all the joints of a skeleton, matching breadth-first
 // joints order of the runtime skeleton structure. In order to optimize cache
 // coherency when sampling the animation, Keyframes in this array are sorted by
-// time, then by track number.
+// time, then by track number. Keyframe times are stored as 16 bits ratios of
+// the animation duration.
+// Soa tracks (4 consecutive tracks) whose values are constant for a
+// transformation type don't have any key frame for this type. Their value is
+// stored once in a constant buffer instead, which saves memory and sampling
+// cost. Key frames track numbers are thus indices in the compact list of
+// animated tracks of their transformation type, see translation_soa_tracks().
+// Constant soa tracks whose value is identity, which is common for additive
+// animations, aren't even stored in the constant buffer.
 class Animation {
  public:
+  // Defines Animation constant values.
+  enum Constants {
+    // Defines the maximum number of key frames of a transformation type for
+    // the animation to store reverse keys, which are 16 bits key indices.
+    kMaxReverseKeys = 1 << 16,
+  };
+
   // Builds a default animation.
   Animation();
 
@@ -79,6 +98,50 @@ class Animation {
   // Gets animation name.
   const char* name() const { return name_ ? name_ : ""; }
 
+  // Gets the number of soa tracks that are animated by translation, rotation
+  // and scale key frames. Other soa tracks are constant.
+  int num_translation_soa_tracks() const { return num_translation_soa_tracks_; }
+  int num_rotation_soa_tracks() const { return num_rotation_soa_tracks_; }
+  int num_scale_soa_tracks() const { return num_scale_soa_tracks_; }
+
+  // Gets the number of constant soa tracks whose translation, rotation and
+  // scale values are identity. Their values aren't stored.
+  int num_translation_identities() const { return num_translation_identities_; }
+  int num_rotation_identities() const { return num_rotation_identities_; }
+  int num_scale_identities() const { return num_scale_identities_; }
+
+  // Gets the output soa track indices of translations. The first
+  // num_translation_soa_tracks() are animated by translation keys, in compact
+  // track number order. The following ones are constant, their values being
+  // stored in the same order in translation_constants(). The last
+  // num_translation_identities() are identity.
+  ozz::Range<const uint16_t> translation_soa_tracks() const {
+    return translation_soa_tracks_;
+  }
+
+  // Gets the output soa track indices of rotations. See
+  // translation_soa_tracks() for more details.
+  ozz::Range<const uint16_t> rotation_soa_tracks() const {
+    return rotation_soa_tracks_;
+  }
+
+  // Gets the output soa track indices of scales. See translation_soa_tracks()
+  // for more details.
+  ozz::Range<const uint16_t> scale_soa_tracks() const {
+    return scale_soa_tracks_;
+  }
+
+  // Gets the buffers of constant soa tracks values.
+  ozz::Range<const math::SoaFloat3> translation_constants() const {
+    return translation_constants_;
+  }
+  ozz::Range<const math::SoaQuaternion> rotation_constants() const {
+    return rotation_constants_;
+  }
+  ozz::Range<const math::SoaFloat3> scale_constants() const {
+    return scale_constants_;
+  }
+
   // Gets the buffer of translations keys.
   ozz::Range<const TranslationKey> translations() const {
     return translations_;
@@ -90,6 +153,73 @@ class Animation {
   // Gets the buffer of scale keys.
   ozz::Range<const ScaleKey> scales() const { return scales_; }
 
+  // Gets the buffer of translation keys quantization ranges. See
+  // translation_ranges_ for layout.
+  ozz::Range<const math::SoaFloat3> translation_ranges() const {
+    return translation_ranges_;
+  }
+
+  // Gets the buffer of scale keys quantization ranges. See scale_ranges_ for
+  // layout.
+  ozz::Range<const math::SoaFloat3> scale_ranges() const {
+    return scale_ranges_;
+  }
+
+  // Tests whether the animation stores reverse keys, allowing to play it
+  // backward without restarting the SamplingCache.
+  bool has_reverse_keys() const { return has_reverse_keys_; }
+
+  // Gets the buffer of translation keys indices, in reverse sampling order.
+  // It's empty if the animation has no reverse keys.
+  ozz::Range<const uint16_t> reverse_translations() const {
+    return reverse_translations_;
+  }
+
+  // Gets the buffer of rotation keys indices, in reverse sampling order.
+  ozz::Range<const uint16_t> reverse_rotations() const {
+    return reverse_rotations_;
+  }
+
+  // Gets the buffer of scale keys indices, in reverse sampling order.
+  ozz::Range<const uint16_t> reverse_scales() const { return reverse_scales_; }
+
+  // Gets the time interval between two consecutive seek points. 0 means that
+  // the animation has no seek point.
+  float seek_interval() const { return seek_interval_; }
+
+  // Gets the number of seek points.
+  int num_seek_points() const {
+    return static_cast<int>(translation_seeks_.Count()) /
+           (2 + num_translation_soa_tracks_ * 4 * 2);
+  }
+
+  // Gets the buffer of translation seek points.
+  ozz::Range<const int> translation_seeks() const { return translation_seeks_; }
+
+  // Gets the buffer of rotation seek points.
+  ozz::Range<const int> rotation_seeks() const { return rotation_seeks_; }
+
+  // Gets the buffer of scale seek points.
+  ozz::Range<const int> scale_seeks() const { return scale_seeks_; }
+
+  // Tests whether the animation stores per-track key indices, required by the
+  // RandomAccessSamplingJob.
+  bool has_track_keys() const { return has_track_keys_; }
+
+  // Gets the per-track index of translation keys. See translation_track_keys_
+  // for layout. It's empty if the animation has no per-track key indices.
+  ozz::Range<const int> translation_track_keys() const {
+    return translation_track_keys_;
+  }
+
+  // Gets the per-track index of rotation keys.
+  ozz::Range<const int> rotation_track_keys() const {
+    return rotation_track_keys_;
+  }
+
+  // Gets the per-track index of scale keys.
+  ozz::Range<const int> scale_track_keys() const { return scale_track_keys_; }
+
   // Get the estimated animation's size in bytes.
   size_t size() const;
 
@@ -108,8 +238,14 @@ class Animation {
   friend class offline::AnimationBuilder;
 
   // Internal destruction function.
+  // Constant soa tracks, reverse keys, quantization ranges and seek points
+  // counts are deduced from num_tracks_ and the number of animated and
+  // identity soa tracks of each transformation type, so they must be set
+  // before calling Allocate. Reverse keys and per-track key indices are only
+  // allocated if _reverse_keys and _track_keys are true.
   void Allocate(size_t _name_len, size_t _translation_count,
-                size_t _rotation_count, size_t _scale_count);
+                size_t _rotation_count, size_t _scale_count,
+                size_t _num_seek_points, bool _reverse_keys, bool _track_keys);
   void Deallocate();
 
   // Duration of the animation clip.
@@ -122,15 +258,95 @@ class Animation {
   // Animation name.
   char* name_;
 
+  // The number of soa tracks animated by key frames, for every transformation
+  // type.
+  int num_translation_soa_tracks_;
+  int num_rotation_soa_tracks_;
+  int num_scale_soa_tracks_;
+
+  // The number of identity soa tracks, for every transformation type.
+  int num_translation_identities_;
+  int num_rotation_identities_;
+  int num_scale_identities_;
+
+  // Stores output soa track indices of every transformation type, animated
+  // ones first, then constant ones, and identity ones last. Their size is
+  // num_soa_tracks().
+  ozz::Range<uint16_t> translation_soa_tracks_;
+  ozz::Range<uint16_t> rotation_soa_tracks_;
+  ozz::Range<uint16_t> scale_soa_tracks_;
+
+  // Stores constant soa tracks values, for every transformation type.
+  ozz::Range<math::SoaFloat3> translation_constants_;
+  ozz::Range<math::SoaQuaternion> rotation_constants_;
+  ozz::Range<math::SoaFloat3> scale_constants_;
+
   // Stores all translation/rotation/scale keys begin and end of buffers.
   ozz::Range<TranslationKey> translations_;
   ozz::Range<RotationKey> rotations_;
   ozz::Range<ScaleKey> scales_;
+
+  // Stores translation/scale keys quantization ranges begin and end of
+  // buffers.
+  // Translation and scale key values are quantized to 16 bits unsigned
+  // integers, within the range of values of their track. There are 2 entries
+  // per animated soa track: the minimum value of each of the 4 tracks,
+  // followed by the value of a quantization step (range extent / 65535). A key
+  // value is thus restored as min + step * quantized, and the quantization
+  // error of a track is bounded by half of its step.
+  ozz::Range<math::SoaFloat3> translation_ranges_;
+  ozz::Range<math::SoaFloat3> scale_ranges_;
+
+  // Stores all translation/rotation/scale reverse keys begin and end of
+  // buffers.
+  // Reverse keys are indices of the key frames that have a successor in their
+  // track (all but the last one), sorted by successor time and then by track
+  // number. This is the order in which the SamplingCache needs key frames when
+  // the animation is played backward, the same way key frames buffers are
+  // sorted in the order they are needed when played forward.
+  // Reverse keys are optional, see offline::AnimationBuilder::reverse_keys.
+  // They're stored as 16 bits indices, so they can only be built if no
+  // transformation type has more than kMaxReverseKeys key frames.
+  bool has_reverse_keys_;
+  ozz::Range<uint16_t> reverse_translations_;
+  ozz::Range<uint16_t> reverse_rotations_;
+  ozz::Range<uint16_t> reverse_scales_;
+
+  // Time interval between two consecutive seek points.
+  float seek_interval_;
+
+  // Stores all translation/rotation/scale seek points begin and end of
+  // buffers.
+  // A seek point is a snapshot of the SamplingCache key frames state at time
+  // (n + 1) * seek_interval_, n being the index of the seek point. It allows
+  // the SamplingCache to jump to the closest seek point when the animation is
+  // rewound, instead of walking all key frames from the beginning. Every seek
+  // point is stored as the cursor in the key frames buffer and the cursor in
+  // the reverse keys buffer, followed by the indices of the 2 key frames to
+  // interpolate for every (soa aligned) animated track.
+  ozz::Range<int> translation_seeks_;
+  ozz::Range<int> rotation_seeks_;
+  ozz::Range<int> scale_seeks_;
+
+  // Stores all translation/rotation/scale per-track key indices begin and end
+  // of buffers.
+  // Key frames of every animated track are listed in time order, allowing to
+  // binary search the keys surrounding any time without a SamplingCache (see
+  // RandomAccessSamplingJob). The buffer starts with an offset per animated
+  // track, plus one for the end of the last track, followed by the key
+  // indices. Keys of track n are thus the indices stored in range
+  // [offset[n], offset[n + 1]) of the key indices.
+  // Per-track key indices are optional, see
+  // offline::AnimationBuilder::track_keys.
+  bool has_track_keys_;
+  ozz::Range<int> translation_track_keys_;
+  ozz::Range<int> rotation_track_keys_;
+  ozz::Range<int> scale_track_keys_;
 };
 }  // animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(4, animation::Animation)
+OZZ_IO_TYPE_VERSION(5, animation::Animation)
 OZZ_IO_TYPE_TAG("ozz-animation", animation::Animation)
 }  // io
 }  // ozz
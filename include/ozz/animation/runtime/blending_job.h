@@ -39,13 +39,21 @@ struct SoaTransform;
 
 namespace animation {
 
+// Forward declaration of the runtime animation.
+class Animation;
+
 // Blends multiple input layer/postures to a single output. The number of
 // transforms/joints blended by the job is defined by the number of transforms
 // of the bind pose (note that this is a SoA format). This means that all
 // buffers must be at least as big as the bind pose buffer.
 // Partial animation blending is supported through optional joint weights that
 // can be specified with layers joint_weights buffer. Unspecified joint weights
-// are considered as a unit weight of 1.f.
+// are considered as a unit weight of 1.f. Layers that only affect a part of the
+// skeleton can also specify the ranges of soa joints they affect, so that other
+// soa joints are skipped.
+// Per soa joint accumulated weights are stored to an optional scratch buffer
+// provided by the caller. Otherwise the job works by chunks of soa joints,
+// using a small stack buffer. Neither limits the number of joints.
 // The job does not owned any buffers (input/output) and will thus not delete
 // them during job's destruction.
 struct BlendingJob {
@@ -56,10 +64,13 @@ struct BlendingJob {
   // Returns true for a valid job, false otherwise:
   // -if layer range is not valid (can be empty though).
   // -if additive layer range is not valid (can be empty though).
-  // -if any layer is not valid.
+  // -if any layer is not valid, including soa joint ranges that aren't sorted
+  // or exceed the bind pose buffer.
   // -if output range is not valid.
   // -if any buffer (including layers' content : transform, joint weights...) is
   // smaller than the bind pose buffer.
+  // -if scratch buffer is specified but smaller than the bind pose buffer.
+  // -if [begin_soa,end_soa[ isn't a valid range.
   // -if the threshold value is less than or equal to 0.f.
   bool Validate() const;
 
@@ -69,6 +80,12 @@ struct BlendingJob {
   // Returns false if *this job is not valid.
   bool Run() const;
 
+  // Defines a range [begin,end[ of soa joints.
+  struct SoaJointRange {
+    int begin;
+    int end;
+  };
+
   // Defines a layer of blending input data (local space transforms) and
   // parameters (weights).
   struct Layer {
@@ -102,6 +119,15 @@ struct BlendingJob {
     // clamped because they could exceed 1.f if all layers contains valid joint
     // weights.
     Range<const math::SimdFloat4> joint_weights;
+
+    // Optional sparse form of the per joint weights: the ranges of soa joints
+    // affected by this layer, sorted and not overlapping. Soa joints outside of
+    // these ranges are considered as having a weight of 0, so they are neither
+    // read nor blended. Inside these ranges, weights are defined by
+    // joint_weights if specified, or are 1.f otherwise.
+    // If both pointers are NULL (default case) then all soa joints are
+    // affected. See ComputeSoaJointRanges() to build ranges from joint weights.
+    Range<const SoaJointRange> soa_ranges;
   };
 
   // The job blends the bind pose to the output when the accumulated weight of
@@ -130,7 +156,48 @@ struct BlendingJob {
   // Must be at least as big as the bind pose buffer, but only the number of
   // transforms defined by the bind pose buffer size will be processed.
   Range<ozz::math::SoaTransform> output;
+
+  // Optional scratch buffer, used to accumulate per soa joint weights.
+  // If specified, it must be at least as big as the bind pose buffer, and
+  // allows the job to blend all soa joints at once. If both pointers are NULL
+  // (default case) then the job blends soa joints by chunks, using a small
+  // stack buffer instead. Output is the same in both cases. Scratch buffer is
+  // indexed by soa joint, so jobs blending disjoint soa joint ranges (see
+  // begin_soa) can share it.
+  Range<math::SimdFloat4> scratch;
+
+  // Optional range [begin_soa,end_soa[ of the soa joints to blend, allowing
+  // to split the blending of a single posture across multiple threads. Only
+  // output soa joints of this range are written, others are left unchanged.
+  // Threshold and bind pose fallback are resolved the same way they are when
+  // blending all soa joints. end_soa is clamped to the bind pose size, so the
+  // default range [0,max int[ blends all soa joints.
+  int begin_soa;
+  int end_soa;
 };
+
+// Computes the ranges of soa joints whose _joint_weights are greater than 0 for
+// at least one of their 4 joints, to be used as BlendingJob::Layer::soa_ranges.
+// _ranges must be big enough to store (_joint_weights.Count() + 1) / 2 ranges,
+// which is the worst case.
+// Returns the part of _ranges that was filled, which is empty but not NULL (ie:
+// no soa joint is affected) if all weights are 0. Returns a NULL range (which
+// means that all soa joints are affected) if _ranges is too small.
+Range<BlendingJob::SoaJointRange> ComputeSoaJointRanges(
+    Range<const math::SimdFloat4> _joint_weights,
+    Range<BlendingJob::SoaJointRange> _ranges);
+
+// Computes the ranges of soa joints that _animation doesn't leave to identity,
+// ie: that have a non-identity translation, rotation or scale soa track. Used
+// as BlendingJob::Layer::soa_ranges of an additive layer, only non-identity
+// soa joints are blended.
+// _ranges must be big enough to store (_animation.num_soa_tracks() + 1) / 2
+// ranges, which is the worst case.
+// Returns the part of _ranges that was filled, which is empty but not NULL (ie:
+// no soa joint is affected) if all tracks are identity. Returns a NULL range
+// (which means that all soa joints are affected) if _ranges is too small.
+Range<BlendingJob::SoaJointRange> ComputeSoaJointRanges(
+    const Animation& _animation, Range<BlendingJob::SoaJointRange> _ranges);
 }  // animation
 }  // ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_BLENDING_JOB_H_
@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_FIXED_RATE_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_FIXED_RATE_ANIMATION_H_
+
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}
+namespace animation {
+
+// Forward declares the FixedRateAnimationBuilder, used to instantiate a
+// FixedRateAnimation.
+namespace offline {
+class FixedRateAnimationBuilder;
+}
+
+// Forward declaration of key frame's type.
+struct FixedRateSoaKey;
+
+// Defines a runtime skeletal animation clip, uniformly sampled at a fixed
+// rate.
+// As opposed to Animation, which stores a variable number of key frames per
+// track, FixedRateAnimation stores all tracks at every frame. Key frames are
+// laid out frame-major, in SoA order: all soa tracks of the first frame, then
+// all soa tracks of the second frame... Sampling at any time is thus a direct
+// index in the key frames buffer, which doesn't need any cache state (see
+// FixedRateSamplingJob). This suits baked animations, like physics or cloth
+// simulations, and allows free random access and scrubbing. Memory footprint
+// is only lower than Animation's if most tracks have a key at most frames.
+// Tracks match breadth-first joints order of the runtime skeleton structure.
+class FixedRateAnimation {
+ public:
+  // Builds a default animation.
+  FixedRateAnimation();
+
+  // Declares the public non-virtual destructor.
+  ~FixedRateAnimation();
+
+  // Gets the animation clip duration.
+  float duration() const { return duration_; }
+
+  // Gets the number of animated tracks.
+  int num_tracks() const { return num_tracks_; }
+
+  // Returns the number of SoA elements matching the number of tracks of *this
+  // animation. This value is useful to allocate SoA runtime data structures.
+  int num_soa_tracks() const { return (num_tracks_ + 3) / 4; }
+
+  // Gets the number of frames. Frames are uniformly distributed, the first one
+  // at time 0 and the last one at time duration. An animation built with the
+  // FixedRateAnimationBuilder has at least 2 frames.
+  int num_frames() const { return num_frames_; }
+
+  // Gets animation name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Gets the buffer of key frames, num_soa_tracks() per frame.
+  ozz::Range<const FixedRateSoaKey> keys() const { return keys_; }
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  FixedRateAnimation(FixedRateAnimation const&);
+  void operator=(FixedRateAnimation const&);
+
+  // FixedRateAnimationBuilder class is allowed to instantiate an animation.
+  friend class offline::FixedRateAnimationBuilder;
+
+  // Internal allocation/deallocation functions.
+  void Allocate(size_t _name_len, size_t _key_count);
+  void Deallocate();
+
+  // Duration of the animation clip.
+  float duration_;
+
+  // The number of joint tracks. Can differ from the data stored in keys_
+  // buffer because of SoA requirements.
+  int num_tracks_;
+
+  // The number of frames.
+  int num_frames_;
+
+  // Animation name.
+  char* name_;
+
+  // Stores all key frames, frame-major.
+  ozz::Range<FixedRateSoaKey> keys_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::FixedRateAnimation)
+OZZ_IO_TYPE_TAG("ozz-fixed_rate_animation", animation::FixedRateAnimation)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_FIXED_RATE_ANIMATION_H_
@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_FIXED_RATE_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_FIXED_RATE_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the animation type to sample.
+class FixedRateAnimation;
+
+// Samples a FixedRateAnimation at a given time, to output the corresponding
+// posture in local-space.
+// As opposed to SamplingJob, this job doesn't need any cache: the 2 frames
+// surrounding the sampling time are directly indexed in the animation, then
+// decompressed and interpolated. Sampling cost is the same whatever the time
+// and the playback direction, which makes random access and scrubbing free.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct FixedRateSamplingJob {
+  // Default constructor, initializes default values.
+  FixedRateSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL
+  // -if output range is invalid.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time used to sample animation, clamped in range [0,duration] before
+  // job execution. This resolves approximations issues on range bounds.
+  float time;
+
+  // The animation to sample.
+  const FixedRateAnimation* animation;
+
+  // Job output.
+  // The output range to be filled with sampled joints during job execution.
+  // It must be big enough to store all animation soa tracks.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_FIXED_RATE_SAMPLING_JOB_H_
@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
+
+#include "ozz/base/maths/soa_float.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Stores, for a soa joint, the offset of the outgoing posture from the incoming
+// posture at transition time, and the velocity of this offset. Rotation offsets
+// and velocities are stored as scaled axis (axis * angle) vectors.
+// It is filled by the InertializationCaptureJob and decayed by the
+// InertializationJob.
+struct SoaInertializationOffset {
+  math::SoaFloat3 translation;
+  math::SoaFloat3 translation_velocity;
+  math::SoaFloat3 rotation;
+  math::SoaFloat3 rotation_velocity;
+  math::SoaFloat3 scale;
+  math::SoaFloat3 scale_velocity;
+};
+
+// Captures the offsets of an inertialization transition, from the outgoing
+// posture at transition time and one frame before, and the incoming posture at
+// transition time. Offsets are then decayed over the incoming posture by the
+// InertializationJob, so that the outgoing animation doesn't need to be
+// sampled anymore during the transition.
+// The number of soa joints processed by the job is defined by the size of the
+// target buffer.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct InertializationCaptureJob {
+  // Default constructor, initializes default values.
+  InertializationCaptureJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if any range is not valid.
+  // -if previous, current or output buffer is smaller than the target buffer.
+  // -if delta_time is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's capture task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time elapsed between previous and current outgoing postures, used to
+  // compute offsets velocity. Must be greater than 0.f.
+  float delta_time;
+
+  // Outgoing posture, one frame before the transition.
+  Range<const math::SoaTransform> previous;
+
+  // Outgoing posture at transition time.
+  Range<const math::SoaTransform> current;
+
+  // Incoming posture at transition time. The size of this buffer defines the
+  // number of soa joints to process.
+  Range<const math::SoaTransform> target;
+
+  // Job output.
+  // The range of offsets to be filled during job execution.
+  Range<SoaInertializationOffset> output;
+};
+
+// Decays offsets captured by the InertializationCaptureJob over the incoming
+// posture, to smoothly transition from the outgoing posture. The length of
+// every offset follows a quintic polynomial that reaches 0 at the end of the
+// transition, with null velocity and acceleration, while its direction
+// remains the same. Its initial velocity matches the outgoing posture velocity
+// along the offset direction, unless it moves away from the incoming posture.
+// See "Inertialization: High-Performance Animation Transitions in Gears of
+// War", David Bollo, GDC 2018.
+// The number of soa joints processed by the job is defined by the size of the
+// input buffer.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct InertializationJob {
+  // Default constructor, initializes default values.
+  InertializationJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if any range is not valid.
+  // -if offsets or output buffer is smaller than the input buffer.
+  // -if duration is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's inertialization task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time elapsed since the transition, clamped in range [0,duration] before
+  // job execution. Input posture is output unchanged once time reaches
+  // duration.
+  float time;
+
+  // Duration of the transition, which must remain the same for the whole
+  // transition. Must be greater than 0.f.
+  float duration;
+
+  // Offsets captured at transition time by the InertializationCaptureJob.
+  Range<const SoaInertializationOffset> offsets;
+
+  // Incoming posture, sampled at the current time. The size of this buffer
+  // defines the number of soa joints to process.
+  Range<const math::SoaTransform> input;
+
+  // Job output.
+  // The range of output transforms to be filled during job execution. It can
+  // be the same buffer as input.
+  Range<math::SoaTransform> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
@@ -35,9 +35,9 @@ namespace ozz {
 // Forward declaration math structures.
 namespace math {
 struct SoaTransform;
-}
-namespace math {
 struct Float4x4;
+struct Float3x4;
+struct SoaFloat4x4;
 }
 
 namespace animation {
@@ -53,17 +53,31 @@ class Skeleton;
 // skeleton's joints. Job output is an array of matrices (in model-space),
 // ordered like skeleton's joints. Output are matrices, because the combination
 // of affine transformations can contain shearing or complex transformation
-// that cannot be represented as Transform object.
+// that cannot be represented as Transform object. Output matrices can either be
+// Float4x4 or Float3x4, which drops the last (0, 0, 0, 1) row of affine
+// matrices, saving 25% of output memory and bandwidth. Skinning matrices can
+// optionally be output in the same pass, multiplying each model matrix by its
+// inverse bind pose.
+// The job can optionally update only the subtree of a joint, see from member,
+// the joints that changed and their descendants, see dirty member, or a list
+// of joints, see joints member.
 struct LocalToModelJob {
   // Default constructor, initializes default values.
-  LocalToModelJob() : skeleton(NULL) {}
+  LocalToModelJob();
 
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer, including ranges, is NULL.
   // -if the size of the input is smaller than the skeleton's number of joints.
   // Note that this input has a SoA format.
-  // -if the size of of the output is smaller than the skeleton's number of
-  // joints.
+  // -if none or both of output and affine_output are set.
+  // -if only one of inverse_bind_poses and skinning_output is set.
+  // -if the size of the output, affine_output, inverse_bind_poses or
+  // skinning_output is smaller than the skeleton's number of joints.
+  // -if from isn't a joint of the skeleton nor Skeleton::kNoParentIndex.
+  // -if joints is set together with from or dirty, or contains an index that
+  // isn't a joint of the skeleton.
+  // -if dirty is set together with from, or is smaller than the skeleton's
+  // number of soa joints bits.
   bool Validate() const;
 
   // Runs job's local-to-model task.
@@ -76,6 +90,32 @@ struct LocalToModelJob {
   // model space conversion.
   const Skeleton* skeleton;
 
+  // Optional index of the joint whose subtree (the joint itself and all its
+  // descendants) is updated, allowing to only recompute the joints affected by
+  // a local-space change, like an IK or a procedural tweak. Other output
+  // matrices are left unchanged, and model matrices of from ancestors are
+  // read from the output, so they must be up to date.
+  // Set to Skeleton::kNoParentIndex (default) to update all joints.
+  int from;
+
+  // Optional list of the joints to update. Other joints are left unchanged,
+  // and model matrices of parents that aren't in the list are read from the
+  // output, so they must be up to date. Joints sharing a soa joint should be
+  // adjacent in the list, so that their local matrices are built once.
+  // Joints of a level of Skeleton::level_joints() only depend on previous
+  // levels. A large skeleton can thus be updated level after level, each level
+  // being split across multiple jobs run concurrently. Can't be used with from
+  // nor dirty.
+  Range<const uint16_t> joints;
+
+  // Optional dirty mask, one bit per soa joint: bit (i & 7) of byte i / 8 is
+  // set if any local transform of soa joint i changed since the last update.
+  // Only the joints of dirty soa joints and their descendants are updated,
+  // other output matrices are left unchanged and must be up to date. This
+  // saves the update of joints that don't change between frames, like fingers
+  // in a static grip or facial joints at rest. Can't be used with from.
+  Range<const uint8_t> dirty;
+
   // Job input.
   // The input range that store local transforms.
   Range<const ozz::math::SoaTransform> input;
@@ -83,6 +123,113 @@ struct LocalToModelJob {
   // Job output.
   // The output range to be filled with model matrices.
   Range<ozz::math::Float4x4> output;
+
+  // Optional job output, to use instead of output.
+  // The output range to be filled with model matrices, as 3x4 affine matrices.
+  // Matrices are computed with affine specialized multiplications.
+  Range<ozz::math::Float3x4> affine_output;
+
+  // Optional inverse bind pose matrices, ordered like skeleton's joints. Must
+  // be set together with skinning_output.
+  Range<const ozz::math::Float4x4> inverse_bind_poses;
+
+  // Optional job output.
+  // The output range to be filled with skinning matrices, ie: model matrices
+  // multiplied by their inverse bind pose, as expected by SkinningJob. They are
+  // computed in the same pass as model matrices, avoiding a second pass over
+  // all joints.
+  Range<ozz::math::Float4x4> skinning_output;
+};
+
+// Computes model-space joint matrices of multiple instances of the same
+// skeleton. This job is intended for crowds, where many characters share a
+// skeleton.
+// Instances are processed by groups of 4, the 4 lanes of a soa matrix being 4
+// instances instead of 4 joints. The hierarchy walk is thus shared by the 4
+// instances, and the multiplication by the parent matrix is a SoaFloat4x4
+// multiplication, without any per joint splat nor shuffle. Inputs and outputs
+// have the same layout as LocalToModelJob ones, so instances local transforms
+// are transposed once when they are loaded, and model matrices when they are
+// stored.
+// The job does not own the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct BatchLocalToModelJob {
+  // Default constructor, initializes default values.
+  BatchLocalToModelJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if skeleton pointer is NULL.
+  // -if the number of outputs does not match the number of inputs.
+  // -if any input or output range is invalid. See LocalToModelJob.
+  // -if the scratch buffer is smaller than the skeleton's number of joints.
+  bool Validate() const;
+
+  // Runs job's local-to-model task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy shared by all
+  // instances.
+  const Skeleton* skeleton;
+
+  // Job input.
+  // The input ranges that store local transforms, one range per instance. See
+  // LocalToModelJob::input for each range requirements.
+  Range<const Range<const ozz::math::SoaTransform> > inputs;
+
+  // Job output.
+  // The output ranges to be filled with model matrices, one range per instance.
+  // See LocalToModelJob::output for each range requirements.
+  Range<const Range<ozz::math::Float4x4> > outputs;
+
+  // Scratch buffer, used to store model matrices of 4 instances while walking
+  // the hierarchy. Must be at least as big as the skeleton's number of joints.
+  Range<ozz::math::SoaFloat4x4> scratch;
+};
+
+// Computes model-space joint transforms from local-space SoaTransform, for
+// consumers that need model-space translations and rotations rather than
+// matrices, like IK, physics or network replication.
+// Transforms are concatenated hierarchically with soa quaternion math, 4 joints
+// at a time, so model-space transforms are output directly, without matrix
+// decomposition. A joint whose parent belongs to the same soa joint can only be
+// computed once its parent is, so such soa joints are processed in multiple
+// passes.
+// Scales are multiplied component-wise, which is exact for uniform scales only.
+// Non-uniform scales combined with rotations produce shearing, which can't be
+// represented by a SoaTransform. Use LocalToModelJob in this case.
+// The job does not own the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct LocalToModelTransformJob {
+  // Default constructor, initializes default values.
+  LocalToModelTransformJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer, including ranges, is NULL.
+  // -if the size of the input or the output is smaller than the skeleton's
+  // number of soa joints.
+  bool Validate() const;
+
+  // Runs job's local-to-model task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy used for local to
+  // model space conversion.
+  const Skeleton* skeleton;
+
+  // Job input.
+  // The input range that store local transforms.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Job output.
+  // The output range to be filled with model-space transforms, in soa format
+  // like the input.
+  Range<ozz::math::SoaTransform> output;
 };
 }  // animation
 }  // ozz
@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_BLENDING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_BLENDING_JOB_H_
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the animation type to sample.
+class Animation;
+
+// Forward declares the cache object used by the SamplingJob.
+class SamplingCache;
+
+// Samples and blends multiple animations to a single output, in a single job.
+// It produces the same output as running a SamplingJob per layer followed by a
+// BlendingJob, without requiring any intermediate local-space posture buffer:
+// Soa joints are processed by small chunks, every layer being interpolated to
+// a stack buffer that stays in L1 cache and is immediately accumulated to the
+// output.
+// As for the BlendingJob, the number of transforms/joints blended by the job is
+// defined by the number of transforms of the bind pose (note that this is a SoA
+// format). Additive blending isn't supported, a BlendingJob must be used for
+// that purpose.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct SampleBlendingJob {
+  // Default constructor, initializes default values.
+  SampleBlendingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if layer range is not valid (can be empty though).
+  // -if any layer is not valid: NULL animation or cache, cache too small for
+  // the animation, animation or joint weights with less soa tracks than the
+  // bind pose.
+  // -if output range is not valid.
+  // -if output is smaller than the bind pose buffer.
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's sampling and blending task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines a layer of blending input data (an animation sampled at a given
+  // time) and parameters (weights).
+  struct Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // Blending weight of this layer. Negative values are considered as 0.
+    // Normalization is performed during the blending stage so weight can be in
+    // any range, even though range [0:1] is optimal.
+    // Layers whose weight is less or equal to 0 aren't sampled.
+    float weight;
+
+    // Time used to sample the animation, clamped in range [0,duration] before
+    // job execution. See SamplingJob::time.
+    float time;
+
+    // The animation to sample. It must have at least as many soa tracks as the
+    // bind pose.
+    const Animation* animation;
+
+    // A cache object that must be big enough to sample *this animation. A
+    // cache must not be shared by multiple layers of a same job.
+    SamplingCache* cache;
+
+    // Optional range [begin,end[ of blending weight for each joint in this
+    // layer. See BlendingJob::Layer::joint_weights.
+    Range<const math::SimdFloat4> joint_weights;
+  };
+
+  // The job blends the bind pose to the output when the accumulated weight of
+  // all layers is less than this threshold value.
+  // Must be greater than 0.f.
+  float threshold;
+
+  // Job input layers, can be empty or NULL.
+  // The range of layers that must be sampled and blended.
+  Range<const Layer> layers;
+
+  // The skeleton bind pose. The size of this buffer defines the number of
+  // transforms to blend. See BlendingJob::bind_pose.
+  Range<const ozz::math::SoaTransform> bind_pose;
+
+  // Job output.
+  // The range of output transforms to be filled with blended layer
+  // transforms during job execution.
+  // Must be at least as big as the bind pose buffer, but only the number of
+  // transforms defined by the bind pose buffer size will be processed.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SAMPLE_BLENDING_JOB_H_
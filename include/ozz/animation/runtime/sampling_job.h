@@ -45,13 +45,58 @@ class Animation;
 // Forward declares the cache object used by the SamplingJob.
 class SamplingCache;
 
+// Sampling statistics, allowing to profile SamplingJob and SamplingCache
+// efficiency: cache invalidations, key frames density, decompression cost...
+// Statistics are only collected if ozz is built with OZZ_BUILD_SAMPLING_STATS
+// defined (see ozz_build_sampling_stats cmake option), so they cost nothing
+// otherwise. Jobs accumulate counters to their SamplingStats object without any
+// synchronization, so jobs run concurrently must not share the same object.
+// Use one SamplingStats per thread instead, and combine them with Accumulate()
+// once jobs are completed.
+struct SamplingStats {
+  // Default constructor, initializes all counters to 0.
+  SamplingStats();
+
+  // Resets all counters to 0.
+  void Reset();
+
+  // Adds _stats counters to *this counters.
+  void Accumulate(const SamplingStats& _stats);
+
+  // Number of times animations were sampled.
+  uint64_t num_samples;
+
+  // Number of times the cache was invalidated, because it was used with a
+  // different animation (or because SamplingCache::Invalidate() was called).
+  uint64_t num_cache_invalidations;
+
+  // Number of times the cache was restarted from the beginning of the
+  // animation, including invalidations.
+  uint64_t num_cache_restarts;
+
+  // Number of times the cache was restored from a seek point.
+  uint64_t num_cache_seeks;
+
+  // Number of key frames walked while playing forward or backward. A high
+  // number of walked keys per sample reveals a high key frames density.
+  uint64_t num_forward_keys;
+  uint64_t num_backward_keys;
+
+  // Number of soa entries (4 tracks of a transformation type) marked outdated
+  // and decompressed.
+  uint64_t num_decompressed_soa;
+};
+
 // Samples an animation at a given time, to output the corresponding posture in
 // local-space.
 // SamplingJob uses a cache (aka SamplingCache) to store intermediate values
 // (decompressed animation keyframes...) while sampling. This cache also stores
 // pre-computed values that allows drastic optimization while playing/sampling
-// the animation forward. Backward sampling works, but isn't optimized through
-// the cache.
+// the animation forward, or backward if the animation was built with reverse
+// keys (see offline::AnimationBuilder::reverse_keys). Jumping to a new time is
+// optimized if the animation was built with seek points (see
+// offline::AnimationBuilder::seek_interval). In this case the cache is restored
+// from the nearest seek point instead of being walked from the beginning.
 // The job does not owned the buffers (in/output) and will thus not delete them
 // during job's destruction.
 struct SamplingJob {
@@ -61,6 +106,8 @@ struct SamplingJob {
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer is NULL
   // -if output range is invalid.
+  // -if soa_mask isn't empty and is too small for the animation.
+  // -if [begin_soa,end_soa[ isn't a valid range.
   bool Validate() const;
 
   // Runs job's sampling task.
@@ -79,6 +126,27 @@ struct SamplingJob {
   // A cache object that must be big enough to sample *this animation.
   SamplingCache* cache;
 
+  // Optional mask of the soa tracks to sample, allowing to implement animation
+  // level of details. It stores one bit per soa track (aka 4 joints), 8 soa
+  // tracks per byte, starting with the least significant bit of the first
+  // byte. Soa tracks whose bit is 0 are not decompressed nor interpolated, and
+  // their output is left unchanged. The cache is still updated for all tracks,
+  // so that a masked track can be unmasked at any time without invalidating
+  // the cache.
+  // If not empty, the mask must be big enough to cover all animation soa
+  // tracks. Default empty mask samples all soa tracks.
+  Range<const unsigned char> soa_mask;
+
+  // Optional range [begin_soa,end_soa[ of the soa tracks to sample, allowing
+  // to split the sampling of a single posture across multiple threads. Only
+  // soa tracks of this range are decompressed and output, other output
+  // SoaTransform are left unchanged. end_soa is clamped to the number of soa
+  // tracks of the animation, so the default range [0,max int[ samples all soa
+  // tracks. Key frames are still fetched for all soa tracks, so every thread
+  // must use its own cache.
+  int begin_soa;
+  int end_soa;
+
   // Job output.
   // The output range to be filled with sampled joints during job execution.
   // If there are less joints in the animation compared to the output range,
@@ -86,6 +154,114 @@ struct SamplingJob {
   // If there are more joints in the animation, then the last joints are not
   // sampled.
   Range<ozz::math::SoaTransform> output;
+
+  // Optional statistics, accumulated by the job if ozz is built with
+  // OZZ_BUILD_SAMPLING_STATS defined. See SamplingStats.
+  SamplingStats* stats;
+};
+
+// Samples a single animation at multiple times, to output one posture per
+// time. This job is intended for crowds, where many instances play the same
+// animation at different times.
+// All times are sampled in a single forward sweep of the animation, using a
+// single cache. Every keyframe between the first and the last time is walked
+// once per batch, and soa tracks are only decompressed when their keys change
+// from one time to the next, so instances sampled between the same keys share
+// decompression. The cost of a batch is thus bounded by the number of
+// keyframes of the sampled time span, plus the interpolation of every
+// instance. This pays off when instances outnumber the keyframes of the span.
+// Otherwise, one SamplingJob and cache per instance is cheaper, as it only
+// walks the keys between an instance previous and current time, whereas the
+// batch cache restarts from the first time at every run. This requires times
+// to be sorted in ascending order, which is checked by the validation stage.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct BatchSamplingJob {
+  // Default constructor, initializes default values.
+  BatchSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL
+  // -if times are not sorted in ascending order.
+  // -if the number of outputs does not match the number of times.
+  // -if any output range is invalid.
+  // -if soa_mask isn't empty and is too small for the animation.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The animation to sample.
+  const Animation* animation;
+
+  // A cache object that must be big enough to sample *this animation. The same
+  // cache is used to sample all times.
+  SamplingCache* cache;
+
+  // Optional mask of the soa tracks to sample, shared by all times. See
+  // SamplingJob::soa_mask.
+  Range<const unsigned char> soa_mask;
+
+  // Times used to sample animation, sorted in ascending order. Each time is
+  // clamped in range [0,duration] before being sampled.
+  Range<const float> times;
+
+  // Job output.
+  // The output ranges to be filled with sampled joints during job execution,
+  // one range per time. See SamplingJob::output for each range requirements.
+  Range<const Range<ozz::math::SoaTransform> > outputs;
+
+  // Optional statistics, accumulated by the job for all times. See
+  // SamplingStats.
+  SamplingStats* stats;
+};
+
+// Samples an animation at a given time without any cache, to output the
+// corresponding posture in local-space.
+// The 2 keys to interpolate are binary searched in every track, using the
+// per-track key indices built by offline::AnimationBuilder when its track_keys
+// option is set. As opposed to the SamplingJob, sampling cost doesn't depend on
+// the previously sampled time, which suits random access use cases (motion
+// matching, trajectory prediction...) where a cache would be invalidated
+// anyway. The job doesn't write to the animation nor to any shared state, so
+// any number of jobs can sample the same animation concurrently.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct RandomAccessSamplingJob {
+  // Default constructor, initializes default values.
+  RandomAccessSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation pointer is NULL
+  // -if animation has no per-track key indices.
+  // -if output range is invalid.
+  // -if soa_mask isn't empty and is too small for the animation.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time used to sample animation, clamped in range [0,duration] before
+  // job execution.
+  float time;
+
+  // The animation to sample, which must have been built with per-track key
+  // indices (see offline::AnimationBuilder::track_keys).
+  const Animation* animation;
+
+  // Optional mask of the soa tracks to sample. See SamplingJob::soa_mask.
+  Range<const unsigned char> soa_mask;
+
+  // Job output.
+  // The output range to be filled with sampled joints during job execution.
+  // See SamplingJob::output for range requirements.
+  Range<ozz::math::SoaTransform> output;
 };
 
 namespace internal {
@@ -127,12 +303,42 @@ class SamplingCache {
   void operator=(SamplingCache const&);
 
   friend struct SamplingJob;
+  friend struct BatchSamplingJob;
+  friend struct SampleBlendingJob;
 
   // Steps the cache in order to use it for a potentially new animation and
   // time. If the _animation is different from the animation currently cached,
-  // or if the _time shows that the animation is played backward, then the
-  // cache is invalidated and reseted for the new _animation and _time.
-  void Step(const Animation& _animation, float _time);
+  // or if _time is closer to the beginning (or to the nearest seek point) than
+  // to the current time when played backward, then the cache is reseted for
+  // the new _animation and _time. The cache is always reseted when played
+  // backward if _animation has no reverse keys. The cache is then restored from
+  // the nearest seek point if _animation has any.
+  void Step(const Animation& _animation, float _time, SamplingStats* _stats);
+
+  // Steps the cache to _time, which must be in range [0,duration], and
+  // updates key frames. Decompressed values are updated for output soa tracks
+  // [_begin,_end[ selected by _mask (if not NULL). Statistics are accumulated
+  // to _stats if it isn't NULL.
+  void Update(const Animation& _animation, float _time,
+              const unsigned char* _mask, int _begin, int _end,
+              SamplingStats* _stats);
+
+  // Interpolates output soa tracks [_begin,_end[ of _animation at _time, from
+  // cache values that must have been updated to _time. _output receives soa
+  // track _begin. Soa tracks that aren't selected by _mask (if not NULL) are
+  // left unchanged.
+  void Interpolate(const Animation& _animation, float _time,
+                   const unsigned char* _mask, int _begin, int _end,
+                   math::SoaTransform* _output) const;
+
+  // Samples output soa tracks [_begin,_end[ of _animation at _time, which must
+  // be in range [0,duration], to _output. _output receives soa track _begin.
+  // The cache is stepped to _time first. Soa tracks that aren't selected by
+  // _mask (if not NULL) are left unchanged. Statistics are accumulated to
+  // _stats if it isn't NULL.
+  void Sample(const Animation& _animation, float _time,
+              const unsigned char* _mask, int _begin, int _end,
+              math::SoaTransform* _output, SamplingStats* _stats);
 
   // The animation this cache refers to. NULL means that the cache is invalid.
   const Animation* animation_;
@@ -158,6 +364,11 @@ class SamplingCache {
   int rotation_cursor_;
   int scale_cursor_;
 
+  // Current cursors in the animation reverse keys, used to play backward.
+  int translation_reverse_cursor_;
+  int rotation_reverse_cursor_;
+  int scale_reverse_cursor_;
+
   // Outdated soa entries. One bit per soa entry (32 joints per byte).
   unsigned char* outdated_translations_;
   unsigned char* outdated_rotations_;
@@ -107,6 +107,26 @@ class Skeleton {
     return joint_properties_;
   }
 
+  // Returns joint indices sorted by depth in the hierarchy, roots first. Joints
+  // of the same depth are sorted by increasing index. This permutation doesn't
+  // change joint indices, it is computed when the skeleton is built or loaded,
+  // and isn't serialized.
+  Range<const uint16_t> level_joints() const { return level_joints_; }
+
+  // Returns the offsets of every depth level in level_joints(). Level i
+  // contains joints level_joints()[levels()[i]] to
+  // level_joints()[levels()[i + 1] - 1], the last element being the number of
+  // joints. Joints of a level only depend on joints of previous levels, so
+  // hierarchical algorithms like LocalToModelJob can process a level
+  // concurrently, see LocalToModelJob::joints.
+  Range<const uint16_t> levels() const { return levels_; }
+
+  // Returns the number of levels, which is the depth of the hierarchy. See
+  // levels().
+  int num_levels() const {
+    return levels_.Count() ? static_cast<int>(levels_.Count()) - 1 : 0;
+  }
+
   // Returns joint's bind poses. Bind poses are stored in soa format.
   Range<const math::SoaTransform> bind_pose() const { return bind_pose_; }
 
@@ -130,6 +150,10 @@ class Skeleton {
   char* Allocate(size_t _char_count, size_t _num_joints);
   void Deallocate();
 
+  // Computes level_joints_ and levels_ from joint_properties_. Their buffers
+  // must be allocated.
+  void ComputeLevels();
+
   // SkeletonBuilder class is allowed to instantiate an Skeleton.
   friend class offline::SkeletonBuilder;
 
@@ -139,6 +163,13 @@ class Skeleton {
   // Array of joint properties.
   Range<JointProperties> joint_properties_;
 
+  // Joint indices sorted by depth.
+  Range<uint16_t> level_joints_;
+
+  // Offset of every level in level_joints_, followed by the number of joints.
+  // Its size is the number of levels + 1.
+  Range<uint16_t> levels_;
+
   // Bind pose of every joint in local space.
   Range<math::SoaTransform> bind_pose_;
 
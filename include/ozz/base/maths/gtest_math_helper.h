@@ -164,6 +164,17 @@ do {                                                                          \
     IMPL_EXPECT_SIMDFLOAT_EQ(expected.cols[3], _w0, _w1, _w2, _w3);           \
 } while (void(0), 0)
 
+// Macro for testing ozz::math::Float3x4 rows with x, y, z, w float values.
+#define EXPECT_FLOAT3x4_EQ(_expected, _x0, _x1, _x2, _x3, _y0, _y1, _y2, _y3, \
+                           _z0, _z1, _z2, _z3)                                \
+do {                                                                          \
+    SCOPED_TRACE("");                                                         \
+    const ozz::math::Float3x4 expected(_expected);                            \
+    IMPL_EXPECT_SIMDFLOAT_EQ(expected.rows[0], _x0, _x1, _x2, _x3);           \
+    IMPL_EXPECT_SIMDFLOAT_EQ(expected.rows[1], _y0, _y1, _y2, _y3);           \
+    IMPL_EXPECT_SIMDFLOAT_EQ(expected.rows[2], _z0, _z1, _z2, _z3);           \
+} while (void(0), 0)
+
 // Macro for testing ozz::math::SoaFloat4 members with x, y, z, w float values.
 #define EXPECT_SOAFLOAT4_EQ(_expected, _x0, _x1, _x2, _x3, _y0, _y1, _y2, _y3, \
                             _z0, _z1, _z2, _z3, _w0, _w1, _w2, _w3)            \
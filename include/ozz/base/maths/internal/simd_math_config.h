@@ -35,6 +35,12 @@
 #if !defined(OZZ_BUILD_SIMD_REF)
 
 // Try to match a SSE2+ version.
+#if defined(__AVX2__) || defined(OZZ_SIMD_AVX2)
+#include <immintrin.h>
+#define OZZ_SIMD_AVX2
+#define OZZ_SIMD_AVX  // AVX is available if AVX2 is.
+#endif
+
 #if defined(__AVX__) || defined(OZZ_SIMD_AVX)
 #include <immintrin.h>
 #define OZZ_SIMD_AVX
@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_FLOAT3X4_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_FLOAT3X4_H_
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+
+// Declares the 3x4 affine matrix type. It stores the 3 first rows of an affine
+// Float4x4, whose last row is implicitly (0, 0, 0, 1). Rows are stored (row
+// major), so the layout matches the usual 3x4 shader constants format:
+// [ m.rows[0].x m.rows[0].y m.rows[0].z m.rows[0].w ]   {v.x}
+// | m.rows[1].x m.rows[1].y m.rows[1].z m.rows[1].w | * {v.y}
+// | m.rows[2].x m.rows[2].y m.rows[2].z m.rows[2].w |   {v.z}
+// [ 0           0           0           1           ]   {v.1}
+// A Float3x4 is 48 bytes, instead of 64 for a Float4x4.
+struct Float3x4 {
+  // Matrix rows.
+  SimdFloat4 rows[3];
+
+  // Returns the identity matrix.
+  static OZZ_INLINE Float3x4 identity() {
+    const Float3x4 ret = {{simd_float4::x_axis(), simd_float4::y_axis(),
+                           simd_float4::z_axis()}};
+    return ret;
+  }
+
+  // Returns the 3x4 matrix built from the 3 first rows of _m. The last row of
+  // _m is ignored, it's assumed to be (0, 0, 0, 1).
+  static OZZ_INLINE Float3x4 FromFloat4x4(const Float4x4& _m) {
+    Float3x4 ret;
+    Transpose4x3(_m.cols, ret.rows);
+    return ret;
+  }
+};
+
+// Returns the Float4x4 affine matrix equivalent to _m.
+OZZ_INLINE Float4x4 ToFloat4x4(const Float3x4& _m) {
+  Float4x4 ret;
+  Transpose3x4(_m.rows, ret.cols);
+  ret.cols[3] = ret.cols[3] + simd_float4::w_axis();
+  return ret;
+}
+
+// Computes the transformation of a Float3x4 matrix and a point _p.
+// This is equivalent to multiplying a matrix by a SimdFloat4 with a w component
+// of 1. Returned w component is 1.
+OZZ_INLINE SimdFloat4 TransformPoint(const Float3x4& _m, _SimdFloat4 _p) {
+  SimdFloat4 cols[4];
+  Transpose3x4(_m.rows, cols);
+  return cols[0] * SplatX(_p) + cols[1] * SplatY(_p) + cols[2] * SplatZ(_p) +
+         cols[3] + simd_float4::w_axis();
+}
+
+// Computes the transformation of a Float3x4 matrix and a vector _v.
+// This is equivalent to multiplying a matrix by a SimdFloat4 with a w component
+// of 0. Returned w component is 0.
+OZZ_INLINE SimdFloat4 TransformVector(const Float3x4& _m, _SimdFloat4 _v) {
+  SimdFloat4 cols[4];
+  Transpose3x4(_m.rows, cols);
+  return cols[0] * SplatX(_v) + cols[1] * SplatY(_v) + cols[2] * SplatZ(_v);
+}
+}  // math
+}  // ozz
+
+// Computes the multiplication of affine matrices _a and _b. As the last row of
+// both matrices is (0, 0, 0, 1), it costs 9 multiplications and 9 additions,
+// instead of 16 multiplications and 12 additions for a Float4x4.
+OZZ_INLINE ozz::math::Float3x4 operator*(const ozz::math::Float3x4& _a,
+                                         const ozz::math::Float3x4& _b) {
+  using ozz::math::SimdFloat4;
+  ozz::math::Float3x4 ret;
+  for (int i = 0; i < 3; ++i) {
+    const SimdFloat4 row = _a.rows[i];
+    const SimdFloat4 translation =
+        ozz::math::And(row, ozz::math::simd_int4::mask_000f());
+    ret.rows[i] = ozz::math::MAdd(
+        ozz::math::SplatX(row), _b.rows[0],
+        ozz::math::MAdd(ozz::math::SplatY(row), _b.rows[1],
+                        ozz::math::MAdd(ozz::math::SplatZ(row), _b.rows[2],
+                                        translation)));
+  }
+  return ret;
+}
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_FLOAT3X4_H_
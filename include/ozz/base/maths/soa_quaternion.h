@@ -140,6 +140,19 @@ OZZ_INLINE SoaQuaternion NLerpEst(const SoaQuaternion& _a,
                            lerp.w * inv_len};
   return r;
 }
+
+// Returns vector _v rotated by quaternion _q. _q must be normalized.
+OZZ_INLINE SoaFloat3 TransformVector(const SoaQuaternion& _q,
+                                     const SoaFloat3& _v) {
+  // Computes _v + 2 * cross(q.xyz, cross(q.xyz, _v) + q.w * _v).
+  const SoaFloat3 qv = {_q.x, _q.y, _q.z};
+  const SoaFloat3 c = CrossProduct(qv, _v);
+  const SoaFloat3 a = {c.x + _v.x * _q.w, c.y + _v.y * _q.w,
+                       c.z + _v.z * _q.w};
+  const SoaFloat3 b = CrossProduct(qv, a);
+  const SoaFloat3 r = {_v.x + b.x + b.x, _v.y + b.y + b.y, _v.z + b.z + b.z};
+  return r;
+}
 }  // maths
 }  // ozz
 
@@ -119,6 +119,10 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
     additive_layers[0].transform = samplers_[kAdditiveAnimation].locals;
     additive_layers[0].weight = samplers_[kAdditiveAnimation].weight_setting;
 
+    // Only soa joints that the additive animation doesn't leave to identity
+    // are blended.
+    additive_layers[0].soa_ranges = additive_soa_ranges_;
+
     // Set per-joint weights for the additive blended layer.
     if (upper_body_mask_enable_) {
       additive_layers[0].joint_weights = upper_body_joint_weights_;
@@ -145,6 +149,11 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
     ltm_job.input = blended_locals_;
     ltm_job.output = models_;
 
+    // Skinning matrices are computed by the same job, multiplying model
+    // matrices by mesh inverse bind poses.
+    ltm_job.inverse_bind_poses = ozz::make_range(mesh_.inverse_bind_poses);
+    ltm_job.skinning_output = skinning_matrices_;
+
     // Run ltm job.
     if (!ltm_job.Run()) {
       return false;
@@ -155,16 +164,7 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
 
   // Samples animation, transforms to model space and renders.
   virtual bool OnDisplay(ozz::sample::Renderer* _renderer) {
-    // Update skinning matrices latest blending stage output.
-    assert(models_.Count() == skinning_matrices_.Count() &&
-           models_.Count() == mesh_.inverse_bind_poses.size());
-
-    // Builds skinning matrices, based on the output of the animation stage.
-    for (size_t i = 0; i < models_.Count(); ++i) {
-      skinning_matrices_[i] = models_[i] * mesh_.inverse_bind_poses[i];
-    }
-
-    // Renders skin.
+    // Renders skin, using skinning matrices output by the local-to-model job.
     return _renderer->DrawSkinnedMesh(mesh_, skinning_matrices_,
                                       ozz::math::Float4x4::identity(),
                                       render_options_);
@@ -230,6 +230,13 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
     upper_body_joint_weights_ =
         allocator->AllocateRange<ozz::math::SimdFloat4>(num_soa_joints);
 
+    // Computes the ranges of soa joints affected by the additive animation.
+    additive_soa_ranges_buffer_ =
+        allocator->AllocateRange<ozz::animation::BlendingJob::SoaJointRange>(
+            (num_soa_joints + 1) / 2);
+    additive_soa_ranges_ = ozz::animation::ComputeSoaJointRanges(
+        samplers_[kAdditiveAnimation].animation, additive_soa_ranges_buffer_);
+
     // Finds the "Spine1" joint in the joint hierarchy.
     for (int i = 0; i < num_joints; ++i) {
       if (std::strstr(skeleton_.joint_names()[i], "Spine1")) {
@@ -277,6 +284,7 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
       allocator->Delete(sampler.cache);
     }
     allocator->Deallocate(upper_body_joint_weights_);
+    allocator->Deallocate(additive_soa_ranges_buffer_);
     allocator->Deallocate(blended_locals_);
     allocator->Deallocate(models_);
     allocator->Deallocate(skinning_matrices_);
@@ -428,6 +436,13 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
   // weight_setting.
   ozz::Range<ozz::math::SimdFloat4> upper_body_joint_weights_;
 
+  // Ranges of soa joints that the additive animation doesn't leave to
+  // identity. additive_soa_ranges_ is the used part of
+  // additive_soa_ranges_buffer_.
+  ozz::Range<ozz::animation::BlendingJob::SoaJointRange>
+      additive_soa_ranges_buffer_;
+  ozz::Range<ozz::animation::BlendingJob::SoaJointRange> additive_soa_ranges_;
+
   // Blending job bind pose threshold.
   float threshold_;
 
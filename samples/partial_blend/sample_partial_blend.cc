@@ -109,8 +109,10 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
       layers[i].transform = samplers_[i].locals;
       layers[i].weight = samplers_[i].weight_setting;
 
-      // Set per-joint weights for the partially blended layer.
+      // Set per-joint weights for the partially blended layer, and the ranges
+      // of soa joints they affect.
       layers[i].joint_weights = samplers_[i].joint_weights;
+      layers[i].soa_ranges = samplers_[i].soa_ranges;
     }
 
     // Setups blending job.
@@ -177,6 +179,12 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
       sampler.joint_weights =
           allocator->AllocateRange<ozz::math::SimdFloat4>(num_soa_joints);
 
+      // Allocates soa joint ranges, for the worst case of one range every
+      // other soa joint.
+      sampler.soa_ranges_buffer =
+          allocator->AllocateRange<ozz::animation::BlendingJob::SoaJointRange>(
+              (num_soa_joints + 1) / 2);
+
       // Allocates a cache that matches animation requirements.
       sampler.cache = allocator->New<ozz::animation::SamplingCache>(num_joints);
     }
@@ -248,6 +256,13 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
                             upper_body_sampler.joint_weight_setting);
       }
     }
+
+    // Computes the ranges of soa joints affected by each layer.
+    for (int i = 0; i < kNumLayers; ++i) {
+      Sampler& sampler = samplers_[i];
+      sampler.soa_ranges = ozz::animation::ComputeSoaJointRanges(
+          sampler.joint_weights, sampler.soa_ranges_buffer);
+    }
   }
 
   virtual void OnDestroy() {
@@ -256,6 +271,7 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
       Sampler& sampler = samplers_[i];
       allocator->Deallocate(sampler.locals);
       allocator->Deallocate(sampler.joint_weights);
+      allocator->Deallocate(sampler.soa_ranges_buffer);
       allocator->Delete(sampler.cache);
     }
     allocator->Deallocate(blended_locals_);
@@ -399,6 +415,12 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
     // select which joints are considered during blending, and their individual
     // weight_setting.
     ozz::Range<ozz::math::SimdFloat4> joint_weights;
+
+    // Ranges of soa joints whose joint weights aren't 0, so that the blending
+    // job can skip other soa joints. soa_ranges is the used part of
+    // soa_ranges_buffer.
+    ozz::Range<ozz::animation::BlendingJob::SoaJointRange> soa_ranges_buffer;
+    ozz::Range<ozz::animation::BlendingJob::SoaJointRange> soa_ranges;
   } samplers_[kNumLayers];  // kNumLayers animations to blend.
 
   // Index of the joint at the base of the upper body hierarchy.
@@ -34,9 +34,13 @@
 #include <limits>
 
 #include "ozz/base/containers/vector.h"
+#include "ozz/base/log.h"
 #include "ozz/base/memory/allocator.h"
 
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/maths/vec_float.h"
 
 #include "ozz/animation/offline/raw_animation.h"
 
@@ -77,28 +81,36 @@ bool SortingKeyLess(const _Key& _left, const _Key& _right) {
           _left.track < _right.track);
 }
 
-template <typename _SrcKey, typename _DestTrack>
-void PushBackIdentityKey(uint16_t _track, float _time, _DestTrack* _dest) {
-  typedef typename _DestTrack::value_type DestKey;
-  float prev_time = -1.f;
-  if (!_dest->empty() && _dest->back().track == _track) {
-    prev_time = _dest->back().key.time;
-  }
-  const DestKey key = {_track, prev_time, {_time, _SrcKey::identity()}};
-  _dest->push_back(key);
+// Converts _time to the 16 bits ratio of _duration used by runtime key frames.
+uint16_t TimeToRatio(float _time, float _duration) {
+  const int ratio = static_cast<int>(floor(_time / _duration * 65535.f + .5f));
+  return static_cast<uint16_t>(math::Clamp(0, ratio, 65535));
+}
+
+// Snaps _time to the closest time that a runtime key frame can represent.
+float SnapTime(float _time, float _duration) {
+  return static_cast<float>(TimeToRatio(_time, _duration)) / 65535.f *
+         _duration;
 }
 
 // Copies a track from a RawAnimation to an Animation.
 // Also fixes up the front (t = 0) and back keys (t = duration).
+// Key times are snapped to the precision of runtime key frames ratios. Keys
+// that are too close to be distinguished once snapped are merged, keeping the
+// value of the last one, so that the value reached after a discontinuity is
+// preserved. Returns the number of merged keys.
 template <typename _SrcTrack, typename _DestTrack>
-void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
+size_t CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
              _DestTrack* _dest) {
   typedef typename _SrcTrack::value_type SrcKey;
   typedef typename _DestTrack::value_type DestKey;
 
+  size_t merged = 0;
   if (_src.size() == 0) {  // Adds 2 new keys.
-    PushBackIdentityKey<SrcKey, _DestTrack>(_track, 0.f, _dest);
-    PushBackIdentityKey<SrcKey, _DestTrack>(_track, _duration, _dest);
+    const DestKey first = {_track, -1.f, {0.f, SrcKey::identity()}};
+    _dest->push_back(first);
+    const DestKey last = {_track, 0.f, {_duration, SrcKey::identity()}};
+    _dest->push_back(last);
   } else if (_src.size() == 1) {  // Adds 1 new key.
     const SrcKey& raw_key = _src.front();
     assert(raw_key.time >= 0 && raw_key.time <= _duration);
@@ -108,7 +120,7 @@ void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
     _dest->push_back(last);
   } else {  // Copies all keys, and fixes up first and last keys.
     float prev_time = -1.f;
-    if (_src.front().time != 0.f) {  // Needs a key at t = 0.f.
+    if (SnapTime(_src.front().time, _duration) != 0.f) {  // Needs a key at 0.
       const DestKey first = {_track, prev_time, {0.f, _src.front().value}};
       _dest->push_back(first);
       prev_time = 0.f;
@@ -116,61 +128,285 @@ void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
     for (size_t k = 0; k < _src.size(); ++k) {  // Copies all keys.
       const SrcKey& raw_key = _src[k];
       assert(raw_key.time >= 0 && raw_key.time <= _duration);
-      const DestKey key = {_track, prev_time, {raw_key.time, raw_key.value}};
+      const float time = SnapTime(raw_key.time, _duration);
+      if (time == prev_time) {  // Overwrites previous key value.
+        _dest->back().key.value = raw_key.value;
+        ++merged;
+        continue;
+      }
+      const DestKey key = {_track, prev_time, {time, raw_key.value}};
       _dest->push_back(key);
-      prev_time = raw_key.time;
+      prev_time = time;
     }
-    if (_src.back().time != _duration) {  // Needs a key at t = _duration.
+    if (prev_time != _duration) {  // Needs a key at t = _duration.
       const DestKey last = {_track, prev_time, {_duration, _src.back().value}};
       _dest->push_back(last);
     }
   }
   assert(_dest->front().key.time == 0.f && _dest->back().key.time == _duration);
+  return merged;
 }
 
-void CopyToAnimation(ozz::Vector<SortingTranslationKey>::Std* _src,
-                     ozz::Range<TranslationKey>* _dest) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return;
+// Tests if all the keys of _src have the same value. A track without any key
+// is constant, as its value is identity.
+template <typename _SrcTrack>
+bool IsConstant(const _SrcTrack& _src) {
+  for (size_t k = 1; k < _src.size(); ++k) {
+    if (!(_src[k].value == _src.front().value)) {
+      return false;
+    }
   }
+  return true;
+}
 
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1,
-            &SortingKeyLess<SortingTranslationKey>);
+// Gets the value of track _track, which must be constant (see IsConstant()).
+// Tracks beyond _input tracks, used for soa padding, are identity.
+template <typename _SrcTrack>
+typename _SrcTrack::value_type::Value GetConstant(
+    const RawAnimation& _input, _SrcTrack RawAnimation::JointTrack::*_member,
+    int _track) {
+  typedef typename _SrcTrack::value_type SrcKey;
+  if (_track >= _input.num_tracks()) {
+    return SrcKey::identity();
+  }
+  const _SrcTrack& src = _input.tracks[_track].*_member;
+  assert(IsConstant(src));
+  return src.empty() ? SrcKey::identity() : src.front().value;
+}
 
-  // Fills output.
-  const SortingTranslationKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
-    TranslationKey& key = _dest->begin[i];
-    key.time = src[i].key.time;
-    key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
+// Copies all tracks of a transformation type (selected by _member) from a
+// RawAnimation to the sorting structure _dest.
+// Soa tracks whose 4 tracks are constant aren't copied, their index is pushed
+// back to _constants instead. Other soa tracks indices are pushed back to
+// _animated, and their keys are copied with a track number that is the index
+// in the compact list of animated tracks. Constant tracks of an animated soa
+// track only get the 2 keys required at t = 0 and t = duration.
+// Returns the number of keys merged by CopyRaw().
+template <typename _SrcTrack, typename _DestTrack>
+size_t CopyRawTracks(const RawAnimation& _input,
+                   _SrcTrack RawAnimation::JointTrack::*_member,
+                   float _duration, _DestTrack* _dest,
+                   ozz::Vector<uint16_t>::Std* _animated,
+                   ozz::Vector<uint16_t>::Std* _constants) {
+  typedef typename _DestTrack::value_type DestKey;
+  const int num_tracks = _input.num_tracks();
+  const int num_soa_tracks = (num_tracks + 3) / 4;
+  size_t merged = 0;
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    bool constant = true;
+    for (int j = i * 4; constant && j < i * 4 + 4 && j < num_tracks; ++j) {
+      constant = IsConstant(_input.tracks[j].*_member);
+    }
+    if (constant) {
+      _constants->push_back(static_cast<uint16_t>(i));
+      continue;
+    }
+
+    const size_t first_track = _animated->size() * 4;
+    _animated->push_back(static_cast<uint16_t>(i));
+    for (int j = 0; j < 4; ++j) {
+      const int raw_track = i * 4 + j;
+      const uint16_t track = static_cast<uint16_t>(first_track + j);
+      if (raw_track < num_tracks &&
+          !IsConstant(_input.tracks[raw_track].*_member)) {
+        merged +=
+            CopyRaw(_input.tracks[raw_track].*_member, track, _duration, _dest);
+      } else {
+        const DestKey first = {
+            track, -1.f, {0.f, GetConstant(_input, _member, raw_track)}};
+        _dest->push_back(first);
+        const DestKey last = {track, 0.f, {_duration, first.key.value}};
+        _dest->push_back(last);
+      }
+    }
+  }
+  return merged;
+}
+
+// Gets the value of rotation track _track, which must be constant. It is
+// normalized and uses the same w >= 0 convention as key frames.
+math::Quaternion GetRotationConstant(const RawAnimation& _input, int _track) {
+  const math::Quaternion value =
+      GetConstant(_input, &RawAnimation::JointTrack::rotations, _track);
+  const math::Quaternion normalized =
+      NormalizeSafe(value, math::Quaternion::identity());
+  return normalized.w < 0.f ? -normalized : normalized;
+}
+
+// Tests if the 4 tracks of constant soa track _soa_track are identity.
+template <typename _SrcTrack>
+bool IsIdentity(const RawAnimation& _input,
+                _SrcTrack RawAnimation::JointTrack::*_member, int _soa_track) {
+  typedef typename _SrcTrack::value_type SrcKey;
+  for (int j = _soa_track * 4; j < _soa_track * 4 + 4; ++j) {
+    if (!(GetConstant(_input, _member, j) == SrcKey::identity())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Specialize for rotations, which are normalized before being compared.
+bool IsIdentity(const RawAnimation& _input,
+                RawAnimation::JointTrack::Rotations RawAnimation::JointTrack::*,
+                int _soa_track) {
+  for (int j = _soa_track * 4; j < _soa_track * 4 + 4; ++j) {
+    if (!(GetRotationConstant(_input, j) == math::Quaternion::identity())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Moves identity soa tracks from _constants to _identities. Their value doesn't
+// need to be stored.
+template <typename _SrcTrack>
+void SplitIdentities(const RawAnimation& _input,
+                     _SrcTrack RawAnimation::JointTrack::*_member,
+                     ozz::Vector<uint16_t>::Std* _constants,
+                     ozz::Vector<uint16_t>::Std* _identities) {
+  size_t count = 0;
+  for (size_t i = 0; i < _constants->size(); ++i) {
+    const uint16_t soa_track = (*_constants)[i];
+    if (IsIdentity(_input, _member, soa_track)) {
+      _identities->push_back(soa_track);
+    } else {
+      (*_constants)[count++] = soa_track;
+    }
+  }
+  _constants->resize(count);
+}
+
+// Copies translation or scale constant soa tracks values to the animation.
+template <typename _SrcTrack>
+void CopyConstants(const RawAnimation& _input,
+                   _SrcTrack RawAnimation::JointTrack::*_member,
+                   const ozz::Vector<uint16_t>::Std& _constants,
+                   ozz::Range<math::SoaFloat3>* _dest) {
+  for (size_t i = 0; i < _constants.size(); ++i) {
+    math::Float3 values[4];
+    for (int j = 0; j < 4; ++j) {
+      values[j] = GetConstant(_input, _member, _constants[i] * 4 + j);
+    }
+    math::SoaFloat3& dest = _dest->begin[i];
+    dest.x = math::simd_float4::Load(values[0].x, values[1].x, values[2].x,
+                                     values[3].x);
+    dest.y = math::simd_float4::Load(values[0].y, values[1].y, values[2].y,
+                                     values[3].y);
+    dest.z = math::simd_float4::Load(values[0].z, values[1].z, values[2].z,
+                                     values[3].z);
+  }
+}
+
+// Specialize for rotations in order to normalize quaternions.
+void CopyConstants(const RawAnimation& _input,
+                   const ozz::Vector<uint16_t>::Std& _constants,
+                   ozz::Range<math::SoaQuaternion>* _dest) {
+  for (size_t i = 0; i < _constants.size(); ++i) {
+    math::Quaternion values[4];
+    for (int j = 0; j < 4; ++j) {
+      values[j] = GetRotationConstant(_input, _constants[i] * 4 + j);
+    }
+    math::SoaQuaternion& dest = _dest->begin[i];
+    dest.x = math::simd_float4::Load(values[0].x, values[1].x, values[2].x,
+                                     values[3].x);
+    dest.y = math::simd_float4::Load(values[0].y, values[1].y, values[2].y,
+                                     values[3].y);
+    dest.z = math::simd_float4::Load(values[0].z, values[1].z, values[2].z,
+                                     values[3].z);
+    dest.w = math::simd_float4::Load(values[0].w, values[1].w, values[2].w,
+                                     values[3].w);
+  }
+}
+
+// Copies output soa track indices to the animation, animated ones first, then
+// constant ones and identity ones.
+void CopySoaTracks(const ozz::Vector<uint16_t>::Std& _animated,
+                   const ozz::Vector<uint16_t>::Std& _constants,
+                   const ozz::Vector<uint16_t>::Std& _identities,
+                   ozz::Range<uint16_t>* _dest) {
+  assert(_animated.size() + _constants.size() + _identities.size() ==
+         _dest->Count());
+  uint16_t* dest = _dest->begin;
+  dest = std::copy(_animated.begin(), _animated.end(), dest);
+  dest = std::copy(_constants.begin(), _constants.end(), dest);
+  std::copy(_identities.begin(), _identities.end(), dest);
+}
+
+// Quantizes _value to a 16 bits unsigned integer, where 0 matches _min and
+// 65535 matches _min + _extent.
+uint16_t Quantize(float _value, float _min, float _extent) {
+  if (!(_extent > 0.f)) {
+    return 0;
   }
+  const float ratio = (_value - _min) / _extent;
+  const int quantized = static_cast<int>(floor(ratio * 65535.f + .5f));
+  return static_cast<uint16_t>(math::Clamp(0, quantized, 65535));
 }
 
-void CopyToAnimation(ozz::Vector<SortingScaleKey>::Std* _src,
-                     ozz::Range<ScaleKey>* _dest) {
+// Copies translation or scale keys to the animation.
+// Values are quantized within the range of values of their track, which is
+// also output to _ranges in soa format (min and step entries per soa track).
+template <typename _Src, typename _Key>
+void CopyToAnimation(_Src* _src, float _duration, ozz::Range<_Key>* _dest,
+                     ozz::Range<math::SoaFloat3>* _ranges) {
+  typedef typename _Src::value_type SortingKey;
   const size_t src_count = _src->size();
   if (!src_count) {
     return;
   }
 
+  // Computes the range of values of every track.
+  const size_t num_tracks = _ranges->Count() / 2 * 4;
+  const float kMaxFloat = std::numeric_limits<float>::max();
+  ozz::Vector<math::Float3>::Std mins(num_tracks, math::Float3(kMaxFloat));
+  ozz::Vector<math::Float3>::Std maxs(num_tracks, math::Float3(-kMaxFloat));
+  for (size_t i = 0; i < src_count; ++i) {
+    const SortingKey& src = _src->at(i);
+    mins[src.track] = Min(mins[src.track], src.key.value);
+    maxs[src.track] = Max(maxs[src.track], src.key.value);
+  }
+  ozz::Vector<math::Float3>::Std extents(num_tracks);
+  for (size_t i = 0; i < num_tracks; ++i) {
+    extents[i] = maxs[i] - mins[i];
+  }
+
+  // Stores ranges in soa format.
+  const math::SimdFloat4 kInvMax = math::simd_float4::Load1(1.f / 65535.f);
+  for (size_t i = 0; i < num_tracks; i += 4) {
+    math::SoaFloat3& min = _ranges->begin[i / 4 * 2 + 0];
+    math::SoaFloat3& step = _ranges->begin[i / 4 * 2 + 1];
+    min.x = math::simd_float4::Load(mins[i].x, mins[i + 1].x, mins[i + 2].x,
+                                    mins[i + 3].x);
+    min.y = math::simd_float4::Load(mins[i].y, mins[i + 1].y, mins[i + 2].y,
+                                    mins[i + 3].y);
+    min.z = math::simd_float4::Load(mins[i].z, mins[i + 1].z, mins[i + 2].z,
+                                    mins[i + 3].z);
+    step.x = math::simd_float4::Load(extents[i].x, extents[i + 1].x,
+                                     extents[i + 2].x, extents[i + 3].x) *
+             kInvMax;
+    step.y = math::simd_float4::Load(extents[i].y, extents[i + 1].y,
+                                     extents[i + 2].y, extents[i + 3].y) *
+             kInvMax;
+    step.z = math::simd_float4::Load(extents[i].z, extents[i + 1].z,
+                                     extents[i + 2].z, extents[i + 3].z) *
+             kInvMax;
+  }
+
   // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1,
-            &SortingKeyLess<SortingScaleKey>);
+  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingKey>);
 
   // Fills output.
-  const SortingScaleKey* src = &_src->front();
+  const SortingKey* src = &_src->front();
   for (size_t i = 0; i < src_count; ++i) {
-    ScaleKey& key = _dest->begin[i];
-    key.time = src[i].key.time;
-    key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
+    _Key& key = _dest->begin[i];
+    const uint16_t track = src[i].track;
+    const math::Float3& value = src[i].key.value;
+    key.ratio = TimeToRatio(src[i].key.time, _duration);
+    key.track = track;
+    key.value[0] = Quantize(value.x, mins[track].x, extents[track].x);
+    key.value[1] = Quantize(value.y, mins[track].y, extents[track].y);
+    key.value[2] = Quantize(value.z, mins[track].z, extents[track].z);
   }
 }
 
@@ -214,7 +450,7 @@ void CompressQuat(const ozz::math::Quaternion& _src,
 // Consecutive opposite quaternions are also fixed up in order to avoid checking
 // for the smallest path during the NLerp runtime algorithm.
 void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
-                     ozz::Range<RotationKey>* _dest) {
+                     float _duration, ozz::Range<RotationKey>* _dest) {
   const size_t src_count = _src->size();
   if (!src_count) {
     return;
@@ -256,15 +492,155 @@ void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
   for (size_t i = 0; i < src_count; ++i) {
     const SortingRotationKey& skey = src[i];
     RotationKey& dkey = _dest->begin[i];
-    dkey.time = skey.key.time;
+    dkey.ratio = TimeToRatio(skey.key.time, _duration);
     dkey.track = skey.track;
 
     // Compress quaternion to destination container.
     CompressQuat(skey.key.value, &dkey);
   }
 }
+
+// Computes the number of seek points required for an animation of duration
+// _duration. Seek points are placed at every multiple of _interval, strictly
+// between 0 and _duration.
+int CountSeekPoints(float _duration, float _interval) {
+  if (_interval <= 0.f) {
+    return 0;
+  }
+  int count = 0;
+  while (static_cast<float>(count + 1) * _interval < _duration) {
+    ++count;
+  }
+  return count;
+}
+
+// Reverse key, sorted by successor time and track.
+struct SortingReverseKey {
+  uint16_t next_key_ratio;
+  uint16_t track;
+  int key;
+};
+
+bool SortingReverseKeyLess(const SortingReverseKey& _left,
+                           const SortingReverseKey& _right) {
+  return _left.next_key_ratio < _right.next_key_ratio ||
+         (_left.next_key_ratio == _right.next_key_ratio &&
+          _left.track < _right.track);
+}
+
+// Fills reverse keys, which are the indices of all _keys that have a successor
+// in their track, sorted by successor time and then track. Nothing is done if
+// reverse keys weren't allocated.
+template <typename _Key>
+void BuildReverseKeys(ozz::Range<const _Key> _keys, int _num_soa_tracks,
+                      ozz::Range<uint16_t>* _reverse) {
+  if (_reverse->Count() == 0) {
+    return;
+  }
+  const int num_tracks = _num_soa_tracks * 4;
+  ozz::Vector<int>::Std last(num_tracks, -1);
+  ozz::Vector<SortingReverseKey>::Std sorting;
+  sorting.reserve(_reverse->Count());
+  for (const _Key* key = _keys.begin; key < _keys.end; ++key) {
+    const uint16_t track = key->track;
+    if (last[track] >= 0) {
+      const SortingReverseKey reverse = {key->ratio, track, last[track]};
+      sorting.push_back(reverse);
+    }
+    last[track] = static_cast<int>(key - _keys.begin);
+  }
+  assert(sorting.size() == _reverse->Count());
+
+  std::sort(sorting.begin(), sorting.end(), &SortingReverseKeyLess);
+  for (size_t i = 0; i < sorting.size(); ++i) {
+    _reverse->begin[i] = static_cast<uint16_t>(sorting[i].key);
+  }
+}
+
+// Fills seek points, by replaying SamplingJob key frames fetching algorithm on
+// the sorted _keys.
+template <typename _Key>
+void BuildSeekPoints(ozz::Range<const _Key> _keys,
+                     ozz::Range<const uint16_t> _reverse, int _num_soa_tracks,
+                     float _duration, float _interval,
+                     ozz::Range<int>* _seeks) {
+  const int num_tracks = _num_soa_tracks * 4;
+  const int stride = 2 + num_tracks * 2;
+  const int num_seeks = static_cast<int>(_seeks->Count()) / stride;
+  if (!num_seeks) {
+    return;
+  }
+
+  // Initializes interpolated entries with the first 2 sets of key frames, as
+  // done by the SamplingJob.
+  ozz::Vector<int>::Std cache(num_tracks * 2);
+  for (int i = 0; i < num_tracks; ++i) {
+    cache[i * 2 + 0] = i;
+    cache[i * 2 + 1] = i + num_tracks;
+  }
+  const _Key* cursor = _keys.begin + num_tracks * 2;
+  const uint16_t* reverse_cursor = _reverse.begin;
+
+  for (int i = 0; i < num_seeks; ++i) {
+    // Iterates up to seek point time, converted to key frames ratio unit the
+    // same way SamplingJob does.
+    const float time = static_cast<float>(i + 1) * _interval;
+    const float ratio = time / _duration * 65535.f;
+    while (cursor < _keys.end &&
+           _keys.begin[cache[cursor->track * 2 + 1]].ratio <= ratio) {
+      const int base = cursor->track * 2;
+      cache[base] = cache[base + 1];
+      cache[base + 1] = static_cast<int>(cursor - _keys.begin);
+      ++cursor;
+    }
+    while (reverse_cursor < _reverse.end &&
+           *reverse_cursor < cache[_keys.begin[*reverse_cursor].track * 2]) {
+      ++reverse_cursor;
+    }
+
+    // Stores cursors and interpolated entries.
+    int* seek = _seeks->begin + i * stride;
+    seek[0] = static_cast<int>(cursor - _keys.begin);
+    seek[1] = static_cast<int>(reverse_cursor - _reverse.begin);
+    std::copy(cache.begin(), cache.end(), seek + 2);
+  }
+}
+
+// Fills the per-track index of _keys, which lists the keys of every track in
+// time order, preceded by the offset of every track in this list. Nothing is
+// done if the index wasn't allocated.
+template <typename _Key>
+void BuildTrackKeys(ozz::Range<const _Key> _keys, int _num_soa_tracks,
+                    ozz::Range<int>* _track_keys) {
+  if (_track_keys->Count() == 0) {
+    return;
+  }
+  const int num_tracks = _num_soa_tracks * 4;
+  int* offsets = _track_keys->begin;
+  int* indices = _track_keys->begin + num_tracks + 1;
+  assert(indices + _keys.Count() == _track_keys->end);
+
+  // Counts keys per track, and deduces offsets.
+  ozz::Vector<int>::Std counts(num_tracks, 0);
+  for (const _Key* key = _keys.begin; key < _keys.end; ++key) {
+    ++counts[key->track];
+  }
+  offsets[0] = 0;
+  for (int i = 0; i < num_tracks; ++i) {
+    offsets[i + 1] = offsets[i] + counts[i];
+  }
+
+  // Keys are sorted by time within a track, so they can be pushed in order.
+  ozz::Vector<int>::Std cursors(offsets, offsets + num_tracks);
+  for (const _Key* key = _keys.begin; key < _keys.end; ++key) {
+    indices[cursors[key->track]++] = static_cast<int>(key - _keys.begin);
+  }
+}
 }  // namespace
 
+AnimationBuilder::AnimationBuilder()
+    : seek_interval(0.f), reverse_keys(false), track_keys(false) {}
+
 // Ensures _input's validity and allocates _animation.
 // An animation needs to have at least two key frames per joint, the first at
 // t = 0 and the last at t = duration. If at least one of those keys are not
@@ -291,7 +667,6 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   // already been validated.
   const uint16_t num_tracks = static_cast<uint16_t>(_input.num_tracks());
   animation->num_tracks_ = num_tracks;
-  const uint16_t num_soa_tracks = math::Align(num_tracks, 4);
 
   // Declares and preallocates tracks to sort.
   size_t translations = 0, rotations = 0, scales = 0;
@@ -309,37 +684,118 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   sorting_scales.reserve(scales);
 
   // Filters RawAnimation keys and copies them to the output sorting structure.
-  uint16_t i = 0;
-  for (; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    CopyRaw(raw_track.translations, i, duration, &sorting_translations);
-    CopyRaw(raw_track.rotations, i, duration, &sorting_rotations);
-    CopyRaw(raw_track.scales, i, duration, &sorting_scales);
+  // Constant soa tracks are filtered out.
+  ozz::Vector<uint16_t>::Std animated_translations, constant_translations;
+  size_t merged = CopyRawTracks(
+      _input, &RawAnimation::JointTrack::translations, duration,
+      &sorting_translations, &animated_translations, &constant_translations);
+  ozz::Vector<uint16_t>::Std animated_rotations, constant_rotations;
+  merged += CopyRawTracks(_input, &RawAnimation::JointTrack::rotations,
+                          duration, &sorting_rotations, &animated_rotations,
+                          &constant_rotations);
+  ozz::Vector<uint16_t>::Std animated_scales, constant_scales;
+  merged += CopyRawTracks(_input, &RawAnimation::JointTrack::scales, duration,
+                          &sorting_scales, &animated_scales, &constant_scales);
+  if (merged != 0) {
+    log::LogV() << merged << " key(s) closer than duration / 65535 to the"
+                << " previous key of their track were merged, keeping the"
+                << " last value." << std::endl;
   }
-
-  // Add enough identity keys to match soa requirements.
-  for (; i < num_soa_tracks; ++i) {
-    typedef RawAnimation::TranslationKey SrcTKey;
-    PushBackIdentityKey<SrcTKey>(i, 0.f, &sorting_translations);
-    PushBackIdentityKey<SrcTKey>(i, duration, &sorting_translations);
-
-    typedef RawAnimation::RotationKey SrcRKey;
-    PushBackIdentityKey<SrcRKey>(i, 0.f, &sorting_rotations);
-    PushBackIdentityKey<SrcRKey>(i, duration, &sorting_rotations);
-
-    typedef RawAnimation::ScaleKey SrcSKey;
-    PushBackIdentityKey<SrcSKey>(i, 0.f, &sorting_scales);
-    PushBackIdentityKey<SrcSKey>(i, duration, &sorting_scales);
+  animation->num_translation_soa_tracks_ =
+      static_cast<int>(animated_translations.size());
+  animation->num_rotation_soa_tracks_ =
+      static_cast<int>(animated_rotations.size());
+  animation->num_scale_soa_tracks_ = static_cast<int>(animated_scales.size());
+
+  // Identity constant soa tracks values aren't stored.
+  ozz::Vector<uint16_t>::Std identity_translations, identity_rotations,
+      identity_scales;
+  SplitIdentities(_input, &RawAnimation::JointTrack::translations,
+                  &constant_translations, &identity_translations);
+  SplitIdentities(_input, &RawAnimation::JointTrack::rotations,
+                  &constant_rotations, &identity_rotations);
+  SplitIdentities(_input, &RawAnimation::JointTrack::scales, &constant_scales,
+                  &identity_scales);
+  animation->num_translation_identities_ =
+      static_cast<int>(identity_translations.size());
+  animation->num_rotation_identities_ =
+      static_cast<int>(identity_rotations.size());
+  animation->num_scale_identities_ = static_cast<int>(identity_scales.size());
+
+  // Computes seek points count.
+  const int num_seeks = CountSeekPoints(duration, seek_interval);
+  animation->seek_interval_ = num_seeks ? seek_interval : 0.f;
+
+  // Reverse keys are 16 bits indices, which limits the number of keys.
+  const size_t max_reverse_keys = Animation::kMaxReverseKeys;
+  const bool build_reverse_keys =
+      reverse_keys && sorting_translations.size() <= max_reverse_keys &&
+      sorting_rotations.size() <= max_reverse_keys &&
+      sorting_scales.size() <= max_reverse_keys;
+  if (reverse_keys && !build_reverse_keys) {
+    log::Log() << "Reverse keys aren't built, as the animation has more than "
+               << max_reverse_keys << " keys of a transformation type."
+               << std::endl;
   }
 
   // Allocate animation members.
   animation->Allocate(_input.name.length() + 1, sorting_translations.size(),
-                      sorting_rotations.size(), sorting_scales.size());
+                      sorting_rotations.size(), sorting_scales.size(),
+                      num_seeks, build_reverse_keys, track_keys);
+
+  // Copy soa tracks indices and constant values to final animation.
+  CopySoaTracks(animated_translations, constant_translations,
+                identity_translations, &animation->translation_soa_tracks_);
+  CopySoaTracks(animated_rotations, constant_rotations, identity_rotations,
+                &animation->rotation_soa_tracks_);
+  CopySoaTracks(animated_scales, constant_scales, identity_scales,
+                &animation->scale_soa_tracks_);
+  CopyConstants(_input, &RawAnimation::JointTrack::translations,
+                constant_translations, &animation->translation_constants_);
+  CopyConstants(_input, constant_rotations, &animation->rotation_constants_);
+  CopyConstants(_input, &RawAnimation::JointTrack::scales, constant_scales,
+                &animation->scale_constants_);
 
   // Copy sorted keys to final animation.
-  CopyToAnimation(&sorting_translations, &animation->translations_);
-  CopyToAnimation(&sorting_rotations, &animation->rotations_);
-  CopyToAnimation(&sorting_scales, &animation->scales_);
+  CopyToAnimation(&sorting_translations, duration, &animation->translations_,
+                  &animation->translation_ranges_);
+  CopyToAnimation(&sorting_rotations, duration, &animation->rotations_);
+  CopyToAnimation(&sorting_scales, duration, &animation->scales_,
+                  &animation->scale_ranges_);
+
+  // Builds reverse keys from sorted keys.
+  const int translation_soa_tracks = animation->num_translation_soa_tracks_;
+  const int rotation_soa_tracks = animation->num_rotation_soa_tracks_;
+  const int scale_soa_tracks = animation->num_scale_soa_tracks_;
+  BuildReverseKeys<TranslationKey>(animation->translations_,
+                                   translation_soa_tracks,
+                                   &animation->reverse_translations_);
+  BuildReverseKeys<RotationKey>(animation->rotations_, rotation_soa_tracks,
+                                &animation->reverse_rotations_);
+  BuildReverseKeys<ScaleKey>(animation->scales_, scale_soa_tracks,
+                             &animation->reverse_scales_);
+
+  // Builds seek points from sorted keys.
+  BuildSeekPoints<TranslationKey>(
+      animation->translations_, animation->reverse_translations_,
+      translation_soa_tracks, duration, seek_interval,
+      &animation->translation_seeks_);
+  BuildSeekPoints<RotationKey>(
+      animation->rotations_, animation->reverse_rotations_,
+      rotation_soa_tracks, duration, seek_interval,
+      &animation->rotation_seeks_);
+  BuildSeekPoints<ScaleKey>(animation->scales_, animation->reverse_scales_,
+                            scale_soa_tracks, duration, seek_interval,
+                            &animation->scale_seeks_);
+
+  // Builds per-track key indices from sorted keys.
+  BuildTrackKeys<TranslationKey>(animation->translations_,
+                                 translation_soa_tracks,
+                                 &animation->translation_track_keys_);
+  BuildTrackKeys<RotationKey>(animation->rotations_, rotation_soa_tracks,
+                              &animation->rotation_track_keys_);
+  BuildTrackKeys<ScaleKey>(animation->scales_, scale_soa_tracks,
+                           &animation->scale_track_keys_);
 
   // Copy animation's name.
   strcpy(animation->name_, _input.name.c_str());
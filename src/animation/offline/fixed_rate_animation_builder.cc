@@ -0,0 +1,172 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/fixed_rate_animation_builder.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+
+#include "ozz/animation/runtime/fixed_rate_animation.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Samples a track at time _time, using _lerp interpolation function.
+// Returns _identity if the track has no key.
+template <typename _Track, typename _Value>
+_Value SampleTrack(const _Track& _track, float _time, const _Value& _identity,
+                   _Value (*_lerp)(const _Value&, const _Value&, float)) {
+  if (_track.empty()) {
+    return _identity;
+  }
+  if (_time <= _track.front().time) {
+    return _track.front().value;
+  }
+  if (_time >= _track.back().time) {
+    return _track.back().value;
+  }
+  // Keys are sorted, finds the first key after _time. Tracks are walked
+  // linearly as the builder isn't performance critical.
+  size_t k = 1;
+  while (_track[k].time <= _time) {
+    ++k;
+  }
+  const float alpha =
+      (_time - _track[k - 1].time) / (_track[k].time - _track[k - 1].time);
+  return _lerp(_track[k - 1].value, _track[k].value, alpha);
+}
+
+int16_t QuantizeRotation(float _value) {
+  return static_cast<int16_t>(
+      floorf(math::Clamp(-1.f, _value, 1.f) * 32767.f + .5f));
+}
+}  // namespace
+
+FixedRateAnimationBuilder::FixedRateAnimationBuilder() : frequency(30.f) {}
+
+FixedRateAnimation* FixedRateAnimationBuilder::operator()(
+    const RawAnimation& _input) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate() || !(frequency > 0.f)) {
+    return NULL;
+  }
+
+  // Everything is fine, allocates and fills the animation.
+  // Nothing can fail now.
+  FixedRateAnimation* animation =
+      memory::default_allocator()->New<FixedRateAnimation>();
+
+  // Sets duration.
+  const float duration = _input.duration;
+  animation->duration_ = duration;
+  assert(duration > 0.f);  // This case is handled by Validate().
+
+  // Computes the number of frames, with at least the first and last ones.
+  const int num_intervals =
+      math::Max(1, static_cast<int>(ceilf(duration * frequency)));
+  const int num_frames = num_intervals + 1;
+  animation->num_frames_ = num_frames;
+
+  // Sets tracks count.
+  const int num_tracks = _input.num_tracks();
+  animation->num_tracks_ = num_tracks;
+  const int num_soa_tracks = animation->num_soa_tracks();
+
+  // Allocate animation members.
+  animation->Allocate(_input.name.length() + 1, num_frames * num_soa_tracks);
+
+  // Samples all tracks at every frame. Padding tracks are set to identity.
+  const math::Float3 t_identity = math::Float3::zero();
+  const math::Quaternion r_identity = math::Quaternion::identity();
+  const math::Float3 s_identity = math::Float3::one();
+  for (int i = 0; i < num_soa_tracks * 4; ++i) {
+    const int soa = i / 4;
+    const int lane = i & 3;
+    math::Quaternion prev_rotation = r_identity;
+    for (int f = 0; f < num_frames; ++f) {
+      const float time = f < num_intervals ? duration * f / num_intervals
+                                           : duration;  // Avoids rounding.
+      math::Float3 translation = t_identity;
+      math::Quaternion rotation = r_identity;
+      math::Float3 scale = s_identity;
+      if (i < num_tracks) {
+        const RawAnimation::JointTrack& track = _input.tracks[i];
+        translation = SampleTrack(track.translations, time, t_identity,
+                                  &LerpTranslation);
+        rotation =
+            SampleTrack(track.rotations, time, r_identity, &LerpRotation);
+        scale = SampleTrack(track.scales, time, s_identity, &LerpScale);
+      }
+
+      // Ensures that rotations are interpolated along the shortest path, so
+      // that runtime doesn't need to test it.
+      rotation = math::NormalizeSafe(rotation, r_identity);
+      const float dot = prev_rotation.x * rotation.x +
+                        prev_rotation.y * rotation.y +
+                        prev_rotation.z * rotation.z +
+                        prev_rotation.w * rotation.w;
+      if (dot < 0.f) {
+        rotation = -rotation;
+      }
+      prev_rotation = rotation;
+
+      FixedRateSoaKey& key = animation->keys_.begin[f * num_soa_tracks + soa];
+      key.translation[0][lane] = math::FloatToHalf(translation.x);
+      key.translation[1][lane] = math::FloatToHalf(translation.y);
+      key.translation[2][lane] = math::FloatToHalf(translation.z);
+      key.rotation[0][lane] = QuantizeRotation(rotation.x);
+      key.rotation[1][lane] = QuantizeRotation(rotation.y);
+      key.rotation[2][lane] = QuantizeRotation(rotation.z);
+      key.rotation[3][lane] = QuantizeRotation(rotation.w);
+      key.scale[0][lane] = math::FloatToHalf(scale.x);
+      key.scale[1][lane] = math::FloatToHalf(scale.y);
+      key.scale[2][lane] = math::FloatToHalf(scale.z);
+    }
+  }
+
+  // Copy animation's name.
+  strcpy(animation->name_, _input.name.c_str());
+
+  return animation;  // Success.
+}
+}  // offline
+}  // animation
+}  // ozz
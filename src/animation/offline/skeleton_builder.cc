@@ -116,6 +116,7 @@ Skeleton* SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton) const {
     skeleton->joint_properties_[i].is_leaf =
         lister.linear_joints[i].joint->children.empty();
   }
+  skeleton->ComputeLevels();
 
   // Transfers t-poses.
   const math::SimdFloat4 w_axis = math::simd_float4::w_axis();
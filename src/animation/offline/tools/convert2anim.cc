@@ -97,6 +97,22 @@ OZZ_OPTIONS_DECLARE_FLOAT(
     hierarchical, "Optimizer hierarchical tolerance in meters",
     ozz::animation::offline::AnimationOptimizer().hierarchical_tolerance, false)
 
+OZZ_OPTIONS_DECLARE_FLOAT(
+    seek_interval,
+    "Interval in seconds between two seek points. Set a value = 0 to disable "
+    "seek points.",
+    ozz::animation::offline::AnimationBuilder().seek_interval, false)
+
+OZZ_OPTIONS_DECLARE_BOOL(
+    reverse_keys,
+    "Builds reverse keys, which optimize backward playback.",
+    ozz::animation::offline::AnimationBuilder().reverse_keys, false)
+
+OZZ_OPTIONS_DECLARE_BOOL(
+    track_keys,
+    "Builds per-track key indices, required by RandomAccessSamplingJob.",
+    ozz::animation::offline::AnimationBuilder().track_keys, false)
+
 OZZ_OPTIONS_DECLARE_BOOL(
     additive,
     "Creates a delta animation that can be used for additive blending.", false,
@@ -310,6 +326,9 @@ bool Export(const ozz::animation::offline::RawAnimation _raw_animation,
   if (!OPTIONS_raw) {
     ozz::log::Log() << "Builds runtime animation." << std::endl;
     ozz::animation::offline::AnimationBuilder builder;
+    builder.seek_interval = OPTIONS_seek_interval;
+    builder.reverse_keys = OPTIONS_reverse_keys;
+    builder.track_keys = OPTIONS_track_keys;
     animation = builder(raw_animation);
     if (!animation) {
       ozz::log::Err() << "Failed to build runtime animation." << std::endl;
@@ -31,6 +31,9 @@
 #include "ozz/base/log.h"
 #include "ozz/base/maths/math_archive.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/maths/soa_math_archive.h"
 #include "ozz/base/memory/allocator.h"
 
 #include <cassert>
@@ -43,29 +46,178 @@
 namespace ozz {
 namespace animation {
 
-Animation::Animation() : duration_(0.f), num_tracks_(0), name_(NULL) {}
+Animation::Animation()
+    : duration_(0.f),
+      num_tracks_(0),
+      name_(NULL),
+      num_translation_soa_tracks_(0),
+      num_rotation_soa_tracks_(0),
+      num_scale_soa_tracks_(0),
+      num_translation_identities_(0),
+      num_rotation_identities_(0),
+      num_scale_identities_(0),
+      has_reverse_keys_(false),
+      seek_interval_(0.f),
+      has_track_keys_(false) {}
 
 Animation::~Animation() { Deallocate(); }
 
 void Animation::Allocate(size_t name_len, size_t _translation_count,
-                         size_t _rotation_count, size_t _scale_count) {
+                         size_t _rotation_count, size_t _scale_count,
+                         size_t _num_seek_points, bool _reverse_keys,
+                         bool _track_keys) {
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
-  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(TranslationKey) >= OZZ_ALIGN_OF(RotationKey) &&
-                    OZZ_ALIGN_OF(RotationKey) >= OZZ_ALIGN_OF(ScaleKey) &&
-                    OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(char));
-
-  assert(name_ == NULL && translations_.Size() == 0 && rotations_.Size() == 0 &&
-         scales_.Size() == 0);
+  OZZ_STATIC_ASSERT(
+      OZZ_ALIGN_OF(math::SoaQuaternion) >= OZZ_ALIGN_OF(math::SoaFloat3) &&
+      OZZ_ALIGN_OF(math::SoaFloat3) >= OZZ_ALIGN_OF(int) &&
+      OZZ_ALIGN_OF(int) >= OZZ_ALIGN_OF(TranslationKey) &&
+      OZZ_ALIGN_OF(TranslationKey) >= OZZ_ALIGN_OF(RotationKey) &&
+      OZZ_ALIGN_OF(RotationKey) >= OZZ_ALIGN_OF(ScaleKey) &&
+      OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(uint16_t) &&
+      OZZ_ALIGN_OF(uint16_t) >= OZZ_ALIGN_OF(char));
+
+  assert(name_ == NULL && translation_ranges_.Size() == 0 &&
+         scale_ranges_.Size() == 0 && translation_constants_.Size() == 0 &&
+         rotation_constants_.Size() == 0 && scale_constants_.Size() == 0 &&
+         translation_soa_tracks_.Size() == 0 &&
+         rotation_soa_tracks_.Size() == 0 && scale_soa_tracks_.Size() == 0 &&
+         translations_.Size() == 0 && rotations_.Size() == 0 &&
+         scales_.Size() == 0 && reverse_translations_.Size() == 0 &&
+         reverse_rotations_.Size() == 0 && reverse_scales_.Size() == 0 &&
+         translation_seeks_.Size() == 0 && rotation_seeks_.Size() == 0 &&
+         scale_seeks_.Size() == 0 && translation_track_keys_.Size() == 0 &&
+         rotation_track_keys_.Size() == 0 && scale_track_keys_.Size() == 0);
+  assert(num_translation_soa_tracks_ + num_translation_identities_ <=
+             num_soa_tracks() &&
+         num_rotation_soa_tracks_ + num_rotation_identities_ <=
+             num_soa_tracks() &&
+         num_scale_soa_tracks_ + num_scale_identities_ <= num_soa_tracks());
+
+  // Soa tracks that aren't animated are constant, identity ones aren't
+  // stored.
+  const size_t num_soa = num_soa_tracks();
+  const size_t translation_constant_count =
+      num_soa - num_translation_soa_tracks_ - num_translation_identities_;
+  const size_t rotation_constant_count =
+      num_soa - num_rotation_soa_tracks_ - num_rotation_identities_;
+  const size_t scale_constant_count =
+      num_soa - num_scale_soa_tracks_ - num_scale_identities_;
+
+  // All keys but the last of each animated track are referenced by reverse
+  // keys, if any.
+  const size_t max_reverse_keys = kMaxReverseKeys;
+  assert(!_reverse_keys || (_translation_count <= max_reverse_keys &&
+                            _rotation_count <= max_reverse_keys &&
+                            _scale_count <= max_reverse_keys));
+  (void)max_reverse_keys;
+  has_reverse_keys_ = _reverse_keys;
+  const size_t translation_reverse_count =
+      _reverse_keys && _translation_count > 0
+          ? _translation_count - num_translation_soa_tracks_ * 4
+          : 0;
+  const size_t rotation_reverse_count =
+      _reverse_keys && _rotation_count > 0
+          ? _rotation_count - num_rotation_soa_tracks_ * 4
+          : 0;
+  const size_t scale_reverse_count =
+      _reverse_keys && _scale_count > 0
+          ? _scale_count - num_scale_soa_tracks_ * 4
+          : 0;
+
+  // Translations and scales have a min and a step entry per animated soa
+  // track.
+  const size_t translation_range_count = num_translation_soa_tracks_ * 2;
+  const size_t scale_range_count = num_scale_soa_tracks_ * 2;
+
+  // Seek points store 2 cursors, and 2 key indices per animated track.
+  const size_t translation_seek_count =
+      _num_seek_points * (2 + num_translation_soa_tracks_ * 4 * 2);
+  const size_t rotation_seek_count =
+      _num_seek_points * (2 + num_rotation_soa_tracks_ * 4 * 2);
+  const size_t scale_seek_count =
+      _num_seek_points * (2 + num_scale_soa_tracks_ * 4 * 2);
+
+  // Per-track key indices, if any, store an offset per animated track (plus
+  // one), and an index per key.
+  has_track_keys_ = _track_keys;
+  const size_t translation_track_key_count =
+      _track_keys ? num_translation_soa_tracks_ * 4 + 1 + _translation_count
+                  : 0;
+  const size_t rotation_track_key_count =
+      _track_keys ? num_rotation_soa_tracks_ * 4 + 1 + _rotation_count : 0;
+  const size_t scale_track_key_count =
+      _track_keys ? num_scale_soa_tracks_ * 4 + 1 + _scale_count : 0;
 
   // Compute overall size and allocate a single buffer for all the data.
-  const size_t buffer_size = (name_len > 0 ? name_len + 1 : 0) +
-                             _translation_count * sizeof(TranslationKey) +
-                             _rotation_count * sizeof(RotationKey) +
-                             _scale_count * sizeof(ScaleKey);
-  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
+  const size_t buffer_size =
+      (translation_range_count + scale_range_count +
+       translation_constant_count + scale_constant_count) *
+          sizeof(math::SoaFloat3) +
+      rotation_constant_count * sizeof(math::SoaQuaternion) +
+      (name_len > 0 ? name_len + 1 : 0) +
+      _translation_count * sizeof(TranslationKey) +
+      _rotation_count * sizeof(RotationKey) + _scale_count * sizeof(ScaleKey) +
+      (num_soa * 3 + translation_reverse_count + rotation_reverse_count +
+       scale_reverse_count) *
+          sizeof(uint16_t) +
+      (translation_seek_count + rotation_seek_count + scale_seek_count +
+       translation_track_key_count + rotation_track_key_count +
+       scale_track_key_count) *
+          sizeof(int);
+  char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
+      buffer_size, OZZ_ALIGN_OF(math::SoaQuaternion)));
 
   // Fix up pointers
+  rotation_constants_.begin = reinterpret_cast<math::SoaQuaternion*>(buffer);
+  assert(math::IsAligned(rotation_constants_.begin,
+                         OZZ_ALIGN_OF(math::SoaQuaternion)));
+  buffer += rotation_constant_count * sizeof(math::SoaQuaternion);
+  rotation_constants_.end = reinterpret_cast<math::SoaQuaternion*>(buffer);
+
+  translation_ranges_.begin = reinterpret_cast<math::SoaFloat3*>(buffer);
+  assert(math::IsAligned(translation_ranges_.begin,
+                         OZZ_ALIGN_OF(math::SoaFloat3)));
+  buffer += translation_range_count * sizeof(math::SoaFloat3);
+  translation_ranges_.end = reinterpret_cast<math::SoaFloat3*>(buffer);
+
+  scale_ranges_.begin = reinterpret_cast<math::SoaFloat3*>(buffer);
+  buffer += scale_range_count * sizeof(math::SoaFloat3);
+  scale_ranges_.end = reinterpret_cast<math::SoaFloat3*>(buffer);
+
+  translation_constants_.begin = reinterpret_cast<math::SoaFloat3*>(buffer);
+  buffer += translation_constant_count * sizeof(math::SoaFloat3);
+  translation_constants_.end = reinterpret_cast<math::SoaFloat3*>(buffer);
+
+  scale_constants_.begin = reinterpret_cast<math::SoaFloat3*>(buffer);
+  buffer += scale_constant_count * sizeof(math::SoaFloat3);
+  scale_constants_.end = reinterpret_cast<math::SoaFloat3*>(buffer);
+
+  translation_seeks_.begin = reinterpret_cast<int*>(buffer);
+  assert(math::IsAligned(translation_seeks_.begin, OZZ_ALIGN_OF(int)));
+  buffer += translation_seek_count * sizeof(int);
+  translation_seeks_.end = reinterpret_cast<int*>(buffer);
+
+  rotation_seeks_.begin = reinterpret_cast<int*>(buffer);
+  buffer += rotation_seek_count * sizeof(int);
+  rotation_seeks_.end = reinterpret_cast<int*>(buffer);
+
+  scale_seeks_.begin = reinterpret_cast<int*>(buffer);
+  buffer += scale_seek_count * sizeof(int);
+  scale_seeks_.end = reinterpret_cast<int*>(buffer);
+
+  translation_track_keys_.begin = reinterpret_cast<int*>(buffer);
+  buffer += translation_track_key_count * sizeof(int);
+  translation_track_keys_.end = reinterpret_cast<int*>(buffer);
+
+  rotation_track_keys_.begin = reinterpret_cast<int*>(buffer);
+  buffer += rotation_track_key_count * sizeof(int);
+  rotation_track_keys_.end = reinterpret_cast<int*>(buffer);
+
+  scale_track_keys_.begin = reinterpret_cast<int*>(buffer);
+  buffer += scale_track_key_count * sizeof(int);
+  scale_track_keys_.end = reinterpret_cast<int*>(buffer);
+
   translations_.begin = reinterpret_cast<TranslationKey*>(buffer);
   assert(math::IsAligned(translations_.begin, OZZ_ALIGN_OF(TranslationKey)));
   buffer += _translation_count * sizeof(TranslationKey);
@@ -81,6 +233,32 @@ void Animation::Allocate(size_t name_len, size_t _translation_count,
   buffer += _scale_count * sizeof(ScaleKey);
   scales_.end = reinterpret_cast<ScaleKey*>(buffer);
 
+  translation_soa_tracks_.begin = reinterpret_cast<uint16_t*>(buffer);
+  assert(math::IsAligned(translation_soa_tracks_.begin,
+                         OZZ_ALIGN_OF(uint16_t)));
+  buffer += num_soa * sizeof(uint16_t);
+  translation_soa_tracks_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  rotation_soa_tracks_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += num_soa * sizeof(uint16_t);
+  rotation_soa_tracks_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  scale_soa_tracks_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += num_soa * sizeof(uint16_t);
+  scale_soa_tracks_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  reverse_translations_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += translation_reverse_count * sizeof(uint16_t);
+  reverse_translations_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  reverse_rotations_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += rotation_reverse_count * sizeof(uint16_t);
+  reverse_rotations_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  reverse_scales_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += scale_reverse_count * sizeof(uint16_t);
+  reverse_scales_.end = reinterpret_cast<uint16_t*>(buffer);
+
   // Let name be NULL if animation has no name. Allows to avoid allocating this
   // buffer in the constructor of empty animations.
   name_ = reinterpret_cast<char*>(name_len > 0 ? buffer : NULL);
@@ -88,17 +266,45 @@ void Animation::Allocate(size_t name_len, size_t _translation_count,
 }
 
 void Animation::Deallocate() {
-  memory::default_allocator()->Deallocate(translations_.begin);
+  memory::default_allocator()->Deallocate(rotation_constants_.begin);
 
   name_ = NULL;
+  translation_ranges_ = ozz::Range<math::SoaFloat3>();
+  scale_ranges_ = ozz::Range<math::SoaFloat3>();
+  translation_constants_ = ozz::Range<math::SoaFloat3>();
+  rotation_constants_ = ozz::Range<math::SoaQuaternion>();
+  scale_constants_ = ozz::Range<math::SoaFloat3>();
+  translation_soa_tracks_ = ozz::Range<uint16_t>();
+  rotation_soa_tracks_ = ozz::Range<uint16_t>();
+  scale_soa_tracks_ = ozz::Range<uint16_t>();
   translations_ = ozz::Range<TranslationKey>();
   rotations_ = ozz::Range<RotationKey>();
   scales_ = ozz::Range<ScaleKey>();
+  has_reverse_keys_ = false;
+  reverse_translations_ = ozz::Range<uint16_t>();
+  reverse_rotations_ = ozz::Range<uint16_t>();
+  reverse_scales_ = ozz::Range<uint16_t>();
+  translation_seeks_ = ozz::Range<int>();
+  rotation_seeks_ = ozz::Range<int>();
+  scale_seeks_ = ozz::Range<int>();
+  has_track_keys_ = false;
+  translation_track_keys_ = ozz::Range<int>();
+  rotation_track_keys_ = ozz::Range<int>();
+  scale_track_keys_ = ozz::Range<int>();
 }
 
 size_t Animation::size() const {
   const size_t size =
-      sizeof(*this) + translations_.Size() + rotations_.Size() + scales_.Size();
+      sizeof(*this) + translation_ranges_.Size() + scale_ranges_.Size() +
+      translation_constants_.Size() + rotation_constants_.Size() +
+      scale_constants_.Size() + translation_soa_tracks_.Size() +
+      rotation_soa_tracks_.Size() + scale_soa_tracks_.Size() +
+      translations_.Size() + rotations_.Size() +
+      scales_.Size() + reverse_translations_.Size() +
+      reverse_rotations_.Size() + reverse_scales_.Size() +
+      translation_seeks_.Size() + rotation_seeks_.Size() +
+      scale_seeks_.Size() + translation_track_keys_.Size() +
+      rotation_track_keys_.Size() + scale_track_keys_.Size();
   return size;
 }
 
@@ -115,19 +321,40 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
   _archive << static_cast<int32_t>(rotation_count);
   const ptrdiff_t scale_count = scales_.Count();
   _archive << static_cast<int32_t>(scale_count);
+  const int num_seeks = num_seek_points();
+  _archive << static_cast<int32_t>(num_seeks);
+  _archive << has_reverse_keys_;
+  _archive << has_track_keys_;
+  _archive << static_cast<int32_t>(num_translation_soa_tracks_);
+  _archive << static_cast<int32_t>(num_rotation_soa_tracks_);
+  _archive << static_cast<int32_t>(num_scale_soa_tracks_);
+  _archive << static_cast<int32_t>(num_translation_identities_);
+  _archive << static_cast<int32_t>(num_rotation_identities_);
+  _archive << static_cast<int32_t>(num_scale_identities_);
 
   _archive << ozz::io::MakeArray(name_, name_len);
 
+  _archive << ozz::io::MakeArray(translation_soa_tracks_);
+  _archive << ozz::io::MakeArray(rotation_soa_tracks_);
+  _archive << ozz::io::MakeArray(scale_soa_tracks_);
+
+  _archive << ozz::io::MakeArray(translation_constants_);
+  _archive << ozz::io::MakeArray(rotation_constants_);
+  _archive << ozz::io::MakeArray(scale_constants_);
+
+  _archive << ozz::io::MakeArray(translation_ranges_);
+  _archive << ozz::io::MakeArray(scale_ranges_);
+
   for (ptrdiff_t i = 0; i < translation_count; ++i) {
     const TranslationKey& key = translations_.begin[i];
-    _archive << key.time;
+    _archive << key.ratio;
     _archive << key.track;
     _archive << ozz::io::MakeArray(key.value);
   }
 
   for (ptrdiff_t i = 0; i < rotation_count; ++i) {
     const RotationKey& key = rotations_.begin[i];
-    _archive << key.time;
+    _archive << key.ratio;
     uint16_t track = key.track;
     _archive << track;
     uint8_t largest = key.largest;
@@ -139,10 +366,39 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
 
   for (ptrdiff_t i = 0; i < scale_count; ++i) {
     const ScaleKey& key = scales_.begin[i];
-    _archive << key.time;
+    _archive << key.ratio;
     _archive << key.track;
     _archive << ozz::io::MakeArray(key.value);
   }
+
+  _archive << ozz::io::MakeArray(reverse_translations_);
+  _archive << ozz::io::MakeArray(reverse_rotations_);
+  _archive << ozz::io::MakeArray(reverse_scales_);
+
+  _archive << seek_interval_;
+  for (const int* it = translation_seeks_.begin; it < translation_seeks_.end;
+       ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+  for (const int* it = rotation_seeks_.begin; it < rotation_seeks_.end; ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+  for (const int* it = scale_seeks_.begin; it < scale_seeks_.end; ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+
+  for (const int* it = translation_track_keys_.begin;
+       it < translation_track_keys_.end; ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+  for (const int* it = rotation_track_keys_.begin;
+       it < rotation_track_keys_.end; ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+  for (const int* it = scale_track_keys_.begin; it < scale_track_keys_.end;
+       ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
 }
 
 void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
@@ -150,9 +406,16 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   Deallocate();
   duration_ = 0.f;
   num_tracks_ = 0;
+  num_translation_soa_tracks_ = 0;
+  num_rotation_soa_tracks_ = 0;
+  num_scale_soa_tracks_ = 0;
+  num_translation_identities_ = 0;
+  num_rotation_identities_ = 0;
+  num_scale_identities_ = 0;
+  seek_interval_ = 0.f;
 
   // No retro-compatibility with anterior versions.
-  if (_version != 4) {
+  if (_version != 5) {
     log::Err() << "Unsupported Animation version " << _version << "."
                << std::endl;
     return;
@@ -172,24 +435,60 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> rotation_count;
   int32_t scale_count;
   _archive >> scale_count;
-
-  Allocate(name_len, translation_count, rotation_count, scale_count);
+  int32_t num_seeks;
+  _archive >> num_seeks;
+  bool reverse_keys;
+  _archive >> reverse_keys;
+  bool track_keys;
+  _archive >> track_keys;
+  int32_t num_translation_soa_tracks;
+  _archive >> num_translation_soa_tracks;
+  num_translation_soa_tracks_ = num_translation_soa_tracks;
+  int32_t num_rotation_soa_tracks;
+  _archive >> num_rotation_soa_tracks;
+  num_rotation_soa_tracks_ = num_rotation_soa_tracks;
+  int32_t num_scale_soa_tracks;
+  _archive >> num_scale_soa_tracks;
+  num_scale_soa_tracks_ = num_scale_soa_tracks;
+  int32_t num_translation_identities;
+  _archive >> num_translation_identities;
+  num_translation_identities_ = num_translation_identities;
+  int32_t num_rotation_identities;
+  _archive >> num_rotation_identities;
+  num_rotation_identities_ = num_rotation_identities;
+  int32_t num_scale_identities;
+  _archive >> num_scale_identities;
+  num_scale_identities_ = num_scale_identities;
+
+  Allocate(name_len, translation_count, rotation_count, scale_count,
+           num_seeks, reverse_keys, track_keys);
 
   if (name_) {  // NULL name_ is supported.
     _archive >> ozz::io::MakeArray(name_, name_len);
     name_[name_len] = 0;
   }
 
+  _archive >> ozz::io::MakeArray(translation_soa_tracks_);
+  _archive >> ozz::io::MakeArray(rotation_soa_tracks_);
+  _archive >> ozz::io::MakeArray(scale_soa_tracks_);
+
+  _archive >> ozz::io::MakeArray(translation_constants_);
+  _archive >> ozz::io::MakeArray(rotation_constants_);
+  _archive >> ozz::io::MakeArray(scale_constants_);
+
+  _archive >> ozz::io::MakeArray(translation_ranges_);
+  _archive >> ozz::io::MakeArray(scale_ranges_);
+
   for (int i = 0; i < translation_count; ++i) {
     TranslationKey& key = translations_.begin[i];
-    _archive >> key.time;
+    _archive >> key.ratio;
     _archive >> key.track;
     _archive >> ozz::io::MakeArray(key.value);
   }
 
   for (int i = 0; i < rotation_count; ++i) {
     RotationKey& key = rotations_.begin[i];
-    _archive >> key.time;
+    _archive >> key.ratio;
     uint16_t track;
     _archive >> track;
     key.track = track;
@@ -204,10 +503,49 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 
   for (int i = 0; i < scale_count; ++i) {
     ScaleKey& key = scales_.begin[i];
-    _archive >> key.time;
+    _archive >> key.ratio;
     _archive >> key.track;
     _archive >> ozz::io::MakeArray(key.value);
   }
+
+  _archive >> ozz::io::MakeArray(reverse_translations_);
+  _archive >> ozz::io::MakeArray(reverse_rotations_);
+  _archive >> ozz::io::MakeArray(reverse_scales_);
+
+  _archive >> seek_interval_;
+  for (int* it = translation_seeks_.begin; it < translation_seeks_.end; ++it) {
+    int32_t seek;
+    _archive >> seek;
+    *it = seek;
+  }
+  for (int* it = rotation_seeks_.begin; it < rotation_seeks_.end; ++it) {
+    int32_t seek;
+    _archive >> seek;
+    *it = seek;
+  }
+  for (int* it = scale_seeks_.begin; it < scale_seeks_.end; ++it) {
+    int32_t seek;
+    _archive >> seek;
+    *it = seek;
+  }
+
+  for (int* it = translation_track_keys_.begin;
+       it < translation_track_keys_.end; ++it) {
+    int32_t key;
+    _archive >> key;
+    *it = key;
+  }
+  for (int* it = rotation_track_keys_.begin; it < rotation_track_keys_.end;
+       ++it) {
+    int32_t key;
+    _archive >> key;
+    *it = key;
+  }
+  for (int* it = scale_track_keys_.begin; it < scale_track_keys_.end; ++it) {
+    int32_t key;
+    _archive >> key;
+    *it = key;
+  }
 }
 }  // animation
 }  // ozz
@@ -39,14 +39,20 @@ namespace animation {
 // as the same base made of the key time and it's track. This is required as
 // key frames are not sorted per track, but sorted by time to favor cache
 // coherency.
+// Key time is stored as a 16 bits unsigned integer ratio of the animation
+// duration, 0 matching time 0 and 65535 matching the duration. Key frames of a
+// same track are thus at least duration / 65535 apart.
 // Key frame values are compressed, according on their type. Decompression is
 // efficient because it's done on SoA data and cached during sampling.
 
 // Defines the translation key frame type.
-// Translation values are stored as half precision floats with 16 bits per
-// component.
+// Translation values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see
+// Animation::translation_ranges()). As opposed to half precision floats, the
+// precision doesn't depend on the magnitude of the value, but only on the
+// range covered by the track.
 struct TranslationKey {
-  float time;
+  uint16_t ratio;
   uint16_t track;
   uint16_t value[3];
 };
@@ -67,7 +73,7 @@ struct TranslationKey {
 // key frames, but in this case RotationKey structure would induce 16 bits of
 // padding.
 struct RotationKey {
-  float time;
+  uint16_t ratio;
   uint16_t track : 13;   // The track this key frame belongs to.
   uint16_t largest : 2;  // The largest component of the quaternion.
   uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
@@ -75,13 +81,27 @@ struct RotationKey {
 };
 
 // Defines the scale key frame type.
-// Scale values are stored as half precision floats with 16 bits per
-// component.
+// Scale values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see Animation::scale_ranges()).
 struct ScaleKey {
-  float time;
+  uint16_t ratio;
   uint16_t track;
   uint16_t value[3];
 };
+
+// Defines the key frame type of FixedRateAnimation.
+// A key stores the values of a soa track (4 consecutive tracks) at a given
+// frame, in SoA layout. There's no need to store key time and track, as they
+// are implicitly defined by key position in the frame-major key frames buffer.
+// Translation and scale values are stored as half precision floats with 16 bits
+// per component. Rotation quaternion components are all in range [-1:1], and
+// quantized to signed integer 16 bits values. Unlike RotationKey, the 4
+// components are stored, so decompression is straightforward SoA code.
+struct FixedRateSoaKey {
+  uint16_t translation[3][4];
+  int16_t rotation[4][4];
+  uint16_t scale[3][4];
+};
 }  // animation
 }  // ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -29,18 +29,23 @@
 
 #include <cassert>
 #include <cstddef>
+#include <limits>
 
-#include "ozz/animation/runtime/skeleton.h"
-
+#include "ozz/animation/runtime/animation.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
 
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/blending_passes.h"
+
 namespace ozz {
 namespace animation {
 
 BlendingJob::Layer::Layer() : weight(0.f) {}
 
-BlendingJob::BlendingJob() : threshold(.1f) {}
+BlendingJob::BlendingJob()
+    : threshold(.1f), begin_soa(0), end_soa(std::numeric_limits<int>::max()) {}
 
 namespace {
 bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
@@ -59,6 +64,22 @@ bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
   } else {
     valid &= _layer.joint_weights.end == NULL;
   }
+
+  // Soa joint ranges are optional. They must be sorted, and within the range
+  // of transforms to blend.
+  if (_layer.soa_ranges.begin != NULL) {
+    valid &= _layer.soa_ranges.end >= _layer.soa_ranges.begin;
+    int previous_end = 0;
+    for (const BlendingJob::SoaJointRange* range = _layer.soa_ranges.begin;
+         range < _layer.soa_ranges.end; ++range) {
+      valid &= range->begin >= previous_end;
+      valid &= range->end >= range->begin;
+      previous_end = range->end;
+    }
+    valid &= previous_end <= _min_range;
+  } else {
+    valid &= _layer.soa_ranges.end == NULL;
+  }
   return valid;
 }
 }  // namespace
@@ -86,6 +107,17 @@ bool BlendingJob::Validate() const {
   const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
   valid &= output.end - output.begin >= min_range;
 
+  // Tests soa joints range.
+  valid &= begin_soa >= 0 && end_soa >= begin_soa;
+
+  // Scratch buffer is optional.
+  if (scratch.begin != NULL) {
+    valid &= scratch.end >= scratch.begin;
+    valid &= scratch.end - scratch.begin >= min_range;
+  } else {
+    valid &= scratch.end == NULL;
+  }
+
   // Blend layers are optional.
   if (layers.begin != NULL) {
     valid &= layers.end >= layers.begin;
@@ -119,36 +151,6 @@ bool BlendingJob::Validate() const {
 
 namespace {
 
-// Macro that defines the process of blending the 1st pass.
-#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out)     \
-  {                                                     \
-    _out->translation = _in.translation * _simd_weight; \
-    _out->rotation = _in.rotation * _simd_weight;       \
-    _out->scale = _in.scale * _simd_weight;             \
-  \
-}
-
-// Macro that defines the process of blending any pass but the first.
-#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out)                           \
-  {                                                                         \
-    /* Blends translation. */                                               \
-    _out->translation = _out->translation + _in.translation * _simd_weight; \
-    /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
-    /* the shortest path between the two.*/                                 \
-    const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x +        \
-                                 _out->rotation.y * _in.rotation.y +        \
-                                 _out->rotation.z * _in.rotation.z +        \
-                                 _out->rotation.w * _in.rotation.w;         \
-    const math::SimdInt4 sign = math::Sign(dot);                            \
-    const math::SoaQuaternion rotation = {                                  \
-        math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),   \
-        math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};  \
-    _out->rotation = _out->rotation + rotation * _simd_weight;              \
-    /* Blends scales.*/                                                     \
-    _out->scale = _out->scale + _in.scale * _simd_weight;                   \
-  \
-}
-
 // Macro that defines the process of adding a pass.
 #define OZZ_ADD_PASS(_in, _simd_weight, _out)                                \
   {                                                                          \
@@ -190,35 +192,37 @@ namespace {
   \
 }
 
-// Defines parameters that are passed through blending stages.
+// Defines the number of soa joints processed at once when the job doesn't
+// provide a scratch buffer.
+const int kBlendingChunkSize = 32;
+
+// Defines parameters that are passed through blending stages, to blend soa
+// joints [_begin,_end[.
 struct ProcessArgs {
-  ProcessArgs(const BlendingJob& _job)
-      : job(_job),
-        num_soa_joints(_job.bind_pose.end - _job.bind_pose.begin),
+  ProcessArgs(const BlendingJob& _job, int _begin, int _end,
+              math::SimdFloat4* _accumulated_weights)
+      : accumulated_weights(_accumulated_weights),
+        job(_job),
+        begin(_begin),
+        end(_end),
         num_passes(0),
         num_partial_passes(0),
         accumulated_weight(0.f) {
     // The range of all buffers has already been validated.
-    assert(job.output.end >= job.output.begin + num_soa_joints);
-    assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
+    assert(job.output.end >= job.output.begin + end);
+    assert(job.bind_pose.end >= job.bind_pose.begin + end);
   }
 
-  // Allocates enough space to store a accumulated weights per-joint.
-  // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (16 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
-  // Note that this array is used with SoA data.
-  // This is the first argument in order to avoid wasting too much space with
-  // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+  // Accumulated weights per soa joint, starting at soa joint begin. They are
+  // initialized by the first pass processed, if any.
+  math::SimdFloat4* accumulated_weights;
 
   // The job to process.
   const BlendingJob& job;
 
-  // The number of transforms to process as defined by the size of the bind
-  // pose.
-  size_t num_soa_joints;
+  // The range [begin,end[ of soa joints to process.
+  int begin;
+  int end;
 
   // Number of processed blended passes (excluding passes with a weight <= 0.f),
   // including partial passes.
@@ -236,19 +240,100 @@ struct ProcessArgs {
   void operator=(const ProcessArgs&);
 };
 
+// Gets the ranges of soa joints affected by _layer. It's the whole _all range
+// if _layer doesn't specify any.
+Range<const BlendingJob::SoaJointRange> GetSoaRanges(
+    const BlendingJob::Layer& _layer, const BlendingJob::SoaJointRange& _all) {
+  if (_layer.soa_ranges.begin) {
+    return _layer.soa_ranges;
+  }
+  return Range<const BlendingJob::SoaJointRange>(_all);
+}
+
+// Clips _range to the soa joints processed by _args.
+BlendingJob::SoaJointRange ClipRange(const ProcessArgs& _args,
+                                     const BlendingJob::SoaJointRange& _range) {
+  const BlendingJob::SoaJointRange clipped = {
+      math::Max(_range.begin, _args.begin), math::Min(_range.end, _args.end)};
+  return clipped;
+}
+
+// Clears output and accumulated weights of soa joints [_begin,_end[, as the
+// first pass does for soa joints with a weight of 0.
+void ClearSoaJoints(ProcessArgs* _args, int _begin, int _end) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SoaTransform cleared = {math::SoaFloat3::zero(),
+                                      {zero, zero, zero, zero},
+                                      math::SoaFloat3::zero()};
+  for (int i = _begin; i < _end; ++i) {
+    _args->accumulated_weights[i - _args->begin] = zero;
+    _args->job.output.begin[i] = cleared;
+  }
+}
+
+// Blends soa joints _range of a partial _layer to the output.
+void BlendPartialRange(ProcessArgs* _args, const BlendingJob::Layer& _layer,
+                       math::SimdFloat4 _layer_weight,
+                       const BlendingJob::SoaJointRange& _range) {
+  if (_layer.joint_weights.begin) {
+    // Weights are defined per joint.
+    if (_args->num_passes == 0) {
+      for (int i = _range.begin; i < _range.end; ++i) {
+        const math::SoaTransform& src = _layer.transform.begin[i];
+        math::SoaTransform* dest = _args->job.output.begin + i;
+        const math::SimdFloat4 weight =
+            _layer_weight * math::Max0(_layer.joint_weights.begin[i]);
+        _args->accumulated_weights[i - _args->begin] = weight;
+        OZZ_BLEND_1ST_PASS(src, weight, dest);
+      }
+    } else {
+      for (int i = _range.begin; i < _range.end; ++i) {
+        const math::SoaTransform& src = _layer.transform.begin[i];
+        math::SoaTransform* dest = _args->job.output.begin + i;
+        const math::SimdFloat4 weight =
+            _layer_weight * math::Max0(_layer.joint_weights.begin[i]);
+        math::SimdFloat4& accumulated_weight =
+            _args->accumulated_weights[i - _args->begin];
+        accumulated_weight = accumulated_weight + weight;
+        OZZ_BLEND_N_PASS(src, weight, dest);
+      }
+    }
+  } else {
+    // All joints of the range have the layer weight.
+    if (_args->num_passes == 0) {
+      for (int i = _range.begin; i < _range.end; ++i) {
+        const math::SoaTransform& src = _layer.transform.begin[i];
+        math::SoaTransform* dest = _args->job.output.begin + i;
+        _args->accumulated_weights[i - _args->begin] = _layer_weight;
+        OZZ_BLEND_1ST_PASS(src, _layer_weight, dest);
+      }
+    } else {
+      for (int i = _range.begin; i < _range.end; ++i) {
+        const math::SoaTransform& src = _layer.transform.begin[i];
+        math::SoaTransform* dest = _args->job.output.begin + i;
+        math::SimdFloat4& accumulated_weight =
+            _args->accumulated_weights[i - _args->begin];
+        accumulated_weight = accumulated_weight + _layer_weight;
+        OZZ_BLEND_N_PASS(src, _layer_weight, dest);
+      }
+    }
+  }
+}
+
 // Blends all layers of the job to its output.
 void BlendLayers(ProcessArgs* _args) {
   assert(_args);
 
+  const BlendingJob::SoaJointRange all = {_args->begin, _args->end};
+
   // Iterates through all layers and blend them to the output.
   for (const BlendingJob::Layer* layer = _args->job.layers.begin;
        layer < _args->job.layers.end; ++layer) {
     // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
+    assert(layer->transform.end >= layer->transform.begin + _args->end);
     assert(!layer->joint_weights.begin ||
            (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+            layer->joint_weights.begin + _args->end));
 
     // Skip irrelevant layers.
     if (layer->weight <= 0.f) {
@@ -260,45 +345,46 @@ void BlendLayers(ProcessArgs* _args) {
     const math::SimdFloat4 layer_weight =
         math::simd_float4::Load1(layer->weight);
 
-    if (layer->joint_weights.begin) {
-      // This layer has per-joint weights.
+    if (layer->joint_weights.begin || layer->soa_ranges.begin) {
+      // This layer has per-joint weights, or only affects some soa joints.
       ++_args->num_partial_passes;
 
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] = weight;
-          OZZ_BLEND_1ST_PASS(src, weight, dest);
+      // Only soa joints within layer ranges are processed. Others have a
+      // weight of 0, so they only need to be cleared by the first pass.
+      const Range<const BlendingJob::SoaJointRange> ranges =
+          GetSoaRanges(*layer, all);
+      int cleared = _args->begin;
+      for (const BlendingJob::SoaJointRange* range = ranges.begin;
+           range < ranges.end; ++range) {
+        const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+        if (clipped.begin >= clipped.end) {
+          continue;
         }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] =
-              _args->accumulated_weights[i] + weight;
-          OZZ_BLEND_N_PASS(src, weight, dest);
+        if (_args->num_passes == 0) {
+          ClearSoaJoints(_args, cleared, clipped.begin);
+          cleared = clipped.end;
         }
+        BlendPartialRange(_args, *layer, layer_weight, clipped);
+      }
+      if (_args->num_passes == 0) {
+        ClearSoaJoints(_args, cleared, _args->end);
       }
     } else {
       // This is a full layer.
       if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        for (int i = _args->begin; i < _args->end; ++i) {
           const math::SoaTransform& src = layer->transform.begin[i];
           math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] = layer_weight;
+          _args->accumulated_weights[i - _args->begin] = layer_weight;
           OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
         }
       } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        for (int i = _args->begin; i < _args->end; ++i) {
           const math::SoaTransform& src = layer->transform.begin[i];
           math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] =
-              _args->accumulated_weights[i] + layer_weight;
+          math::SimdFloat4& accumulated_weight =
+              _args->accumulated_weights[i - _args->begin];
+          accumulated_weight = accumulated_weight + layer_weight;
           OZZ_BLEND_N_PASS(src, layer_weight, dest);
         }
       }
@@ -314,8 +400,7 @@ void BlendBindPose(ProcessArgs* _args) {
   assert(_args);
 
   // Asserts buffer sizes, which must never fail as it has been validated.
-  assert(_args->job.bind_pose.end >=
-         _args->job.bind_pose.begin + _args->num_soa_joints);
+  assert(_args->job.bind_pose.end >= _args->job.bind_pose.begin + _args->end);
 
   if (_args->num_partial_passes == 0) {
     // No partial blending pass detected, threshold can be tested globally.
@@ -325,7 +410,7 @@ void BlendBindPose(ProcessArgs* _args) {
       if (_args->num_passes == 0) {
         // Strictly copying bind-pose.
         _args->accumulated_weight = 1.f;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        for (int i = _args->begin; i < _args->end; ++i) {
           _args->job.output.begin[i] = _args->job.bind_pose.begin[i];
         }
       } else {
@@ -336,7 +421,7 @@ void BlendBindPose(ProcessArgs* _args) {
         const math::SimdFloat4 simd_bp_weight =
             math::simd_float4::Load1(bp_weight);
 
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        for (int i = _args->begin; i < _args->end; ++i) {
           const math::SoaTransform& src = _args->job.bind_pose.begin[i];
           math::SoaTransform* dest = _args->job.output.begin + i;
           OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
@@ -352,13 +437,14 @@ void BlendBindPose(ProcessArgs* _args) {
     // There's been at least 1 pass as num_partial_passes != 0.
     assert(_args->num_passes != 0);
 
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+    for (int i = _args->begin; i < _args->end; ++i) {
       const math::SoaTransform& src = _args->job.bind_pose.begin[i];
       math::SoaTransform* dest = _args->job.output.begin + i;
+      math::SimdFloat4& accumulated_weight =
+          _args->accumulated_weights[i - _args->begin];
       const math::SimdFloat4 bp_weight =
-          math::Max0(threshold - _args->accumulated_weights[i]);
-      _args->accumulated_weights[i] =
-          math::Max(threshold, _args->accumulated_weights[i]);
+          math::Max0(threshold - accumulated_weight);
+      accumulated_weight = math::Max(threshold, accumulated_weight);
       OZZ_BLEND_N_PASS(src, bp_weight, dest);
     }
   }
@@ -376,7 +462,7 @@ void Normalize(ProcessArgs* _args) {
     // division to all joints.
     const math::SimdFloat4 ratio =
         math::simd_float4::Load1(1.f / _args->accumulated_weight);
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+    for (int i = _args->begin; i < _args->end; ++i) {
       math::SoaTransform& dest = _args->job.output.begin[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
@@ -385,8 +471,9 @@ void Normalize(ProcessArgs* _args) {
   } else {
     // Partial blending normalization requires to compute the divider per-joint.
     const math::SimdFloat4 one = math::simd_float4::one();
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
+    for (int i = _args->begin; i < _args->end; ++i) {
+      const math::SimdFloat4 ratio =
+          one / _args->accumulated_weights[i - _args->begin];
       math::SoaTransform& dest = _args->job.output.begin[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
@@ -399,19 +486,25 @@ void Normalize(ProcessArgs* _args) {
 void AddLayers(ProcessArgs* _args) {
   assert(_args);
 
+  const BlendingJob::SoaJointRange all = {_args->begin, _args->end};
+
   // Iterates through all layers and blend them to the output.
   for (const BlendingJob::Layer* layer = _args->job.additive_layers.begin;
        layer < _args->job.additive_layers.end; ++layer) {
     // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
+    assert(layer->transform.end >= layer->transform.begin + _args->end);
     assert(!layer->joint_weights.begin ||
            (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+            layer->joint_weights.begin + _args->end));
 
     // Prepares constants.
     const math::SimdFloat4 one = math::simd_float4::one();
 
+    // Only soa joints within layer ranges are processed, others have a weight
+    // of 0.
+    const Range<const BlendingJob::SoaJointRange> ranges =
+        GetSoaRanges(*layer, all);
+
     if (layer->weight > 0.f) {
       // Weight is positive, need to perform additive blending.
       const math::SimdFloat4 layer_weight =
@@ -419,15 +512,19 @@ void AddLayers(ProcessArgs* _args) {
 
       if (layer->joint_weights.begin) {
         // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          const math::SoaFloat3 one_minus_weight_f3 = {
-              one_minus_weight, one_minus_weight, one_minus_weight};
-          OZZ_ADD_PASS(src, weight, dest);
+        for (const BlendingJob::SoaJointRange* range = ranges.begin;
+             range < ranges.end; ++range) {
+          const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+          for (int i = clipped.begin; i < clipped.end; ++i) {
+            const math::SoaTransform& src = layer->transform.begin[i];
+            math::SoaTransform& dest = _args->job.output.begin[i];
+            const math::SimdFloat4 weight =
+                layer_weight * math::Max0(layer->joint_weights.begin[i]);
+            const math::SimdFloat4 one_minus_weight = one - weight;
+            const math::SoaFloat3 one_minus_weight_f3 = {
+                one_minus_weight, one_minus_weight, one_minus_weight};
+            OZZ_ADD_PASS(src, weight, dest);
+          }
         }
       } else {
         // This is a full layer.
@@ -435,10 +532,14 @@ void AddLayers(ProcessArgs* _args) {
         const math::SoaFloat3 one_minus_weight_f3 = {
             one_minus_weight, one_minus_weight, one_minus_weight};
 
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_ADD_PASS(src, layer_weight, dest);
+        for (const BlendingJob::SoaJointRange* range = ranges.begin;
+             range < ranges.end; ++range) {
+          const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+          for (int i = clipped.begin; i < clipped.end; ++i) {
+            const math::SoaTransform& src = layer->transform.begin[i];
+            math::SoaTransform& dest = _args->job.output.begin[i];
+            OZZ_ADD_PASS(src, layer_weight, dest);
+          }
         }
       }
     } else if (layer->weight < 0.f) {
@@ -448,21 +549,29 @@ void AddLayers(ProcessArgs* _args) {
 
       if (layer->joint_weights.begin) {
         // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          OZZ_SUB_PASS(src, weight, dest);
+        for (const BlendingJob::SoaJointRange* range = ranges.begin;
+             range < ranges.end; ++range) {
+          const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+          for (int i = clipped.begin; i < clipped.end; ++i) {
+            const math::SoaTransform& src = layer->transform.begin[i];
+            math::SoaTransform& dest = _args->job.output.begin[i];
+            const math::SimdFloat4 weight =
+                layer_weight * math::Max0(layer->joint_weights.begin[i]);
+            const math::SimdFloat4 one_minus_weight = one - weight;
+            OZZ_SUB_PASS(src, weight, dest);
+          }
         }
       } else {
         // This is a full layer.
         const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_SUB_PASS(src, layer_weight, dest);
+        for (const BlendingJob::SoaJointRange* range = ranges.begin;
+             range < ranges.end; ++range) {
+          const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+          for (int i = clipped.begin; i < clipped.end; ++i) {
+            const math::SoaTransform& src = layer->transform.begin[i];
+            math::SoaTransform& dest = _args->job.output.begin[i];
+            OZZ_SUB_PASS(src, layer_weight, dest);
+          }
         }
       }
     } else {
@@ -470,15 +579,13 @@ void AddLayers(ProcessArgs* _args) {
     }
   }
 }
-}  // namespace
-
-bool BlendingJob::Run() const {
-  if (!Validate()) {
-    return false;
-  }
 
+// Blends soa joints [_begin,_end[ of _job, using _accumulated_weights buffer
+// to accumulate their weights.
+void ProcessSoaJoints(const BlendingJob& _job, int _begin, int _end,
+                      math::SimdFloat4* _accumulated_weights) {
   // Initializes blended parameters that are exchanged across blend stages.
-  ProcessArgs process_args(*this);
+  ProcessArgs process_args(_job, _begin, _end, _accumulated_weights);
 
   // Blends all layers to the job output buffers.
   BlendLayers(&process_args);
@@ -491,8 +598,136 @@ bool BlendingJob::Run() const {
 
   // Process additive blending.
   AddLayers(&process_args);
+}
+}  // namespace
+
+bool BlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Blends soa joints range, clamped to the bind pose. Global weights only
+  // depend on layers weights, so any sub-range is blended the same way it is
+  // when blending all soa joints at once.
+  const int num_soa_joints = static_cast<int>(bind_pose.end - bind_pose.begin);
+  const int end_soa_joint = math::Min(end_soa, num_soa_joints);
+  if (begin_soa >= end_soa_joint) {
+    return true;
+  }
+
+  if (scratch.begin) {
+    // All soa joints are blended at once, accumulating weights to the scratch
+    // buffer.
+    ProcessSoaJoints(*this, begin_soa, end_soa_joint,
+                     scratch.begin + begin_soa);
+  } else {
+    // Soa joints are blended by chunks, accumulating weights to a small stack
+    // buffer.
+    math::SimdFloat4 accumulated_weights[kBlendingChunkSize];
+    for (int begin = begin_soa; begin < end_soa_joint;
+         begin += kBlendingChunkSize) {
+      const int end = math::Min(begin + kBlendingChunkSize, end_soa_joint);
+      ProcessSoaJoints(*this, begin, end, accumulated_weights);
+    }
+  }
 
   return true;
 }
+
+Range<BlendingJob::SoaJointRange> ComputeSoaJointRanges(
+    Range<const math::SimdFloat4> _joint_weights,
+    Range<BlendingJob::SoaJointRange> _ranges) {
+  // Worst case is one range every other soa joint.
+  const int num_soa_joints = static_cast<int>(_joint_weights.Count());
+  if (_ranges.Count() < static_cast<size_t>((num_soa_joints + 1) / 2)) {
+    return Range<BlendingJob::SoaJointRange>();
+  }
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  BlendingJob::SoaJointRange* range = _ranges.begin;
+  for (int i = 0; i < num_soa_joints;) {
+    // Skips soa joints whose 4 weights are less or equal to 0.
+    if (math::AreAllFalse(math::CmpGt(_joint_weights.begin[i], zero))) {
+      ++i;
+      continue;
+    }
+    // Extends the range while any weight is greater than 0.
+    range->begin = i;
+    do {
+      ++i;
+    } while (i < num_soa_joints &&
+             !math::AreAllFalse(math::CmpGt(_joint_weights.begin[i], zero)));
+    range->end = i;
+    ++range;
+  }
+  return Range<BlendingJob::SoaJointRange>(_ranges.begin, range);
+}
+
+namespace {
+// Iterates the sorted identity soa tracks of an animation, for a single
+// transformation type.
+class IdentityIterator {
+ public:
+  IdentityIterator(Range<const uint16_t> _soa_tracks, int _num_animated,
+                   size_t _num_constants, int _num_identities)
+      : it_(_soa_tracks.begin + _num_animated + _num_constants),
+        end_(it_ + _num_identities) {}
+
+  // Tests if soa track _soa_track is identity. Must be called with ascending
+  // soa track indices.
+  bool IsIdentity(int _soa_track) {
+    while (it_ < end_ && *it_ < _soa_track) {
+      ++it_;
+    }
+    return it_ < end_ && *it_ == _soa_track;
+  }
+
+ private:
+  const uint16_t* it_;
+  const uint16_t* end_;
+};
+}  // namespace
+
+Range<BlendingJob::SoaJointRange> ComputeSoaJointRanges(
+    const Animation& _animation, Range<BlendingJob::SoaJointRange> _ranges) {
+  // Worst case is one range every other soa joint.
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  if (_ranges.Count() < static_cast<size_t>((num_soa_tracks + 1) / 2)) {
+    return Range<BlendingJob::SoaJointRange>();
+  }
+
+  IdentityIterator translations(_animation.translation_soa_tracks(),
+                                _animation.num_translation_soa_tracks(),
+                                _animation.translation_constants().Count(),
+                                _animation.num_translation_identities());
+  IdentityIterator rotations(_animation.rotation_soa_tracks(),
+                             _animation.num_rotation_soa_tracks(),
+                             _animation.rotation_constants().Count(),
+                             _animation.num_rotation_identities());
+  IdentityIterator scales(_animation.scale_soa_tracks(),
+                          _animation.num_scale_soa_tracks(),
+                          _animation.scale_constants().Count(),
+                          _animation.num_scale_identities());
+
+  BlendingJob::SoaJointRange* range = _ranges.begin;
+  bool in_range = false;
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    const bool identity = translations.IsIdentity(i) &&
+                          rotations.IsIdentity(i) && scales.IsIdentity(i);
+    if (!identity && !in_range) {
+      range->begin = i;
+      in_range = true;
+    } else if (identity && in_range) {
+      range->end = i;
+      ++range;
+      in_range = false;
+    }
+  }
+  if (in_range) {
+    range->end = num_soa_tracks;
+    ++range;
+  }
+  return Range<BlendingJob::SoaJointRange>(_ranges.begin, range);
+}
 }  // animation
 }  // ozz
@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
+#define OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Defines the blending passes shared by BlendingJob and SampleBlendingJob.
+// _in is a math::SoaTransform, _simd_weight a math::SimdFloat4 weight and _out
+// a pointer to the math::SoaTransform being accumulated.
+
+// Macro that defines the process of blending the 1st pass.
+#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out)     \
+  {                                                     \
+    _out->translation = _in.translation * _simd_weight; \
+    _out->rotation = _in.rotation * _simd_weight;       \
+    _out->scale = _in.scale * _simd_weight;             \
+  \
+}
+
+// Macro that defines the process of blending any pass but the first.
+#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out)                           \
+  {                                                                         \
+    /* Blends translation. */                                               \
+    _out->translation = _out->translation + _in.translation * _simd_weight; \
+    /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
+    /* the shortest path between the two.*/                                 \
+    const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x +        \
+                                 _out->rotation.y * _in.rotation.y +        \
+                                 _out->rotation.z * _in.rotation.z +        \
+                                 _out->rotation.w * _in.rotation.w;         \
+    const math::SimdInt4 sign = math::Sign(dot);                            \
+    const math::SoaQuaternion rotation = {                                  \
+        math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),   \
+        math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};  \
+    _out->rotation = _out->rotation + rotation * _simd_weight;              \
+    /* Blends scales.*/                                                     \
+    _out->scale = _out->scale + _in.scale * _simd_weight;                   \
+  \
+}
+
+#endif  // OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
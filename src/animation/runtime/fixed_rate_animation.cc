@@ -0,0 +1,161 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/fixed_rate_animation.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+
+FixedRateAnimation::FixedRateAnimation()
+    : duration_(0.f), num_tracks_(0), num_frames_(0), name_(NULL) {}
+
+FixedRateAnimation::~FixedRateAnimation() { Deallocate(); }
+
+void FixedRateAnimation::Allocate(size_t _name_len, size_t _key_count) {
+  // Distributes buffer memory while ensuring proper alignment (serves larger
+  // alignment values first).
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(FixedRateSoaKey) >= OZZ_ALIGN_OF(char));
+
+  assert(name_ == NULL && keys_.Size() == 0);
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size = (_name_len > 0 ? _name_len + 1 : 0) +
+                             _key_count * sizeof(FixedRateSoaKey);
+  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
+
+  // Fix up pointers
+  keys_.begin = reinterpret_cast<FixedRateSoaKey*>(buffer);
+  assert(math::IsAligned(keys_.begin, OZZ_ALIGN_OF(FixedRateSoaKey)));
+  buffer += _key_count * sizeof(FixedRateSoaKey);
+  keys_.end = reinterpret_cast<FixedRateSoaKey*>(buffer);
+
+  // Let name be NULL if animation has no name. Allows to avoid allocating this
+  // buffer in the constructor of empty animations.
+  name_ = reinterpret_cast<char*>(_name_len > 0 ? buffer : NULL);
+}
+
+void FixedRateAnimation::Deallocate() {
+  memory::default_allocator()->Deallocate(keys_.begin);
+
+  name_ = NULL;
+  keys_ = ozz::Range<FixedRateSoaKey>();
+}
+
+size_t FixedRateAnimation::size() const {
+  const size_t size = sizeof(*this) + keys_.Size();
+  return size;
+}
+
+void FixedRateAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << static_cast<int32_t>(num_frames_);
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+
+  const ptrdiff_t key_count = keys_.Count();
+  _archive << static_cast<int32_t>(key_count);
+
+  _archive << ozz::io::MakeArray(name_, name_len);
+
+  for (ptrdiff_t i = 0; i < key_count; ++i) {
+    const FixedRateSoaKey& key = keys_.begin[i];
+    for (int c = 0; c < 3; ++c) {
+      _archive << ozz::io::MakeArray(key.translation[c]);
+    }
+    for (int c = 0; c < 4; ++c) {
+      _archive << ozz::io::MakeArray(key.rotation[c]);
+    }
+    for (int c = 0; c < 3; ++c) {
+      _archive << ozz::io::MakeArray(key.scale[c]);
+    }
+  }
+}
+
+void FixedRateAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+  num_tracks_ = 0;
+  num_frames_ = 0;
+
+  if (_version != 1) {
+    log::Err() << "Unsupported FixedRateAnimation version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  _archive >> duration_;
+
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  num_tracks_ = num_tracks;
+
+  int32_t num_frames;
+  _archive >> num_frames;
+  num_frames_ = num_frames;
+
+  int32_t name_len;
+  _archive >> name_len;
+  int32_t key_count;
+  _archive >> key_count;
+
+  Allocate(name_len, key_count);
+
+  if (name_) {  // NULL name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+
+  for (int i = 0; i < key_count; ++i) {
+    FixedRateSoaKey& key = keys_.begin[i];
+    for (int c = 0; c < 3; ++c) {
+      _archive >> ozz::io::MakeArray(key.translation[c]);
+    }
+    for (int c = 0; c < 4; ++c) {
+      _archive >> ozz::io::MakeArray(key.rotation[c]);
+    }
+    for (int c = 0; c < 3; ++c) {
+      _archive >> ozz::io::MakeArray(key.scale[c]);
+    }
+  }
+}
+}  // animation
+}  // ozz
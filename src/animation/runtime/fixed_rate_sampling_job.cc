@@ -0,0 +1,148 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/fixed_rate_sampling_job.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/fixed_rate_animation.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Decompresses 4 half precision floats.
+math::SimdFloat4 DecompressHalves(const uint16_t* _h) {
+  return math::HalfToFloat(math::simd_int4::Load(_h[0], _h[1], _h[2], _h[3]));
+}
+
+// Decompresses 4 quantized quaternion components.
+math::SimdFloat4 DecompressQuantized(const int16_t* _q,
+                                     math::_SimdFloat4 _int2float) {
+  return _int2float * math::simd_float4::FromInt(
+                          math::simd_int4::Load(_q[0], _q[1], _q[2], _q[3]));
+}
+}  // namespace
+
+FixedRateSamplingJob::FixedRateSamplingJob() : time(0.f), animation(NULL) {}
+
+bool FixedRateSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation) {
+    return false;
+  }
+  valid &= output.begin != NULL;
+
+  // Tests output range, implicitly tests output.end != NULL.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= output.end - output.begin >= num_soa_tracks;
+
+  return valid;
+}
+
+bool FixedRateSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  const int num_frames = animation->num_frames();
+  if (num_soa_tracks == 0 || num_frames < 2) {  // Early out if no key frame.
+    return true;
+  }
+
+  // Finds the 2 frames to interpolate, directly from time.
+  const float duration = animation->duration();
+  const float anim_time = math::Clamp(0.f, time, duration);
+  const float frame = anim_time * (num_frames - 1) / duration;
+  const int frame0 = math::Min(static_cast<int>(frame), num_frames - 2);
+  const math::SimdFloat4 ratio =
+      math::simd_float4::Load1(frame - static_cast<float>(frame0));
+
+  const FixedRateSoaKey* keys0 =
+      animation->keys().begin + frame0 * num_soa_tracks;
+  const FixedRateSoaKey* keys1 = keys0 + num_soa_tracks;
+  assert(keys1 + num_soa_tracks <= animation->keys().end);
+
+  const math::SimdFloat4 int2float =
+      math::simd_float4::Load1(1.f / 32767.f);
+
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    const FixedRateSoaKey& k0 = keys0[i];
+    const FixedRateSoaKey& k1 = keys1[i];
+    math::SoaTransform& out = output.begin[i];
+
+    // Decompresses and interpolates translations.
+    const math::SoaFloat3 t0 = {DecompressHalves(k0.translation[0]),
+                                DecompressHalves(k0.translation[1]),
+                                DecompressHalves(k0.translation[2])};
+    const math::SoaFloat3 t1 = {DecompressHalves(k1.translation[0]),
+                                DecompressHalves(k1.translation[1]),
+                                DecompressHalves(k1.translation[2])};
+    out.translation = Lerp(t0, t1, ratio);
+
+    // Decompresses and interpolates rotations.
+    // The lerp of the rotation uses the shortest path, because opposed
+    // quaternions were negated during animation build stage.
+    const math::SoaQuaternion r0 = {
+        DecompressQuantized(k0.rotation[0], int2float),
+        DecompressQuantized(k0.rotation[1], int2float),
+        DecompressQuantized(k0.rotation[2], int2float),
+        DecompressQuantized(k0.rotation[3], int2float)};
+    const math::SoaQuaternion r1 = {
+        DecompressQuantized(k1.rotation[0], int2float),
+        DecompressQuantized(k1.rotation[1], int2float),
+        DecompressQuantized(k1.rotation[2], int2float),
+        DecompressQuantized(k1.rotation[3], int2float)};
+    out.rotation = NLerpEst(r0, r1, ratio);
+
+    // Decompresses and interpolates scales.
+    const math::SoaFloat3 s0 = {DecompressHalves(k0.scale[0]),
+                                DecompressHalves(k0.scale[1]),
+                                DecompressHalves(k0.scale[2])};
+    const math::SoaFloat3 s1 = {DecompressHalves(k1.scale[0]),
+                                DecompressHalves(k1.scale[1]),
+                                DecompressHalves(k1.scale[2])};
+    out.scale = Lerp(s0, s1, ratio);
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,292 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/inertialization_job.h"
+
+#include <cassert>
+#include <cstddef>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+InertializationCaptureJob::InertializationCaptureJob() : delta_time(0.f) {}
+
+bool InertializationCaptureJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid ranges.
+  valid &= target.end >= target.begin;
+  valid &= previous.begin != NULL && previous.end >= previous.begin;
+  valid &= current.begin != NULL && current.end >= current.begin;
+  valid &= output.begin != NULL && output.end >= output.begin;
+
+  // The target size defines the number of soa joints to capture, so all other
+  // buffers should be bigger.
+  const ptrdiff_t min_range = target.end - target.begin;
+  valid &= previous.end - previous.begin >= min_range;
+  valid &= current.end - current.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  // Velocities are computed using delta_time.
+  valid &= delta_time > 0.f;
+
+  return valid;
+}
+
+InertializationJob::InertializationJob() : time(0.f), duration(0.f) {}
+
+bool InertializationJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid ranges.
+  valid &= input.end >= input.begin;
+  valid &= offsets.begin != NULL && offsets.end >= offsets.begin;
+  valid &= output.begin != NULL && output.end >= output.begin;
+
+  // The input size defines the number of soa joints to process, so all other
+  // buffers should be bigger.
+  const ptrdiff_t min_range = input.end - input.begin;
+  valid &= offsets.end - offsets.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  // Duration must be strictly positive, as time is normalized by duration.
+  valid &= duration > 0.f;
+
+  return valid;
+}
+
+namespace {
+// Approximates acos(_x) / sqrt(1 - _x) for _x in range [0,1], with a
+// polynomial whose absolute error is less than 2e-8 once multiplied by
+// sqrt(1 - _x). See Abramowitz and Stegun, "Handbook of Mathematical
+// Functions", 4.4.46.
+math::SimdFloat4 ACosRatio(math::_SimdFloat4 _x) {
+  math::SimdFloat4 p = math::simd_float4::Load1(-.0012624911f);
+  p = math::MAdd(p, _x, math::simd_float4::Load1(.0066700901f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(-.0170881256f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(.0308918810f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(-.0501743046f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(.0889789874f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(-.2145988016f));
+  return math::MAdd(p, _x, math::simd_float4::Load1(1.5707963050f));
+}
+
+// Approximates sin(_x) / _x, from the Taylor series of sin truncated after
+// x^11. _x2 is the square of _x, which must be in range [0,pi/2].
+math::SimdFloat4 SinRatioFromSquare(math::_SimdFloat4 _x2) {
+  math::SimdFloat4 p = math::simd_float4::Load1(-1.f / 39916800.f);
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(1.f / 362880.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-1.f / 5040.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(1.f / 120.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-1.f / 6.f));
+  return math::MAdd(p, _x2, math::simd_float4::one());
+}
+
+// Approximates cos(_x), from its Taylor series truncated after x^12. _x2 is
+// the square of _x, which must be in range [0,pi/2].
+math::SimdFloat4 CosFromSquare(math::_SimdFloat4 _x2) {
+  math::SimdFloat4 p = math::simd_float4::Load1(1.f / 479001600.f);
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-1.f / 3628800.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(1.f / 40320.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-1.f / 720.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(1.f / 24.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-.5f));
+  return math::MAdd(p, _x2, math::simd_float4::one());
+}
+
+// Computes the scaled axis (axis * angle) vector of rotation _q, taking the
+// shortest path.
+math::SoaFloat3 ToScaledAxis(const math::SoaQuaternion& _q) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 two = math::simd_float4::Load1(2.f);
+
+  // Negates quaternions whose w is negative, to take the shortest path.
+  const math::SimdInt4 sign = math::Sign(_q.w);
+  const math::SimdFloat4 w = math::Min(math::Abs(_q.w), one);
+
+  // The angle / sin(angle / 2) ratio is 2 * acos(w) / sqrt(1 - w^2). Once
+  // sqrt(1 - w) is factored out of acos, it has no singularity for small
+  // angles.
+  const math::SimdFloat4 ratio =
+      two * ACosRatio(w) * math::RSqrtEstNR(one + w);
+  const math::SimdFloat4 signed_ratio = math::Xor(ratio, sign);
+  return math::SoaFloat3::Load(_q.x * signed_ratio, _q.y * signed_ratio,
+                               _q.z * signed_ratio);
+}
+
+// Computes the rotation matching scaled axis (axis * angle) vector _v, whose
+// angle must be in range [0,pi].
+math::SoaQuaternion FromScaledAxis(const math::SoaFloat3& _v) {
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 quarter = math::simd_float4::Load1(.25f);
+
+  // The sin(angle / 2) / angle ratio has no singularity for small angles.
+  const math::SimdFloat4 half_angle2 = math::Dot(_v, _v) * quarter;
+  const math::SimdFloat4 ratio = half * SinRatioFromSquare(half_angle2);
+  return math::SoaQuaternion::Load(_v.x * ratio, _v.y * ratio, _v.z * ratio,
+                                   CosFromSquare(half_angle2));
+}
+
+// Evaluates at time _t the decay of offset _x0, whose initial velocity is _v0,
+// over _duration. The decay follows a quintic polynomial that reaches 0 with
+// null velocity and acceleration. Velocities moving away from 0 are ignored,
+// and the decay is shortened if the initial velocity would make it overshoot.
+math::SimdFloat4 Decay(math::_SimdFloat4 _x0, math::_SimdFloat4 _v0,
+                       math::_SimdFloat4 _t, math::_SimdFloat4 _duration) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-6f);
+
+  // The polynomial is computed for a positive offset, and its sign restored
+  // afterward.
+  const math::SimdInt4 sign = math::Sign(_x0);
+  const math::SimdFloat4 x0 = math::Abs(_x0);
+  const math::SimdFloat4 v0 = math::Min(math::Xor(_v0, sign), zero);
+
+  // Shortens decay duration to avoid overshooting.
+  const math::SimdFloat4 t1 = math::Min(
+      _duration, math::simd_float4::Load1(-5.f) * x0 / math::Min(v0, -eps));
+
+  // Polynomial coefficients, for a time normalized by t1. Initial
+  // acceleration is chosen to avoid overshooting.
+  const math::SimdFloat4 v0t1 = v0 * t1;
+  const math::SimdFloat4 a0t1 = math::Max0(
+      math::simd_float4::Load1(-8.f) * v0t1 -
+      math::simd_float4::Load1(20.f) * x0);
+  const math::SimdFloat4 a = math::simd_float4::Load1(-6.f) * x0 -
+                             math::simd_float4::Load1(3.f) * v0t1 -
+                             half * a0t1;
+  const math::SimdFloat4 b = math::simd_float4::Load1(15.f) * x0 +
+                             math::simd_float4::Load1(8.f) * v0t1 +
+                             math::simd_float4::Load1(1.5f) * a0t1;
+  const math::SimdFloat4 c = math::simd_float4::Load1(-10.f) * x0 -
+                             math::simd_float4::Load1(6.f) * v0t1 -
+                             math::simd_float4::Load1(1.5f) * a0t1;
+
+  // Evaluates polynomial using Horner's method.
+  const math::SimdFloat4 u = math::Min(_t / math::Max(t1, eps), one);
+  const math::SimdFloat4 x =
+      x0 + u * (v0t1 + u * (half * a0t1 + u * (c + u * (b + u * a))));
+
+  // Offset is 0 once decay is over.
+  return math::Xor(math::Select(math::CmpLt(_t, t1), x, zero), sign);
+}
+
+// Decays vector offset _x0 along its own direction, so that its axis doesn't
+// drift during the transition. Only the component of the velocity _v0 along
+// this axis is kept.
+math::SoaFloat3 Decay(const math::SoaFloat3& _x0, const math::SoaFloat3& _v0,
+                      math::_SimdFloat4 _t, math::_SimdFloat4 _duration) {
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-6f);
+  const math::SimdFloat4 length = math::Length(_x0);
+  const math::SimdFloat4 inv_length = math::simd_float4::one() /
+                                      math::Max(length, eps);
+  const math::SoaFloat3 axis = math::SoaFloat3::Load(
+      _x0.x * inv_length, _x0.y * inv_length, _x0.z * inv_length);
+  const math::SimdFloat4 x =
+      Decay(length, math::Dot(_v0, axis), _t, _duration);
+  return math::SoaFloat3::Load(axis.x * x, axis.y * x, axis.z * x);
+}
+}  // namespace
+
+bool InertializationCaptureJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 inv_dt = math::simd_float4::Load1(1.f / delta_time);
+  const ptrdiff_t num_soa_joints = target.end - target.begin;
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    const math::SoaTransform& prev = previous.begin[i];
+    const math::SoaTransform& cur = current.begin[i];
+    const math::SoaTransform& tgt = target.begin[i];
+    SoaInertializationOffset& offset = output.begin[i];
+
+    // Translations and scales offsets are differences with the target, so
+    // their velocities don't depend on the target.
+    offset.translation = cur.translation - tgt.translation;
+    offset.translation_velocity = (cur.translation - prev.translation) * inv_dt;
+    offset.scale = cur.scale - tgt.scale;
+    offset.scale_velocity = (cur.scale - prev.scale) * inv_dt;
+
+    // Rotation offsets are the rotations from the target, such that
+    // cur = offset * tgt.
+    const math::SoaQuaternion inv_tgt = math::Conjugate(tgt.rotation);
+    offset.rotation = ToScaledAxis(cur.rotation * inv_tgt);
+    const math::SoaFloat3 prev_rotation = ToScaledAxis(prev.rotation * inv_tgt);
+    offset.rotation_velocity = (offset.rotation - prev_rotation) * inv_dt;
+  }
+
+  return true;
+}
+
+bool InertializationJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const ptrdiff_t num_soa_joints = input.end - input.begin;
+
+  // Once the transition is over, all offsets are 0.
+  if (time >= duration) {
+    if (output.begin != input.begin) {
+      for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+        output.begin[i] = input.begin[i];
+      }
+    }
+    return true;
+  }
+
+  const math::SimdFloat4 t = math::simd_float4::Load1(math::Max(time, 0.f));
+  const math::SimdFloat4 d = math::simd_float4::Load1(duration);
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    const SoaInertializationOffset& offset = offsets.begin[i];
+    const math::SoaTransform& in = input.begin[i];
+    math::SoaTransform& out = output.begin[i];
+    out.translation =
+        in.translation +
+        Decay(offset.translation, offset.translation_velocity, t, d);
+    out.rotation =
+        FromScaledAxis(Decay(offset.rotation, offset.rotation_velocity, t, d)) *
+        in.rotation;
+    out.scale = in.scale + Decay(offset.scale, offset.scale_velocity, t, d);
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -28,8 +28,10 @@
 #include "ozz/animation/runtime/local_to_model_job.h"
 
 #include <cassert>
+#include <cstring>
 
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_float3x4.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
@@ -39,6 +41,10 @@
 namespace ozz {
 namespace animation {
 
+LocalToModelJob::LocalToModelJob()
+    : skeleton(NULL),
+      from(Skeleton::kNoParentIndex) {}
+
 bool LocalToModelJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -50,66 +56,493 @@ bool LocalToModelJob::Validate() const {
     return false;
   }
   valid &= input.begin != NULL;
-  valid &= output.begin != NULL;
 
   const int num_joints = skeleton->num_joints();
   const int num_soa_joints = (num_joints + 3) / 4;
 
-  // Test input and output ranges, implicitly tests for NULL end pointers.
+  // Test input range, implicitly tests for NULL end pointers.
   valid &= input.end - input.begin >= num_soa_joints;
-  valid &= output.end - output.begin >= num_joints;
+
+  // Test output ranges, exactly one of them must be used.
+  if (output.begin) {
+    valid &= output.end - output.begin >= num_joints;
+    valid &= affine_output.begin == NULL;
+  } else {
+    valid &= affine_output.begin != NULL;
+    valid &= affine_output.end - affine_output.begin >= num_joints;
+  }
+
+  // Test optional skinning output, which requires inverse bind poses.
+  if (skinning_output.begin || inverse_bind_poses.begin) {
+    valid &= skinning_output.begin != NULL;
+    valid &= skinning_output.end - skinning_output.begin >= num_joints;
+    valid &= inverse_bind_poses.begin != NULL;
+    valid &= inverse_bind_poses.end - inverse_bind_poses.begin >= num_joints;
+  }
+
+  // Test from joint.
+  valid &= from == Skeleton::kNoParentIndex || (from >= 0 && from < num_joints);
+
+  // Test joints list, which can't be used with from joint nor dirty mask.
+  if (joints.begin) {
+    valid &= joints.end >= joints.begin;
+    valid &= from == Skeleton::kNoParentIndex && dirty.begin == NULL;
+    for (const uint16_t* joint = joints.begin; valid && joint < joints.end;
+         ++joint) {
+      valid &= *joint < num_joints;
+    }
+  }
+
+  // Test dirty mask, which can't be used with from joint.
+  if (dirty.begin) {
+    valid &= dirty.end - dirty.begin >= (num_soa_joints + 7) / 8;
+    valid &= from == Skeleton::kNoParentIndex;
+  }
 
   return valid;
 }
 
-bool LocalToModelJob::Run() const {
-  using math::SoaTransform;
-  using math::SoaFloat4x4;
-  using math::Float4x4;
+namespace {
+// Converts the 4 soa matrices of _soa to aos Float4x4 matrices.
+void SoaToAos(const math::SoaFloat4x4& _soa, math::Float4x4 _aos[4]) {
+  math::Transpose16x16(&_soa.cols[0].x, &_aos[0].cols[0]);
+}
 
-  if (!Validate()) {
-    return false;
+// Converts the 4 soa matrices of _soa to aos Float3x4 matrices. Each row is a
+// 4x4 transposition of the matching component of the 4 columns, the last row
+// (0, 0, 0, 1) is dropped.
+void SoaToAos(const math::SoaFloat4x4& _soa, math::Float3x4 _aos[4]) {
+  math::SimdFloat4 rows[3][4];
+  const math::SimdFloat4 xs[4] = {_soa.cols[0].x, _soa.cols[1].x,
+                                  _soa.cols[2].x, _soa.cols[3].x};
+  math::Transpose4x4(xs, rows[0]);
+  const math::SimdFloat4 ys[4] = {_soa.cols[0].y, _soa.cols[1].y,
+                                  _soa.cols[2].y, _soa.cols[3].y};
+  math::Transpose4x4(ys, rows[1]);
+  const math::SimdFloat4 zs[4] = {_soa.cols[0].z, _soa.cols[1].z,
+                                  _soa.cols[2].z, _soa.cols[3].z};
+  math::Transpose4x4(zs, rows[2]);
+  for (int i = 0; i < 4; ++i) {
+    _aos[i].rows[0] = rows[0][i];
+    _aos[i].rows[1] = rows[1][i];
+    _aos[i].rows[2] = rows[2][i];
   }
+}
 
-  // Early out if no joint.
-  const int num_joints = skeleton->num_joints();
-  if (num_joints == 0) {
-    return true;
-  }
+// Computes the skinning matrix of _model matrix.
+math::Float4x4 ToSkinning(const math::Float4x4& _model,
+                          const math::Float4x4& _inverse_bind_pose) {
+  return _model * _inverse_bind_pose;
+}
+
+math::Float4x4 ToSkinning(const math::Float3x4& _model,
+                          const math::Float4x4& _inverse_bind_pose) {
+  return ToFloat4x4(_model) * _inverse_bind_pose;
+}
+
+// Implements local to model conversion for both Float4x4 and Float3x4 model
+// matrices.
+template <typename _Matrix>
+void LocalToModel(const LocalToModelJob& _job, _Matrix* _model_matrices) {
+  using math::SoaTransform;
+  using math::SoaFloat4x4;
 
   // Fetch joint's properties.
+  const int num_joints = _job.skeleton->num_joints();
   Range<const Skeleton::JointProperties> properties =
-      skeleton->joint_properties();
-
-  // Output.
-  Float4x4* const model_matrices = output.begin;
+      _job.skeleton->joint_properties();
 
   // Initializes an identity matrix that will be used to compute roots model
   // matrices without requiring a branch.
-  const Float4x4 identity = Float4x4::identity();
+  const _Matrix identity = _Matrix::identity();
+
+  // Skinning matrices are optionally computed while model matrices are still
+  // hot.
+  const math::Float4x4* inverse_bind_poses = _job.inverse_bind_poses.begin;
+  math::Float4x4* skinning_matrices = _job.skinning_output.begin;
+
+  // Flags the joints to update, one bit per joint. Joints are stored in
+  // breadth-first order, so a parent is always flagged before its children,
+  // which are updated as soon as their parent is. Updated joints aren't
+  // contiguous though, so the flags are needed to skip other joints.
+  // Updates start from from joint, or from the joints of dirty soa joints.
+  const int from = _job.from;
+  const uint8_t* dirty = _job.dirty.begin;
+  const bool all = from == Skeleton::kNoParentIndex && !dirty;
+  uint32_t updated[(Skeleton::kMaxJoints + 31) / 32];
+  if (!all) {
+    std::memset(updated, 0, sizeof(updated));
+  }
 
   // Converts to matrices and applies hierarchical transformation.
-  for (int joint = 0; joint < num_joints;) {
+  for (int joint = all || dirty ? 0 : from & ~3; joint < num_joints;) {
+    const int proceed_up_to = joint + math::Min(4, num_joints - joint);
+
+    // Finds the joints of this soa joint to update.
+    int update = 0xf;
+    if (!all) {
+      update = 0;
+      const int soa_joint = joint / 4;
+      const bool soa_dirty =
+          dirty && (dirty[soa_joint / 8] & (1 << (soa_joint & 7)));
+      for (int i = joint; i < proceed_up_to; ++i) {
+        const int parent = properties.begin[i].parent;
+        const bool parent_updated =
+            parent != Skeleton::kNoParentIndex &&
+            (updated[parent / 32] & (1u << (parent & 31)));
+        if (parent_updated || (dirty ? soa_dirty : i == from)) {
+          updated[i / 32] |= 1u << (i & 31);
+          update |= 1 << (i & 3);
+        }
+      }
+    }
+    if (!update) {
+      joint = proceed_up_to;
+      continue;
+    }
+
     // Builds soa matrices from soa transforms.
-    const SoaTransform& transform = input.begin[joint / 4];
+    const SoaTransform& transform = _job.input.begin[joint / 4];
     const SoaFloat4x4 local_soa_matrices = SoaFloat4x4::FromAffine(
         transform.translation, transform.rotation, transform.scale);
     // Converts to aos matrices.
-    math::SimdFloat4 local_aos_matrices[16];
-    math::Transpose16x16(&local_soa_matrices.cols[0].x, local_aos_matrices);
+    _Matrix local_aos_matrices[4];
+    SoaToAos(local_soa_matrices, local_aos_matrices);
 
     // Applies hierarchical transformation.
-    const int proceed_up_to = joint + math::Min(4, num_joints - joint);
-    const math::SimdFloat4* local_aos_matrix = local_aos_matrices;
-    for (; joint < proceed_up_to; ++joint, local_aos_matrix += 4) {
+    const _Matrix* local_matrix = local_aos_matrices;
+    for (; joint < proceed_up_to; ++joint, ++local_matrix) {
+      if (!(update & (1 << (joint & 3)))) {
+        continue;
+      }
+      const int parent = properties.begin[joint].parent;
+      const _Matrix* parent_matrix =
+          math::Select(parent == Skeleton::kNoParentIndex, &identity,
+                       &_model_matrices[parent]);
+      const _Matrix model_matrix = (*parent_matrix) * (*local_matrix);
+      _model_matrices[joint] = model_matrix;
+      if (skinning_matrices) {
+        skinning_matrices[joint] =
+            ToSkinning(model_matrix, inverse_bind_poses[joint]);
+      }
+    }
+  }
+}
+
+// Implements local to model conversion of a list of joints, for both Float4x4
+// and Float3x4 model matrices. Adjacent joints of the same soa joint share
+// their local matrices conversion.
+template <typename _Matrix>
+void LocalToModelJoints(const LocalToModelJob& _job,
+                        _Matrix* _model_matrices) {
+  using math::SoaTransform;
+  using math::SoaFloat4x4;
+
+  Range<const Skeleton::JointProperties> properties =
+      _job.skeleton->joint_properties();
+  const _Matrix identity = _Matrix::identity();
+  const math::Float4x4* inverse_bind_poses = _job.inverse_bind_poses.begin;
+  math::Float4x4* skinning_matrices = _job.skinning_output.begin;
+
+  for (const uint16_t* joints = _job.joints.begin; joints < _job.joints.end;) {
+    // Builds local matrices of the soa joint of the current joint.
+    const int soa_joint = *joints / 4;
+    const SoaTransform& transform = _job.input.begin[soa_joint];
+    const SoaFloat4x4 local_soa_matrices = SoaFloat4x4::FromAffine(
+        transform.translation, transform.rotation, transform.scale);
+    _Matrix local_aos_matrices[4];
+    SoaToAos(local_soa_matrices, local_aos_matrices);
+
+    // Applies hierarchical transformation to all adjacent joints of this soa
+    // joint.
+    for (; joints < _job.joints.end && *joints / 4 == soa_joint; ++joints) {
+      const int joint = *joints;
       const int parent = properties.begin[joint].parent;
-      const Float4x4* parent_matrix =
+      const _Matrix* parent_matrix =
           math::Select(parent == Skeleton::kNoParentIndex, &identity,
-                       &model_matrices[parent]);
-      const Float4x4 local_matrix = {{local_aos_matrix[0], local_aos_matrix[1],
-                                      local_aos_matrix[2],
-                                      local_aos_matrix[3]}};
-      model_matrices[joint] = (*parent_matrix) * local_matrix;
+                       &_model_matrices[parent]);
+      const _Matrix model_matrix =
+          (*parent_matrix) * local_aos_matrices[joint & 3];
+      _model_matrices[joint] = model_matrix;
+      if (skinning_matrices) {
+        skinning_matrices[joint] =
+            ToSkinning(model_matrix, inverse_bind_poses[joint]);
+      }
+    }
+  }
+}
+}  // namespace
+
+bool LocalToModelJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no joint.
+  if (skeleton->num_joints() == 0) {
+    return true;
+  }
+
+  // Outputs to the model matrices type selected by the user.
+  if (joints.begin) {
+    if (output.begin) {
+      LocalToModelJoints(*this, output.begin);
+    } else {
+      LocalToModelJoints(*this, affine_output.begin);
+    }
+  } else if (output.begin) {
+    LocalToModel(*this, output.begin);
+  } else {
+    LocalToModel(*this, affine_output.begin);
+  }
+  return true;
+}
+
+BatchLocalToModelJob::BatchLocalToModelJob() : skeleton(NULL) {}
+
+bool BatchLocalToModelJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  bool valid = true;
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+
+  // Test inputs and outputs ranges, one per instance.
+  valid &= inputs.end - inputs.begin == outputs.end - outputs.begin;
+  for (const Range<const math::SoaTransform>* input = inputs.begin;
+       valid && input < inputs.end; ++input) {
+    valid &= input->begin != NULL;
+    valid &= input->end - input->begin >= num_soa_joints;
+  }
+  for (const Range<math::Float4x4>* output = outputs.begin;
+       valid && output < outputs.end; ++output) {
+    valid &= output->begin != NULL;
+    valid &= output->end - output->begin >= num_joints;
+  }
+
+  // Test scratch buffer.
+  valid &= scratch.begin != NULL;
+  valid &= scratch.end - scratch.begin >= num_joints;
+
+  return valid;
+}
+
+namespace {
+// Transposes the soa transforms of 4 instances, whose lanes are 4 joints, to
+// the soa transforms of the 4 joints, whose lanes are the 4 instances.
+void TransposeInstances(const math::SoaTransform* const _instances[4],
+                        math::SoaTransform _joints[4]) {
+  // A SoaTransform is made of 10 SimdFloat4, that are transposed one by one.
+  const int kNumMembers = sizeof(math::SoaTransform) / sizeof(math::SimdFloat4);
+  for (int m = 0; m < kNumMembers; ++m) {
+    math::SimdFloat4 in[4];
+    for (int i = 0; i < 4; ++i) {
+      in[i] = reinterpret_cast<const math::SimdFloat4*>(_instances[i])[m];
+    }
+    math::SimdFloat4 out[4];
+    math::Transpose4x4(in, out);
+    for (int j = 0; j < 4; ++j) {
+      reinterpret_cast<math::SimdFloat4*>(&_joints[j])[m] = out[j];
+    }
+  }
+}
+}  // namespace
+
+bool BatchLocalToModelJob::Run() const {
+  using math::SoaTransform;
+  using math::SoaFloat4x4;
+  using math::Float4x4;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = skeleton->num_joints();
+  const int num_instances = static_cast<int>(inputs.end - inputs.begin);
+  Range<const Skeleton::JointProperties> properties =
+      skeleton->joint_properties();
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const SoaFloat4x4 identity = SoaFloat4x4::identity();
+
+  // Processes instances by groups of 4. The last group is completed with
+  // copies of its last instance, whose outputs aren't written.
+  for (int first = 0; first < num_instances; first += 4) {
+    const int group_size = math::Min(4, num_instances - first);
+    int instances[4];
+    for (int i = 0; i < 4; ++i) {
+      instances[i] = first + math::Min(i, group_size - 1);
+    }
+
+    for (int joint = 0; joint < num_joints;) {
+      // Transposes local transforms of the 4 joints of this soa joint, so
+      // that lanes are instances.
+      const SoaTransform* soa_locals[4];
+      for (int i = 0; i < 4; ++i) {
+        soa_locals[i] = inputs.begin[instances[i]].begin + joint / 4;
+      }
+      SoaTransform locals[4];
+      TransposeInstances(soa_locals, locals);
+
+      // Applies hierarchical transformation to the 4 instances at once.
+      const int proceed_up_to = joint + math::Min(4, num_joints - joint);
+      for (const SoaTransform* local = locals; joint < proceed_up_to;
+           ++joint, ++local) {
+        const int parent = properties.begin[joint].parent;
+        const SoaFloat4x4* parent_matrix =
+            math::Select(parent == Skeleton::kNoParentIndex, &identity,
+                         &scratch.begin[parent]);
+        const SoaFloat4x4 model =
+            (*parent_matrix) * SoaFloat4x4::FromAffine(local->translation,
+                                                       local->rotation,
+                                                       local->scale);
+        scratch.begin[joint] = model;
+
+        // Converts to instances aos matrices.
+        math::SimdFloat4 aos_matrices[16];
+        math::Transpose16x16(&model.cols[0].x, aos_matrices);
+        for (int i = 0; i < group_size; ++i) {
+          const Float4x4 matrix = {{aos_matrices[i * 4 + 0],
+                                    aos_matrices[i * 4 + 1],
+                                    aos_matrices[i * 4 + 2],
+                                    aos_matrices[i * 4 + 3]}};
+          outputs.begin[first + i].begin[joint] = matrix;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+LocalToModelTransformJob::LocalToModelTransformJob() : skeleton(NULL) {}
+
+bool LocalToModelTransformJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  bool valid = true;
+
+  const int num_soa_joints = skeleton->num_soa_joints();
+
+  // Test input and output ranges, implicitly tests for NULL end pointers.
+  valid &= input.begin != NULL;
+  valid &= input.end - input.begin >= num_soa_joints;
+  valid &= output.begin != NULL;
+  valid &= output.end - output.begin >= num_soa_joints;
+
+  return valid;
+}
+
+namespace {
+// A SoaTransform is made of 10 SimdFloat4, that are accessed lane by lane.
+const int kNumSoaTransformMembers =
+    sizeof(math::SoaTransform) / sizeof(math::SimdFloat4);
+
+// Gathers the model-space transforms of _parents joints into the lanes of
+// _gathered. Lanes whose parent is Skeleton::kNoParentIndex get identity.
+void GatherParentTransforms(const math::SoaTransform* _models,
+                            const int _parents[4],
+                            math::SoaTransform* _gathered) {
+  const math::SoaTransform identity = math::SoaTransform::identity();
+  float* gathered = reinterpret_cast<float*>(_gathered);
+  for (int i = 0; i < 4; ++i) {
+    const int parent = _parents[i];
+    const bool root = parent == Skeleton::kNoParentIndex;
+    const float* src =
+        reinterpret_cast<const float*>(root ? &identity : &_models[parent / 4]);
+    const int lane = root ? 0 : parent & 3;
+    for (int m = 0; m < kNumSoaTransformMembers; ++m) {
+      gathered[m * 4 + i] = src[m * 4 + lane];
+    }
+  }
+}
+
+// Copies _lanes lanes (one bit per lane) of _src to _dest.
+void CopyTransformLanes(const math::SoaTransform& _src, int _lanes,
+                        math::SoaTransform* _dest) {
+  const float* src = reinterpret_cast<const float*>(&_src);
+  float* dest = reinterpret_cast<float*>(_dest);
+  for (int i = 0; i < 4; ++i) {
+    if (_lanes & (1 << i)) {
+      for (int m = 0; m < kNumSoaTransformMembers; ++m) {
+        dest[m * 4 + i] = src[m * 4 + i];
+      }
+    }
+  }
+}
+
+// Concatenates _local transforms to their _parent model-space transforms.
+math::SoaTransform ConcatenateTransforms(const math::SoaTransform& _parent,
+                                         const math::SoaTransform& _local) {
+  const math::SoaTransform model = {
+      _parent.translation +
+          math::TransformVector(_parent.rotation,
+                                _parent.scale * _local.translation),
+      _parent.rotation * _local.rotation, _parent.scale * _local.scale};
+  return model;
+}
+}  // namespace
+
+bool LocalToModelTransformJob::Run() const {
+  using math::SoaTransform;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = skeleton->num_soa_joints();
+  Range<const Skeleton::JointProperties> properties =
+      skeleton->joint_properties();
+
+  for (int soa_joint = 0; soa_joint < num_soa_joints; ++soa_joint) {
+    const int first = soa_joint * 4;
+
+    // Finds lanes parents. Lanes out of the skeleton are processed as roots.
+    // Lanes whose parent belongs to this soa joint are pending, until their
+    // parent lane is computed.
+    int parents[4];
+    int pending = 0;
+    for (int i = 0; i < 4; ++i) {
+      parents[i] = first + i < num_joints ? properties.begin[first + i].parent
+                                          : Skeleton::kNoParentIndex;
+      if (parents[i] != Skeleton::kNoParentIndex && parents[i] >= first) {
+        pending |= 1 << i;
+      }
+    }
+
+    // Local transforms are copied, so that input and output can alias.
+    const SoaTransform local = input.begin[soa_joint];
+    SoaTransform* model = &output.begin[soa_joint];
+
+    // Fast path, all parents belong to previous soa joints.
+    SoaTransform parent;
+    if (!pending) {
+      GatherParentTransforms(output.begin, parents, &parent);
+      *model = ConcatenateTransforms(parent, local);
+      continue;
+    }
+
+    // Otherwise computes ready lanes, until there's no more pending one. Each
+    // pass computes all lanes, but only copies the ready ones. Parents of other
+    // lanes aren't computed yet, identity is gathered instead.
+    for (int done = 0; done != 0xf;) {
+      int ready = 0;
+      int ready_parents[4];
+      for (int i = 0; i < 4; ++i) {
+        ready_parents[i] = Skeleton::kNoParentIndex;
+        if (!(done & (1 << i)) &&
+            (!(pending & (1 << i)) || done & (1 << (parents[i] & 3)))) {
+          ready |= 1 << i;
+          ready_parents[i] = parents[i];
+        }
+      }
+      GatherParentTransforms(output.begin, ready_parents, &parent);
+      CopyTransformLanes(ConcatenateTransforms(parent, local), ready, model);
+      done |= ready;
     }
   }
   return true;
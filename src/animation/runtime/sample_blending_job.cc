@@ -0,0 +1,286 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/sample_blending_job.h"
+
+#include <cassert>
+#include <cstddef>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/blending_passes.h"
+
+namespace ozz {
+namespace animation {
+
+SampleBlendingJob::Layer::Layer()
+    : weight(0.f), time(0.f), animation(NULL), cache(NULL) {}
+
+SampleBlendingJob::SampleBlendingJob() : threshold(.1f) {}
+
+namespace {
+bool ValidateSampleLayer(const SampleBlendingJob::Layer& _layer,
+                         ptrdiff_t _min_range) {
+  // Test for NULL pointers.
+  if (!_layer.animation || !_layer.cache) {
+    return false;
+  }
+
+  bool valid = true;
+
+  // Tests animation and cache sizes.
+  const ptrdiff_t num_soa_tracks = _layer.animation->num_soa_tracks();
+  valid &= num_soa_tracks >= _min_range;
+  valid &= _layer.cache->max_soa_tracks() >= num_soa_tracks;
+
+  // Joint weights are optional.
+  if (_layer.joint_weights.begin != NULL) {
+    valid &= _layer.joint_weights.end >= _layer.joint_weights.begin;
+    valid &=
+        _layer.joint_weights.end - _layer.joint_weights.begin >= _min_range;
+  } else {
+    valid &= _layer.joint_weights.end == NULL;
+  }
+  return valid;
+}
+}  // namespace
+
+bool SampleBlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
+
+  // Test for NULL begin pointers.
+  valid &= bind_pose.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= bind_pose.end >= bind_pose.begin;
+  valid &= output.end >= output.begin;
+
+  // The bind pose size defines the ranges of transforms to blend, so all
+  // other buffers should be bigger.
+  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
+  valid &= output.end - output.begin >= min_range;
+
+  // Layers are optional.
+  if (layers.begin != NULL) {
+    valid &= layers.end >= layers.begin;
+  } else {
+    valid &= layers.end == NULL;
+  }
+
+  // Validates layers.
+  for (const Layer* layer = layers.begin; layers.begin && layer < layers.end;
+       ++layer) {
+    valid &= ValidateSampleLayer(*layer, min_range);
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Defines the number of soa joints processed at once. Intermediate samples of
+// a chunk, accumulated weights and output stay in L1 cache while all layers
+// are blended.
+const int kSampleBlendingChunkSize = 8;
+
+// Clamps layer time in range [0,duration].
+float LayerTime(const SampleBlendingJob::Layer& _layer) {
+  return math::Clamp(0.f, _layer.time, _layer.animation->duration());
+}
+
+// Blends _count soa joints _samples of _layer to _output, starting at soa
+// joint _begin. _first_pass selects whether _output and _accumulated_weights
+// are initialized or accumulated.
+void BlendChunk(const SampleBlendingJob::Layer& _layer, bool _first_pass,
+                int _begin, int _count, const math::SoaTransform* _samples,
+                math::SimdFloat4* _accumulated_weights,
+                math::SoaTransform* _output) {
+  const math::SimdFloat4 layer_weight =
+      math::simd_float4::Load1(_layer.weight);
+  if (_layer.joint_weights.begin) {
+    // This layer has per-joint weights.
+    const math::SimdFloat4* joint_weights = _layer.joint_weights.begin + _begin;
+    if (_first_pass) {
+      for (int i = 0; i < _count; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        const math::SimdFloat4 weight =
+            layer_weight * math::Max0(joint_weights[i]);
+        _accumulated_weights[i] = weight;
+        OZZ_BLEND_1ST_PASS(src, weight, dest);
+      }
+    } else {
+      for (int i = 0; i < _count; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        const math::SimdFloat4 weight =
+            layer_weight * math::Max0(joint_weights[i]);
+        _accumulated_weights[i] = _accumulated_weights[i] + weight;
+        OZZ_BLEND_N_PASS(src, weight, dest);
+      }
+    }
+  } else {
+    // This is a full layer.
+    if (_first_pass) {
+      for (int i = 0; i < _count; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        _accumulated_weights[i] = layer_weight;
+        OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
+      }
+    } else {
+      for (int i = 0; i < _count; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        _accumulated_weights[i] = _accumulated_weights[i] + layer_weight;
+        OZZ_BLEND_N_PASS(src, layer_weight, dest);
+      }
+    }
+  }
+}
+}  // namespace
+
+bool SampleBlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Updates the cache of every layer to its time, and accumulates global
+  // weights. Layers with a weight <= 0 are skipped.
+  float accumulated_weight = 0.f;
+  int num_passes = 0;
+  int num_partial_passes = 0;
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    if (layer->weight <= 0.f) {
+      continue;
+    }
+    layer->cache->Update(*layer->animation, LayerTime(*layer), NULL, 0,
+                         layer->animation->num_soa_tracks(), NULL);
+    accumulated_weight += layer->weight;
+    num_partial_passes += layer->joint_weights.begin != NULL;
+    ++num_passes;
+  }
+
+  // Computes the bind pose weight when no partial blending pass is used, in
+  // which case threshold can be tested globally.
+  const float bp_weight = threshold - accumulated_weight;
+  const bool global_bind_pose = num_partial_passes == 0 && bp_weight > 0.f;
+  if (global_bind_pose) {
+    accumulated_weight = num_passes == 0 ? 1.f : threshold;
+  }
+  const math::SimdFloat4 simd_bp_weight = math::simd_float4::Load1(bp_weight);
+  const math::SimdFloat4 simd_threshold = math::simd_float4::Load1(threshold);
+  const math::SimdFloat4 ratio =
+      math::simd_float4::Load1(1.f / accumulated_weight);
+  const math::SimdFloat4 one = math::simd_float4::one();
+
+  // Processes soa joints by chunks, sampling and blending all layers to the
+  // output, before applying bind pose and normalizing.
+  const int num_soa_joints = static_cast<int>(bind_pose.end - bind_pose.begin);
+  for (int begin = 0; begin < num_soa_joints;
+       begin += kSampleBlendingChunkSize) {
+    const int end = math::Min(begin + kSampleBlendingChunkSize, num_soa_joints);
+    const int count = end - begin;
+    math::SoaTransform* chunk_output = output.begin + begin;
+    const math::SoaTransform* chunk_bind_pose = bind_pose.begin + begin;
+    math::SimdFloat4 accumulated_weights[kSampleBlendingChunkSize];
+
+    // Samples and blends all layers.
+    bool first_pass = true;
+    for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+      if (layer->weight <= 0.f) {
+        continue;
+      }
+      math::SoaTransform samples[kSampleBlendingChunkSize];
+      layer->cache->Interpolate(*layer->animation, LayerTime(*layer), NULL,
+                                begin, end, samples);
+      BlendChunk(*layer, first_pass, begin, count, samples,
+                 accumulated_weights, chunk_output);
+      first_pass = false;
+    }
+
+    // Blends bind pose to the output if accumulated weight is less than the
+    // threshold value, and normalizes output. Quaternion length cannot be
+    // zero as opposed quaternions have been fixed up during blending passes.
+    if (num_partial_passes == 0) {
+      if (global_bind_pose) {
+        if (num_passes == 0) {
+          // Strictly copying bind-pose.
+          for (int i = 0; i < count; ++i) {
+            chunk_output[i] = chunk_bind_pose[i];
+          }
+        } else {
+          for (int i = 0; i < count; ++i) {
+            const math::SoaTransform& src = chunk_bind_pose[i];
+            math::SoaTransform* dest = chunk_output + i;
+            OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
+          }
+        }
+      }
+      for (int i = 0; i < count; ++i) {
+        math::SoaTransform& dest = chunk_output[i];
+        dest.rotation = NormalizeEst(dest.rotation);
+        dest.translation = dest.translation * ratio;
+        dest.scale = dest.scale * ratio;
+      }
+    } else {
+      // Blending passes contain partial blending, threshold must be tested
+      // for each joint.
+      for (int i = 0; i < count; ++i) {
+        const math::SoaTransform& src = chunk_bind_pose[i];
+        math::SoaTransform* dest = chunk_output + i;
+        const math::SimdFloat4 joint_bp_weight =
+            math::Max0(simd_threshold - accumulated_weights[i]);
+        const math::SimdFloat4 weight =
+            math::Max(simd_threshold, accumulated_weights[i]);
+        OZZ_BLEND_N_PASS(src, joint_bp_weight, dest);
+        const math::SimdFloat4 joint_ratio = one / weight;
+        dest->rotation = NormalizeEst(dest->rotation);
+        dest->translation = dest->translation * joint_ratio;
+        dest->scale = dest->scale * joint_ratio;
+      }
+    }
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
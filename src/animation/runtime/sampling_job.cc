@@ -27,7 +27,10 @@
 
 #include "ozz/animation/runtime/sampling_job.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <limits>
 
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/base/maths/math_constant.h"
@@ -42,17 +45,32 @@
 namespace ozz {
 namespace animation {
 
+// Adds _value to statistics _counter, if statistics are enabled and _stats
+// isn't NULL. _value isn't evaluated if statistics are disabled.
+#if defined(OZZ_BUILD_SAMPLING_STATS)
+#define OZZ_SAMPLING_STATS_ADD(_stats, _counter, _value) \
+  do {                                                   \
+    if (_stats) {                                        \
+      (_stats)->_counter += (_value);                    \
+    }                                                    \
+  } while (void(0), 0)
+#else  // OZZ_BUILD_SAMPLING_STATS
+#define OZZ_SAMPLING_STATS_ADD(_stats, _counter, _value) \
+  do {                                                   \
+  } while (void(0), 0)
+#endif  // OZZ_BUILD_SAMPLING_STATS
+
 namespace internal {
 struct InterpSoaTranslation {
-  math::SimdFloat4 time[2];
+  math::SimdFloat4 ratio[2];
   math::SoaFloat3 value[2];
 };
 struct InterpSoaRotation {
-  math::SimdFloat4 time[2];
+  math::SimdFloat4 ratio[2];
   math::SoaQuaternion value[2];
 };
 struct InterpSoaScale {
-  math::SimdFloat4 time[2];
+  math::SimdFloat4 ratio[2];
   math::SoaFloat3 value[2];
 };
 }  // internal
@@ -76,15 +94,85 @@ bool SamplingJob::Validate() const {
   // Tests cache size.
   valid &= cache->max_soa_tracks() >= num_soa_tracks;
 
+  // Tests mask size, if any.
+  valid &= soa_mask.begin == soa_mask.end ||
+           (soa_mask.begin != NULL &&
+            soa_mask.end - soa_mask.begin >= (num_soa_tracks + 7) / 8);
+
+  // Tests soa tracks range.
+  valid &= begin_soa >= 0 && end_soa >= begin_soa;
+
   return valid;
 }
 
 namespace {
+// Flags all soa entries as outdated. It cares to only flag valid soa entries as
+// this is the exit condition of other algorithms.
+void OutdateAll(int _num_soa_tracks, unsigned char* _outdated) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  if (!num_outdated_flags) {
+    return;
+  }
+  for (int i = 0; i < num_outdated_flags - 1; ++i) {
+    _outdated[i] = 0xff;
+  }
+  _outdated[num_outdated_flags - 1] =
+      0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+}
+
+// Finds the index of the last seek point of _animation whose time is less or
+// equal to _time. Returns -1 if there's no such seek point.
+int FindSeekPoint(const Animation& _animation, float _time) {
+  const float interval = _animation.seek_interval();
+  if (interval <= 0.f) {
+    return -1;
+  }
+  int point = static_cast<int>(_time / interval);
+  // Fixes up float approximations, seek point time must be less than _time.
+  if (static_cast<float>(point) * interval > _time) {
+    --point;
+  }
+  return math::Min(point, _animation.num_seek_points()) - 1;
+}
+
+// Converts _time to key frames ratio unit, 0 being the beginning of _animation
+// and 65535 its end. AnimationBuilder uses the same conversion when building
+// seek points, which guarantees they are consistent with sampling.
+float TimeToRatio(const Animation& _animation, float _time) {
+  return _time / _animation.duration() * 65535.f;
+}
+
+// Restores cache entries and cursors from seek point _point.
+void Seek(ozz::Range<const int> _seeks, int _point, int _num_soa_tracks,
+          int* _cursor, int* _reverse_cursor, int* _cache,
+          unsigned char* _outdated) {
+  const int num_entries = _num_soa_tracks * 4 * 2;
+  const int* seek = _seeks.begin + _point * (2 + num_entries);
+  assert(seek + 2 + num_entries <= _seeks.end);
+  *_cursor = seek[0];
+  *_reverse_cursor = seek[1];
+  std::memcpy(_cache, seek + 2, num_entries * sizeof(int));
+
+  // All entries are outdated.
+  OutdateAll(_num_soa_tracks, _outdated);
+}
+
 // Loops through the sorted key frames and update cache structure.
+// _ratio is the sampling time expressed in key frames ratio unit (see
+// TimeToRatio).
+// Cache can be updated forward using _keys order, or backward using
+// _reverse_keys order. Both cursors are kept in sync, so that playback
+// direction can change at any time without invalidating the cache. Without
+// reverse keys, the cache can only be updated forward.
 template <typename _Key>
-void UpdateKeys(float _time, int _num_soa_tracks, ozz::Range<const _Key> _keys,
-                int* _cursor, int* _cache, unsigned char* _outdated) {
-  assert(_num_soa_tracks >= 1);
+void UpdateKeys(float _ratio, int _num_soa_tracks, ozz::Range<const _Key> _keys,
+                ozz::Range<const uint16_t> _reverse_keys, int* _cursor,
+                int* _reverse_cursor, int* _cache, unsigned char* _outdated,
+                SamplingStats* _stats) {
+  // Nothing to update if all soa tracks are constant.
+  if (!_num_soa_tracks) {
+    return;
+  }
   const int num_tracks = _num_soa_tracks * 4;
   assert(_keys.begin + num_tracks * 2 <= _keys.end);
 
@@ -107,27 +195,55 @@ void UpdateKeys(float _time, int _num_soa_tracks, ozz::Range<const _Key> _keys,
       _cache[out_index + 7] = in_index1 + 3;
     }
     cursor = _keys.begin + num_tracks * 2;  // New cursor position.
+    *_reverse_cursor = 0;  // No key is behind the first ones.
 
-    // All entries are outdated. It cares to only flag valid soa entries as
-    // this is the exit condition of other algorithms.
-    const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-    for (int i = 0; i < num_outdated_flags - 1; ++i) {
-      _outdated[i] = 0xff;
-    }
-    _outdated[num_outdated_flags - 1] =
-        0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+    // All entries are outdated.
+    OutdateAll(_num_soa_tracks, _outdated);
   } else {
     assert(cursor >= _keys.begin + num_tracks * 2 && cursor <= _keys.end);
   }
 
-  // Search for the keys that matches _time.
+  const uint16_t* reverse_cursor = _reverse_keys.begin + *_reverse_cursor;
+  assert(reverse_cursor >= _reverse_keys.begin &&
+         reverse_cursor <= _reverse_keys.end);
+
+  // Search backward for the keys that matches _ratio.
+  // Iterates while the left key of the track of the previous reverse key is
+  // greater than _ratio. The reverse key is then the predecessor of the left
+  // key, which becomes the new left key. Thanks to reverse keys sorting, the
+  // loop can end as soon as it finds a key lower or equal to _ratio.
+  while (reverse_cursor > _reverse_keys.begin) {
+    const int key = reverse_cursor[-1];
+    const int track = _keys.begin[key].track;
+    const int base = track * 2;
+    if (_keys.begin[_cache[base]].ratio <= _ratio) {
+      break;
+    }
+    // Flag this soa entry as outdated.
+    _outdated[track / 32] |= (1 << ((track & 0x1f) / 4));
+    // Updates cache.
+    _cache[base + 1] = _cache[base];
+    _cache[base] = key;
+    // Process previous key.
+    --reverse_cursor;
+    OZZ_SAMPLING_STATS_ADD(_stats, num_backward_keys, 1);
+  }
+
+  // Moves forward cursor back to the first key that is after the right key of
+  // its track.
+  while (cursor > _keys.begin + num_tracks * 2 &&
+         cursor - 1 - _keys.begin > _cache[cursor[-1].track * 2 + 1]) {
+    --cursor;
+  }
+
+  // Search for the keys that matches _ratio.
   // Iterates while the cache is not updated with left and right keys required
-  // for interpolation at time _time, for all tracks. Thanks to the keyframe
-  // sorting, the loop can end as soon as it finds a key greater that _time.
-  // It will mean that all the keys lower than _time have been processed,
+  // for interpolation at time _ratio, for all tracks. Thanks to the keyframe
+  // sorting, the loop can end as soon as it finds a key greater that _ratio.
+  // It will mean that all the keys lower than _ratio have been processed,
   // meaning all cache entries are updated.
   while (cursor < _keys.end &&
-         _keys.begin[_cache[cursor->track * 2 + 1]].time <= _time) {
+         _keys.begin[_cache[cursor->track * 2 + 1]].ratio <= _ratio) {
     // Flag this soa entry as outdated.
     _outdated[cursor->track / 32] |= (1 << ((cursor->track & 0x1f) / 4));
     // Updates cache.
@@ -136,58 +252,266 @@ void UpdateKeys(float _time, int _num_soa_tracks, ozz::Range<const _Key> _keys,
     _cache[base + 1] = static_cast<int>(cursor - _keys.begin);
     // Process next key.
     ++cursor;
+    OZZ_SAMPLING_STATS_ADD(_stats, num_forward_keys, 1);
   }
   assert(cursor <= _keys.end);
 
-  // Updates cursor output.
+  // Moves reverse cursor forward to the first key that isn't before the left
+  // key of its track.
+  while (reverse_cursor < _reverse_keys.end &&
+         *reverse_cursor < _cache[_keys.begin[*reverse_cursor].track * 2]) {
+    ++reverse_cursor;
+  }
+
+  // Updates cursors output.
   *_cursor = static_cast<int>(cursor - _keys.begin);
+  *_reverse_cursor = static_cast<int>(reverse_cursor - _reverse_keys.begin);
 }
 
-void UpdateSoaTranslations(int _num_soa_tracks,
+// Tests whether soa track _i is selected by _mask. A NULL _mask selects all
+// soa tracks.
+bool IsSampled(const unsigned char* _mask, int _i) {
+  return !_mask || (_mask[_i / 8] & (1 << (_i & 7))) != 0;
+}
+
+// Gets the mask of the animated soa tracks of range [_from,_to[ matching
+// outdated flags byte _j. _mask bits are indexed by output soa track, so they
+// are remapped to animated soa tracks order using _soa_tracks.
+unsigned char RemapMask(const unsigned char* _mask,
+                        const uint16_t* _soa_tracks, int _from, int _to,
+                        int _j) {
+  const int begin = math::Max(_j * 8, _from);
+  const int end = math::Min(_j * 8 + 8, _to);
+  if (!_mask) {
+    return static_cast<unsigned char>(((1 << (end - begin)) - 1)
+                                      << (begin & 7));
+  }
+  unsigned char mask = 0;
+  for (int i = begin; i < end; ++i) {
+    mask |= IsSampled(_mask, _soa_tracks[i]) << (i & 7);
+  }
+  return mask;
+}
+
+#if defined(OZZ_SIMD_AVX)
+// 8-wide AVX helpers. They allow to process 8 key frames at once while
+// decompressing (left and right key frames of a soa track), and 2 soa tracks
+// at once while interpolating.
+
+// Builds a 8-wide vector from 2 4-wide vectors, _lo being the 4 first lanes.
+__m256 Load2(math::_SimdFloat4 _lo, math::_SimdFloat4 _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+// Stores a 8-wide vector to 2 4-wide vectors, _lo receiving the 4 first lanes.
+void Store2(__m256 _v, math::SimdFloat4* _lo, math::SimdFloat4* _hi) {
+  *_lo = _mm256_castps256_ps128(_v);
+  *_hi = _mm256_extractf128_ps(_v, 1);
+}
+
+// Lerps _a and _b vectors with coefficient _f, the same way 4-wide
+// math::Lerp does.
+__m256 Lerp8(__m256 _a, __m256 _b, __m256 _f) {
+  return _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_b, _a), _f), _a);
+}
+#endif  // OZZ_SIMD_AVX
+
+#if defined(OZZ_SIMD_AVX)
+// Decompresses left and right key frames of a translation or scale soa track
+// at once. _keys are ordered as stored in the cache, alternating left and
+// right keys. _range points to the min and step quantization entries of the
+// soa track.
+template <typename _Key, typename _SoaInterp>
+void DecompressSoaFloat3x8(const _Key* const* _keys,
+                           const math::SoaFloat3* _range, _SoaInterp* _soa) {
+  // Left keys in the first 4 lanes, right keys in the last 4 ones.
+  const _Key& k00 = *_keys[0];
+  const _Key& k10 = *_keys[2];
+  const _Key& k20 = *_keys[4];
+  const _Key& k30 = *_keys[6];
+  const _Key& k01 = *_keys[1];
+  const _Key& k11 = *_keys[3];
+  const _Key& k21 = *_keys[5];
+  const _Key& k31 = *_keys[7];
+
+  // Both left and right keys share the same range.
+  const math::SoaFloat3& min = _range[0];
+  const math::SoaFloat3& step = _range[1];
+
+  // ratio[0] and ratio[1] are contiguous.
+  _mm256_storeu_ps(reinterpret_cast<float*>(_soa->ratio),
+                   _mm256_cvtepi32_ps(_mm256_setr_epi32(
+                       k00.ratio, k10.ratio, k20.ratio, k30.ratio, k01.ratio,
+                       k11.ratio, k21.ratio, k31.ratio)));
+  const __m256 x = _mm256_cvtepi32_ps(_mm256_setr_epi32(
+      k00.value[0], k10.value[0], k20.value[0], k30.value[0], k01.value[0],
+      k11.value[0], k21.value[0], k31.value[0]));
+  Store2(_mm256_add_ps(Load2(min.x, min.x),
+                       _mm256_mul_ps(Load2(step.x, step.x), x)),
+         &_soa->value[0].x, &_soa->value[1].x);
+  const __m256 y = _mm256_cvtepi32_ps(_mm256_setr_epi32(
+      k00.value[1], k10.value[1], k20.value[1], k30.value[1], k01.value[1],
+      k11.value[1], k21.value[1], k31.value[1]));
+  Store2(_mm256_add_ps(Load2(min.y, min.y),
+                       _mm256_mul_ps(Load2(step.y, step.y), y)),
+         &_soa->value[0].y, &_soa->value[1].y);
+  const __m256 z = _mm256_cvtepi32_ps(_mm256_setr_epi32(
+      k00.value[2], k10.value[2], k20.value[2], k30.value[2], k01.value[2],
+      k11.value[2], k21.value[2], k31.value[2]));
+  Store2(_mm256_add_ps(Load2(min.z, min.z),
+                       _mm256_mul_ps(Load2(step.z, step.z), z)),
+         &_soa->value[0].z, &_soa->value[1].z);
+}
+#else  // OZZ_SIMD_AVX
+// Decompresses 4 translation or scale key frames, one per track of a soa track,
+// using the min and step quantization entries of the soa track _range.
+template <typename _Key>
+void DecompressSoaFloat3(const _Key& _k0, const _Key& _k1, const _Key& _k2,
+                         const _Key& _k3, const math::SoaFloat3* _range,
+                         math::SimdFloat4* _ratio, math::SoaFloat3* _value) {
+  const math::SoaFloat3& min = _range[0];
+  const math::SoaFloat3& step = _range[1];
+  *_ratio = math::simd_float4::FromInt(
+      math::simd_int4::Load(_k0.ratio, _k1.ratio, _k2.ratio, _k3.ratio));
+  _value->x = math::MAdd(step.x,
+                         math::simd_float4::FromInt(math::simd_int4::Load(
+                             _k0.value[0], _k1.value[0], _k2.value[0],
+                             _k3.value[0])),
+                         min.x);
+  _value->y = math::MAdd(step.y,
+                         math::simd_float4::FromInt(math::simd_int4::Load(
+                             _k0.value[1], _k1.value[1], _k2.value[1],
+                             _k3.value[1])),
+                         min.y);
+  _value->z = math::MAdd(step.z,
+                         math::simd_float4::FromInt(math::simd_int4::Load(
+                             _k0.value[2], _k1.value[2], _k2.value[2],
+                             _k3.value[2])),
+                         min.z);
+}
+#endif  // OZZ_SIMD_AVX
+
+void UpdateSoaTranslations(int _from, int _to,
                            ozz::Range<const TranslationKey> _keys,
-                           const int* _interp, unsigned char* _outdated,
-                           internal::InterpSoaTranslation* soa_translations_) {
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+                           const math::SoaFloat3* _ranges, const int* _interp,
+                           unsigned char* _outdated,
+                           const unsigned char* _mask,
+                           const uint16_t* _soa_tracks,
+                           internal::InterpSoaTranslation* soa_translations_,
+                           SamplingStats* _stats) {
+  const int num_outdated_flags = (_to + 7) / 8;
+  for (int j = _from / 8; j < num_outdated_flags; ++j) {
+    // Masked entries, and entries out of [_from,_to[, are not processed, so
+    // they remain outdated.
+    const unsigned char mask = RemapMask(_mask, _soa_tracks, _from, _to, j);
+    unsigned char outdated = _outdated[j] & mask;
+    _outdated[j] &= ~mask;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
+      OZZ_SAMPLING_STATS_ADD(_stats, num_decompressed_soa, 1);
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
+#if defined(OZZ_SIMD_AVX)
+      const TranslationKey* keys[8] = {
+          &_keys.begin[_interp[base + 0]], &_keys.begin[_interp[base + 1]],
+          &_keys.begin[_interp[base + 2]], &_keys.begin[_interp[base + 3]],
+          &_keys.begin[_interp[base + 4]], &_keys.begin[_interp[base + 5]],
+          &_keys.begin[_interp[base + 6]], &_keys.begin[_interp[base + 7]]};
+      DecompressSoaFloat3x8(keys, &_ranges[i * 2], &soa_translations_[i]);
+#else   // OZZ_SIMD_AVX
       // Decompress left side keyframes and store them in soa structures.
-      const TranslationKey& k00 = _keys.begin[_interp[base + 0]];
-      const TranslationKey& k10 = _keys.begin[_interp[base + 2]];
-      const TranslationKey& k20 = _keys.begin[_interp[base + 4]];
-      const TranslationKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_translations_[i].time[0] =
-          math::simd_float4::Load(k00.time, k10.time, k20.time, k30.time);
-      soa_translations_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      soa_translations_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_translations_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+      DecompressSoaFloat3(
+          _keys.begin[_interp[base + 0]], _keys.begin[_interp[base + 2]],
+          _keys.begin[_interp[base + 4]], _keys.begin[_interp[base + 6]],
+          &_ranges[i * 2], &soa_translations_[i].ratio[0],
+          &soa_translations_[i].value[0]);
 
       // Decompress right side keyframes and store them in soa structures.
-      const TranslationKey& k01 = _keys.begin[_interp[base + 1]];
-      const TranslationKey& k11 = _keys.begin[_interp[base + 3]];
-      const TranslationKey& k21 = _keys.begin[_interp[base + 5]];
-      const TranslationKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_translations_[i].time[1] =
-          math::simd_float4::Load(k01.time, k11.time, k21.time, k31.time);
-      soa_translations_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_translations_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_translations_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+      DecompressSoaFloat3(
+          _keys.begin[_interp[base + 1]], _keys.begin[_interp[base + 3]],
+          _keys.begin[_interp[base + 5]], _keys.begin[_interp[base + 7]],
+          &_ranges[i * 2], &soa_translations_[i].ratio[1],
+          &soa_translations_[i].value[1]);
+#endif  // OZZ_SIMD_AVX
     }
   }
 }
 
+#if defined(OZZ_SIMD_AVX)
+// Decompresses left and right key frames of a rotation soa track at once. This
+// is the 8-wide version of DECOMPRESS_SOA_QUAT. _keys are ordered as stored in
+// the cache, alternating left and right keys.
+void DecompressSoaQuat8(const RotationKey* const* _keys,
+                        const int (*_mapping)[4],
+                        internal::InterpSoaRotation* _soa) {
+  // Left keys in the first 4 lanes, right keys in the last 4 ones.
+  const int kLanes[8] = {0, 2, 4, 6, 1, 3, 5, 7};
+
+  // Prepares an array of input values, according to the mapping required to
+  // restore quaternion largest component. Also prepares ratios, signs and
+  // largest component indices.
+  OZZ_ALIGN(32) int cmp_keys[4][8];
+  OZZ_ALIGN(32) int ratios[8];
+  OZZ_ALIGN(32) float signs[8];
+  OZZ_ALIGN(32) float largests[8];
+  for (int l = 0; l < 8; ++l) {
+    const RotationKey& key = *_keys[kLanes[l]];
+    const int* m = _mapping[key.largest];
+    cmp_keys[0][l] = key.value[m[0]];
+    cmp_keys[1][l] = key.value[m[1]];
+    cmp_keys[2][l] = key.value[m[2]];
+    cmp_keys[3][l] = key.value[m[3]];
+    cmp_keys[key.largest][l] = 0;  // Resets largest component to 0.
+    ratios[l] = key.ratio;
+    signs[l] = key.sign ? -0.f : 0.f;
+    largests[l] = static_cast<float>(key.largest);
+  }
+
+  // ratio[0] and ratio[1] are contiguous.
+  _mm256_storeu_ps(
+      reinterpret_cast<float*>(_soa->ratio),
+      _mm256_cvtepi32_ps(
+          _mm256_load_si256(reinterpret_cast<const __m256i*>(ratios))));
+
+  // Rebuilds quaternion from quantized values.
+  const __m256 kInt2Float = _mm256_set1_ps(1.f / (32767.f * math::kSqrt2));
+  __m256 cpnt[4];
+  for (int c = 0; c < 4; ++c) {
+    cpnt[c] = _mm256_mul_ps(
+        kInt2Float, _mm256_cvtepi32_ps(_mm256_load_si256(
+                        reinterpret_cast<const __m256i*>(cmp_keys[c]))));
+  }
+
+  // Get back length of 4th component. Favors performance over accuracy by
+  // using x * RSqrtEst(x) instead of Sqrt(x).
+  const __m256 dot = _mm256_add_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cpnt[0], cpnt[0]),
+                                  _mm256_mul_ps(cpnt[1], cpnt[1])),
+                    _mm256_mul_ps(cpnt[2], cpnt[2])),
+      _mm256_mul_ps(cpnt[3], cpnt[3]));
+  const __m256 ww0 = _mm256_max_ps(_mm256_set1_ps(1e-16f),
+                                   _mm256_sub_ps(_mm256_set1_ps(1.f), dot));
+  const __m256 w0 = _mm256_mul_ps(ww0, _mm256_rsqrt_ps(ww0));
+  // Re-applies 4th component's sign.
+  const __m256 restored = _mm256_or_ps(w0, _mm256_load_ps(signs));
+
+  // Re-injects the largest component inside the SoA structure.
+  const __m256 largest = _mm256_load_ps(largests);
+  for (int c = 0; c < 4; ++c) {
+    const __m256 mask = _mm256_cmp_ps(
+        largest, _mm256_set1_ps(static_cast<float>(c)), _CMP_EQ_OQ);
+    cpnt[c] = _mm256_or_ps(cpnt[c], _mm256_and_ps(restored, mask));
+  }
+
+  // Stores result.
+  Store2(cpnt[0], &_soa->value[0].x, &_soa->value[1].x);
+  Store2(cpnt[1], &_soa->value[0].y, &_soa->value[1].y);
+  Store2(cpnt[2], &_soa->value[0].z, &_soa->value[1].z);
+  Store2(cpnt[3], &_soa->value[0].w, &_soa->value[1].w);
+}
+#else  // OZZ_SIMD_AVX
 #define DECOMPRESS_SOA_QUAT(_k0, _k1, _k2, _k3, _quat)                         \
   {                                                                            \
     /* Selects proper mapping for each key.*/                                  \
@@ -256,11 +580,15 @@ void UpdateSoaTranslations(int _num_soa_tracks,
     _quat.w = cpnt[3];                                                         \
   \
 }
+#endif  // OZZ_SIMD_AVX
 
-void UpdateSoaRotations(int _num_soa_tracks,
+void UpdateSoaRotations(int _from, int _to,
                         ozz::Range<const RotationKey> _keys, const int* _interp,
-                        unsigned char* _outdated,
-                        internal::InterpSoaRotation* _soa_rotations) {
+                        unsigned char* _outdated, const unsigned char* _mask,
+                        const uint16_t* _soa_tracks,
+                        internal::InterpSoaRotation* _soa_rotations,
+                        SamplingStats* _stats) {
+#if !defined(OZZ_SIMD_AVX)
   // Prepares constants.
   const math::SimdFloat4 one = math::simd_float4::one();
   const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
@@ -270,23 +598,36 @@ void UpdateSoaRotations(int _num_soa_tracks,
   const math::SimdInt4 m0f00 = math::simd_int4::mask_0f00();
   const math::SimdInt4 m00f0 = math::simd_int4::mask_00f0();
   const math::SimdInt4 m000f = math::simd_int4::mask_000f();
+#endif  // OZZ_SIMD_AVX
 
   // Defines a mapping table that defines components assignation in the output
   // quaternion.
   const int kCpntMapping[4][4] = {
       {0, 0, 1, 2}, {0, 0, 1, 2}, {0, 1, 0, 2}, {0, 1, 2, 0}};
 
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+  const int num_outdated_flags = (_to + 7) / 8;
+  for (int j = _from / 8; j < num_outdated_flags; ++j) {
+    // Masked entries, and entries out of [_from,_to[, are not processed, so
+    // they remain outdated.
+    const unsigned char mask = RemapMask(_mask, _soa_tracks, _from, _to, j);
+    unsigned char outdated = _outdated[j] & mask;
+    _outdated[j] &= ~mask;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
+      OZZ_SAMPLING_STATS_ADD(_stats, num_decompressed_soa, 1);
 
       const int base = i * 4 * 2;  // * soa size * 2 keys per track
 
+#if defined(OZZ_SIMD_AVX)
+      const RotationKey* keys[8] = {
+          &_keys.begin[_interp[base + 0]], &_keys.begin[_interp[base + 1]],
+          &_keys.begin[_interp[base + 2]], &_keys.begin[_interp[base + 3]],
+          &_keys.begin[_interp[base + 4]], &_keys.begin[_interp[base + 5]],
+          &_keys.begin[_interp[base + 6]], &_keys.begin[_interp[base + 7]]};
+      DecompressSoaQuat8(keys, kCpntMapping, &_soa_rotations[i]);
+#else   // OZZ_SIMD_AVX
       // Decompress left side keyframes and store them in soa structures.
       {
         const RotationKey& k0 = _keys.begin[_interp[base + 0]];
@@ -294,8 +635,8 @@ void UpdateSoaRotations(int _num_soa_tracks,
         const RotationKey& k2 = _keys.begin[_interp[base + 4]];
         const RotationKey& k3 = _keys.begin[_interp[base + 6]];
 
-        _soa_rotations[i].time[0] =
-            math::simd_float4::Load(k0.time, k1.time, k2.time, k3.time);
+        _soa_rotations[i].ratio[0] = math::simd_float4::FromInt(
+            math::simd_int4::Load(k0.ratio, k1.ratio, k2.ratio, k3.ratio));
         math::SoaQuaternion& quat = _soa_rotations[i].value[0];
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
       }
@@ -307,93 +648,295 @@ void UpdateSoaRotations(int _num_soa_tracks,
         const RotationKey& k2 = _keys.begin[_interp[base + 5]];
         const RotationKey& k3 = _keys.begin[_interp[base + 7]];
 
-        _soa_rotations[i].time[1] =
-            math::simd_float4::Load(k0.time, k1.time, k2.time, k3.time);
+        _soa_rotations[i].ratio[1] = math::simd_float4::FromInt(
+            math::simd_int4::Load(k0.ratio, k1.ratio, k2.ratio, k3.ratio));
         math::SoaQuaternion& quat = _soa_rotations[i].value[1];
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
       }
+#endif  // OZZ_SIMD_AVX
     }
   }
 }
 
+#if !defined(OZZ_SIMD_AVX)
 #undef DECOMPRESS_SOA_QUAT
+#endif  // OZZ_SIMD_AVX
 
-void UpdateSoaScales(int _num_soa_tracks, ozz::Range<const ScaleKey> _keys,
-                     const int* _interp, unsigned char* _outdated,
-                     internal::InterpSoaScale* soa_scales_) {
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+void UpdateSoaScales(int _from, int _to, ozz::Range<const ScaleKey> _keys,
+                     const math::SoaFloat3* _ranges, const int* _interp,
+                     unsigned char* _outdated, const unsigned char* _mask,
+                     const uint16_t* _soa_tracks,
+                     internal::InterpSoaScale* soa_scales_,
+                     SamplingStats* _stats) {
+  const int num_outdated_flags = (_to + 7) / 8;
+  for (int j = _from / 8; j < num_outdated_flags; ++j) {
+    // Masked entries, and entries out of [_from,_to[, are not processed, so
+    // they remain outdated.
+    const unsigned char mask = RemapMask(_mask, _soa_tracks, _from, _to, j);
+    unsigned char outdated = _outdated[j] & mask;
+    _outdated[j] &= ~mask;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
+      OZZ_SAMPLING_STATS_ADD(_stats, num_decompressed_soa, 1);
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
+#if defined(OZZ_SIMD_AVX)
+      const ScaleKey* keys[8] = {
+          &_keys.begin[_interp[base + 0]], &_keys.begin[_interp[base + 1]],
+          &_keys.begin[_interp[base + 2]], &_keys.begin[_interp[base + 3]],
+          &_keys.begin[_interp[base + 4]], &_keys.begin[_interp[base + 5]],
+          &_keys.begin[_interp[base + 6]], &_keys.begin[_interp[base + 7]]};
+      DecompressSoaFloat3x8(keys, &_ranges[i * 2], &soa_scales_[i]);
+#else   // OZZ_SIMD_AVX
       // Decompress left side keyframes and store them in soa structures.
-      const ScaleKey& k00 = _keys.begin[_interp[base + 0]];
-      const ScaleKey& k10 = _keys.begin[_interp[base + 2]];
-      const ScaleKey& k20 = _keys.begin[_interp[base + 4]];
-      const ScaleKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_scales_[i].time[0] =
-          math::simd_float4::Load(k00.time, k10.time, k20.time, k30.time);
-      soa_scales_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      soa_scales_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_scales_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+      DecompressSoaFloat3(
+          _keys.begin[_interp[base + 0]], _keys.begin[_interp[base + 2]],
+          _keys.begin[_interp[base + 4]], _keys.begin[_interp[base + 6]],
+          &_ranges[i * 2], &soa_scales_[i].ratio[0], &soa_scales_[i].value[0]);
 
       // Decompress right side keyframes and store them in soa structures.
-      const ScaleKey& k01 = _keys.begin[_interp[base + 1]];
-      const ScaleKey& k11 = _keys.begin[_interp[base + 3]];
-      const ScaleKey& k21 = _keys.begin[_interp[base + 5]];
-      const ScaleKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_scales_[i].time[1] =
-          math::simd_float4::Load(k01.time, k11.time, k21.time, k31.time);
-      soa_scales_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_scales_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_scales_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+      DecompressSoaFloat3(
+          _keys.begin[_interp[base + 1]], _keys.begin[_interp[base + 3]],
+          _keys.begin[_interp[base + 5]], _keys.begin[_interp[base + 7]],
+          &_ranges[i * 2], &soa_scales_[i].ratio[1], &soa_scales_[i].value[1]);
+#endif  // OZZ_SIMD_AVX
     }
   }
 }
 
-void Interpolates(float _anim_time, int _num_soa_tracks,
-                  const internal::InterpSoaTranslation* _translations,
-                  const internal::InterpSoaRotation* _rotations,
-                  const internal::InterpSoaScale* _scales,
-                  math::SoaTransform* _output) {
-  const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
+// Interpolates translations or scales (selected by _member) of animated soa
+// tracks, and outputs them to their soa track. _output is the output of soa
+// track _first.
+template <typename _Interp>
+void InterpolatesFloat3(float _anim_ratio, int _num_soa_tracks,
+                        const uint16_t* _soa_tracks, const _Interp* _interps,
+                        const unsigned char* _mask, int _first,
+                        math::SoaFloat3 math::SoaTransform::*_member,
+                        math::SoaTransform* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+#if defined(OZZ_SIMD_AVX)
+  const __m256 anim_ratio8 = _mm256_set1_ps(_anim_ratio);
+#endif  // OZZ_SIMD_AVX
   for (int i = 0; i < _num_soa_tracks; ++i) {
-    // Prepares interpolation coefficients.
-    const math::SimdFloat4 interp_t_time =
-        (anim_time - _translations[i].time[0]) *
-        math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
-    const math::SimdFloat4 interp_r_time =
-        (anim_time - _rotations[i].time[0]) *
-        math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
-    const math::SimdFloat4 interp_s_time =
-        (anim_time - _scales[i].time[0]) *
-        math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
-
-    // Processes interpolations.
+    if (!IsSampled(_mask, _soa_tracks[i])) {
+      continue;
+    }
+
+#if defined(OZZ_SIMD_AVX)
+    // Processes 2 soa tracks at once if both are sampled.
+    if (i + 1 < _num_soa_tracks && IsSampled(_mask, _soa_tracks[i + 1])) {
+      const _Interp& i0 = _interps[i];
+      const _Interp& i1 = _interps[i + 1];
+
+      // Prepares interpolation coefficients.
+      const __m256 ratio0 = Load2(i0.ratio[0], i1.ratio[0]);
+      const __m256 interp_time = _mm256_mul_ps(
+          _mm256_sub_ps(anim_ratio8, ratio0),
+          _mm256_rcp_ps(
+              _mm256_sub_ps(Load2(i0.ratio[1], i1.ratio[1]), ratio0)));
+
+      math::SoaFloat3& o0 = _output[_soa_tracks[i] - _first].*_member;
+      math::SoaFloat3& o1 = _output[_soa_tracks[i + 1] - _first].*_member;
+      Store2(Lerp8(Load2(i0.value[0].x, i1.value[0].x),
+                   Load2(i0.value[1].x, i1.value[1].x), interp_time),
+             &o0.x, &o1.x);
+      Store2(Lerp8(Load2(i0.value[0].y, i1.value[0].y),
+                   Load2(i0.value[1].y, i1.value[1].y), interp_time),
+             &o0.y, &o1.y);
+      Store2(Lerp8(Load2(i0.value[0].z, i1.value[0].z),
+                   Load2(i0.value[1].z, i1.value[1].z), interp_time),
+             &o0.z, &o1.z);
+      ++i;
+      continue;
+    }
+#endif  // OZZ_SIMD_AVX
+
+    const _Interp& interp = _interps[i];
+    const math::SimdFloat4 interp_time =
+        (anim_ratio - interp.ratio[0]) *
+        math::RcpEst(interp.ratio[1] - interp.ratio[0]);
+    _output[_soa_tracks[i] - _first].*_member =
+        Lerp(interp.value[0], interp.value[1], interp_time);
+  }
+}
+
+// Interpolates rotations of animated soa tracks, and outputs them to their
+// soa track. _output is the output of soa track _first.
+void InterpolatesRotations(float _anim_ratio, int _num_soa_tracks,
+                           const uint16_t* _soa_tracks,
+                           const internal::InterpSoaRotation* _rotations,
+                           const unsigned char* _mask, int _first,
+                           math::SoaTransform* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+#if defined(OZZ_SIMD_AVX)
+  const __m256 anim_ratio8 = _mm256_set1_ps(_anim_ratio);
+#endif  // OZZ_SIMD_AVX
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (!IsSampled(_mask, _soa_tracks[i])) {
+      continue;
+    }
+
+#if defined(OZZ_SIMD_AVX)
+    // Processes 2 soa tracks at once if both are sampled.
+    if (i + 1 < _num_soa_tracks && IsSampled(_mask, _soa_tracks[i + 1])) {
+      const internal::InterpSoaRotation& r0 = _rotations[i];
+      const internal::InterpSoaRotation& r1 = _rotations[i + 1];
+
+      // Prepares interpolation coefficients.
+      const __m256 ratio0 = Load2(r0.ratio[0], r1.ratio[0]);
+      const __m256 interp_time = _mm256_mul_ps(
+          _mm256_sub_ps(anim_ratio8, ratio0),
+          _mm256_rcp_ps(
+              _mm256_sub_ps(Load2(r0.ratio[1], r1.ratio[1]), ratio0)));
+
+      // Interpolates rotations, see math::NLerpEst.
+      const __m256 rx = Lerp8(Load2(r0.value[0].x, r1.value[0].x),
+                              Load2(r0.value[1].x, r1.value[1].x), interp_time);
+      const __m256 ry = Lerp8(Load2(r0.value[0].y, r1.value[0].y),
+                              Load2(r0.value[1].y, r1.value[1].y), interp_time);
+      const __m256 rz = Lerp8(Load2(r0.value[0].z, r1.value[0].z),
+                              Load2(r0.value[1].z, r1.value[1].z), interp_time);
+      const __m256 rw = Lerp8(Load2(r0.value[0].w, r1.value[0].w),
+                              Load2(r0.value[1].w, r1.value[1].w), interp_time);
+      const __m256 len2 = _mm256_add_ps(
+          _mm256_add_ps(
+              _mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry)),
+              _mm256_mul_ps(rz, rz)),
+          _mm256_mul_ps(rw, rw));
+      // Uses one more Newton-Raphson step, as math::RSqrtEstNR does.
+      const __m256 nr = _mm256_rsqrt_ps(len2);
+      const __m256 muls = _mm256_mul_ps(_mm256_mul_ps(len2, nr), nr);
+      const __m256 inv_len =
+          _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(.5f), nr),
+                        _mm256_sub_ps(_mm256_set1_ps(3.f), muls));
+      math::SoaQuaternion& o0 = _output[_soa_tracks[i] - _first].rotation;
+      math::SoaQuaternion& o1 = _output[_soa_tracks[i + 1] - _first].rotation;
+      Store2(_mm256_mul_ps(rx, inv_len), &o0.x, &o1.x);
+      Store2(_mm256_mul_ps(ry, inv_len), &o0.y, &o1.y);
+      Store2(_mm256_mul_ps(rz, inv_len), &o0.z, &o1.z);
+      Store2(_mm256_mul_ps(rw, inv_len), &o0.w, &o1.w);
+      ++i;
+      continue;
+    }
+#endif  // OZZ_SIMD_AVX
+
     // The lerp of the rotation uses the shortest path, because opposed
     // quaternions were negated during animation build stage (AnimationBuilder).
-    _output[i].translation = Lerp(_translations[i].value[0],
-                                  _translations[i].value[1], interp_t_time);
-    _output[i].rotation =
-        NLerpEst(_rotations[i].value[0], _rotations[i].value[1], interp_r_time);
-    _output[i].scale =
-        Lerp(_scales[i].value[0], _scales[i].value[1], interp_s_time);
+    const internal::InterpSoaRotation& interp = _rotations[i];
+    const math::SimdFloat4 interp_time =
+        (anim_ratio - interp.ratio[0]) *
+        math::RcpEst(interp.ratio[1] - interp.ratio[0]);
+    _output[_soa_tracks[i] - _first].rotation =
+        NLerpEst(interp.value[0], interp.value[1], interp_time);
+  }
+}
+
+// Copies constant soa tracks values (selected by _member) to their output soa
+// track. _soa_tracks are the output indices of constant soa tracks, and
+// _output is the output of soa track _first.
+template <typename _Value>
+void CopyConstants(ozz::Range<const _Value> _constants,
+                   const uint16_t* _soa_tracks, const unsigned char* _mask,
+                   int _first, _Value math::SoaTransform::*_member,
+                   math::SoaTransform* _output) {
+  const int count = static_cast<int>(_constants.Count());
+  for (int i = 0; i < count; ++i) {
+    const int soa_track = _soa_tracks[i];
+    if (IsSampled(_mask, soa_track)) {
+      _output[soa_track - _first].*_member = _constants.begin[i];
+    }
+  }
+}
+
+// Sets _identity to the _count identity soa tracks that are sampled. Identity
+// soa tracks have no stored value, their output indices are _soa_tracks.
+template <typename _Value>
+void CopyIdentities(const _Value& _identity, const uint16_t* _soa_tracks,
+                    int _count, const unsigned char* _mask, int _first,
+                    _Value math::SoaTransform::*_member,
+                    math::SoaTransform* _output) {
+  for (int i = 0; i < _count; ++i) {
+    const int soa_track = _soa_tracks[i];
+    if (IsSampled(_mask, soa_track)) {
+      _output[soa_track - _first].*_member = _identity;
+    }
+  }
+}
+
+// Finds the range [*_from,*_to[ of the _count soa tracks whose output index,
+// stored by _soa_tracks in ascending order, is within [_begin,_end[.
+void FindSoaTracks(const uint16_t* _soa_tracks, int _count, int _begin,
+                   int _end, int* _from, int* _to) {
+  const uint16_t* end = _soa_tracks + _count;
+  const uint16_t* from = std::lower_bound(_soa_tracks, end, _begin);
+  *_from = static_cast<int>(from - _soa_tracks);
+  *_to = static_cast<int>(std::lower_bound(from, end, _end) - _soa_tracks);
+}
+
+// Binary searches the 2 keys to interpolate at _ratio for every track of the
+// _count soa tracks starting at soa track _first. Keys indices are output to
+// _interp, with the same layout as SamplingCache entries.
+template <typename _Key>
+void SearchKeys(float _ratio, int _first, int _count, int _num_soa_tracks,
+                ozz::Range<const _Key> _keys, ozz::Range<const int> _track_keys,
+                int* _interp) {
+  const int* offsets = _track_keys.begin;
+  const int* indices = offsets + _num_soa_tracks * 4 + 1;
+  for (int i = 0; i < _count * 4; ++i) {
+    const int track = _first * 4 + i;
+    const int* track_keys = indices + offsets[track];
+    const int num_keys = offsets[track + 1] - offsets[track];
+    assert(num_keys >= 2 && indices + offsets[track + 1] <= _track_keys.end);
+
+    // Finds the first key whose ratio is greater than _ratio, the first key
+    // being excluded as it's always at ratio 0. The last key is used if
+    // there's none, which happens when sampling the end of the animation.
+    int left = 1, right = num_keys - 1;
+    while (left < right) {
+      const int middle = (left + right) / 2;
+      if (_keys.begin[track_keys[middle]].ratio <= _ratio) {
+        left = middle + 1;
+      } else {
+        right = middle;
+      }
+    }
+    _interp[i * 2 + 0] = track_keys[left - 1];
+    _interp[i * 2 + 1] = track_keys[left];
   }
 }
 }  // namespace
 
-SamplingJob::SamplingJob() : time(0.f), animation(NULL), cache(NULL) {}
+SamplingStats::SamplingStats() { Reset(); }
+
+void SamplingStats::Reset() {
+  num_samples = 0;
+  num_cache_invalidations = 0;
+  num_cache_restarts = 0;
+  num_cache_seeks = 0;
+  num_forward_keys = 0;
+  num_backward_keys = 0;
+  num_decompressed_soa = 0;
+}
+
+void SamplingStats::Accumulate(const SamplingStats& _stats) {
+  num_samples += _stats.num_samples;
+  num_cache_invalidations += _stats.num_cache_invalidations;
+  num_cache_restarts += _stats.num_cache_restarts;
+  num_cache_seeks += _stats.num_cache_seeks;
+  num_forward_keys += _stats.num_forward_keys;
+  num_backward_keys += _stats.num_backward_keys;
+  num_decompressed_soa += _stats.num_decompressed_soa;
+}
+
+SamplingJob::SamplingJob()
+    : time(0.f),
+      animation(NULL),
+      cache(NULL),
+      begin_soa(0),
+      end_soa(std::numeric_limits<int>::max()),
+      stats(NULL) {}
 
 bool SamplingJob::Run() const {
   if (!Validate()) {
@@ -408,35 +951,218 @@ bool SamplingJob::Run() const {
   // Clamps time in range [0,duration].
   const float anim_time = math::Clamp(0.f, time, animation->duration());
 
-  // Step the cache to this potentially new animation and time.
+  // An empty mask samples all soa tracks.
+  const unsigned char* mask = soa_mask.begin != soa_mask.end ? soa_mask.begin
+                                                             : NULL;
+
+  // Samples soa tracks range, clamped to the animation.
+  const int end = math::Min(end_soa, num_soa_tracks);
+  if (begin_soa >= end) {
+    return true;
+  }
+
+  assert(cache->max_soa_tracks() >= num_soa_tracks);
+  cache->Sample(*animation, anim_time, mask, begin_soa, end,
+                output.begin + begin_soa, stats);
+
+  return true;
+}
+
+BatchSamplingJob::BatchSamplingJob()
+    : animation(NULL), cache(NULL), stats(NULL) {}
+
+bool BatchSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation || !cache) {
+    return false;
+  }
+
+  // Times and outputs are optional, but must match.
+  valid &= times.end >= times.begin;
+  valid &= outputs.end >= outputs.begin;
+  valid &= times.end - times.begin == outputs.end - outputs.begin;
+  if (!valid) {
+    return false;
+  }
+
+  // Tests cache size.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= cache->max_soa_tracks() >= num_soa_tracks;
+
+  // Tests mask size, if any.
+  valid &= soa_mask.begin == soa_mask.end ||
+           (soa_mask.begin != NULL &&
+            soa_mask.end - soa_mask.begin >= (num_soa_tracks + 7) / 8);
+
+  // Tests times order, and outputs ranges.
+  const ptrdiff_t count = times.end - times.begin;
+  for (ptrdiff_t i = 0; i < count; ++i) {
+    valid &= i == 0 || times.begin[i - 1] <= times.begin[i];
+    const Range<math::SoaTransform>& output = outputs.begin[i];
+    valid &= output.begin != NULL;
+    valid &= output.end - output.begin >= num_soa_tracks;
+  }
+
+  return valid;
+}
+
+bool BatchSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  // An empty mask samples all soa tracks.
+  const unsigned char* mask = soa_mask.begin != soa_mask.end ? soa_mask.begin
+                                                             : NULL;
+
+  // Times are sorted, so the cache is only stepped forward, from one time to
+  // the next. Every key frame of the sampled span is thus walked once for the
+  // whole batch, and soa values decompressed for a time are reused by the
+  // next ones as long as their keys don't change. All times were validated
+  // at once, so sampling is done directly with the cache.
   assert(cache->max_soa_tracks() >= num_soa_tracks);
-  cache->Step(*animation, anim_time);
-
-  // Fetch key frames from the animation to the cache a t = anim_time.
-  // Then updates outdated soa hot values.
-  UpdateKeys(anim_time, num_soa_tracks, animation->translations(),
-             &cache->translation_cursor_, cache->translation_keys_,
-             cache->outdated_translations_);
-  UpdateSoaTranslations(num_soa_tracks, animation->translations(),
-                        cache->translation_keys_, cache->outdated_translations_,
-                        cache->soa_translations_);
-
-  UpdateKeys(anim_time, num_soa_tracks, animation->rotations(),
-             &cache->rotation_cursor_, cache->rotation_keys_,
-             cache->outdated_rotations_);
-  UpdateSoaRotations(num_soa_tracks, animation->rotations(),
-                     cache->rotation_keys_, cache->outdated_rotations_,
-                     cache->soa_rotations_);
-
-  UpdateKeys(anim_time, num_soa_tracks, animation->scales(),
-             &cache->scale_cursor_, cache->scale_keys_,
-             cache->outdated_scales_);
-  UpdateSoaScales(num_soa_tracks, animation->scales(), cache->scale_keys_,
-                  cache->outdated_scales_, cache->soa_scales_);
-
-  // Interpolates soa hot data.
-  Interpolates(anim_time, num_soa_tracks, cache->soa_translations_,
-               cache->soa_rotations_, cache->soa_scales_, output.begin);
+  const float duration = animation->duration();
+  const ptrdiff_t count = times.end - times.begin;
+  for (ptrdiff_t i = 0; i < count; ++i) {
+    const float anim_time = math::Clamp(0.f, times.begin[i], duration);
+    cache->Sample(*animation, anim_time, mask, 0, num_soa_tracks,
+                  outputs.begin[i].begin, stats);
+  }
+
+  return true;
+}
+
+RandomAccessSamplingJob::RandomAccessSamplingJob()
+    : time(0.f), animation(NULL) {}
+
+bool RandomAccessSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation) {
+    return false;
+  }
+  valid &= output.begin != NULL;
+
+  // Keys are binary searched using per-track key indices.
+  valid &= animation->has_track_keys();
+
+  // Tests output range, implicitly tests output.end != NULL.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= output.end - output.begin >= num_soa_tracks;
+
+  // Tests mask size, if any.
+  valid &= soa_mask.begin == soa_mask.end ||
+           (soa_mask.begin != NULL &&
+            soa_mask.end - soa_mask.begin >= (num_soa_tracks + 7) / 8);
+
+  return valid;
+}
+
+bool RandomAccessSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Clamps time in range [0,duration].
+  const float anim_time = math::Clamp(0.f, time, animation->duration());
+  const float anim_ratio = TimeToRatio(*animation, anim_time);
+
+  // An empty mask samples all soa tracks.
+  const unsigned char* mask = soa_mask.begin != soa_mask.end ? soa_mask.begin
+                                                             : NULL;
+
+  // Animated soa tracks are processed by chunks of 8 (the number of soa tracks
+  // per outdated flags byte), so that SamplingJob decompression and
+  // interpolation functions can be used with stack buffers instead of a
+  // cache.
+  const int kChunkSize = 8;
+  int interp[kChunkSize * 4 * 2];
+  unsigned char outdated;
+
+  const uint16_t* translation_tracks =
+      animation->translation_soa_tracks().begin;
+  const int num_translations = animation->num_translation_soa_tracks();
+  for (int i = 0; i < num_translations; i += kChunkSize) {
+    const int count = math::Min(kChunkSize, num_translations - i);
+    internal::InterpSoaTranslation translations[kChunkSize];
+    SearchKeys(anim_ratio, i, count, num_translations,
+               animation->translations(), animation->translation_track_keys(),
+               interp);
+    outdated = 0xff >> (kChunkSize - count);
+    UpdateSoaTranslations(0, count, animation->translations(),
+                          animation->translation_ranges().begin + i * 2,
+                          interp, &outdated, mask, translation_tracks + i,
+                          translations, NULL);
+    InterpolatesFloat3(anim_ratio, count, translation_tracks + i, translations,
+                       mask, 0, &math::SoaTransform::translation,
+                       output.begin);
+  }
+  CopyConstants(animation->translation_constants(),
+                translation_tracks + num_translations, mask, 0,
+                &math::SoaTransform::translation, output.begin);
+  CopyIdentities(math::SoaFloat3::zero(),
+                 translation_tracks + num_translations +
+                     animation->translation_constants().Count(),
+                 animation->num_translation_identities(), mask, 0,
+                 &math::SoaTransform::translation, output.begin);
+
+  const uint16_t* rotation_tracks = animation->rotation_soa_tracks().begin;
+  const int num_rotations = animation->num_rotation_soa_tracks();
+  for (int i = 0; i < num_rotations; i += kChunkSize) {
+    const int count = math::Min(kChunkSize, num_rotations - i);
+    internal::InterpSoaRotation rotations[kChunkSize];
+    SearchKeys(anim_ratio, i, count, num_rotations, animation->rotations(),
+               animation->rotation_track_keys(), interp);
+    outdated = 0xff >> (kChunkSize - count);
+    UpdateSoaRotations(0, count, animation->rotations(), interp, &outdated,
+                       mask, rotation_tracks + i, rotations, NULL);
+    InterpolatesRotations(anim_ratio, count, rotation_tracks + i, rotations,
+                          mask, 0, output.begin);
+  }
+  CopyConstants(animation->rotation_constants(),
+                rotation_tracks + num_rotations, mask, 0,
+                &math::SoaTransform::rotation, output.begin);
+  CopyIdentities(math::SoaQuaternion::identity(),
+                 rotation_tracks + num_rotations +
+                     animation->rotation_constants().Count(),
+                 animation->num_rotation_identities(), mask, 0,
+                 &math::SoaTransform::rotation, output.begin);
+
+  const uint16_t* scale_tracks = animation->scale_soa_tracks().begin;
+  const int num_scales = animation->num_scale_soa_tracks();
+  for (int i = 0; i < num_scales; i += kChunkSize) {
+    const int count = math::Min(kChunkSize, num_scales - i);
+    internal::InterpSoaScale scales[kChunkSize];
+    SearchKeys(anim_ratio, i, count, num_scales, animation->scales(),
+               animation->scale_track_keys(), interp);
+    outdated = 0xff >> (kChunkSize - count);
+    UpdateSoaScales(0, count, animation->scales(),
+                    animation->scale_ranges().begin + i * 2, interp,
+                    &outdated, mask, scale_tracks + i, scales, NULL);
+    InterpolatesFloat3(anim_ratio, count, scale_tracks + i, scales, mask, 0,
+                       &math::SoaTransform::scale, output.begin);
+  }
+  CopyConstants(animation->scale_constants(), scale_tracks + num_scales, mask,
+                0, &math::SoaTransform::scale, output.begin);
+  CopyIdentities(math::SoaFloat3::one(),
+                 scale_tracks + num_scales +
+                     animation->scale_constants().Count(),
+                 animation->num_scale_identities(), mask, 0,
+                 &math::SoaTransform::scale, output.begin);
 
   return true;
 }
@@ -454,6 +1180,9 @@ SamplingCache::SamplingCache(int _max_tracks)
       translation_cursor_(0),
       rotation_cursor_(0),
       scale_cursor_(0),
+      translation_reverse_cursor_(0),
+      rotation_reverse_cursor_(0),
+      scale_reverse_cursor_(0),
       outdated_translations_(NULL),
       outdated_rotations_(NULL),
       outdated_scales_(NULL) {
@@ -513,17 +1242,197 @@ SamplingCache::~SamplingCache() {
   memory::default_allocator()->Deallocate(soa_translations_);
 }
 
-void SamplingCache::Step(const Animation& _animation, float _time) {
-  // The cache is invalidated if animation has changed or if it is being rewind.
-  if (animation_ != &_animation || _time < time_) {
+void SamplingCache::Step(const Animation& _animation, float _time,
+                         SamplingStats* _stats) {
+  // Selects the cheapest way to reach _time. Key frames can be walked from the
+  // current cache state, forward or backward, or the cache can be restarted
+  // from the closest seek point (or from the beginning if there's none).
+  const float interval = _animation.seek_interval();
+  const int point = FindSeekPoint(_animation, _time);
+  const float restart_time = static_cast<float>(point + 1) * interval;
+  bool restart;
+  if (animation_ != &_animation) {
+    // The cache is invalidated if animation has changed.
     animation_ = &_animation;
-    translation_cursor_ = 0;
-    rotation_cursor_ = 0;
-    scale_cursor_ = 0;
+    restart = true;
+    OZZ_SAMPLING_STATS_ADD(_stats, num_cache_invalidations, 1);
+  } else if (_time < time_) {
+    // Restarts if _time is closer to the restart point than to the current
+    // time, which is typically the case when an animation loops. Restarting is
+    // the only option if the animation has no reverse keys.
+    restart = !_animation.has_reverse_keys() ||
+              _time - restart_time < time_ - _time;
+  } else {
+    // Seeking isn't used while playing forward, as it requires to decompress
+    // all key frames again. It's only used if time is jumping forward farther
+    // than the next seek point.
+    restart = _time - time_ > interval && restart_time > time_;
+  }
+
+  if (restart) {
+    if (point >= 0) {
+      Seek(_animation.translation_seeks(), point,
+           _animation.num_translation_soa_tracks(), &translation_cursor_,
+           &translation_reverse_cursor_, translation_keys_,
+           outdated_translations_);
+      Seek(_animation.rotation_seeks(), point,
+           _animation.num_rotation_soa_tracks(), &rotation_cursor_,
+           &rotation_reverse_cursor_, rotation_keys_, outdated_rotations_);
+      Seek(_animation.scale_seeks(), point, _animation.num_scale_soa_tracks(),
+           &scale_cursor_, &scale_reverse_cursor_, scale_keys_,
+           outdated_scales_);
+      OZZ_SAMPLING_STATS_ADD(_stats, num_cache_seeks, 1);
+    } else {
+      translation_cursor_ = 0;
+      rotation_cursor_ = 0;
+      scale_cursor_ = 0;
+      OZZ_SAMPLING_STATS_ADD(_stats, num_cache_restarts, 1);
+    }
   }
   time_ = _time;
 }
 
+void SamplingCache::Update(const Animation& _animation, float _time,
+                           const unsigned char* _mask, int _begin, int _end,
+                           SamplingStats* _stats) {
+  OZZ_SAMPLING_STATS_ADD(_stats, num_samples, 1);
+
+  // Step the cache to this potentially new animation and time.
+  Step(_animation, _time, _stats);
+
+  // Key frames times are stored as ratios of the duration.
+  const float anim_ratio = TimeToRatio(_animation, _time);
+
+  // Fetch key frames from the animation to the cache a t = _time.
+  // Then updates outdated soa hot values. Only animated soa tracks are
+  // processed. Key frames are fetched for all soa tracks, as they're sorted
+  // by time, but only soa tracks within [_begin,_end[ are decompressed.
+  int from, to;
+  const int num_translations = _animation.num_translation_soa_tracks();
+  UpdateKeys(anim_ratio, num_translations, _animation.translations(),
+             _animation.reverse_translations(), &translation_cursor_,
+             &translation_reverse_cursor_, translation_keys_,
+             outdated_translations_, _stats);
+  FindSoaTracks(_animation.translation_soa_tracks().begin, num_translations,
+                _begin, _end, &from, &to);
+  UpdateSoaTranslations(from, to, _animation.translations(),
+                        _animation.translation_ranges().begin,
+                        translation_keys_, outdated_translations_, _mask,
+                        _animation.translation_soa_tracks().begin,
+                        soa_translations_, _stats);
+
+  const int num_rotations = _animation.num_rotation_soa_tracks();
+  UpdateKeys(anim_ratio, num_rotations, _animation.rotations(),
+             _animation.reverse_rotations(), &rotation_cursor_,
+             &rotation_reverse_cursor_, rotation_keys_, outdated_rotations_,
+             _stats);
+  FindSoaTracks(_animation.rotation_soa_tracks().begin, num_rotations, _begin,
+                _end, &from, &to);
+  UpdateSoaRotations(from, to, _animation.rotations(), rotation_keys_,
+                     outdated_rotations_, _mask,
+                     _animation.rotation_soa_tracks().begin, soa_rotations_,
+                     _stats);
+
+  const int num_scales = _animation.num_scale_soa_tracks();
+  UpdateKeys(anim_ratio, num_scales, _animation.scales(),
+             _animation.reverse_scales(), &scale_cursor_,
+             &scale_reverse_cursor_, scale_keys_, outdated_scales_, _stats);
+  FindSoaTracks(_animation.scale_soa_tracks().begin, num_scales, _begin, _end,
+                &from, &to);
+  UpdateSoaScales(from, to, _animation.scales(),
+                  _animation.scale_ranges().begin, scale_keys_,
+                  outdated_scales_, _mask, _animation.scale_soa_tracks().begin,
+                  soa_scales_, _stats);
+}
+
+void SamplingCache::Interpolate(const Animation& _animation, float _time,
+                                const unsigned char* _mask, int _begin,
+                                int _end, math::SoaTransform* _output) const {
+  const float anim_ratio = TimeToRatio(_animation, _time);
+
+  // Interpolates animated soa tracks within [_begin,_end[, and copies
+  // constant and identity ones.
+  int from, to;
+  const uint16_t* translation_tracks =
+      _animation.translation_soa_tracks().begin;
+  const int num_translations = _animation.num_translation_soa_tracks();
+  FindSoaTracks(translation_tracks, num_translations, _begin, _end, &from,
+                &to);
+  InterpolatesFloat3(anim_ratio, to - from, translation_tracks + from,
+                     soa_translations_ + from, _mask, _begin,
+                     &math::SoaTransform::translation, _output);
+  const ozz::Range<const math::SoaFloat3> translation_constants =
+      _animation.translation_constants();
+  FindSoaTracks(translation_tracks + num_translations,
+                static_cast<int>(translation_constants.Count()), _begin, _end,
+                &from, &to);
+  CopyConstants(ozz::Range<const math::SoaFloat3>(
+                    translation_constants.begin + from,
+                    translation_constants.begin + to),
+                translation_tracks + num_translations + from, _mask, _begin,
+                &math::SoaTransform::translation, _output);
+  const uint16_t* translation_identities =
+      translation_tracks + num_translations + translation_constants.Count();
+  FindSoaTracks(translation_identities,
+                _animation.num_translation_identities(), _begin, _end, &from,
+                &to);
+  CopyIdentities(math::SoaFloat3::zero(), translation_identities + from,
+                 to - from, _mask, _begin, &math::SoaTransform::translation,
+                 _output);
+
+  const uint16_t* rotation_tracks = _animation.rotation_soa_tracks().begin;
+  const int num_rotations = _animation.num_rotation_soa_tracks();
+  FindSoaTracks(rotation_tracks, num_rotations, _begin, _end, &from, &to);
+  InterpolatesRotations(anim_ratio, to - from, rotation_tracks + from,
+                        soa_rotations_ + from, _mask, _begin, _output);
+  const ozz::Range<const math::SoaQuaternion> rotation_constants =
+      _animation.rotation_constants();
+  FindSoaTracks(rotation_tracks + num_rotations,
+                static_cast<int>(rotation_constants.Count()), _begin, _end,
+                &from, &to);
+  CopyConstants(ozz::Range<const math::SoaQuaternion>(
+                    rotation_constants.begin + from,
+                    rotation_constants.begin + to),
+                rotation_tracks + num_rotations + from, _mask, _begin,
+                &math::SoaTransform::rotation, _output);
+  const uint16_t* rotation_identities =
+      rotation_tracks + num_rotations + rotation_constants.Count();
+  FindSoaTracks(rotation_identities, _animation.num_rotation_identities(),
+                _begin, _end, &from, &to);
+  CopyIdentities(math::SoaQuaternion::identity(), rotation_identities + from,
+                 to - from, _mask, _begin, &math::SoaTransform::rotation,
+                 _output);
+
+  const uint16_t* scale_tracks = _animation.scale_soa_tracks().begin;
+  const int num_scales = _animation.num_scale_soa_tracks();
+  FindSoaTracks(scale_tracks, num_scales, _begin, _end, &from, &to);
+  InterpolatesFloat3(anim_ratio, to - from, scale_tracks + from,
+                     soa_scales_ + from, _mask, _begin,
+                     &math::SoaTransform::scale, _output);
+  const ozz::Range<const math::SoaFloat3> scale_constants =
+      _animation.scale_constants();
+  FindSoaTracks(scale_tracks + num_scales,
+                static_cast<int>(scale_constants.Count()), _begin, _end, &from,
+                &to);
+  CopyConstants(ozz::Range<const math::SoaFloat3>(scale_constants.begin + from,
+                                                  scale_constants.begin + to),
+                scale_tracks + num_scales + from, _mask, _begin,
+                &math::SoaTransform::scale, _output);
+  const uint16_t* scale_identities =
+      scale_tracks + num_scales + scale_constants.Count();
+  FindSoaTracks(scale_identities, _animation.num_scale_identities(), _begin,
+                _end, &from, &to);
+  CopyIdentities(math::SoaFloat3::one(), scale_identities + from, to - from,
+                 _mask, _begin, &math::SoaTransform::scale, _output);
+}
+
+void SamplingCache::Sample(const Animation& _animation, float _time,
+                           const unsigned char* _mask, int _begin, int _end,
+                           math::SoaTransform* _output, SamplingStats* _stats) {
+  Update(_animation, _time, _mask, _begin, _end, _stats);
+  Interpolate(_animation, _time, _mask, _begin, _end, _output);
+}
+
 void SamplingCache::Invalidate() {
   animation_ = NULL;
   time_ = 0.f;
@@ -84,10 +84,12 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   OZZ_STATIC_ASSERT(
       OZZ_ALIGN_OF(math::SoaTransform) >= OZZ_ALIGN_OF(char*) &&
       OZZ_ALIGN_OF(char*) >= OZZ_ALIGN_OF(Skeleton::JointProperties) &&
-      OZZ_ALIGN_OF(Skeleton::JointProperties) >= OZZ_ALIGN_OF(char));
+      OZZ_ALIGN_OF(Skeleton::JointProperties) >= OZZ_ALIGN_OF(uint16_t) &&
+      OZZ_ALIGN_OF(uint16_t) >= OZZ_ALIGN_OF(char));
 
   assert(bind_pose_.Size() == 0 && joint_names_.Size() == 0 &&
-         joint_properties_.Size() == 0);
+         joint_properties_.Size() == 0 && level_joints_.Size() == 0 &&
+         levels_.Size() == 0);
 
   // Early out if no joint.
   if (_num_joints == 0) {
@@ -100,8 +102,11 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   const size_t names_size = _num_joints * sizeof(char*);
   const size_t properties_size =
       _num_joints * sizeof(Skeleton::JointProperties);
-  const size_t buffer_size =
-      names_size + _chars_size + properties_size + bind_poses_size;
+  const size_t level_joints_size = _num_joints * sizeof(uint16_t);
+  // There are at most as many levels as joints, plus the last element.
+  const size_t levels_size = (_num_joints + 1) * sizeof(uint16_t);
+  const size_t buffer_size = names_size + _chars_size + properties_size +
+                             level_joints_size + levels_size + bind_poses_size;
 
   // Allocates whole buffer.
   char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
@@ -127,6 +132,18 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   buffer += properties_size;
   joint_properties_.end = reinterpret_cast<Skeleton::JointProperties*>(buffer);
 
+  // Level joints.
+  level_joints_.begin = reinterpret_cast<uint16_t*>(buffer);
+  assert(math::IsAligned(level_joints_.begin, OZZ_ALIGN_OF(uint16_t)));
+  buffer += level_joints_size;
+  level_joints_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  // Levels, whose range end is set by ComputeLevels.
+  levels_.begin = reinterpret_cast<uint16_t*>(buffer);
+  assert(math::IsAligned(levels_.begin, OZZ_ALIGN_OF(uint16_t)));
+  buffer += levels_size;
+  levels_.end = reinterpret_cast<uint16_t*>(buffer);
+
   // Remaning buffer will be used to store joint names.
   return buffer;
 }
@@ -136,6 +153,48 @@ void Skeleton::Deallocate() {
   bind_pose_.Clear();
   joint_names_.Clear();
   joint_properties_.Clear();
+  level_joints_.Clear();
+  levels_.Clear();
+}
+
+void Skeleton::ComputeLevels() {
+  // Early out if no joint, levels buffers aren't allocated.
+  const int num_joints = this->num_joints();
+  if (num_joints == 0) {
+    return;
+  }
+  assert(level_joints_.Count() == static_cast<size_t>(num_joints) &&
+         levels_.Count() >= static_cast<size_t>(num_joints + 1));
+
+  // Computes joints depth. Parents precede their children, so a parent depth
+  // is known before its children's. levels_ is used to count joints per depth,
+  // shifted by one so that it can then be turned into offsets in place.
+  uint16_t depths[kMaxJoints];
+  std::memset(levels_.begin, 0, levels_.Size());
+  int num_levels = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = joint_properties_.begin[i].parent;
+    const int depth = parent == kNoParentIndex ? 0 : depths[parent] + 1;
+    depths[i] = static_cast<uint16_t>(depth);
+    ++levels_.begin[depth + 1];
+    num_levels = math::Max(num_levels, depth + 1);
+  }
+
+  // Converts counts to offsets.
+  for (int l = 0; l < num_levels; ++l) {
+    levels_.begin[l + 1] += levels_.begin[l];
+  }
+  levels_.end = levels_.begin + num_levels + 1;
+
+  // Distributes joints to their level, in increasing index order. Level
+  // offsets are used as insertion cursors, then restored.
+  for (int i = 0; i < num_joints; ++i) {
+    level_joints_.begin[levels_.begin[depths[i]]++] = static_cast<uint16_t>(i);
+  }
+  for (int l = num_levels; l > 0; --l) {
+    levels_.begin[l] = levels_.begin[l - 1];
+  }
+  levels_.begin[0] = 0;
 }
 
 void Skeleton::Save(ozz::io::OArchive& _archive) const {
@@ -202,6 +261,9 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 
   _archive >> ozz::io::MakeArray(joint_properties_);
   _archive >> ozz::io::MakeArray(bind_pose_);
+
+  // Levels aren't serialized, as they are deduced from joint properties.
+  ComputeLevels();
 }
 }  // animation
 }  // ozz
@@ -35,6 +35,9 @@
 #include "ozz/base/log.h"
 #include "ozz/base/maths/math_archive.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/maths/soa_math_archive.h"
 #include "ozz/base/memory/allocator.h"
 
 #include <cassert>
@@ -86,14 +89,20 @@ namespace animation {
 // as the same base made of the key time and it's track. This is required as
 // key frames are not sorted per track, but sorted by time to favor cache
 // coherency.
+// Key time is stored as a 16 bits unsigned integer ratio of the animation
+// duration, 0 matching time 0 and 65535 matching the duration. Key frames of a
+// same track are thus at least duration / 65535 apart.
 // Key frame values are compressed, according on their type. Decompression is
 // efficient because it's done on SoA data and cached during sampling.
 
 // Defines the translation key frame type.
-// Translation values are stored as half precision floats with 16 bits per
-// component.
+// Translation values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see
+// Animation::translation_ranges()). As opposed to half precision floats, the
+// precision doesn't depend on the magnitude of the value, but only on the
+// range covered by the track.
 struct TranslationKey {
-  float time;
+  uint16_t ratio;
   uint16_t track;
   uint16_t value[3];
 };
@@ -114,7 +123,7 @@ struct TranslationKey {
 // key frames, but in this case RotationKey structure would induce 16 bits of
 // padding.
 struct RotationKey {
-  float time;
+  uint16_t ratio;
   uint16_t track : 13;   // The track this key frame belongs to.
   uint16_t largest : 2;  // The largest component of the quaternion.
   uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
@@ -122,13 +131,27 @@ struct RotationKey {
 };
 
 // Defines the scale key frame type.
-// Scale values are stored as half precision floats with 16 bits per
-// component.
+// Scale values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see Animation::scale_ranges()).
 struct ScaleKey {
-  float time;
+  uint16_t ratio;
   uint16_t track;
   uint16_t value[3];
 };
+
+// Defines the key frame type of FixedRateAnimation.
+// A key stores the values of a soa track (4 consecutive tracks) at a given
+// frame, in SoA layout. There's no need to store key time and track, as they
+// are implicitly defined by key position in the frame-major key frames buffer.
+// Translation and scale values are stored as half precision floats with 16 bits
+// per component. Rotation quaternion components are all in range [-1:1], and
+// quantized to signed integer 16 bits values. Unlike RotationKey, the 4
+// components are stored, so decompression is straightforward SoA code.
+struct FixedRateSoaKey {
+  uint16_t translation[3][4];
+  int16_t rotation[4][4];
+  uint16_t scale[3][4];
+};
 }  // animation
 }  // ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -137,29 +160,178 @@ struct ScaleKey {
 namespace ozz {
 namespace animation {
 
-Animation::Animation() : duration_(0.f), num_tracks_(0), name_(NULL) {}
+Animation::Animation()
+    : duration_(0.f),
+      num_tracks_(0),
+      name_(NULL),
+      num_translation_soa_tracks_(0),
+      num_rotation_soa_tracks_(0),
+      num_scale_soa_tracks_(0),
+      num_translation_identities_(0),
+      num_rotation_identities_(0),
+      num_scale_identities_(0),
+      has_reverse_keys_(false),
+      seek_interval_(0.f),
+      has_track_keys_(false) {}
 
 Animation::~Animation() { Deallocate(); }
 
 void Animation::Allocate(size_t name_len, size_t _translation_count,
-                         size_t _rotation_count, size_t _scale_count) {
+                         size_t _rotation_count, size_t _scale_count,
+                         size_t _num_seek_points, bool _reverse_keys,
+                         bool _track_keys) {
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
-  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(TranslationKey) >= OZZ_ALIGN_OF(RotationKey) &&
-                    OZZ_ALIGN_OF(RotationKey) >= OZZ_ALIGN_OF(ScaleKey) &&
-                    OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(char));
-
-  assert(name_ == NULL && translations_.Size() == 0 && rotations_.Size() == 0 &&
-         scales_.Size() == 0);
+  OZZ_STATIC_ASSERT(
+      OZZ_ALIGN_OF(math::SoaQuaternion) >= OZZ_ALIGN_OF(math::SoaFloat3) &&
+      OZZ_ALIGN_OF(math::SoaFloat3) >= OZZ_ALIGN_OF(int) &&
+      OZZ_ALIGN_OF(int) >= OZZ_ALIGN_OF(TranslationKey) &&
+      OZZ_ALIGN_OF(TranslationKey) >= OZZ_ALIGN_OF(RotationKey) &&
+      OZZ_ALIGN_OF(RotationKey) >= OZZ_ALIGN_OF(ScaleKey) &&
+      OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(uint16_t) &&
+      OZZ_ALIGN_OF(uint16_t) >= OZZ_ALIGN_OF(char));
+
+  assert(name_ == NULL && translation_ranges_.Size() == 0 &&
+         scale_ranges_.Size() == 0 && translation_constants_.Size() == 0 &&
+         rotation_constants_.Size() == 0 && scale_constants_.Size() == 0 &&
+         translation_soa_tracks_.Size() == 0 &&
+         rotation_soa_tracks_.Size() == 0 && scale_soa_tracks_.Size() == 0 &&
+         translations_.Size() == 0 && rotations_.Size() == 0 &&
+         scales_.Size() == 0 && reverse_translations_.Size() == 0 &&
+         reverse_rotations_.Size() == 0 && reverse_scales_.Size() == 0 &&
+         translation_seeks_.Size() == 0 && rotation_seeks_.Size() == 0 &&
+         scale_seeks_.Size() == 0 && translation_track_keys_.Size() == 0 &&
+         rotation_track_keys_.Size() == 0 && scale_track_keys_.Size() == 0);
+  assert(num_translation_soa_tracks_ + num_translation_identities_ <=
+             num_soa_tracks() &&
+         num_rotation_soa_tracks_ + num_rotation_identities_ <=
+             num_soa_tracks() &&
+         num_scale_soa_tracks_ + num_scale_identities_ <= num_soa_tracks());
+
+  // Soa tracks that aren't animated are constant, identity ones aren't
+  // stored.
+  const size_t num_soa = num_soa_tracks();
+  const size_t translation_constant_count =
+      num_soa - num_translation_soa_tracks_ - num_translation_identities_;
+  const size_t rotation_constant_count =
+      num_soa - num_rotation_soa_tracks_ - num_rotation_identities_;
+  const size_t scale_constant_count =
+      num_soa - num_scale_soa_tracks_ - num_scale_identities_;
+
+  // All keys but the last of each animated track are referenced by reverse
+  // keys, if any.
+  const size_t max_reverse_keys = kMaxReverseKeys;
+  assert(!_reverse_keys || (_translation_count <= max_reverse_keys &&
+                            _rotation_count <= max_reverse_keys &&
+                            _scale_count <= max_reverse_keys));
+  (void)max_reverse_keys;
+  has_reverse_keys_ = _reverse_keys;
+  const size_t translation_reverse_count =
+      _reverse_keys && _translation_count > 0
+          ? _translation_count - num_translation_soa_tracks_ * 4
+          : 0;
+  const size_t rotation_reverse_count =
+      _reverse_keys && _rotation_count > 0
+          ? _rotation_count - num_rotation_soa_tracks_ * 4
+          : 0;
+  const size_t scale_reverse_count =
+      _reverse_keys && _scale_count > 0
+          ? _scale_count - num_scale_soa_tracks_ * 4
+          : 0;
+
+  // Translations and scales have a min and a step entry per animated soa
+  // track.
+  const size_t translation_range_count = num_translation_soa_tracks_ * 2;
+  const size_t scale_range_count = num_scale_soa_tracks_ * 2;
+
+  // Seek points store 2 cursors, and 2 key indices per animated track.
+  const size_t translation_seek_count =
+      _num_seek_points * (2 + num_translation_soa_tracks_ * 4 * 2);
+  const size_t rotation_seek_count =
+      _num_seek_points * (2 + num_rotation_soa_tracks_ * 4 * 2);
+  const size_t scale_seek_count =
+      _num_seek_points * (2 + num_scale_soa_tracks_ * 4 * 2);
+
+  // Per-track key indices, if any, store an offset per animated track (plus
+  // one), and an index per key.
+  has_track_keys_ = _track_keys;
+  const size_t translation_track_key_count =
+      _track_keys ? num_translation_soa_tracks_ * 4 + 1 + _translation_count
+                  : 0;
+  const size_t rotation_track_key_count =
+      _track_keys ? num_rotation_soa_tracks_ * 4 + 1 + _rotation_count : 0;
+  const size_t scale_track_key_count =
+      _track_keys ? num_scale_soa_tracks_ * 4 + 1 + _scale_count : 0;
 
   // Compute overall size and allocate a single buffer for all the data.
-  const size_t buffer_size = (name_len > 0 ? name_len + 1 : 0) +
-                             _translation_count * sizeof(TranslationKey) +
-                             _rotation_count * sizeof(RotationKey) +
-                             _scale_count * sizeof(ScaleKey);
-  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
+  const size_t buffer_size =
+      (translation_range_count + scale_range_count +
+       translation_constant_count + scale_constant_count) *
+          sizeof(math::SoaFloat3) +
+      rotation_constant_count * sizeof(math::SoaQuaternion) +
+      (name_len > 0 ? name_len + 1 : 0) +
+      _translation_count * sizeof(TranslationKey) +
+      _rotation_count * sizeof(RotationKey) + _scale_count * sizeof(ScaleKey) +
+      (num_soa * 3 + translation_reverse_count + rotation_reverse_count +
+       scale_reverse_count) *
+          sizeof(uint16_t) +
+      (translation_seek_count + rotation_seek_count + scale_seek_count +
+       translation_track_key_count + rotation_track_key_count +
+       scale_track_key_count) *
+          sizeof(int);
+  char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
+      buffer_size, OZZ_ALIGN_OF(math::SoaQuaternion)));
 
   // Fix up pointers
+  rotation_constants_.begin = reinterpret_cast<math::SoaQuaternion*>(buffer);
+  assert(math::IsAligned(rotation_constants_.begin,
+                         OZZ_ALIGN_OF(math::SoaQuaternion)));
+  buffer += rotation_constant_count * sizeof(math::SoaQuaternion);
+  rotation_constants_.end = reinterpret_cast<math::SoaQuaternion*>(buffer);
+
+  translation_ranges_.begin = reinterpret_cast<math::SoaFloat3*>(buffer);
+  assert(math::IsAligned(translation_ranges_.begin,
+                         OZZ_ALIGN_OF(math::SoaFloat3)));
+  buffer += translation_range_count * sizeof(math::SoaFloat3);
+  translation_ranges_.end = reinterpret_cast<math::SoaFloat3*>(buffer);
+
+  scale_ranges_.begin = reinterpret_cast<math::SoaFloat3*>(buffer);
+  buffer += scale_range_count * sizeof(math::SoaFloat3);
+  scale_ranges_.end = reinterpret_cast<math::SoaFloat3*>(buffer);
+
+  translation_constants_.begin = reinterpret_cast<math::SoaFloat3*>(buffer);
+  buffer += translation_constant_count * sizeof(math::SoaFloat3);
+  translation_constants_.end = reinterpret_cast<math::SoaFloat3*>(buffer);
+
+  scale_constants_.begin = reinterpret_cast<math::SoaFloat3*>(buffer);
+  buffer += scale_constant_count * sizeof(math::SoaFloat3);
+  scale_constants_.end = reinterpret_cast<math::SoaFloat3*>(buffer);
+
+  translation_seeks_.begin = reinterpret_cast<int*>(buffer);
+  assert(math::IsAligned(translation_seeks_.begin, OZZ_ALIGN_OF(int)));
+  buffer += translation_seek_count * sizeof(int);
+  translation_seeks_.end = reinterpret_cast<int*>(buffer);
+
+  rotation_seeks_.begin = reinterpret_cast<int*>(buffer);
+  buffer += rotation_seek_count * sizeof(int);
+  rotation_seeks_.end = reinterpret_cast<int*>(buffer);
+
+  scale_seeks_.begin = reinterpret_cast<int*>(buffer);
+  buffer += scale_seek_count * sizeof(int);
+  scale_seeks_.end = reinterpret_cast<int*>(buffer);
+
+  translation_track_keys_.begin = reinterpret_cast<int*>(buffer);
+  buffer += translation_track_key_count * sizeof(int);
+  translation_track_keys_.end = reinterpret_cast<int*>(buffer);
+
+  rotation_track_keys_.begin = reinterpret_cast<int*>(buffer);
+  buffer += rotation_track_key_count * sizeof(int);
+  rotation_track_keys_.end = reinterpret_cast<int*>(buffer);
+
+  scale_track_keys_.begin = reinterpret_cast<int*>(buffer);
+  buffer += scale_track_key_count * sizeof(int);
+  scale_track_keys_.end = reinterpret_cast<int*>(buffer);
+
   translations_.begin = reinterpret_cast<TranslationKey*>(buffer);
   assert(math::IsAligned(translations_.begin, OZZ_ALIGN_OF(TranslationKey)));
   buffer += _translation_count * sizeof(TranslationKey);
@@ -175,6 +347,32 @@ void Animation::Allocate(size_t name_len, size_t _translation_count,
   buffer += _scale_count * sizeof(ScaleKey);
   scales_.end = reinterpret_cast<ScaleKey*>(buffer);
 
+  translation_soa_tracks_.begin = reinterpret_cast<uint16_t*>(buffer);
+  assert(math::IsAligned(translation_soa_tracks_.begin,
+                         OZZ_ALIGN_OF(uint16_t)));
+  buffer += num_soa * sizeof(uint16_t);
+  translation_soa_tracks_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  rotation_soa_tracks_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += num_soa * sizeof(uint16_t);
+  rotation_soa_tracks_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  scale_soa_tracks_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += num_soa * sizeof(uint16_t);
+  scale_soa_tracks_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  reverse_translations_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += translation_reverse_count * sizeof(uint16_t);
+  reverse_translations_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  reverse_rotations_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += rotation_reverse_count * sizeof(uint16_t);
+  reverse_rotations_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  reverse_scales_.begin = reinterpret_cast<uint16_t*>(buffer);
+  buffer += scale_reverse_count * sizeof(uint16_t);
+  reverse_scales_.end = reinterpret_cast<uint16_t*>(buffer);
+
   // Let name be NULL if animation has no name. Allows to avoid allocating this
   // buffer in the constructor of empty animations.
   name_ = reinterpret_cast<char*>(name_len > 0 ? buffer : NULL);
@@ -182,17 +380,45 @@ void Animation::Allocate(size_t name_len, size_t _translation_count,
 }
 
 void Animation::Deallocate() {
-  memory::default_allocator()->Deallocate(translations_.begin);
+  memory::default_allocator()->Deallocate(rotation_constants_.begin);
 
   name_ = NULL;
+  translation_ranges_ = ozz::Range<math::SoaFloat3>();
+  scale_ranges_ = ozz::Range<math::SoaFloat3>();
+  translation_constants_ = ozz::Range<math::SoaFloat3>();
+  rotation_constants_ = ozz::Range<math::SoaQuaternion>();
+  scale_constants_ = ozz::Range<math::SoaFloat3>();
+  translation_soa_tracks_ = ozz::Range<uint16_t>();
+  rotation_soa_tracks_ = ozz::Range<uint16_t>();
+  scale_soa_tracks_ = ozz::Range<uint16_t>();
   translations_ = ozz::Range<TranslationKey>();
   rotations_ = ozz::Range<RotationKey>();
   scales_ = ozz::Range<ScaleKey>();
+  has_reverse_keys_ = false;
+  reverse_translations_ = ozz::Range<uint16_t>();
+  reverse_rotations_ = ozz::Range<uint16_t>();
+  reverse_scales_ = ozz::Range<uint16_t>();
+  translation_seeks_ = ozz::Range<int>();
+  rotation_seeks_ = ozz::Range<int>();
+  scale_seeks_ = ozz::Range<int>();
+  has_track_keys_ = false;
+  translation_track_keys_ = ozz::Range<int>();
+  rotation_track_keys_ = ozz::Range<int>();
+  scale_track_keys_ = ozz::Range<int>();
 }
 
 size_t Animation::size() const {
   const size_t size =
-      sizeof(*this) + translations_.Size() + rotations_.Size() + scales_.Size();
+      sizeof(*this) + translation_ranges_.Size() + scale_ranges_.Size() +
+      translation_constants_.Size() + rotation_constants_.Size() +
+      scale_constants_.Size() + translation_soa_tracks_.Size() +
+      rotation_soa_tracks_.Size() + scale_soa_tracks_.Size() +
+      translations_.Size() + rotations_.Size() +
+      scales_.Size() + reverse_translations_.Size() +
+      reverse_rotations_.Size() + reverse_scales_.Size() +
+      translation_seeks_.Size() + rotation_seeks_.Size() +
+      scale_seeks_.Size() + translation_track_keys_.Size() +
+      rotation_track_keys_.Size() + scale_track_keys_.Size();
   return size;
 }
 
@@ -209,19 +435,40 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
   _archive << static_cast<int32_t>(rotation_count);
   const ptrdiff_t scale_count = scales_.Count();
   _archive << static_cast<int32_t>(scale_count);
+  const int num_seeks = num_seek_points();
+  _archive << static_cast<int32_t>(num_seeks);
+  _archive << has_reverse_keys_;
+  _archive << has_track_keys_;
+  _archive << static_cast<int32_t>(num_translation_soa_tracks_);
+  _archive << static_cast<int32_t>(num_rotation_soa_tracks_);
+  _archive << static_cast<int32_t>(num_scale_soa_tracks_);
+  _archive << static_cast<int32_t>(num_translation_identities_);
+  _archive << static_cast<int32_t>(num_rotation_identities_);
+  _archive << static_cast<int32_t>(num_scale_identities_);
 
   _archive << ozz::io::MakeArray(name_, name_len);
 
+  _archive << ozz::io::MakeArray(translation_soa_tracks_);
+  _archive << ozz::io::MakeArray(rotation_soa_tracks_);
+  _archive << ozz::io::MakeArray(scale_soa_tracks_);
+
+  _archive << ozz::io::MakeArray(translation_constants_);
+  _archive << ozz::io::MakeArray(rotation_constants_);
+  _archive << ozz::io::MakeArray(scale_constants_);
+
+  _archive << ozz::io::MakeArray(translation_ranges_);
+  _archive << ozz::io::MakeArray(scale_ranges_);
+
   for (ptrdiff_t i = 0; i < translation_count; ++i) {
     const TranslationKey& key = translations_.begin[i];
-    _archive << key.time;
+    _archive << key.ratio;
     _archive << key.track;
     _archive << ozz::io::MakeArray(key.value);
   }
 
   for (ptrdiff_t i = 0; i < rotation_count; ++i) {
     const RotationKey& key = rotations_.begin[i];
-    _archive << key.time;
+    _archive << key.ratio;
     uint16_t track = key.track;
     _archive << track;
     uint8_t largest = key.largest;
@@ -233,10 +480,39 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
 
   for (ptrdiff_t i = 0; i < scale_count; ++i) {
     const ScaleKey& key = scales_.begin[i];
-    _archive << key.time;
+    _archive << key.ratio;
     _archive << key.track;
     _archive << ozz::io::MakeArray(key.value);
   }
+
+  _archive << ozz::io::MakeArray(reverse_translations_);
+  _archive << ozz::io::MakeArray(reverse_rotations_);
+  _archive << ozz::io::MakeArray(reverse_scales_);
+
+  _archive << seek_interval_;
+  for (const int* it = translation_seeks_.begin; it < translation_seeks_.end;
+       ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+  for (const int* it = rotation_seeks_.begin; it < rotation_seeks_.end; ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+  for (const int* it = scale_seeks_.begin; it < scale_seeks_.end; ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+
+  for (const int* it = translation_track_keys_.begin;
+       it < translation_track_keys_.end; ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+  for (const int* it = rotation_track_keys_.begin;
+       it < rotation_track_keys_.end; ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
+  for (const int* it = scale_track_keys_.begin; it < scale_track_keys_.end;
+       ++it) {
+    _archive << static_cast<int32_t>(*it);
+  }
 }
 
 void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
@@ -244,9 +520,16 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   Deallocate();
   duration_ = 0.f;
   num_tracks_ = 0;
+  num_translation_soa_tracks_ = 0;
+  num_rotation_soa_tracks_ = 0;
+  num_scale_soa_tracks_ = 0;
+  num_translation_identities_ = 0;
+  num_rotation_identities_ = 0;
+  num_scale_identities_ = 0;
+  seek_interval_ = 0.f;
 
   // No retro-compatibility with anterior versions.
-  if (_version != 4) {
+  if (_version != 5) {
     log::Err() << "Unsupported Animation version " << _version << "."
                << std::endl;
     return;
@@ -266,24 +549,60 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> rotation_count;
   int32_t scale_count;
   _archive >> scale_count;
-
-  Allocate(name_len, translation_count, rotation_count, scale_count);
+  int32_t num_seeks;
+  _archive >> num_seeks;
+  bool reverse_keys;
+  _archive >> reverse_keys;
+  bool track_keys;
+  _archive >> track_keys;
+  int32_t num_translation_soa_tracks;
+  _archive >> num_translation_soa_tracks;
+  num_translation_soa_tracks_ = num_translation_soa_tracks;
+  int32_t num_rotation_soa_tracks;
+  _archive >> num_rotation_soa_tracks;
+  num_rotation_soa_tracks_ = num_rotation_soa_tracks;
+  int32_t num_scale_soa_tracks;
+  _archive >> num_scale_soa_tracks;
+  num_scale_soa_tracks_ = num_scale_soa_tracks;
+  int32_t num_translation_identities;
+  _archive >> num_translation_identities;
+  num_translation_identities_ = num_translation_identities;
+  int32_t num_rotation_identities;
+  _archive >> num_rotation_identities;
+  num_rotation_identities_ = num_rotation_identities;
+  int32_t num_scale_identities;
+  _archive >> num_scale_identities;
+  num_scale_identities_ = num_scale_identities;
+
+  Allocate(name_len, translation_count, rotation_count, scale_count,
+           num_seeks, reverse_keys, track_keys);
 
   if (name_) {  // NULL name_ is supported.
     _archive >> ozz::io::MakeArray(name_, name_len);
     name_[name_len] = 0;
   }
 
+  _archive >> ozz::io::MakeArray(translation_soa_tracks_);
+  _archive >> ozz::io::MakeArray(rotation_soa_tracks_);
+  _archive >> ozz::io::MakeArray(scale_soa_tracks_);
+
+  _archive >> ozz::io::MakeArray(translation_constants_);
+  _archive >> ozz::io::MakeArray(rotation_constants_);
+  _archive >> ozz::io::MakeArray(scale_constants_);
+
+  _archive >> ozz::io::MakeArray(translation_ranges_);
+  _archive >> ozz::io::MakeArray(scale_ranges_);
+
   for (int i = 0; i < translation_count; ++i) {
     TranslationKey& key = translations_.begin[i];
-    _archive >> key.time;
+    _archive >> key.ratio;
     _archive >> key.track;
     _archive >> ozz::io::MakeArray(key.value);
   }
 
   for (int i = 0; i < rotation_count; ++i) {
     RotationKey& key = rotations_.begin[i];
-    _archive >> key.time;
+    _archive >> key.ratio;
     uint16_t track;
     _archive >> track;
     key.track = track;
@@ -298,15 +617,54 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 
   for (int i = 0; i < scale_count; ++i) {
     ScaleKey& key = scales_.begin[i];
-    _archive >> key.time;
+    _archive >> key.ratio;
     _archive >> key.track;
     _archive >> ozz::io::MakeArray(key.value);
   }
+
+  _archive >> ozz::io::MakeArray(reverse_translations_);
+  _archive >> ozz::io::MakeArray(reverse_rotations_);
+  _archive >> ozz::io::MakeArray(reverse_scales_);
+
+  _archive >> seek_interval_;
+  for (int* it = translation_seeks_.begin; it < translation_seeks_.end; ++it) {
+    int32_t seek;
+    _archive >> seek;
+    *it = seek;
+  }
+  for (int* it = rotation_seeks_.begin; it < rotation_seeks_.end; ++it) {
+    int32_t seek;
+    _archive >> seek;
+    *it = seek;
+  }
+  for (int* it = scale_seeks_.begin; it < scale_seeks_.end; ++it) {
+    int32_t seek;
+    _archive >> seek;
+    *it = seek;
+  }
+
+  for (int* it = translation_track_keys_.begin;
+       it < translation_track_keys_.end; ++it) {
+    int32_t key;
+    _archive >> key;
+    *it = key;
+  }
+  for (int* it = rotation_track_keys_.begin; it < rotation_track_keys_.end;
+       ++it) {
+    int32_t key;
+    _archive >> key;
+    *it = key;
+  }
+  for (int* it = scale_track_keys_.begin; it < scale_track_keys_.end; ++it) {
+    int32_t key;
+    _archive >> key;
+    *it = key;
+  }
 }
 }  // animation
 }  // ozz
 
-// Including blending_job.cc file.
+// Including fixed_rate_animation.cc file.
 
 //----------------------------------------------------------------------------//
 //                                                                            //
@@ -335,154 +693,764 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 //                                                                            //
 //----------------------------------------------------------------------------//
 
-#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/fixed_rate_animation.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
 
 #include <cassert>
-#include <cstddef>
+#include <cstring>
 
-#include "ozz/animation/runtime/skeleton.h"
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
 
-#include "ozz/base/maths/math_ex.h"
-#include "ozz/base/maths/soa_transform.h"
+// Includes internal include file animation/runtime/animation_keyframe.h
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
+#define OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
 
 namespace ozz {
 namespace animation {
 
-BlendingJob::Layer::Layer() : weight(0.f) {}
-
-BlendingJob::BlendingJob() : threshold(.1f) {}
+// Define animation key frame types (translation, rotation, scale). Every type
+// as the same base made of the key time and it's track. This is required as
+// key frames are not sorted per track, but sorted by time to favor cache
+// coherency.
+// Key time is stored as a 16 bits unsigned integer ratio of the animation
+// duration, 0 matching time 0 and 65535 matching the duration. Key frames of a
+// same track are thus at least duration / 65535 apart.
+// Key frame values are compressed, according on their type. Decompression is
+// efficient because it's done on SoA data and cached during sampling.
 
-namespace {
-bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
-  bool valid = true;
+// Defines the translation key frame type.
+// Translation values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see
+// Animation::translation_ranges()). As opposed to half precision floats, the
+// precision doesn't depend on the magnitude of the value, but only on the
+// range covered by the track.
+struct TranslationKey {
+  uint16_t ratio;
+  uint16_t track;
+  uint16_t value[3];
+};
 
-  // Tests transforms validity.
-  valid &= _layer.transform.begin != NULL;
-  valid &= _layer.transform.end >= _layer.transform.begin;
-  valid &= _layer.transform.end - _layer.transform.begin >= _min_range;
+// Defines the rotation key frame type.
+// Rotation value is a quaternion. Quaternion are normalized, which means each
+// component is in range [0:1]. This property allows to quantize the 3
+// components to 3 signed integer 16 bits values. The 4th component is restored
+// at runtime, using the knowledge that |w| = sqrt(1 - (a^2 + b^2 + c^2)).
+// The sign of this 4th component is stored using 1 bit taken from the track
+// member.
+//
+// In more details, compression algorithm stores the 3 smallest components of
+// the quaternion and restores the largest. The 3 smallest can be pre-multiplied
+// by sqrt(2) to gain some precision indeed.
+//
+// Quantization could be reduced to 11-11-10 bits as often used for animation
+// key frames, but in this case RotationKey structure would induce 16 bits of
+// padding.
+struct RotationKey {
+  uint16_t ratio;
+  uint16_t track : 13;   // The track this key frame belongs to.
+  uint16_t largest : 2;  // The largest component of the quaternion.
+  uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
+  int16_t value[3];      // The quantized value of the 3 smallest components.
+};
 
-  // Joint weights are optional.
-  if (_layer.joint_weights.begin != NULL) {
-    valid &= _layer.joint_weights.end >= _layer.joint_weights.begin;
-    valid &=
-        _layer.joint_weights.end - _layer.joint_weights.begin >= _min_range;
-  } else {
-    valid &= _layer.joint_weights.end == NULL;
-  }
-  return valid;
-}
-}  // namespace
+// Defines the scale key frame type.
+// Scale values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see Animation::scale_ranges()).
+struct ScaleKey {
+  uint16_t ratio;
+  uint16_t track;
+  uint16_t value[3];
+};
 
-bool BlendingJob::Validate() const {
-  // Don't need any early out, as jobs are valid in most of the performance
-  // critical cases.
-  // Tests are written in multiple lines in order to avoid branches.
-  bool valid = true;
+// Defines the key frame type of FixedRateAnimation.
+// A key stores the values of a soa track (4 consecutive tracks) at a given
+// frame, in SoA layout. There's no need to store key time and track, as they
+// are implicitly defined by key position in the frame-major key frames buffer.
+// Translation and scale values are stored as half precision floats with 16 bits
+// per component. Rotation quaternion components are all in range [-1:1], and
+// quantized to signed integer 16 bits values. Unlike RotationKey, the 4
+// components are stored, so decompression is straightforward SoA code.
+struct FixedRateSoaKey {
+  uint16_t translation[3][4];
+  int16_t rotation[4][4];
+  uint16_t scale[3][4];
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
 
-  // Test for valid threshold).
-  valid &= threshold > 0.f;
 
-  // Test for NULL begin pointers.
-  // Blending layers are mandatory, additive aren't.
-  valid &= bind_pose.begin != NULL;
-  valid &= output.begin != NULL;
+namespace ozz {
+namespace animation {
 
-  // Test ranges are valid (implicitly test for NULL end pointers).
-  valid &= bind_pose.end >= bind_pose.begin;
-  valid &= output.end >= output.begin;
+FixedRateAnimation::FixedRateAnimation()
+    : duration_(0.f), num_tracks_(0), num_frames_(0), name_(NULL) {}
 
-  // The bind pose size defines the ranges of transforms to blend, so all
-  // other buffers should be bigger.
-  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
-  valid &= output.end - output.begin >= min_range;
+FixedRateAnimation::~FixedRateAnimation() { Deallocate(); }
 
-  // Blend layers are optional.
-  if (layers.begin != NULL) {
-    valid &= layers.end >= layers.begin;
-  } else {
-    valid &= layers.end == NULL;
-  }
+void FixedRateAnimation::Allocate(size_t _name_len, size_t _key_count) {
+  // Distributes buffer memory while ensuring proper alignment (serves larger
+  // alignment values first).
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(FixedRateSoaKey) >= OZZ_ALIGN_OF(char));
 
-  // Validates layers.
-  for (const Layer* layer = layers.begin; layers.begin && layer < layers.end;
-       ++layer) {
-    valid &= ValidateLayer(*layer, min_range);
-  }
+  assert(name_ == NULL && keys_.Size() == 0);
 
-  // Additive layers are optional.
-  if (additive_layers.begin != NULL) {
-    valid &= additive_layers.end >= additive_layers.begin;
-  } else {
-    valid &= additive_layers.end == NULL;
-  }
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size = (_name_len > 0 ? _name_len + 1 : 0) +
+                             _key_count * sizeof(FixedRateSoaKey);
+  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
 
-  // Validates additive layers.
-  for (const Layer* layer = additive_layers.begin;
-       additive_layers.begin &&
-       layer < additive_layers.end;  // Handles NULL pointers.
-       ++layer) {
-    valid &= ValidateLayer(*layer, min_range);
-  }
+  // Fix up pointers
+  keys_.begin = reinterpret_cast<FixedRateSoaKey*>(buffer);
+  assert(math::IsAligned(keys_.begin, OZZ_ALIGN_OF(FixedRateSoaKey)));
+  buffer += _key_count * sizeof(FixedRateSoaKey);
+  keys_.end = reinterpret_cast<FixedRateSoaKey*>(buffer);
 
-  return valid;
+  // Let name be NULL if animation has no name. Allows to avoid allocating this
+  // buffer in the constructor of empty animations.
+  name_ = reinterpret_cast<char*>(_name_len > 0 ? buffer : NULL);
 }
 
-namespace {
+void FixedRateAnimation::Deallocate() {
+  memory::default_allocator()->Deallocate(keys_.begin);
 
-// Macro that defines the process of blending the 1st pass.
-#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out)     \
-  {                                                     \
-    _out->translation = _in.translation * _simd_weight; \
-    _out->rotation = _in.rotation * _simd_weight;       \
-    _out->scale = _in.scale * _simd_weight;             \
-  \
+  name_ = NULL;
+  keys_ = ozz::Range<FixedRateSoaKey>();
 }
 
-// Macro that defines the process of blending any pass but the first.
-#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out)                           \
-  {                                                                         \
-    /* Blends translation. */                                               \
-    _out->translation = _out->translation + _in.translation * _simd_weight; \
-    /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
-    /* the shortest path between the two.*/                                 \
-    const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x +        \
-                                 _out->rotation.y * _in.rotation.y +        \
-                                 _out->rotation.z * _in.rotation.z +        \
-                                 _out->rotation.w * _in.rotation.w;         \
-    const math::SimdInt4 sign = math::Sign(dot);                            \
-    const math::SoaQuaternion rotation = {                                  \
-        math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),   \
-        math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};  \
-    _out->rotation = _out->rotation + rotation * _simd_weight;              \
-    /* Blends scales.*/                                                     \
-    _out->scale = _out->scale + _in.scale * _simd_weight;                   \
-  \
+size_t FixedRateAnimation::size() const {
+  const size_t size = sizeof(*this) + keys_.Size();
+  return size;
 }
 
-// Macro that defines the process of adding a pass.
-#define OZZ_ADD_PASS(_in, _simd_weight, _out)                                \
-  {                                                                          \
-    _out.translation = _out.translation + _in.translation * _simd_weight;    \
-    /* Interpolate quaternion between identity and src.rotation.*/           \
-    /* Quaternion sign is fixed up, so that lerp takes the shortest path.*/  \
-    const math::SimdInt4 sign = math::Sign(_in.rotation.w);                  \
-    const math::SoaQuaternion rotation = {                                   \
-        math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),    \
-        math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};   \
-    const math::SoaQuaternion interp_quat = {                                \
-        rotation.x * _simd_weight, rotation.y * _simd_weight,                \
-        rotation.z * _simd_weight, (rotation.w - one) * _simd_weight + one}; \
-    _out.rotation = NormalizeEst(interp_quat) * _out.rotation;               \
-    _out.scale =                                                             \
-        _out.scale * (one_minus_weight_f3 + (_in.scale * _simd_weight));     \
-  \
-}
+void FixedRateAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << static_cast<int32_t>(num_frames_);
 
-// Macro that defines the process of subtracting a pass.
-#define OZZ_SUB_PASS(_in, _simd_weight, _out)                                \
-  {                                                                          \
-    _out.translation = _out.translation - _in.translation * _simd_weight;    \
-    /* Interpolate quaternion between identity and src.rotation.*/           \
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+
+  const ptrdiff_t key_count = keys_.Count();
+  _archive << static_cast<int32_t>(key_count);
+
+  _archive << ozz::io::MakeArray(name_, name_len);
+
+  for (ptrdiff_t i = 0; i < key_count; ++i) {
+    const FixedRateSoaKey& key = keys_.begin[i];
+    for (int c = 0; c < 3; ++c) {
+      _archive << ozz::io::MakeArray(key.translation[c]);
+    }
+    for (int c = 0; c < 4; ++c) {
+      _archive << ozz::io::MakeArray(key.rotation[c]);
+    }
+    for (int c = 0; c < 3; ++c) {
+      _archive << ozz::io::MakeArray(key.scale[c]);
+    }
+  }
+}
+
+void FixedRateAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+  num_tracks_ = 0;
+  num_frames_ = 0;
+
+  if (_version != 1) {
+    log::Err() << "Unsupported FixedRateAnimation version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  _archive >> duration_;
+
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  num_tracks_ = num_tracks;
+
+  int32_t num_frames;
+  _archive >> num_frames;
+  num_frames_ = num_frames;
+
+  int32_t name_len;
+  _archive >> name_len;
+  int32_t key_count;
+  _archive >> key_count;
+
+  Allocate(name_len, key_count);
+
+  if (name_) {  // NULL name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+
+  for (int i = 0; i < key_count; ++i) {
+    FixedRateSoaKey& key = keys_.begin[i];
+    for (int c = 0; c < 3; ++c) {
+      _archive >> ozz::io::MakeArray(key.translation[c]);
+    }
+    for (int c = 0; c < 4; ++c) {
+      _archive >> ozz::io::MakeArray(key.rotation[c]);
+    }
+    for (int c = 0; c < 3; ++c) {
+      _archive >> ozz::io::MakeArray(key.scale[c]);
+    }
+  }
+}
+}  // animation
+}  // ozz
+
+// Including fixed_rate_sampling_job.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/fixed_rate_sampling_job.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/fixed_rate_animation.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+
+// Includes internal include file animation/runtime/animation_keyframe.h
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
+#define OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+namespace ozz {
+namespace animation {
+
+// Define animation key frame types (translation, rotation, scale). Every type
+// as the same base made of the key time and it's track. This is required as
+// key frames are not sorted per track, but sorted by time to favor cache
+// coherency.
+// Key time is stored as a 16 bits unsigned integer ratio of the animation
+// duration, 0 matching time 0 and 65535 matching the duration. Key frames of a
+// same track are thus at least duration / 65535 apart.
+// Key frame values are compressed, according on their type. Decompression is
+// efficient because it's done on SoA data and cached during sampling.
+
+// Defines the translation key frame type.
+// Translation values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see
+// Animation::translation_ranges()). As opposed to half precision floats, the
+// precision doesn't depend on the magnitude of the value, but only on the
+// range covered by the track.
+struct TranslationKey {
+  uint16_t ratio;
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Defines the rotation key frame type.
+// Rotation value is a quaternion. Quaternion are normalized, which means each
+// component is in range [0:1]. This property allows to quantize the 3
+// components to 3 signed integer 16 bits values. The 4th component is restored
+// at runtime, using the knowledge that |w| = sqrt(1 - (a^2 + b^2 + c^2)).
+// The sign of this 4th component is stored using 1 bit taken from the track
+// member.
+//
+// In more details, compression algorithm stores the 3 smallest components of
+// the quaternion and restores the largest. The 3 smallest can be pre-multiplied
+// by sqrt(2) to gain some precision indeed.
+//
+// Quantization could be reduced to 11-11-10 bits as often used for animation
+// key frames, but in this case RotationKey structure would induce 16 bits of
+// padding.
+struct RotationKey {
+  uint16_t ratio;
+  uint16_t track : 13;   // The track this key frame belongs to.
+  uint16_t largest : 2;  // The largest component of the quaternion.
+  uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
+  int16_t value[3];      // The quantized value of the 3 smallest components.
+};
+
+// Defines the scale key frame type.
+// Scale values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see Animation::scale_ranges()).
+struct ScaleKey {
+  uint16_t ratio;
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Defines the key frame type of FixedRateAnimation.
+// A key stores the values of a soa track (4 consecutive tracks) at a given
+// frame, in SoA layout. There's no need to store key time and track, as they
+// are implicitly defined by key position in the frame-major key frames buffer.
+// Translation and scale values are stored as half precision floats with 16 bits
+// per component. Rotation quaternion components are all in range [-1:1], and
+// quantized to signed integer 16 bits values. Unlike RotationKey, the 4
+// components are stored, so decompression is straightforward SoA code.
+struct FixedRateSoaKey {
+  uint16_t translation[3][4];
+  int16_t rotation[4][4];
+  uint16_t scale[3][4];
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
+
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Decompresses 4 half precision floats.
+math::SimdFloat4 DecompressHalves(const uint16_t* _h) {
+  return math::HalfToFloat(math::simd_int4::Load(_h[0], _h[1], _h[2], _h[3]));
+}
+
+// Decompresses 4 quantized quaternion components.
+math::SimdFloat4 DecompressQuantized(const int16_t* _q,
+                                     math::_SimdFloat4 _int2float) {
+  return _int2float * math::simd_float4::FromInt(
+                          math::simd_int4::Load(_q[0], _q[1], _q[2], _q[3]));
+}
+}  // namespace
+
+FixedRateSamplingJob::FixedRateSamplingJob() : time(0.f), animation(NULL) {}
+
+bool FixedRateSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation) {
+    return false;
+  }
+  valid &= output.begin != NULL;
+
+  // Tests output range, implicitly tests output.end != NULL.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= output.end - output.begin >= num_soa_tracks;
+
+  return valid;
+}
+
+bool FixedRateSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  const int num_frames = animation->num_frames();
+  if (num_soa_tracks == 0 || num_frames < 2) {  // Early out if no key frame.
+    return true;
+  }
+
+  // Finds the 2 frames to interpolate, directly from time.
+  const float duration = animation->duration();
+  const float anim_time = math::Clamp(0.f, time, duration);
+  const float frame = anim_time * (num_frames - 1) / duration;
+  const int frame0 = math::Min(static_cast<int>(frame), num_frames - 2);
+  const math::SimdFloat4 ratio =
+      math::simd_float4::Load1(frame - static_cast<float>(frame0));
+
+  const FixedRateSoaKey* keys0 =
+      animation->keys().begin + frame0 * num_soa_tracks;
+  const FixedRateSoaKey* keys1 = keys0 + num_soa_tracks;
+  assert(keys1 + num_soa_tracks <= animation->keys().end);
+
+  const math::SimdFloat4 int2float =
+      math::simd_float4::Load1(1.f / 32767.f);
+
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    const FixedRateSoaKey& k0 = keys0[i];
+    const FixedRateSoaKey& k1 = keys1[i];
+    math::SoaTransform& out = output.begin[i];
+
+    // Decompresses and interpolates translations.
+    const math::SoaFloat3 t0 = {DecompressHalves(k0.translation[0]),
+                                DecompressHalves(k0.translation[1]),
+                                DecompressHalves(k0.translation[2])};
+    const math::SoaFloat3 t1 = {DecompressHalves(k1.translation[0]),
+                                DecompressHalves(k1.translation[1]),
+                                DecompressHalves(k1.translation[2])};
+    out.translation = Lerp(t0, t1, ratio);
+
+    // Decompresses and interpolates rotations.
+    // The lerp of the rotation uses the shortest path, because opposed
+    // quaternions were negated during animation build stage.
+    const math::SoaQuaternion r0 = {
+        DecompressQuantized(k0.rotation[0], int2float),
+        DecompressQuantized(k0.rotation[1], int2float),
+        DecompressQuantized(k0.rotation[2], int2float),
+        DecompressQuantized(k0.rotation[3], int2float)};
+    const math::SoaQuaternion r1 = {
+        DecompressQuantized(k1.rotation[0], int2float),
+        DecompressQuantized(k1.rotation[1], int2float),
+        DecompressQuantized(k1.rotation[2], int2float),
+        DecompressQuantized(k1.rotation[3], int2float)};
+    out.rotation = NLerpEst(r0, r1, ratio);
+
+    // Decompresses and interpolates scales.
+    const math::SoaFloat3 s0 = {DecompressHalves(k0.scale[0]),
+                                DecompressHalves(k0.scale[1]),
+                                DecompressHalves(k0.scale[2])};
+    const math::SoaFloat3 s1 = {DecompressHalves(k1.scale[0]),
+                                DecompressHalves(k1.scale[1]),
+                                DecompressHalves(k1.scale[2])};
+    out.scale = Lerp(s0, s1, ratio);
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
+
+// Including blending_job.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/blending_job.h"
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+
+// Includes internal include file animation/runtime/blending_passes.h
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
+#define OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Defines the blending passes shared by BlendingJob and SampleBlendingJob.
+// _in is a math::SoaTransform, _simd_weight a math::SimdFloat4 weight and _out
+// a pointer to the math::SoaTransform being accumulated.
+
+// Macro that defines the process of blending the 1st pass.
+#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out)     \
+  {                                                     \
+    _out->translation = _in.translation * _simd_weight; \
+    _out->rotation = _in.rotation * _simd_weight;       \
+    _out->scale = _in.scale * _simd_weight;             \
+  \
+}
+
+// Macro that defines the process of blending any pass but the first.
+#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out)                           \
+  {                                                                         \
+    /* Blends translation. */                                               \
+    _out->translation = _out->translation + _in.translation * _simd_weight; \
+    /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
+    /* the shortest path between the two.*/                                 \
+    const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x +        \
+                                 _out->rotation.y * _in.rotation.y +        \
+                                 _out->rotation.z * _in.rotation.z +        \
+                                 _out->rotation.w * _in.rotation.w;         \
+    const math::SimdInt4 sign = math::Sign(dot);                            \
+    const math::SoaQuaternion rotation = {                                  \
+        math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),   \
+        math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};  \
+    _out->rotation = _out->rotation + rotation * _simd_weight;              \
+    /* Blends scales.*/                                                     \
+    _out->scale = _out->scale + _in.scale * _simd_weight;                   \
+  \
+}
+
+#endif  // OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
+
+
+namespace ozz {
+namespace animation {
+
+BlendingJob::Layer::Layer() : weight(0.f) {}
+
+BlendingJob::BlendingJob()
+    : threshold(.1f), begin_soa(0), end_soa(std::numeric_limits<int>::max()) {}
+
+namespace {
+bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
+  bool valid = true;
+
+  // Tests transforms validity.
+  valid &= _layer.transform.begin != NULL;
+  valid &= _layer.transform.end >= _layer.transform.begin;
+  valid &= _layer.transform.end - _layer.transform.begin >= _min_range;
+
+  // Joint weights are optional.
+  if (_layer.joint_weights.begin != NULL) {
+    valid &= _layer.joint_weights.end >= _layer.joint_weights.begin;
+    valid &=
+        _layer.joint_weights.end - _layer.joint_weights.begin >= _min_range;
+  } else {
+    valid &= _layer.joint_weights.end == NULL;
+  }
+
+  // Soa joint ranges are optional. They must be sorted, and within the range
+  // of transforms to blend.
+  if (_layer.soa_ranges.begin != NULL) {
+    valid &= _layer.soa_ranges.end >= _layer.soa_ranges.begin;
+    int previous_end = 0;
+    for (const BlendingJob::SoaJointRange* range = _layer.soa_ranges.begin;
+         range < _layer.soa_ranges.end; ++range) {
+      valid &= range->begin >= previous_end;
+      valid &= range->end >= range->begin;
+      previous_end = range->end;
+    }
+    valid &= previous_end <= _min_range;
+  } else {
+    valid &= _layer.soa_ranges.end == NULL;
+  }
+  return valid;
+}
+}  // namespace
+
+bool BlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
+
+  // Test for NULL begin pointers.
+  // Blending layers are mandatory, additive aren't.
+  valid &= bind_pose.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= bind_pose.end >= bind_pose.begin;
+  valid &= output.end >= output.begin;
+
+  // The bind pose size defines the ranges of transforms to blend, so all
+  // other buffers should be bigger.
+  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
+  valid &= output.end - output.begin >= min_range;
+
+  // Tests soa joints range.
+  valid &= begin_soa >= 0 && end_soa >= begin_soa;
+
+  // Scratch buffer is optional.
+  if (scratch.begin != NULL) {
+    valid &= scratch.end >= scratch.begin;
+    valid &= scratch.end - scratch.begin >= min_range;
+  } else {
+    valid &= scratch.end == NULL;
+  }
+
+  // Blend layers are optional.
+  if (layers.begin != NULL) {
+    valid &= layers.end >= layers.begin;
+  } else {
+    valid &= layers.end == NULL;
+  }
+
+  // Validates layers.
+  for (const Layer* layer = layers.begin; layers.begin && layer < layers.end;
+       ++layer) {
+    valid &= ValidateLayer(*layer, min_range);
+  }
+
+  // Additive layers are optional.
+  if (additive_layers.begin != NULL) {
+    valid &= additive_layers.end >= additive_layers.begin;
+  } else {
+    valid &= additive_layers.end == NULL;
+  }
+
+  // Validates additive layers.
+  for (const Layer* layer = additive_layers.begin;
+       additive_layers.begin &&
+       layer < additive_layers.end;  // Handles NULL pointers.
+       ++layer) {
+    valid &= ValidateLayer(*layer, min_range);
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Macro that defines the process of adding a pass.
+#define OZZ_ADD_PASS(_in, _simd_weight, _out)                                \
+  {                                                                          \
+    _out.translation = _out.translation + _in.translation * _simd_weight;    \
+    /* Interpolate quaternion between identity and src.rotation.*/           \
+    /* Quaternion sign is fixed up, so that lerp takes the shortest path.*/  \
+    const math::SimdInt4 sign = math::Sign(_in.rotation.w);                  \
+    const math::SoaQuaternion rotation = {                                   \
+        math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),    \
+        math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};   \
+    const math::SoaQuaternion interp_quat = {                                \
+        rotation.x * _simd_weight, rotation.y * _simd_weight,                \
+        rotation.z * _simd_weight, (rotation.w - one) * _simd_weight + one}; \
+    _out.rotation = NormalizeEst(interp_quat) * _out.rotation;               \
+    _out.scale =                                                             \
+        _out.scale * (one_minus_weight_f3 + (_in.scale * _simd_weight));     \
+  \
+}
+
+// Macro that defines the process of subtracting a pass.
+#define OZZ_SUB_PASS(_in, _simd_weight, _out)                                \
+  {                                                                          \
+    _out.translation = _out.translation - _in.translation * _simd_weight;    \
+    /* Interpolate quaternion between identity and src.rotation.*/           \
     /* Quaternion sign is fixed up, so that lerp takes the shortest path.*/  \
     const math::SimdInt4 sign = math::Sign(_in.rotation.w);                  \
     const math::SoaQuaternion rotation = {                                   \
@@ -500,307 +1468,1197 @@ namespace {
   \
 }
 
-// Defines parameters that are passed through blending stages.
-struct ProcessArgs {
-  ProcessArgs(const BlendingJob& _job)
-      : job(_job),
-        num_soa_joints(_job.bind_pose.end - _job.bind_pose.begin),
-        num_passes(0),
-        num_partial_passes(0),
-        accumulated_weight(0.f) {
-    // The range of all buffers has already been validated.
-    assert(job.output.end >= job.output.begin + num_soa_joints);
-    assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
+// Defines the number of soa joints processed at once when the job doesn't
+// provide a scratch buffer.
+const int kBlendingChunkSize = 32;
+
+// Defines parameters that are passed through blending stages, to blend soa
+// joints [_begin,_end[.
+struct ProcessArgs {
+  ProcessArgs(const BlendingJob& _job, int _begin, int _end,
+              math::SimdFloat4* _accumulated_weights)
+      : accumulated_weights(_accumulated_weights),
+        job(_job),
+        begin(_begin),
+        end(_end),
+        num_passes(0),
+        num_partial_passes(0),
+        accumulated_weight(0.f) {
+    // The range of all buffers has already been validated.
+    assert(job.output.end >= job.output.begin + end);
+    assert(job.bind_pose.end >= job.bind_pose.begin + end);
+  }
+
+  // Accumulated weights per soa joint, starting at soa joint begin. They are
+  // initialized by the first pass processed, if any.
+  math::SimdFloat4* accumulated_weights;
+
+  // The job to process.
+  const BlendingJob& job;
+
+  // The range [begin,end[ of soa joints to process.
+  int begin;
+  int end;
+
+  // Number of processed blended passes (excluding passes with a weight <= 0.f),
+  // including partial passes.
+  int num_passes;
+
+  // Number of processed partial blending passes (aka with a weight per-joint).
+  int num_partial_passes;
+
+  // The accumulated weight of all layers.
+  float accumulated_weight;
+
+ private:
+  // Disables assignment operators.
+  ProcessArgs(const ProcessArgs&);
+  void operator=(const ProcessArgs&);
+};
+
+// Gets the ranges of soa joints affected by _layer. It's the whole _all range
+// if _layer doesn't specify any.
+Range<const BlendingJob::SoaJointRange> GetSoaRanges(
+    const BlendingJob::Layer& _layer, const BlendingJob::SoaJointRange& _all) {
+  if (_layer.soa_ranges.begin) {
+    return _layer.soa_ranges;
+  }
+  return Range<const BlendingJob::SoaJointRange>(_all);
+}
+
+// Clips _range to the soa joints processed by _args.
+BlendingJob::SoaJointRange ClipRange(const ProcessArgs& _args,
+                                     const BlendingJob::SoaJointRange& _range) {
+  const BlendingJob::SoaJointRange clipped = {
+      math::Max(_range.begin, _args.begin), math::Min(_range.end, _args.end)};
+  return clipped;
+}
+
+// Clears output and accumulated weights of soa joints [_begin,_end[, as the
+// first pass does for soa joints with a weight of 0.
+void ClearSoaJoints(ProcessArgs* _args, int _begin, int _end) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SoaTransform cleared = {math::SoaFloat3::zero(),
+                                      {zero, zero, zero, zero},
+                                      math::SoaFloat3::zero()};
+  for (int i = _begin; i < _end; ++i) {
+    _args->accumulated_weights[i - _args->begin] = zero;
+    _args->job.output.begin[i] = cleared;
+  }
+}
+
+// Blends soa joints _range of a partial _layer to the output.
+void BlendPartialRange(ProcessArgs* _args, const BlendingJob::Layer& _layer,
+                       math::SimdFloat4 _layer_weight,
+                       const BlendingJob::SoaJointRange& _range) {
+  if (_layer.joint_weights.begin) {
+    // Weights are defined per joint.
+    if (_args->num_passes == 0) {
+      for (int i = _range.begin; i < _range.end; ++i) {
+        const math::SoaTransform& src = _layer.transform.begin[i];
+        math::SoaTransform* dest = _args->job.output.begin + i;
+        const math::SimdFloat4 weight =
+            _layer_weight * math::Max0(_layer.joint_weights.begin[i]);
+        _args->accumulated_weights[i - _args->begin] = weight;
+        OZZ_BLEND_1ST_PASS(src, weight, dest);
+      }
+    } else {
+      for (int i = _range.begin; i < _range.end; ++i) {
+        const math::SoaTransform& src = _layer.transform.begin[i];
+        math::SoaTransform* dest = _args->job.output.begin + i;
+        const math::SimdFloat4 weight =
+            _layer_weight * math::Max0(_layer.joint_weights.begin[i]);
+        math::SimdFloat4& accumulated_weight =
+            _args->accumulated_weights[i - _args->begin];
+        accumulated_weight = accumulated_weight + weight;
+        OZZ_BLEND_N_PASS(src, weight, dest);
+      }
+    }
+  } else {
+    // All joints of the range have the layer weight.
+    if (_args->num_passes == 0) {
+      for (int i = _range.begin; i < _range.end; ++i) {
+        const math::SoaTransform& src = _layer.transform.begin[i];
+        math::SoaTransform* dest = _args->job.output.begin + i;
+        _args->accumulated_weights[i - _args->begin] = _layer_weight;
+        OZZ_BLEND_1ST_PASS(src, _layer_weight, dest);
+      }
+    } else {
+      for (int i = _range.begin; i < _range.end; ++i) {
+        const math::SoaTransform& src = _layer.transform.begin[i];
+        math::SoaTransform* dest = _args->job.output.begin + i;
+        math::SimdFloat4& accumulated_weight =
+            _args->accumulated_weights[i - _args->begin];
+        accumulated_weight = accumulated_weight + _layer_weight;
+        OZZ_BLEND_N_PASS(src, _layer_weight, dest);
+      }
+    }
+  }
+}
+
+// Blends all layers of the job to its output.
+void BlendLayers(ProcessArgs* _args) {
+  assert(_args);
+
+  const BlendingJob::SoaJointRange all = {_args->begin, _args->end};
+
+  // Iterates through all layers and blend them to the output.
+  for (const BlendingJob::Layer* layer = _args->job.layers.begin;
+       layer < _args->job.layers.end; ++layer) {
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer->transform.end >= layer->transform.begin + _args->end);
+    assert(!layer->joint_weights.begin ||
+           (layer->joint_weights.end >=
+            layer->joint_weights.begin + _args->end));
+
+    // Skip irrelevant layers.
+    if (layer->weight <= 0.f) {
+      continue;
+    }
+
+    // Accumulates global weights.
+    _args->accumulated_weight += layer->weight;
+    const math::SimdFloat4 layer_weight =
+        math::simd_float4::Load1(layer->weight);
+
+    if (layer->joint_weights.begin || layer->soa_ranges.begin) {
+      // This layer has per-joint weights, or only affects some soa joints.
+      ++_args->num_partial_passes;
+
+      // Only soa joints within layer ranges are processed. Others have a
+      // weight of 0, so they only need to be cleared by the first pass.
+      const Range<const BlendingJob::SoaJointRange> ranges =
+          GetSoaRanges(*layer, all);
+      int cleared = _args->begin;
+      for (const BlendingJob::SoaJointRange* range = ranges.begin;
+           range < ranges.end; ++range) {
+        const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+        if (clipped.begin >= clipped.end) {
+          continue;
+        }
+        if (_args->num_passes == 0) {
+          ClearSoaJoints(_args, cleared, clipped.begin);
+          cleared = clipped.end;
+        }
+        BlendPartialRange(_args, *layer, layer_weight, clipped);
+      }
+      if (_args->num_passes == 0) {
+        ClearSoaJoints(_args, cleared, _args->end);
+      }
+    } else {
+      // This is a full layer.
+      if (_args->num_passes == 0) {
+        for (int i = _args->begin; i < _args->end; ++i) {
+          const math::SoaTransform& src = layer->transform.begin[i];
+          math::SoaTransform* dest = _args->job.output.begin + i;
+          _args->accumulated_weights[i - _args->begin] = layer_weight;
+          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
+        }
+      } else {
+        for (int i = _args->begin; i < _args->end; ++i) {
+          const math::SoaTransform& src = layer->transform.begin[i];
+          math::SoaTransform* dest = _args->job.output.begin + i;
+          math::SimdFloat4& accumulated_weight =
+              _args->accumulated_weights[i - _args->begin];
+          accumulated_weight = accumulated_weight + layer_weight;
+          OZZ_BLEND_N_PASS(src, layer_weight, dest);
+        }
+      }
+    }
+    // One more pass blended.
+    ++_args->num_passes;
+  }
+}
+
+// Blends bind pose to the output if accumulated weight is less than the
+// threshold value.
+void BlendBindPose(ProcessArgs* _args) {
+  assert(_args);
+
+  // Asserts buffer sizes, which must never fail as it has been validated.
+  assert(_args->job.bind_pose.end >= _args->job.bind_pose.begin + _args->end);
+
+  if (_args->num_partial_passes == 0) {
+    // No partial blending pass detected, threshold can be tested globally.
+    const float bp_weight = _args->job.threshold - _args->accumulated_weight;
+
+    if (bp_weight > 0.f) {  // The bind-pose is needed if it has a weight.
+      if (_args->num_passes == 0) {
+        // Strictly copying bind-pose.
+        _args->accumulated_weight = 1.f;
+        for (int i = _args->begin; i < _args->end; ++i) {
+          _args->job.output.begin[i] = _args->job.bind_pose.begin[i];
+        }
+      } else {
+        // Updates global accumulated weight, but not per-joint weight any more
+        // because normalization stage will be global also.
+        _args->accumulated_weight = _args->job.threshold;
+
+        const math::SimdFloat4 simd_bp_weight =
+            math::simd_float4::Load1(bp_weight);
+
+        for (int i = _args->begin; i < _args->end; ++i) {
+          const math::SoaTransform& src = _args->job.bind_pose.begin[i];
+          math::SoaTransform* dest = _args->job.output.begin + i;
+          OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
+        }
+      }
+    }
+  } else {
+    // Blending passes contain partial blending, threshold must be tested for
+    // each joint.
+    const math::SimdFloat4 threshold =
+        math::simd_float4::Load1(_args->job.threshold);
+
+    // There's been at least 1 pass as num_partial_passes != 0.
+    assert(_args->num_passes != 0);
+
+    for (int i = _args->begin; i < _args->end; ++i) {
+      const math::SoaTransform& src = _args->job.bind_pose.begin[i];
+      math::SoaTransform* dest = _args->job.output.begin + i;
+      math::SimdFloat4& accumulated_weight =
+          _args->accumulated_weights[i - _args->begin];
+      const math::SimdFloat4 bp_weight =
+          math::Max0(threshold - accumulated_weight);
+      accumulated_weight = math::Max(threshold, accumulated_weight);
+      OZZ_BLEND_N_PASS(src, bp_weight, dest);
+    }
+  }
+}
+
+// Normalizes output rotations. Quaternion length cannot be zero as opposed
+// quaternions have been fixed up during blending passes.
+// Translations and scales are already normalized because weights were
+// pre-multiplied by the normalization ratio.
+void Normalize(ProcessArgs* _args) {
+  assert(_args);
+
+  if (_args->num_partial_passes == 0) {
+    // Normalization of a non-partial blending requires to apply the same
+    // division to all joints.
+    const math::SimdFloat4 ratio =
+        math::simd_float4::Load1(1.f / _args->accumulated_weight);
+    for (int i = _args->begin; i < _args->end; ++i) {
+      math::SoaTransform& dest = _args->job.output.begin[i];
+      dest.rotation = NormalizeEst(dest.rotation);
+      dest.translation = dest.translation * ratio;
+      dest.scale = dest.scale * ratio;
+    }
+  } else {
+    // Partial blending normalization requires to compute the divider per-joint.
+    const math::SimdFloat4 one = math::simd_float4::one();
+    for (int i = _args->begin; i < _args->end; ++i) {
+      const math::SimdFloat4 ratio =
+          one / _args->accumulated_weights[i - _args->begin];
+      math::SoaTransform& dest = _args->job.output.begin[i];
+      dest.rotation = NormalizeEst(dest.rotation);
+      dest.translation = dest.translation * ratio;
+      dest.scale = dest.scale * ratio;
+    }
+  }
+}
+
+// Process additive blending pass.
+void AddLayers(ProcessArgs* _args) {
+  assert(_args);
+
+  const BlendingJob::SoaJointRange all = {_args->begin, _args->end};
+
+  // Iterates through all layers and blend them to the output.
+  for (const BlendingJob::Layer* layer = _args->job.additive_layers.begin;
+       layer < _args->job.additive_layers.end; ++layer) {
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer->transform.end >= layer->transform.begin + _args->end);
+    assert(!layer->joint_weights.begin ||
+           (layer->joint_weights.end >=
+            layer->joint_weights.begin + _args->end));
+
+    // Prepares constants.
+    const math::SimdFloat4 one = math::simd_float4::one();
+
+    // Only soa joints within layer ranges are processed, others have a weight
+    // of 0.
+    const Range<const BlendingJob::SoaJointRange> ranges =
+        GetSoaRanges(*layer, all);
+
+    if (layer->weight > 0.f) {
+      // Weight is positive, need to perform additive blending.
+      const math::SimdFloat4 layer_weight =
+          math::simd_float4::Load1(layer->weight);
+
+      if (layer->joint_weights.begin) {
+        // This layer has per-joint weights.
+        for (const BlendingJob::SoaJointRange* range = ranges.begin;
+             range < ranges.end; ++range) {
+          const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+          for (int i = clipped.begin; i < clipped.end; ++i) {
+            const math::SoaTransform& src = layer->transform.begin[i];
+            math::SoaTransform& dest = _args->job.output.begin[i];
+            const math::SimdFloat4 weight =
+                layer_weight * math::Max0(layer->joint_weights.begin[i]);
+            const math::SimdFloat4 one_minus_weight = one - weight;
+            const math::SoaFloat3 one_minus_weight_f3 = {
+                one_minus_weight, one_minus_weight, one_minus_weight};
+            OZZ_ADD_PASS(src, weight, dest);
+          }
+        }
+      } else {
+        // This is a full layer.
+        const math::SimdFloat4 one_minus_weight = one - layer_weight;
+        const math::SoaFloat3 one_minus_weight_f3 = {
+            one_minus_weight, one_minus_weight, one_minus_weight};
+
+        for (const BlendingJob::SoaJointRange* range = ranges.begin;
+             range < ranges.end; ++range) {
+          const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+          for (int i = clipped.begin; i < clipped.end; ++i) {
+            const math::SoaTransform& src = layer->transform.begin[i];
+            math::SoaTransform& dest = _args->job.output.begin[i];
+            OZZ_ADD_PASS(src, layer_weight, dest);
+          }
+        }
+      }
+    } else if (layer->weight < 0.f) {
+      // Weight is negative, need to perform subtractive blending.
+      const math::SimdFloat4 layer_weight =
+          math::simd_float4::Load1(-layer->weight);
+
+      if (layer->joint_weights.begin) {
+        // This layer has per-joint weights.
+        for (const BlendingJob::SoaJointRange* range = ranges.begin;
+             range < ranges.end; ++range) {
+          const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+          for (int i = clipped.begin; i < clipped.end; ++i) {
+            const math::SoaTransform& src = layer->transform.begin[i];
+            math::SoaTransform& dest = _args->job.output.begin[i];
+            const math::SimdFloat4 weight =
+                layer_weight * math::Max0(layer->joint_weights.begin[i]);
+            const math::SimdFloat4 one_minus_weight = one - weight;
+            OZZ_SUB_PASS(src, weight, dest);
+          }
+        }
+      } else {
+        // This is a full layer.
+        const math::SimdFloat4 one_minus_weight = one - layer_weight;
+        for (const BlendingJob::SoaJointRange* range = ranges.begin;
+             range < ranges.end; ++range) {
+          const BlendingJob::SoaJointRange clipped = ClipRange(*_args, *range);
+          for (int i = clipped.begin; i < clipped.end; ++i) {
+            const math::SoaTransform& src = layer->transform.begin[i];
+            math::SoaTransform& dest = _args->job.output.begin[i];
+            OZZ_SUB_PASS(src, layer_weight, dest);
+          }
+        }
+      }
+    } else {
+      // Skip layer as its weight is 0.
+    }
+  }
+}
+
+// Blends soa joints [_begin,_end[ of _job, using _accumulated_weights buffer
+// to accumulate their weights.
+void ProcessSoaJoints(const BlendingJob& _job, int _begin, int _end,
+                      math::SimdFloat4* _accumulated_weights) {
+  // Initializes blended parameters that are exchanged across blend stages.
+  ProcessArgs process_args(_job, _begin, _end, _accumulated_weights);
+
+  // Blends all layers to the job output buffers.
+  BlendLayers(&process_args);
+
+  // Applies bind pose.
+  BlendBindPose(&process_args);
+
+  // Normalizes output.
+  Normalize(&process_args);
+
+  // Process additive blending.
+  AddLayers(&process_args);
+}
+}  // namespace
+
+bool BlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Blends soa joints range, clamped to the bind pose. Global weights only
+  // depend on layers weights, so any sub-range is blended the same way it is
+  // when blending all soa joints at once.
+  const int num_soa_joints = static_cast<int>(bind_pose.end - bind_pose.begin);
+  const int end_soa_joint = math::Min(end_soa, num_soa_joints);
+  if (begin_soa >= end_soa_joint) {
+    return true;
+  }
+
+  if (scratch.begin) {
+    // All soa joints are blended at once, accumulating weights to the scratch
+    // buffer.
+    ProcessSoaJoints(*this, begin_soa, end_soa_joint,
+                     scratch.begin + begin_soa);
+  } else {
+    // Soa joints are blended by chunks, accumulating weights to a small stack
+    // buffer.
+    math::SimdFloat4 accumulated_weights[kBlendingChunkSize];
+    for (int begin = begin_soa; begin < end_soa_joint;
+         begin += kBlendingChunkSize) {
+      const int end = math::Min(begin + kBlendingChunkSize, end_soa_joint);
+      ProcessSoaJoints(*this, begin, end, accumulated_weights);
+    }
+  }
+
+  return true;
+}
+
+Range<BlendingJob::SoaJointRange> ComputeSoaJointRanges(
+    Range<const math::SimdFloat4> _joint_weights,
+    Range<BlendingJob::SoaJointRange> _ranges) {
+  // Worst case is one range every other soa joint.
+  const int num_soa_joints = static_cast<int>(_joint_weights.Count());
+  if (_ranges.Count() < static_cast<size_t>((num_soa_joints + 1) / 2)) {
+    return Range<BlendingJob::SoaJointRange>();
+  }
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  BlendingJob::SoaJointRange* range = _ranges.begin;
+  for (int i = 0; i < num_soa_joints;) {
+    // Skips soa joints whose 4 weights are less or equal to 0.
+    if (math::AreAllFalse(math::CmpGt(_joint_weights.begin[i], zero))) {
+      ++i;
+      continue;
+    }
+    // Extends the range while any weight is greater than 0.
+    range->begin = i;
+    do {
+      ++i;
+    } while (i < num_soa_joints &&
+             !math::AreAllFalse(math::CmpGt(_joint_weights.begin[i], zero)));
+    range->end = i;
+    ++range;
+  }
+  return Range<BlendingJob::SoaJointRange>(_ranges.begin, range);
+}
+
+namespace {
+// Iterates the sorted identity soa tracks of an animation, for a single
+// transformation type.
+class IdentityIterator {
+ public:
+  IdentityIterator(Range<const uint16_t> _soa_tracks, int _num_animated,
+                   size_t _num_constants, int _num_identities)
+      : it_(_soa_tracks.begin + _num_animated + _num_constants),
+        end_(it_ + _num_identities) {}
+
+  // Tests if soa track _soa_track is identity. Must be called with ascending
+  // soa track indices.
+  bool IsIdentity(int _soa_track) {
+    while (it_ < end_ && *it_ < _soa_track) {
+      ++it_;
+    }
+    return it_ < end_ && *it_ == _soa_track;
+  }
+
+ private:
+  const uint16_t* it_;
+  const uint16_t* end_;
+};
+}  // namespace
+
+Range<BlendingJob::SoaJointRange> ComputeSoaJointRanges(
+    const Animation& _animation, Range<BlendingJob::SoaJointRange> _ranges) {
+  // Worst case is one range every other soa joint.
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  if (_ranges.Count() < static_cast<size_t>((num_soa_tracks + 1) / 2)) {
+    return Range<BlendingJob::SoaJointRange>();
+  }
+
+  IdentityIterator translations(_animation.translation_soa_tracks(),
+                                _animation.num_translation_soa_tracks(),
+                                _animation.translation_constants().Count(),
+                                _animation.num_translation_identities());
+  IdentityIterator rotations(_animation.rotation_soa_tracks(),
+                             _animation.num_rotation_soa_tracks(),
+                             _animation.rotation_constants().Count(),
+                             _animation.num_rotation_identities());
+  IdentityIterator scales(_animation.scale_soa_tracks(),
+                          _animation.num_scale_soa_tracks(),
+                          _animation.scale_constants().Count(),
+                          _animation.num_scale_identities());
+
+  BlendingJob::SoaJointRange* range = _ranges.begin;
+  bool in_range = false;
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    const bool identity = translations.IsIdentity(i) &&
+                          rotations.IsIdentity(i) && scales.IsIdentity(i);
+    if (!identity && !in_range) {
+      range->begin = i;
+      in_range = true;
+    } else if (identity && in_range) {
+      range->end = i;
+      ++range;
+      in_range = false;
+    }
+  }
+  if (in_range) {
+    range->end = num_soa_tracks;
+    ++range;
+  }
+  return Range<BlendingJob::SoaJointRange>(_ranges.begin, range);
+}
+}  // animation
+}  // ozz
+
+// Including sample_blending_job.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/sample_blending_job.h"
+
+#include <cassert>
+#include <cstddef>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+
+// Includes internal include file animation/runtime/blending_passes.h
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
+#define OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Defines the blending passes shared by BlendingJob and SampleBlendingJob.
+// _in is a math::SoaTransform, _simd_weight a math::SimdFloat4 weight and _out
+// a pointer to the math::SoaTransform being accumulated.
+
+// Macro that defines the process of blending the 1st pass.
+#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out)     \
+  {                                                     \
+    _out->translation = _in.translation * _simd_weight; \
+    _out->rotation = _in.rotation * _simd_weight;       \
+    _out->scale = _in.scale * _simd_weight;             \
+  \
+}
+
+// Macro that defines the process of blending any pass but the first.
+#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out)                           \
+  {                                                                         \
+    /* Blends translation. */                                               \
+    _out->translation = _out->translation + _in.translation * _simd_weight; \
+    /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
+    /* the shortest path between the two.*/                                 \
+    const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x +        \
+                                 _out->rotation.y * _in.rotation.y +        \
+                                 _out->rotation.z * _in.rotation.z +        \
+                                 _out->rotation.w * _in.rotation.w;         \
+    const math::SimdInt4 sign = math::Sign(dot);                            \
+    const math::SoaQuaternion rotation = {                                  \
+        math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),   \
+        math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};  \
+    _out->rotation = _out->rotation + rotation * _simd_weight;              \
+    /* Blends scales.*/                                                     \
+    _out->scale = _out->scale + _in.scale * _simd_weight;                   \
+  \
+}
+
+#endif  // OZZ_ANIMATION_RUNTIME_BLENDING_PASSES_H_
+
+
+namespace ozz {
+namespace animation {
+
+SampleBlendingJob::Layer::Layer()
+    : weight(0.f), time(0.f), animation(NULL), cache(NULL) {}
+
+SampleBlendingJob::SampleBlendingJob() : threshold(.1f) {}
+
+namespace {
+bool ValidateSampleLayer(const SampleBlendingJob::Layer& _layer,
+                         ptrdiff_t _min_range) {
+  // Test for NULL pointers.
+  if (!_layer.animation || !_layer.cache) {
+    return false;
   }
 
-  // Allocates enough space to store a accumulated weights per-joint.
-  // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (16 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
-  // Note that this array is used with SoA data.
-  // This is the first argument in order to avoid wasting too much space with
-  // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+  bool valid = true;
 
-  // The job to process.
-  const BlendingJob& job;
+  // Tests animation and cache sizes.
+  const ptrdiff_t num_soa_tracks = _layer.animation->num_soa_tracks();
+  valid &= num_soa_tracks >= _min_range;
+  valid &= _layer.cache->max_soa_tracks() >= num_soa_tracks;
 
-  // The number of transforms to process as defined by the size of the bind
-  // pose.
-  size_t num_soa_joints;
+  // Joint weights are optional.
+  if (_layer.joint_weights.begin != NULL) {
+    valid &= _layer.joint_weights.end >= _layer.joint_weights.begin;
+    valid &=
+        _layer.joint_weights.end - _layer.joint_weights.begin >= _min_range;
+  } else {
+    valid &= _layer.joint_weights.end == NULL;
+  }
+  return valid;
+}
+}  // namespace
 
-  // Number of processed blended passes (excluding passes with a weight <= 0.f),
-  // including partial passes.
-  int num_passes;
+bool SampleBlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
 
-  // Number of processed partial blending passes (aka with a weight per-joint).
-  int num_partial_passes;
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
 
-  // The accumulated weight of all layers.
-  float accumulated_weight;
+  // Test for NULL begin pointers.
+  valid &= bind_pose.begin != NULL;
+  valid &= output.begin != NULL;
 
- private:
-  // Disables assignment operators.
-  ProcessArgs(const ProcessArgs&);
-  void operator=(const ProcessArgs&);
-};
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= bind_pose.end >= bind_pose.begin;
+  valid &= output.end >= output.begin;
 
-// Blends all layers of the job to its output.
-void BlendLayers(ProcessArgs* _args) {
-  assert(_args);
+  // The bind pose size defines the ranges of transforms to blend, so all
+  // other buffers should be bigger.
+  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
+  valid &= output.end - output.begin >= min_range;
 
-  // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.layers.begin;
-       layer < _args->job.layers.end; ++layer) {
-    // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
-    assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+  // Layers are optional.
+  if (layers.begin != NULL) {
+    valid &= layers.end >= layers.begin;
+  } else {
+    valid &= layers.end == NULL;
+  }
 
-    // Skip irrelevant layers.
+  // Validates layers.
+  for (const Layer* layer = layers.begin; layers.begin && layer < layers.end;
+       ++layer) {
+    valid &= ValidateSampleLayer(*layer, min_range);
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Defines the number of soa joints processed at once. Intermediate samples of
+// a chunk, accumulated weights and output stay in L1 cache while all layers
+// are blended.
+const int kSampleBlendingChunkSize = 8;
+
+// Clamps layer time in range [0,duration].
+float LayerTime(const SampleBlendingJob::Layer& _layer) {
+  return math::Clamp(0.f, _layer.time, _layer.animation->duration());
+}
+
+// Blends _count soa joints _samples of _layer to _output, starting at soa
+// joint _begin. _first_pass selects whether _output and _accumulated_weights
+// are initialized or accumulated.
+void BlendChunk(const SampleBlendingJob::Layer& _layer, bool _first_pass,
+                int _begin, int _count, const math::SoaTransform* _samples,
+                math::SimdFloat4* _accumulated_weights,
+                math::SoaTransform* _output) {
+  const math::SimdFloat4 layer_weight =
+      math::simd_float4::Load1(_layer.weight);
+  if (_layer.joint_weights.begin) {
+    // This layer has per-joint weights.
+    const math::SimdFloat4* joint_weights = _layer.joint_weights.begin + _begin;
+    if (_first_pass) {
+      for (int i = 0; i < _count; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        const math::SimdFloat4 weight =
+            layer_weight * math::Max0(joint_weights[i]);
+        _accumulated_weights[i] = weight;
+        OZZ_BLEND_1ST_PASS(src, weight, dest);
+      }
+    } else {
+      for (int i = 0; i < _count; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        const math::SimdFloat4 weight =
+            layer_weight * math::Max0(joint_weights[i]);
+        _accumulated_weights[i] = _accumulated_weights[i] + weight;
+        OZZ_BLEND_N_PASS(src, weight, dest);
+      }
+    }
+  } else {
+    // This is a full layer.
+    if (_first_pass) {
+      for (int i = 0; i < _count; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        _accumulated_weights[i] = layer_weight;
+        OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
+      }
+    } else {
+      for (int i = 0; i < _count; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        _accumulated_weights[i] = _accumulated_weights[i] + layer_weight;
+        OZZ_BLEND_N_PASS(src, layer_weight, dest);
+      }
+    }
+  }
+}
+}  // namespace
+
+bool SampleBlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Updates the cache of every layer to its time, and accumulates global
+  // weights. Layers with a weight <= 0 are skipped.
+  float accumulated_weight = 0.f;
+  int num_passes = 0;
+  int num_partial_passes = 0;
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
     if (layer->weight <= 0.f) {
       continue;
     }
+    layer->cache->Update(*layer->animation, LayerTime(*layer), NULL, 0,
+                         layer->animation->num_soa_tracks(), NULL);
+    accumulated_weight += layer->weight;
+    num_partial_passes += layer->joint_weights.begin != NULL;
+    ++num_passes;
+  }
 
-    // Accumulates global weights.
-    _args->accumulated_weight += layer->weight;
-    const math::SimdFloat4 layer_weight =
-        math::simd_float4::Load1(layer->weight);
+  // Computes the bind pose weight when no partial blending pass is used, in
+  // which case threshold can be tested globally.
+  const float bp_weight = threshold - accumulated_weight;
+  const bool global_bind_pose = num_partial_passes == 0 && bp_weight > 0.f;
+  if (global_bind_pose) {
+    accumulated_weight = num_passes == 0 ? 1.f : threshold;
+  }
+  const math::SimdFloat4 simd_bp_weight = math::simd_float4::Load1(bp_weight);
+  const math::SimdFloat4 simd_threshold = math::simd_float4::Load1(threshold);
+  const math::SimdFloat4 ratio =
+      math::simd_float4::Load1(1.f / accumulated_weight);
+  const math::SimdFloat4 one = math::simd_float4::one();
 
-    if (layer->joint_weights.begin) {
-      // This layer has per-joint weights.
-      ++_args->num_partial_passes;
+  // Processes soa joints by chunks, sampling and blending all layers to the
+  // output, before applying bind pose and normalizing.
+  const int num_soa_joints = static_cast<int>(bind_pose.end - bind_pose.begin);
+  for (int begin = 0; begin < num_soa_joints;
+       begin += kSampleBlendingChunkSize) {
+    const int end = math::Min(begin + kSampleBlendingChunkSize, num_soa_joints);
+    const int count = end - begin;
+    math::SoaTransform* chunk_output = output.begin + begin;
+    const math::SoaTransform* chunk_bind_pose = bind_pose.begin + begin;
+    math::SimdFloat4 accumulated_weights[kSampleBlendingChunkSize];
+
+    // Samples and blends all layers.
+    bool first_pass = true;
+    for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+      if (layer->weight <= 0.f) {
+        continue;
+      }
+      math::SoaTransform samples[kSampleBlendingChunkSize];
+      layer->cache->Interpolate(*layer->animation, LayerTime(*layer), NULL,
+                                begin, end, samples);
+      BlendChunk(*layer, first_pass, begin, count, samples,
+                 accumulated_weights, chunk_output);
+      first_pass = false;
+    }
 
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] = weight;
-          OZZ_BLEND_1ST_PASS(src, weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] =
-              _args->accumulated_weights[i] + weight;
-          OZZ_BLEND_N_PASS(src, weight, dest);
+    // Blends bind pose to the output if accumulated weight is less than the
+    // threshold value, and normalizes output. Quaternion length cannot be
+    // zero as opposed quaternions have been fixed up during blending passes.
+    if (num_partial_passes == 0) {
+      if (global_bind_pose) {
+        if (num_passes == 0) {
+          // Strictly copying bind-pose.
+          for (int i = 0; i < count; ++i) {
+            chunk_output[i] = chunk_bind_pose[i];
+          }
+        } else {
+          for (int i = 0; i < count; ++i) {
+            const math::SoaTransform& src = chunk_bind_pose[i];
+            math::SoaTransform* dest = chunk_output + i;
+            OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
+          }
         }
       }
+      for (int i = 0; i < count; ++i) {
+        math::SoaTransform& dest = chunk_output[i];
+        dest.rotation = NormalizeEst(dest.rotation);
+        dest.translation = dest.translation * ratio;
+        dest.scale = dest.scale * ratio;
+      }
     } else {
-      // This is a full layer.
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] = layer_weight;
-          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] =
-              _args->accumulated_weights[i] + layer_weight;
-          OZZ_BLEND_N_PASS(src, layer_weight, dest);
-        }
+      // Blending passes contain partial blending, threshold must be tested
+      // for each joint.
+      for (int i = 0; i < count; ++i) {
+        const math::SoaTransform& src = chunk_bind_pose[i];
+        math::SoaTransform* dest = chunk_output + i;
+        const math::SimdFloat4 joint_bp_weight =
+            math::Max0(simd_threshold - accumulated_weights[i]);
+        const math::SimdFloat4 weight =
+            math::Max(simd_threshold, accumulated_weights[i]);
+        OZZ_BLEND_N_PASS(src, joint_bp_weight, dest);
+        const math::SimdFloat4 joint_ratio = one / weight;
+        dest->rotation = NormalizeEst(dest->rotation);
+        dest->translation = dest->translation * joint_ratio;
+        dest->scale = dest->scale * joint_ratio;
       }
     }
-    // One more pass blended.
-    ++_args->num_passes;
   }
+
+  return true;
 }
+}  // animation
+}  // ozz
 
-// Blends bind pose to the output if accumulated weight is less than the
-// threshold value.
-void BlendBindPose(ProcessArgs* _args) {
-  assert(_args);
+// Including inertialization_job.cc file.
 
-  // Asserts buffer sizes, which must never fail as it has been validated.
-  assert(_args->job.bind_pose.end >=
-         _args->job.bind_pose.begin + _args->num_soa_joints);
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
 
-  if (_args->num_partial_passes == 0) {
-    // No partial blending pass detected, threshold can be tested globally.
-    const float bp_weight = _args->job.threshold - _args->accumulated_weight;
+#include "ozz/animation/runtime/inertialization_job.h"
 
-    if (bp_weight > 0.f) {  // The bind-pose is needed if it has a weight.
-      if (_args->num_passes == 0) {
-        // Strictly copying bind-pose.
-        _args->accumulated_weight = 1.f;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          _args->job.output.begin[i] = _args->job.bind_pose.begin[i];
-        }
-      } else {
-        // Updates global accumulated weight, but not per-joint weight any more
-        // because normalization stage will be global also.
-        _args->accumulated_weight = _args->job.threshold;
+#include <cassert>
+#include <cstddef>
 
-        const math::SimdFloat4 simd_bp_weight =
-            math::simd_float4::Load1(bp_weight);
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
 
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
-        }
-      }
-    }
-  } else {
-    // Blending passes contain partial blending, threshold must be tested for
-    // each joint.
-    const math::SimdFloat4 threshold =
-        math::simd_float4::Load1(_args->job.threshold);
+namespace ozz {
+namespace animation {
 
-    // There's been at least 1 pass as num_partial_passes != 0.
-    assert(_args->num_passes != 0);
+InertializationCaptureJob::InertializationCaptureJob() : delta_time(0.f) {}
 
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-      math::SoaTransform* dest = _args->job.output.begin + i;
-      const math::SimdFloat4 bp_weight =
-          math::Max0(threshold - _args->accumulated_weights[i]);
-      _args->accumulated_weights[i] =
-          math::Max(threshold, _args->accumulated_weights[i]);
-      OZZ_BLEND_N_PASS(src, bp_weight, dest);
-    }
-  }
+bool InertializationCaptureJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid ranges.
+  valid &= target.end >= target.begin;
+  valid &= previous.begin != NULL && previous.end >= previous.begin;
+  valid &= current.begin != NULL && current.end >= current.begin;
+  valid &= output.begin != NULL && output.end >= output.begin;
+
+  // The target size defines the number of soa joints to capture, so all other
+  // buffers should be bigger.
+  const ptrdiff_t min_range = target.end - target.begin;
+  valid &= previous.end - previous.begin >= min_range;
+  valid &= current.end - current.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  // Velocities are computed using delta_time.
+  valid &= delta_time > 0.f;
+
+  return valid;
 }
 
-// Normalizes output rotations. Quaternion length cannot be zero as opposed
-// quaternions have been fixed up during blending passes.
-// Translations and scales are already normalized because weights were
-// pre-multiplied by the normalization ratio.
-void Normalize(ProcessArgs* _args) {
-  assert(_args);
+InertializationJob::InertializationJob() : time(0.f), duration(0.f) {}
+
+bool InertializationJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid ranges.
+  valid &= input.end >= input.begin;
+  valid &= offsets.begin != NULL && offsets.end >= offsets.begin;
+  valid &= output.begin != NULL && output.end >= output.begin;
+
+  // The input size defines the number of soa joints to process, so all other
+  // buffers should be bigger.
+  const ptrdiff_t min_range = input.end - input.begin;
+  valid &= offsets.end - offsets.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  // Duration must be strictly positive, as time is normalized by duration.
+  valid &= duration > 0.f;
 
-  if (_args->num_partial_passes == 0) {
-    // Normalization of a non-partial blending requires to apply the same
-    // division to all joints.
-    const math::SimdFloat4 ratio =
-        math::simd_float4::Load1(1.f / _args->accumulated_weight);
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      math::SoaTransform& dest = _args->job.output.begin[i];
-      dest.rotation = NormalizeEst(dest.rotation);
-      dest.translation = dest.translation * ratio;
-      dest.scale = dest.scale * ratio;
-    }
-  } else {
-    // Partial blending normalization requires to compute the divider per-joint.
-    const math::SimdFloat4 one = math::simd_float4::one();
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
-      math::SoaTransform& dest = _args->job.output.begin[i];
-      dest.rotation = NormalizeEst(dest.rotation);
-      dest.translation = dest.translation * ratio;
-      dest.scale = dest.scale * ratio;
-    }
-  }
+  return valid;
 }
 
-// Process additive blending pass.
-void AddLayers(ProcessArgs* _args) {
-  assert(_args);
+namespace {
+// Approximates acos(_x) / sqrt(1 - _x) for _x in range [0,1], with a
+// polynomial whose absolute error is less than 2e-8 once multiplied by
+// sqrt(1 - _x). See Abramowitz and Stegun, "Handbook of Mathematical
+// Functions", 4.4.46.
+math::SimdFloat4 ACosRatio(math::_SimdFloat4 _x) {
+  math::SimdFloat4 p = math::simd_float4::Load1(-.0012624911f);
+  p = math::MAdd(p, _x, math::simd_float4::Load1(.0066700901f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(-.0170881256f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(.0308918810f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(-.0501743046f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(.0889789874f));
+  p = math::MAdd(p, _x, math::simd_float4::Load1(-.2145988016f));
+  return math::MAdd(p, _x, math::simd_float4::Load1(1.5707963050f));
+}
 
-  // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.additive_layers.begin;
-       layer < _args->job.additive_layers.end; ++layer) {
-    // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
-    assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+// Approximates sin(_x) / _x, from the Taylor series of sin truncated after
+// x^11. _x2 is the square of _x, which must be in range [0,pi/2].
+math::SimdFloat4 SinRatioFromSquare(math::_SimdFloat4 _x2) {
+  math::SimdFloat4 p = math::simd_float4::Load1(-1.f / 39916800.f);
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(1.f / 362880.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-1.f / 5040.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(1.f / 120.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-1.f / 6.f));
+  return math::MAdd(p, _x2, math::simd_float4::one());
+}
 
-    // Prepares constants.
-    const math::SimdFloat4 one = math::simd_float4::one();
+// Approximates cos(_x), from its Taylor series truncated after x^12. _x2 is
+// the square of _x, which must be in range [0,pi/2].
+math::SimdFloat4 CosFromSquare(math::_SimdFloat4 _x2) {
+  math::SimdFloat4 p = math::simd_float4::Load1(1.f / 479001600.f);
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-1.f / 3628800.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(1.f / 40320.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-1.f / 720.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(1.f / 24.f));
+  p = math::MAdd(p, _x2, math::simd_float4::Load1(-.5f));
+  return math::MAdd(p, _x2, math::simd_float4::one());
+}
 
-    if (layer->weight > 0.f) {
-      // Weight is positive, need to perform additive blending.
-      const math::SimdFloat4 layer_weight =
-          math::simd_float4::Load1(layer->weight);
+// Computes the scaled axis (axis * angle) vector of rotation _q, taking the
+// shortest path.
+math::SoaFloat3 ToScaledAxis(const math::SoaQuaternion& _q) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 two = math::simd_float4::Load1(2.f);
+
+  // Negates quaternions whose w is negative, to take the shortest path.
+  const math::SimdInt4 sign = math::Sign(_q.w);
+  const math::SimdFloat4 w = math::Min(math::Abs(_q.w), one);
+
+  // The angle / sin(angle / 2) ratio is 2 * acos(w) / sqrt(1 - w^2). Once
+  // sqrt(1 - w) is factored out of acos, it has no singularity for small
+  // angles.
+  const math::SimdFloat4 ratio =
+      two * ACosRatio(w) * math::RSqrtEstNR(one + w);
+  const math::SimdFloat4 signed_ratio = math::Xor(ratio, sign);
+  return math::SoaFloat3::Load(_q.x * signed_ratio, _q.y * signed_ratio,
+                               _q.z * signed_ratio);
+}
 
-      if (layer->joint_weights.begin) {
-        // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          const math::SoaFloat3 one_minus_weight_f3 = {
-              one_minus_weight, one_minus_weight, one_minus_weight};
-          OZZ_ADD_PASS(src, weight, dest);
-        }
-      } else {
-        // This is a full layer.
-        const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        const math::SoaFloat3 one_minus_weight_f3 = {
-            one_minus_weight, one_minus_weight, one_minus_weight};
+// Computes the rotation matching scaled axis (axis * angle) vector _v, whose
+// angle must be in range [0,pi].
+math::SoaQuaternion FromScaledAxis(const math::SoaFloat3& _v) {
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 quarter = math::simd_float4::Load1(.25f);
+
+  // The sin(angle / 2) / angle ratio has no singularity for small angles.
+  const math::SimdFloat4 half_angle2 = math::Dot(_v, _v) * quarter;
+  const math::SimdFloat4 ratio = half * SinRatioFromSquare(half_angle2);
+  return math::SoaQuaternion::Load(_v.x * ratio, _v.y * ratio, _v.z * ratio,
+                                   CosFromSquare(half_angle2));
+}
 
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_ADD_PASS(src, layer_weight, dest);
-        }
-      }
-    } else if (layer->weight < 0.f) {
-      // Weight is negative, need to perform subtractive blending.
-      const math::SimdFloat4 layer_weight =
-          math::simd_float4::Load1(-layer->weight);
+// Evaluates at time _t the decay of offset _x0, whose initial velocity is _v0,
+// over _duration. The decay follows a quintic polynomial that reaches 0 with
+// null velocity and acceleration. Velocities moving away from 0 are ignored,
+// and the decay is shortened if the initial velocity would make it overshoot.
+math::SimdFloat4 Decay(math::_SimdFloat4 _x0, math::_SimdFloat4 _v0,
+                       math::_SimdFloat4 _t, math::_SimdFloat4 _duration) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-6f);
+
+  // The polynomial is computed for a positive offset, and its sign restored
+  // afterward.
+  const math::SimdInt4 sign = math::Sign(_x0);
+  const math::SimdFloat4 x0 = math::Abs(_x0);
+  const math::SimdFloat4 v0 = math::Min(math::Xor(_v0, sign), zero);
+
+  // Shortens decay duration to avoid overshooting.
+  const math::SimdFloat4 t1 = math::Min(
+      _duration, math::simd_float4::Load1(-5.f) * x0 / math::Min(v0, -eps));
+
+  // Polynomial coefficients, for a time normalized by t1. Initial
+  // acceleration is chosen to avoid overshooting.
+  const math::SimdFloat4 v0t1 = v0 * t1;
+  const math::SimdFloat4 a0t1 = math::Max0(
+      math::simd_float4::Load1(-8.f) * v0t1 -
+      math::simd_float4::Load1(20.f) * x0);
+  const math::SimdFloat4 a = math::simd_float4::Load1(-6.f) * x0 -
+                             math::simd_float4::Load1(3.f) * v0t1 -
+                             half * a0t1;
+  const math::SimdFloat4 b = math::simd_float4::Load1(15.f) * x0 +
+                             math::simd_float4::Load1(8.f) * v0t1 +
+                             math::simd_float4::Load1(1.5f) * a0t1;
+  const math::SimdFloat4 c = math::simd_float4::Load1(-10.f) * x0 -
+                             math::simd_float4::Load1(6.f) * v0t1 -
+                             math::simd_float4::Load1(1.5f) * a0t1;
+
+  // Evaluates polynomial using Horner's method.
+  const math::SimdFloat4 u = math::Min(_t / math::Max(t1, eps), one);
+  const math::SimdFloat4 x =
+      x0 + u * (v0t1 + u * (half * a0t1 + u * (c + u * (b + u * a))));
+
+  // Offset is 0 once decay is over.
+  return math::Xor(math::Select(math::CmpLt(_t, t1), x, zero), sign);
+}
 
-      if (layer->joint_weights.begin) {
-        // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          OZZ_SUB_PASS(src, weight, dest);
-        }
-      } else {
-        // This is a full layer.
-        const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_SUB_PASS(src, layer_weight, dest);
-        }
-      }
-    } else {
-      // Skip layer as its weight is 0.
-    }
-  }
+// Decays vector offset _x0 along its own direction, so that its axis doesn't
+// drift during the transition. Only the component of the velocity _v0 along
+// this axis is kept.
+math::SoaFloat3 Decay(const math::SoaFloat3& _x0, const math::SoaFloat3& _v0,
+                      math::_SimdFloat4 _t, math::_SimdFloat4 _duration) {
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-6f);
+  const math::SimdFloat4 length = math::Length(_x0);
+  const math::SimdFloat4 inv_length = math::simd_float4::one() /
+                                      math::Max(length, eps);
+  const math::SoaFloat3 axis = math::SoaFloat3::Load(
+      _x0.x * inv_length, _x0.y * inv_length, _x0.z * inv_length);
+  const math::SimdFloat4 x =
+      Decay(length, math::Dot(_v0, axis), _t, _duration);
+  return math::SoaFloat3::Load(axis.x * x, axis.y * x, axis.z * x);
 }
 }  // namespace
 
-bool BlendingJob::Run() const {
+bool InertializationCaptureJob::Run() const {
   if (!Validate()) {
     return false;
   }
 
-  // Initializes blended parameters that are exchanged across blend stages.
-  ProcessArgs process_args(*this);
+  const math::SimdFloat4 inv_dt = math::simd_float4::Load1(1.f / delta_time);
+  const ptrdiff_t num_soa_joints = target.end - target.begin;
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    const math::SoaTransform& prev = previous.begin[i];
+    const math::SoaTransform& cur = current.begin[i];
+    const math::SoaTransform& tgt = target.begin[i];
+    SoaInertializationOffset& offset = output.begin[i];
+
+    // Translations and scales offsets are differences with the target, so
+    // their velocities don't depend on the target.
+    offset.translation = cur.translation - tgt.translation;
+    offset.translation_velocity = (cur.translation - prev.translation) * inv_dt;
+    offset.scale = cur.scale - tgt.scale;
+    offset.scale_velocity = (cur.scale - prev.scale) * inv_dt;
+
+    // Rotation offsets are the rotations from the target, such that
+    // cur = offset * tgt.
+    const math::SoaQuaternion inv_tgt = math::Conjugate(tgt.rotation);
+    offset.rotation = ToScaledAxis(cur.rotation * inv_tgt);
+    const math::SoaFloat3 prev_rotation = ToScaledAxis(prev.rotation * inv_tgt);
+    offset.rotation_velocity = (offset.rotation - prev_rotation) * inv_dt;
+  }
 
-  // Blends all layers to the job output buffers.
-  BlendLayers(&process_args);
+  return true;
+}
 
-  // Applies bind pose.
-  BlendBindPose(&process_args);
+bool InertializationJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
 
-  // Normalizes output.
-  Normalize(&process_args);
+  const ptrdiff_t num_soa_joints = input.end - input.begin;
 
-  // Process additive blending.
-  AddLayers(&process_args);
+  // Once the transition is over, all offsets are 0.
+  if (time >= duration) {
+    if (output.begin != input.begin) {
+      for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+        output.begin[i] = input.begin[i];
+      }
+    }
+    return true;
+  }
+
+  const math::SimdFloat4 t = math::simd_float4::Load1(math::Max(time, 0.f));
+  const math::SimdFloat4 d = math::simd_float4::Load1(duration);
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    const SoaInertializationOffset& offset = offsets.begin[i];
+    const math::SoaTransform& in = input.begin[i];
+    math::SoaTransform& out = output.begin[i];
+    out.translation =
+        in.translation +
+        Decay(offset.translation, offset.translation_velocity, t, d);
+    out.rotation =
+        FromScaledAxis(Decay(offset.rotation, offset.rotation_velocity, t, d)) *
+        in.rotation;
+    out.scale = in.scale + Decay(offset.scale, offset.scale_velocity, t, d);
+  }
 
   return true;
 }
@@ -839,8 +2697,10 @@ bool BlendingJob::Run() const {
 #include "ozz/animation/runtime/local_to_model_job.h"
 
 #include <cassert>
+#include <cstring>
 
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_float3x4.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
@@ -850,77 +2710,508 @@ bool BlendingJob::Run() const {
 namespace ozz {
 namespace animation {
 
-bool LocalToModelJob::Validate() const {
-  // Don't need any early out, as jobs are valid in most of the performance
-  // critical cases.
-  // Tests are written in multiple lines in order to avoid branches.
-  bool valid = true;
+LocalToModelJob::LocalToModelJob()
+    : skeleton(NULL),
+      from(Skeleton::kNoParentIndex) {}
+
+bool LocalToModelJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  if (!skeleton) {
+    return false;
+  }
+  valid &= input.begin != NULL;
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+
+  // Test input range, implicitly tests for NULL end pointers.
+  valid &= input.end - input.begin >= num_soa_joints;
+
+  // Test output ranges, exactly one of them must be used.
+  if (output.begin) {
+    valid &= output.end - output.begin >= num_joints;
+    valid &= affine_output.begin == NULL;
+  } else {
+    valid &= affine_output.begin != NULL;
+    valid &= affine_output.end - affine_output.begin >= num_joints;
+  }
+
+  // Test optional skinning output, which requires inverse bind poses.
+  if (skinning_output.begin || inverse_bind_poses.begin) {
+    valid &= skinning_output.begin != NULL;
+    valid &= skinning_output.end - skinning_output.begin >= num_joints;
+    valid &= inverse_bind_poses.begin != NULL;
+    valid &= inverse_bind_poses.end - inverse_bind_poses.begin >= num_joints;
+  }
+
+  // Test from joint.
+  valid &= from == Skeleton::kNoParentIndex || (from >= 0 && from < num_joints);
+
+  // Test joints list, which can't be used with from joint nor dirty mask.
+  if (joints.begin) {
+    valid &= joints.end >= joints.begin;
+    valid &= from == Skeleton::kNoParentIndex && dirty.begin == NULL;
+    for (const uint16_t* joint = joints.begin; valid && joint < joints.end;
+         ++joint) {
+      valid &= *joint < num_joints;
+    }
+  }
+
+  // Test dirty mask, which can't be used with from joint.
+  if (dirty.begin) {
+    valid &= dirty.end - dirty.begin >= (num_soa_joints + 7) / 8;
+    valid &= from == Skeleton::kNoParentIndex;
+  }
+
+  return valid;
+}
+
+namespace {
+// Converts the 4 soa matrices of _soa to aos Float4x4 matrices.
+void SoaToAos(const math::SoaFloat4x4& _soa, math::Float4x4 _aos[4]) {
+  math::Transpose16x16(&_soa.cols[0].x, &_aos[0].cols[0]);
+}
+
+// Converts the 4 soa matrices of _soa to aos Float3x4 matrices. Each row is a
+// 4x4 transposition of the matching component of the 4 columns, the last row
+// (0, 0, 0, 1) is dropped.
+void SoaToAos(const math::SoaFloat4x4& _soa, math::Float3x4 _aos[4]) {
+  math::SimdFloat4 rows[3][4];
+  const math::SimdFloat4 xs[4] = {_soa.cols[0].x, _soa.cols[1].x,
+                                  _soa.cols[2].x, _soa.cols[3].x};
+  math::Transpose4x4(xs, rows[0]);
+  const math::SimdFloat4 ys[4] = {_soa.cols[0].y, _soa.cols[1].y,
+                                  _soa.cols[2].y, _soa.cols[3].y};
+  math::Transpose4x4(ys, rows[1]);
+  const math::SimdFloat4 zs[4] = {_soa.cols[0].z, _soa.cols[1].z,
+                                  _soa.cols[2].z, _soa.cols[3].z};
+  math::Transpose4x4(zs, rows[2]);
+  for (int i = 0; i < 4; ++i) {
+    _aos[i].rows[0] = rows[0][i];
+    _aos[i].rows[1] = rows[1][i];
+    _aos[i].rows[2] = rows[2][i];
+  }
+}
+
+// Computes the skinning matrix of _model matrix.
+math::Float4x4 ToSkinning(const math::Float4x4& _model,
+                          const math::Float4x4& _inverse_bind_pose) {
+  return _model * _inverse_bind_pose;
+}
+
+math::Float4x4 ToSkinning(const math::Float3x4& _model,
+                          const math::Float4x4& _inverse_bind_pose) {
+  return ToFloat4x4(_model) * _inverse_bind_pose;
+}
+
+// Implements local to model conversion for both Float4x4 and Float3x4 model
+// matrices.
+template <typename _Matrix>
+void LocalToModel(const LocalToModelJob& _job, _Matrix* _model_matrices) {
+  using math::SoaTransform;
+  using math::SoaFloat4x4;
+
+  // Fetch joint's properties.
+  const int num_joints = _job.skeleton->num_joints();
+  Range<const Skeleton::JointProperties> properties =
+      _job.skeleton->joint_properties();
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const _Matrix identity = _Matrix::identity();
+
+  // Skinning matrices are optionally computed while model matrices are still
+  // hot.
+  const math::Float4x4* inverse_bind_poses = _job.inverse_bind_poses.begin;
+  math::Float4x4* skinning_matrices = _job.skinning_output.begin;
+
+  // Flags the joints to update, one bit per joint. Joints are stored in
+  // breadth-first order, so a parent is always flagged before its children,
+  // which are updated as soon as their parent is. Updated joints aren't
+  // contiguous though, so the flags are needed to skip other joints.
+  // Updates start from from joint, or from the joints of dirty soa joints.
+  const int from = _job.from;
+  const uint8_t* dirty = _job.dirty.begin;
+  const bool all = from == Skeleton::kNoParentIndex && !dirty;
+  uint32_t updated[(Skeleton::kMaxJoints + 31) / 32];
+  if (!all) {
+    std::memset(updated, 0, sizeof(updated));
+  }
+
+  // Converts to matrices and applies hierarchical transformation.
+  for (int joint = all || dirty ? 0 : from & ~3; joint < num_joints;) {
+    const int proceed_up_to = joint + math::Min(4, num_joints - joint);
+
+    // Finds the joints of this soa joint to update.
+    int update = 0xf;
+    if (!all) {
+      update = 0;
+      const int soa_joint = joint / 4;
+      const bool soa_dirty =
+          dirty && (dirty[soa_joint / 8] & (1 << (soa_joint & 7)));
+      for (int i = joint; i < proceed_up_to; ++i) {
+        const int parent = properties.begin[i].parent;
+        const bool parent_updated =
+            parent != Skeleton::kNoParentIndex &&
+            (updated[parent / 32] & (1u << (parent & 31)));
+        if (parent_updated || (dirty ? soa_dirty : i == from)) {
+          updated[i / 32] |= 1u << (i & 31);
+          update |= 1 << (i & 3);
+        }
+      }
+    }
+    if (!update) {
+      joint = proceed_up_to;
+      continue;
+    }
+
+    // Builds soa matrices from soa transforms.
+    const SoaTransform& transform = _job.input.begin[joint / 4];
+    const SoaFloat4x4 local_soa_matrices = SoaFloat4x4::FromAffine(
+        transform.translation, transform.rotation, transform.scale);
+    // Converts to aos matrices.
+    _Matrix local_aos_matrices[4];
+    SoaToAos(local_soa_matrices, local_aos_matrices);
+
+    // Applies hierarchical transformation.
+    const _Matrix* local_matrix = local_aos_matrices;
+    for (; joint < proceed_up_to; ++joint, ++local_matrix) {
+      if (!(update & (1 << (joint & 3)))) {
+        continue;
+      }
+      const int parent = properties.begin[joint].parent;
+      const _Matrix* parent_matrix =
+          math::Select(parent == Skeleton::kNoParentIndex, &identity,
+                       &_model_matrices[parent]);
+      const _Matrix model_matrix = (*parent_matrix) * (*local_matrix);
+      _model_matrices[joint] = model_matrix;
+      if (skinning_matrices) {
+        skinning_matrices[joint] =
+            ToSkinning(model_matrix, inverse_bind_poses[joint]);
+      }
+    }
+  }
+}
+
+// Implements local to model conversion of a list of joints, for both Float4x4
+// and Float3x4 model matrices. Adjacent joints of the same soa joint share
+// their local matrices conversion.
+template <typename _Matrix>
+void LocalToModelJoints(const LocalToModelJob& _job,
+                        _Matrix* _model_matrices) {
+  using math::SoaTransform;
+  using math::SoaFloat4x4;
+
+  Range<const Skeleton::JointProperties> properties =
+      _job.skeleton->joint_properties();
+  const _Matrix identity = _Matrix::identity();
+  const math::Float4x4* inverse_bind_poses = _job.inverse_bind_poses.begin;
+  math::Float4x4* skinning_matrices = _job.skinning_output.begin;
+
+  for (const uint16_t* joints = _job.joints.begin; joints < _job.joints.end;) {
+    // Builds local matrices of the soa joint of the current joint.
+    const int soa_joint = *joints / 4;
+    const SoaTransform& transform = _job.input.begin[soa_joint];
+    const SoaFloat4x4 local_soa_matrices = SoaFloat4x4::FromAffine(
+        transform.translation, transform.rotation, transform.scale);
+    _Matrix local_aos_matrices[4];
+    SoaToAos(local_soa_matrices, local_aos_matrices);
+
+    // Applies hierarchical transformation to all adjacent joints of this soa
+    // joint.
+    for (; joints < _job.joints.end && *joints / 4 == soa_joint; ++joints) {
+      const int joint = *joints;
+      const int parent = properties.begin[joint].parent;
+      const _Matrix* parent_matrix =
+          math::Select(parent == Skeleton::kNoParentIndex, &identity,
+                       &_model_matrices[parent]);
+      const _Matrix model_matrix =
+          (*parent_matrix) * local_aos_matrices[joint & 3];
+      _model_matrices[joint] = model_matrix;
+      if (skinning_matrices) {
+        skinning_matrices[joint] =
+            ToSkinning(model_matrix, inverse_bind_poses[joint]);
+      }
+    }
+  }
+}
+}  // namespace
+
+bool LocalToModelJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no joint.
+  if (skeleton->num_joints() == 0) {
+    return true;
+  }
+
+  // Outputs to the model matrices type selected by the user.
+  if (joints.begin) {
+    if (output.begin) {
+      LocalToModelJoints(*this, output.begin);
+    } else {
+      LocalToModelJoints(*this, affine_output.begin);
+    }
+  } else if (output.begin) {
+    LocalToModel(*this, output.begin);
+  } else {
+    LocalToModel(*this, affine_output.begin);
+  }
+  return true;
+}
+
+BatchLocalToModelJob::BatchLocalToModelJob() : skeleton(NULL) {}
+
+bool BatchLocalToModelJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  bool valid = true;
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+
+  // Test inputs and outputs ranges, one per instance.
+  valid &= inputs.end - inputs.begin == outputs.end - outputs.begin;
+  for (const Range<const math::SoaTransform>* input = inputs.begin;
+       valid && input < inputs.end; ++input) {
+    valid &= input->begin != NULL;
+    valid &= input->end - input->begin >= num_soa_joints;
+  }
+  for (const Range<math::Float4x4>* output = outputs.begin;
+       valid && output < outputs.end; ++output) {
+    valid &= output->begin != NULL;
+    valid &= output->end - output->begin >= num_joints;
+  }
+
+  // Test scratch buffer.
+  valid &= scratch.begin != NULL;
+  valid &= scratch.end - scratch.begin >= num_joints;
+
+  return valid;
+}
+
+namespace {
+// Transposes the soa transforms of 4 instances, whose lanes are 4 joints, to
+// the soa transforms of the 4 joints, whose lanes are the 4 instances.
+void TransposeInstances(const math::SoaTransform* const _instances[4],
+                        math::SoaTransform _joints[4]) {
+  // A SoaTransform is made of 10 SimdFloat4, that are transposed one by one.
+  const int kNumMembers = sizeof(math::SoaTransform) / sizeof(math::SimdFloat4);
+  for (int m = 0; m < kNumMembers; ++m) {
+    math::SimdFloat4 in[4];
+    for (int i = 0; i < 4; ++i) {
+      in[i] = reinterpret_cast<const math::SimdFloat4*>(_instances[i])[m];
+    }
+    math::SimdFloat4 out[4];
+    math::Transpose4x4(in, out);
+    for (int j = 0; j < 4; ++j) {
+      reinterpret_cast<math::SimdFloat4*>(&_joints[j])[m] = out[j];
+    }
+  }
+}
+}  // namespace
+
+bool BatchLocalToModelJob::Run() const {
+  using math::SoaTransform;
+  using math::SoaFloat4x4;
+  using math::Float4x4;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = skeleton->num_joints();
+  const int num_instances = static_cast<int>(inputs.end - inputs.begin);
+  Range<const Skeleton::JointProperties> properties =
+      skeleton->joint_properties();
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const SoaFloat4x4 identity = SoaFloat4x4::identity();
+
+  // Processes instances by groups of 4. The last group is completed with
+  // copies of its last instance, whose outputs aren't written.
+  for (int first = 0; first < num_instances; first += 4) {
+    const int group_size = math::Min(4, num_instances - first);
+    int instances[4];
+    for (int i = 0; i < 4; ++i) {
+      instances[i] = first + math::Min(i, group_size - 1);
+    }
+
+    for (int joint = 0; joint < num_joints;) {
+      // Transposes local transforms of the 4 joints of this soa joint, so
+      // that lanes are instances.
+      const SoaTransform* soa_locals[4];
+      for (int i = 0; i < 4; ++i) {
+        soa_locals[i] = inputs.begin[instances[i]].begin + joint / 4;
+      }
+      SoaTransform locals[4];
+      TransposeInstances(soa_locals, locals);
+
+      // Applies hierarchical transformation to the 4 instances at once.
+      const int proceed_up_to = joint + math::Min(4, num_joints - joint);
+      for (const SoaTransform* local = locals; joint < proceed_up_to;
+           ++joint, ++local) {
+        const int parent = properties.begin[joint].parent;
+        const SoaFloat4x4* parent_matrix =
+            math::Select(parent == Skeleton::kNoParentIndex, &identity,
+                         &scratch.begin[parent]);
+        const SoaFloat4x4 model =
+            (*parent_matrix) * SoaFloat4x4::FromAffine(local->translation,
+                                                       local->rotation,
+                                                       local->scale);
+        scratch.begin[joint] = model;
+
+        // Converts to instances aos matrices.
+        math::SimdFloat4 aos_matrices[16];
+        math::Transpose16x16(&model.cols[0].x, aos_matrices);
+        for (int i = 0; i < group_size; ++i) {
+          const Float4x4 matrix = {{aos_matrices[i * 4 + 0],
+                                    aos_matrices[i * 4 + 1],
+                                    aos_matrices[i * 4 + 2],
+                                    aos_matrices[i * 4 + 3]}};
+          outputs.begin[first + i].begin[joint] = matrix;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+LocalToModelTransformJob::LocalToModelTransformJob() : skeleton(NULL) {}
 
-  // Test for NULL begin pointers.
+bool LocalToModelTransformJob::Validate() const {
   if (!skeleton) {
     return false;
   }
-  valid &= input.begin != NULL;
-  valid &= output.begin != NULL;
+  bool valid = true;
 
-  const int num_joints = skeleton->num_joints();
-  const int num_soa_joints = (num_joints + 3) / 4;
+  const int num_soa_joints = skeleton->num_soa_joints();
 
   // Test input and output ranges, implicitly tests for NULL end pointers.
+  valid &= input.begin != NULL;
   valid &= input.end - input.begin >= num_soa_joints;
-  valid &= output.end - output.begin >= num_joints;
+  valid &= output.begin != NULL;
+  valid &= output.end - output.begin >= num_soa_joints;
 
   return valid;
 }
 
-bool LocalToModelJob::Run() const {
+namespace {
+// A SoaTransform is made of 10 SimdFloat4, that are accessed lane by lane.
+const int kNumSoaTransformMembers =
+    sizeof(math::SoaTransform) / sizeof(math::SimdFloat4);
+
+// Gathers the model-space transforms of _parents joints into the lanes of
+// _gathered. Lanes whose parent is Skeleton::kNoParentIndex get identity.
+void GatherParentTransforms(const math::SoaTransform* _models,
+                            const int _parents[4],
+                            math::SoaTransform* _gathered) {
+  const math::SoaTransform identity = math::SoaTransform::identity();
+  float* gathered = reinterpret_cast<float*>(_gathered);
+  for (int i = 0; i < 4; ++i) {
+    const int parent = _parents[i];
+    const bool root = parent == Skeleton::kNoParentIndex;
+    const float* src =
+        reinterpret_cast<const float*>(root ? &identity : &_models[parent / 4]);
+    const int lane = root ? 0 : parent & 3;
+    for (int m = 0; m < kNumSoaTransformMembers; ++m) {
+      gathered[m * 4 + i] = src[m * 4 + lane];
+    }
+  }
+}
+
+// Copies _lanes lanes (one bit per lane) of _src to _dest.
+void CopyTransformLanes(const math::SoaTransform& _src, int _lanes,
+                        math::SoaTransform* _dest) {
+  const float* src = reinterpret_cast<const float*>(&_src);
+  float* dest = reinterpret_cast<float*>(_dest);
+  for (int i = 0; i < 4; ++i) {
+    if (_lanes & (1 << i)) {
+      for (int m = 0; m < kNumSoaTransformMembers; ++m) {
+        dest[m * 4 + i] = src[m * 4 + i];
+      }
+    }
+  }
+}
+
+// Concatenates _local transforms to their _parent model-space transforms.
+math::SoaTransform ConcatenateTransforms(const math::SoaTransform& _parent,
+                                         const math::SoaTransform& _local) {
+  const math::SoaTransform model = {
+      _parent.translation +
+          math::TransformVector(_parent.rotation,
+                                _parent.scale * _local.translation),
+      _parent.rotation * _local.rotation, _parent.scale * _local.scale};
+  return model;
+}
+}  // namespace
+
+bool LocalToModelTransformJob::Run() const {
   using math::SoaTransform;
-  using math::SoaFloat4x4;
-  using math::Float4x4;
 
   if (!Validate()) {
     return false;
   }
 
-  // Early out if no joint.
   const int num_joints = skeleton->num_joints();
-  if (num_joints == 0) {
-    return true;
-  }
-
-  // Fetch joint's properties.
+  const int num_soa_joints = skeleton->num_soa_joints();
   Range<const Skeleton::JointProperties> properties =
       skeleton->joint_properties();
 
-  // Output.
-  Float4x4* const model_matrices = output.begin;
+  for (int soa_joint = 0; soa_joint < num_soa_joints; ++soa_joint) {
+    const int first = soa_joint * 4;
+
+    // Finds lanes parents. Lanes out of the skeleton are processed as roots.
+    // Lanes whose parent belongs to this soa joint are pending, until their
+    // parent lane is computed.
+    int parents[4];
+    int pending = 0;
+    for (int i = 0; i < 4; ++i) {
+      parents[i] = first + i < num_joints ? properties.begin[first + i].parent
+                                          : Skeleton::kNoParentIndex;
+      if (parents[i] != Skeleton::kNoParentIndex && parents[i] >= first) {
+        pending |= 1 << i;
+      }
+    }
 
-  // Initializes an identity matrix that will be used to compute roots model
-  // matrices without requiring a branch.
-  const Float4x4 identity = Float4x4::identity();
+    // Local transforms are copied, so that input and output can alias.
+    const SoaTransform local = input.begin[soa_joint];
+    SoaTransform* model = &output.begin[soa_joint];
 
-  // Converts to matrices and applies hierarchical transformation.
-  for (int joint = 0; joint < num_joints;) {
-    // Builds soa matrices from soa transforms.
-    const SoaTransform& transform = input.begin[joint / 4];
-    const SoaFloat4x4 local_soa_matrices = SoaFloat4x4::FromAffine(
-        transform.translation, transform.rotation, transform.scale);
-    // Converts to aos matrices.
-    math::SimdFloat4 local_aos_matrices[16];
-    math::Transpose16x16(&local_soa_matrices.cols[0].x, local_aos_matrices);
+    // Fast path, all parents belong to previous soa joints.
+    SoaTransform parent;
+    if (!pending) {
+      GatherParentTransforms(output.begin, parents, &parent);
+      *model = ConcatenateTransforms(parent, local);
+      continue;
+    }
 
-    // Applies hierarchical transformation.
-    const int proceed_up_to = joint + math::Min(4, num_joints - joint);
-    const math::SimdFloat4* local_aos_matrix = local_aos_matrices;
-    for (; joint < proceed_up_to; ++joint, local_aos_matrix += 4) {
-      const int parent = properties.begin[joint].parent;
-      const Float4x4* parent_matrix =
-          math::Select(parent == Skeleton::kNoParentIndex, &identity,
-                       &model_matrices[parent]);
-      const Float4x4 local_matrix = {{local_aos_matrix[0], local_aos_matrix[1],
-                                      local_aos_matrix[2],
-                                      local_aos_matrix[3]}};
-      model_matrices[joint] = (*parent_matrix) * local_matrix;
+    // Otherwise computes ready lanes, until there's no more pending one. Each
+    // pass computes all lanes, but only copies the ready ones. Parents of other
+    // lanes aren't computed yet, identity is gathered instead.
+    for (int done = 0; done != 0xf;) {
+      int ready = 0;
+      int ready_parents[4];
+      for (int i = 0; i < 4; ++i) {
+        ready_parents[i] = Skeleton::kNoParentIndex;
+        if (!(done & (1 << i)) &&
+            (!(pending & (1 << i)) || done & (1 << (parents[i] & 3)))) {
+          ready |= 1 << i;
+          ready_parents[i] = parents[i];
+        }
+      }
+      GatherParentTransforms(output.begin, ready_parents, &parent);
+      CopyTransformLanes(ConcatenateTransforms(parent, local), ready, model);
+      done |= ready;
     }
   }
   return true;
@@ -959,7 +3250,10 @@ bool LocalToModelJob::Run() const {
 
 #include "ozz/animation/runtime/sampling_job.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <limits>
 
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/base/maths/math_constant.h"
@@ -1013,14 +3307,20 @@ namespace animation {
 // as the same base made of the key time and it's track. This is required as
 // key frames are not sorted per track, but sorted by time to favor cache
 // coherency.
+// Key time is stored as a 16 bits unsigned integer ratio of the animation
+// duration, 0 matching time 0 and 65535 matching the duration. Key frames of a
+// same track are thus at least duration / 65535 apart.
 // Key frame values are compressed, according on their type. Decompression is
 // efficient because it's done on SoA data and cached during sampling.
 
 // Defines the translation key frame type.
-// Translation values are stored as half precision floats with 16 bits per
-// component.
+// Translation values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see
+// Animation::translation_ranges()). As opposed to half precision floats, the
+// precision doesn't depend on the magnitude of the value, but only on the
+// range covered by the track.
 struct TranslationKey {
-  float time;
+  uint16_t ratio;
   uint16_t track;
   uint16_t value[3];
 };
@@ -1041,7 +3341,7 @@ struct TranslationKey {
 // key frames, but in this case RotationKey structure would induce 16 bits of
 // padding.
 struct RotationKey {
-  float time;
+  uint16_t ratio;
   uint16_t track : 13;   // The track this key frame belongs to.
   uint16_t largest : 2;  // The largest component of the quaternion.
   uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
@@ -1049,13 +3349,27 @@ struct RotationKey {
 };
 
 // Defines the scale key frame type.
-// Scale values are stored as half precision floats with 16 bits per
-// component.
+// Scale values are quantized to 16 bits unsigned integers per component,
+// within the range of values of their track (see Animation::scale_ranges()).
 struct ScaleKey {
-  float time;
+  uint16_t ratio;
   uint16_t track;
   uint16_t value[3];
 };
+
+// Defines the key frame type of FixedRateAnimation.
+// A key stores the values of a soa track (4 consecutive tracks) at a given
+// frame, in SoA layout. There's no need to store key time and track, as they
+// are implicitly defined by key position in the frame-major key frames buffer.
+// Translation and scale values are stored as half precision floats with 16 bits
+// per component. Rotation quaternion components are all in range [-1:1], and
+// quantized to signed integer 16 bits values. Unlike RotationKey, the 4
+// components are stored, so decompression is straightforward SoA code.
+struct FixedRateSoaKey {
+  uint16_t translation[3][4];
+  int16_t rotation[4][4];
+  uint16_t scale[3][4];
+};
 }  // animation
 }  // ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -1064,17 +3378,32 @@ struct ScaleKey {
 namespace ozz {
 namespace animation {
 
+// Adds _value to statistics _counter, if statistics are enabled and _stats
+// isn't NULL. _value isn't evaluated if statistics are disabled.
+#if defined(OZZ_BUILD_SAMPLING_STATS)
+#define OZZ_SAMPLING_STATS_ADD(_stats, _counter, _value) \
+  do {                                                   \
+    if (_stats) {                                        \
+      (_stats)->_counter += (_value);                    \
+    }                                                    \
+  } while (void(0), 0)
+#else  // OZZ_BUILD_SAMPLING_STATS
+#define OZZ_SAMPLING_STATS_ADD(_stats, _counter, _value) \
+  do {                                                   \
+  } while (void(0), 0)
+#endif  // OZZ_BUILD_SAMPLING_STATS
+
 namespace internal {
 struct InterpSoaTranslation {
-  math::SimdFloat4 time[2];
+  math::SimdFloat4 ratio[2];
   math::SoaFloat3 value[2];
 };
 struct InterpSoaRotation {
-  math::SimdFloat4 time[2];
+  math::SimdFloat4 ratio[2];
   math::SoaQuaternion value[2];
 };
 struct InterpSoaScale {
-  math::SimdFloat4 time[2];
+  math::SimdFloat4 ratio[2];
   math::SoaFloat3 value[2];
 };
 }  // internal
@@ -1098,15 +3427,85 @@ bool SamplingJob::Validate() const {
   // Tests cache size.
   valid &= cache->max_soa_tracks() >= num_soa_tracks;
 
+  // Tests mask size, if any.
+  valid &= soa_mask.begin == soa_mask.end ||
+           (soa_mask.begin != NULL &&
+            soa_mask.end - soa_mask.begin >= (num_soa_tracks + 7) / 8);
+
+  // Tests soa tracks range.
+  valid &= begin_soa >= 0 && end_soa >= begin_soa;
+
   return valid;
 }
 
 namespace {
+// Flags all soa entries as outdated. It cares to only flag valid soa entries as
+// this is the exit condition of other algorithms.
+void OutdateAll(int _num_soa_tracks, unsigned char* _outdated) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  if (!num_outdated_flags) {
+    return;
+  }
+  for (int i = 0; i < num_outdated_flags - 1; ++i) {
+    _outdated[i] = 0xff;
+  }
+  _outdated[num_outdated_flags - 1] =
+      0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+}
+
+// Finds the index of the last seek point of _animation whose time is less or
+// equal to _time. Returns -1 if there's no such seek point.
+int FindSeekPoint(const Animation& _animation, float _time) {
+  const float interval = _animation.seek_interval();
+  if (interval <= 0.f) {
+    return -1;
+  }
+  int point = static_cast<int>(_time / interval);
+  // Fixes up float approximations, seek point time must be less than _time.
+  if (static_cast<float>(point) * interval > _time) {
+    --point;
+  }
+  return math::Min(point, _animation.num_seek_points()) - 1;
+}
+
+// Converts _time to key frames ratio unit, 0 being the beginning of _animation
+// and 65535 its end. AnimationBuilder uses the same conversion when building
+// seek points, which guarantees they are consistent with sampling.
+float TimeToRatio(const Animation& _animation, float _time) {
+  return _time / _animation.duration() * 65535.f;
+}
+
+// Restores cache entries and cursors from seek point _point.
+void Seek(ozz::Range<const int> _seeks, int _point, int _num_soa_tracks,
+          int* _cursor, int* _reverse_cursor, int* _cache,
+          unsigned char* _outdated) {
+  const int num_entries = _num_soa_tracks * 4 * 2;
+  const int* seek = _seeks.begin + _point * (2 + num_entries);
+  assert(seek + 2 + num_entries <= _seeks.end);
+  *_cursor = seek[0];
+  *_reverse_cursor = seek[1];
+  std::memcpy(_cache, seek + 2, num_entries * sizeof(int));
+
+  // All entries are outdated.
+  OutdateAll(_num_soa_tracks, _outdated);
+}
+
 // Loops through the sorted key frames and update cache structure.
+// _ratio is the sampling time expressed in key frames ratio unit (see
+// TimeToRatio).
+// Cache can be updated forward using _keys order, or backward using
+// _reverse_keys order. Both cursors are kept in sync, so that playback
+// direction can change at any time without invalidating the cache. Without
+// reverse keys, the cache can only be updated forward.
 template <typename _Key>
-void UpdateKeys(float _time, int _num_soa_tracks, ozz::Range<const _Key> _keys,
-                int* _cursor, int* _cache, unsigned char* _outdated) {
-  assert(_num_soa_tracks >= 1);
+void UpdateKeys(float _ratio, int _num_soa_tracks, ozz::Range<const _Key> _keys,
+                ozz::Range<const uint16_t> _reverse_keys, int* _cursor,
+                int* _reverse_cursor, int* _cache, unsigned char* _outdated,
+                SamplingStats* _stats) {
+  // Nothing to update if all soa tracks are constant.
+  if (!_num_soa_tracks) {
+    return;
+  }
   const int num_tracks = _num_soa_tracks * 4;
   assert(_keys.begin + num_tracks * 2 <= _keys.end);
 
@@ -1129,27 +3528,55 @@ void UpdateKeys(float _time, int _num_soa_tracks, ozz::Range<const _Key> _keys,
       _cache[out_index + 7] = in_index1 + 3;
     }
     cursor = _keys.begin + num_tracks * 2;  // New cursor position.
+    *_reverse_cursor = 0;  // No key is behind the first ones.
 
-    // All entries are outdated. It cares to only flag valid soa entries as
-    // this is the exit condition of other algorithms.
-    const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-    for (int i = 0; i < num_outdated_flags - 1; ++i) {
-      _outdated[i] = 0xff;
-    }
-    _outdated[num_outdated_flags - 1] =
-        0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+    // All entries are outdated.
+    OutdateAll(_num_soa_tracks, _outdated);
   } else {
     assert(cursor >= _keys.begin + num_tracks * 2 && cursor <= _keys.end);
   }
 
-  // Search for the keys that matches _time.
+  const uint16_t* reverse_cursor = _reverse_keys.begin + *_reverse_cursor;
+  assert(reverse_cursor >= _reverse_keys.begin &&
+         reverse_cursor <= _reverse_keys.end);
+
+  // Search backward for the keys that matches _ratio.
+  // Iterates while the left key of the track of the previous reverse key is
+  // greater than _ratio. The reverse key is then the predecessor of the left
+  // key, which becomes the new left key. Thanks to reverse keys sorting, the
+  // loop can end as soon as it finds a key lower or equal to _ratio.
+  while (reverse_cursor > _reverse_keys.begin) {
+    const int key = reverse_cursor[-1];
+    const int track = _keys.begin[key].track;
+    const int base = track * 2;
+    if (_keys.begin[_cache[base]].ratio <= _ratio) {
+      break;
+    }
+    // Flag this soa entry as outdated.
+    _outdated[track / 32] |= (1 << ((track & 0x1f) / 4));
+    // Updates cache.
+    _cache[base + 1] = _cache[base];
+    _cache[base] = key;
+    // Process previous key.
+    --reverse_cursor;
+    OZZ_SAMPLING_STATS_ADD(_stats, num_backward_keys, 1);
+  }
+
+  // Moves forward cursor back to the first key that is after the right key of
+  // its track.
+  while (cursor > _keys.begin + num_tracks * 2 &&
+         cursor - 1 - _keys.begin > _cache[cursor[-1].track * 2 + 1]) {
+    --cursor;
+  }
+
+  // Search for the keys that matches _ratio.
   // Iterates while the cache is not updated with left and right keys required
-  // for interpolation at time _time, for all tracks. Thanks to the keyframe
-  // sorting, the loop can end as soon as it finds a key greater that _time.
-  // It will mean that all the keys lower than _time have been processed,
+  // for interpolation at time _ratio, for all tracks. Thanks to the keyframe
+  // sorting, the loop can end as soon as it finds a key greater that _ratio.
+  // It will mean that all the keys lower than _ratio have been processed,
   // meaning all cache entries are updated.
   while (cursor < _keys.end &&
-         _keys.begin[_cache[cursor->track * 2 + 1]].time <= _time) {
+         _keys.begin[_cache[cursor->track * 2 + 1]].ratio <= _ratio) {
     // Flag this soa entry as outdated.
     _outdated[cursor->track / 32] |= (1 << ((cursor->track & 0x1f) / 4));
     // Updates cache.
@@ -1158,58 +3585,266 @@ void UpdateKeys(float _time, int _num_soa_tracks, ozz::Range<const _Key> _keys,
     _cache[base + 1] = static_cast<int>(cursor - _keys.begin);
     // Process next key.
     ++cursor;
+    OZZ_SAMPLING_STATS_ADD(_stats, num_forward_keys, 1);
   }
   assert(cursor <= _keys.end);
 
-  // Updates cursor output.
+  // Moves reverse cursor forward to the first key that isn't before the left
+  // key of its track.
+  while (reverse_cursor < _reverse_keys.end &&
+         *reverse_cursor < _cache[_keys.begin[*reverse_cursor].track * 2]) {
+    ++reverse_cursor;
+  }
+
+  // Updates cursors output.
   *_cursor = static_cast<int>(cursor - _keys.begin);
+  *_reverse_cursor = static_cast<int>(reverse_cursor - _reverse_keys.begin);
+}
+
+// Tests whether soa track _i is selected by _mask. A NULL _mask selects all
+// soa tracks.
+bool IsSampled(const unsigned char* _mask, int _i) {
+  return !_mask || (_mask[_i / 8] & (1 << (_i & 7))) != 0;
+}
+
+// Gets the mask of the animated soa tracks of range [_from,_to[ matching
+// outdated flags byte _j. _mask bits are indexed by output soa track, so they
+// are remapped to animated soa tracks order using _soa_tracks.
+unsigned char RemapMask(const unsigned char* _mask,
+                        const uint16_t* _soa_tracks, int _from, int _to,
+                        int _j) {
+  const int begin = math::Max(_j * 8, _from);
+  const int end = math::Min(_j * 8 + 8, _to);
+  if (!_mask) {
+    return static_cast<unsigned char>(((1 << (end - begin)) - 1)
+                                      << (begin & 7));
+  }
+  unsigned char mask = 0;
+  for (int i = begin; i < end; ++i) {
+    mask |= IsSampled(_mask, _soa_tracks[i]) << (i & 7);
+  }
+  return mask;
+}
+
+#if defined(OZZ_SIMD_AVX)
+// 8-wide AVX helpers. They allow to process 8 key frames at once while
+// decompressing (left and right key frames of a soa track), and 2 soa tracks
+// at once while interpolating.
+
+// Builds a 8-wide vector from 2 4-wide vectors, _lo being the 4 first lanes.
+__m256 Load2(math::_SimdFloat4 _lo, math::_SimdFloat4 _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+// Stores a 8-wide vector to 2 4-wide vectors, _lo receiving the 4 first lanes.
+void Store2(__m256 _v, math::SimdFloat4* _lo, math::SimdFloat4* _hi) {
+  *_lo = _mm256_castps256_ps128(_v);
+  *_hi = _mm256_extractf128_ps(_v, 1);
 }
 
-void UpdateSoaTranslations(int _num_soa_tracks,
+// Lerps _a and _b vectors with coefficient _f, the same way 4-wide
+// math::Lerp does.
+__m256 Lerp8(__m256 _a, __m256 _b, __m256 _f) {
+  return _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_b, _a), _f), _a);
+}
+#endif  // OZZ_SIMD_AVX
+
+#if defined(OZZ_SIMD_AVX)
+// Decompresses left and right key frames of a translation or scale soa track
+// at once. _keys are ordered as stored in the cache, alternating left and
+// right keys. _range points to the min and step quantization entries of the
+// soa track.
+template <typename _Key, typename _SoaInterp>
+void DecompressSoaFloat3x8(const _Key* const* _keys,
+                           const math::SoaFloat3* _range, _SoaInterp* _soa) {
+  // Left keys in the first 4 lanes, right keys in the last 4 ones.
+  const _Key& k00 = *_keys[0];
+  const _Key& k10 = *_keys[2];
+  const _Key& k20 = *_keys[4];
+  const _Key& k30 = *_keys[6];
+  const _Key& k01 = *_keys[1];
+  const _Key& k11 = *_keys[3];
+  const _Key& k21 = *_keys[5];
+  const _Key& k31 = *_keys[7];
+
+  // Both left and right keys share the same range.
+  const math::SoaFloat3& min = _range[0];
+  const math::SoaFloat3& step = _range[1];
+
+  // ratio[0] and ratio[1] are contiguous.
+  _mm256_storeu_ps(reinterpret_cast<float*>(_soa->ratio),
+                   _mm256_cvtepi32_ps(_mm256_setr_epi32(
+                       k00.ratio, k10.ratio, k20.ratio, k30.ratio, k01.ratio,
+                       k11.ratio, k21.ratio, k31.ratio)));
+  const __m256 x = _mm256_cvtepi32_ps(_mm256_setr_epi32(
+      k00.value[0], k10.value[0], k20.value[0], k30.value[0], k01.value[0],
+      k11.value[0], k21.value[0], k31.value[0]));
+  Store2(_mm256_add_ps(Load2(min.x, min.x),
+                       _mm256_mul_ps(Load2(step.x, step.x), x)),
+         &_soa->value[0].x, &_soa->value[1].x);
+  const __m256 y = _mm256_cvtepi32_ps(_mm256_setr_epi32(
+      k00.value[1], k10.value[1], k20.value[1], k30.value[1], k01.value[1],
+      k11.value[1], k21.value[1], k31.value[1]));
+  Store2(_mm256_add_ps(Load2(min.y, min.y),
+                       _mm256_mul_ps(Load2(step.y, step.y), y)),
+         &_soa->value[0].y, &_soa->value[1].y);
+  const __m256 z = _mm256_cvtepi32_ps(_mm256_setr_epi32(
+      k00.value[2], k10.value[2], k20.value[2], k30.value[2], k01.value[2],
+      k11.value[2], k21.value[2], k31.value[2]));
+  Store2(_mm256_add_ps(Load2(min.z, min.z),
+                       _mm256_mul_ps(Load2(step.z, step.z), z)),
+         &_soa->value[0].z, &_soa->value[1].z);
+}
+#else  // OZZ_SIMD_AVX
+// Decompresses 4 translation or scale key frames, one per track of a soa track,
+// using the min and step quantization entries of the soa track _range.
+template <typename _Key>
+void DecompressSoaFloat3(const _Key& _k0, const _Key& _k1, const _Key& _k2,
+                         const _Key& _k3, const math::SoaFloat3* _range,
+                         math::SimdFloat4* _ratio, math::SoaFloat3* _value) {
+  const math::SoaFloat3& min = _range[0];
+  const math::SoaFloat3& step = _range[1];
+  *_ratio = math::simd_float4::FromInt(
+      math::simd_int4::Load(_k0.ratio, _k1.ratio, _k2.ratio, _k3.ratio));
+  _value->x = math::MAdd(step.x,
+                         math::simd_float4::FromInt(math::simd_int4::Load(
+                             _k0.value[0], _k1.value[0], _k2.value[0],
+                             _k3.value[0])),
+                         min.x);
+  _value->y = math::MAdd(step.y,
+                         math::simd_float4::FromInt(math::simd_int4::Load(
+                             _k0.value[1], _k1.value[1], _k2.value[1],
+                             _k3.value[1])),
+                         min.y);
+  _value->z = math::MAdd(step.z,
+                         math::simd_float4::FromInt(math::simd_int4::Load(
+                             _k0.value[2], _k1.value[2], _k2.value[2],
+                             _k3.value[2])),
+                         min.z);
+}
+#endif  // OZZ_SIMD_AVX
+
+void UpdateSoaTranslations(int _from, int _to,
                            ozz::Range<const TranslationKey> _keys,
-                           const int* _interp, unsigned char* _outdated,
-                           internal::InterpSoaTranslation* soa_translations_) {
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+                           const math::SoaFloat3* _ranges, const int* _interp,
+                           unsigned char* _outdated,
+                           const unsigned char* _mask,
+                           const uint16_t* _soa_tracks,
+                           internal::InterpSoaTranslation* soa_translations_,
+                           SamplingStats* _stats) {
+  const int num_outdated_flags = (_to + 7) / 8;
+  for (int j = _from / 8; j < num_outdated_flags; ++j) {
+    // Masked entries, and entries out of [_from,_to[, are not processed, so
+    // they remain outdated.
+    const unsigned char mask = RemapMask(_mask, _soa_tracks, _from, _to, j);
+    unsigned char outdated = _outdated[j] & mask;
+    _outdated[j] &= ~mask;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
+      OZZ_SAMPLING_STATS_ADD(_stats, num_decompressed_soa, 1);
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
+#if defined(OZZ_SIMD_AVX)
+      const TranslationKey* keys[8] = {
+          &_keys.begin[_interp[base + 0]], &_keys.begin[_interp[base + 1]],
+          &_keys.begin[_interp[base + 2]], &_keys.begin[_interp[base + 3]],
+          &_keys.begin[_interp[base + 4]], &_keys.begin[_interp[base + 5]],
+          &_keys.begin[_interp[base + 6]], &_keys.begin[_interp[base + 7]]};
+      DecompressSoaFloat3x8(keys, &_ranges[i * 2], &soa_translations_[i]);
+#else   // OZZ_SIMD_AVX
       // Decompress left side keyframes and store them in soa structures.
-      const TranslationKey& k00 = _keys.begin[_interp[base + 0]];
-      const TranslationKey& k10 = _keys.begin[_interp[base + 2]];
-      const TranslationKey& k20 = _keys.begin[_interp[base + 4]];
-      const TranslationKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_translations_[i].time[0] =
-          math::simd_float4::Load(k00.time, k10.time, k20.time, k30.time);
-      soa_translations_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      soa_translations_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_translations_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+      DecompressSoaFloat3(
+          _keys.begin[_interp[base + 0]], _keys.begin[_interp[base + 2]],
+          _keys.begin[_interp[base + 4]], _keys.begin[_interp[base + 6]],
+          &_ranges[i * 2], &soa_translations_[i].ratio[0],
+          &soa_translations_[i].value[0]);
 
       // Decompress right side keyframes and store them in soa structures.
-      const TranslationKey& k01 = _keys.begin[_interp[base + 1]];
-      const TranslationKey& k11 = _keys.begin[_interp[base + 3]];
-      const TranslationKey& k21 = _keys.begin[_interp[base + 5]];
-      const TranslationKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_translations_[i].time[1] =
-          math::simd_float4::Load(k01.time, k11.time, k21.time, k31.time);
-      soa_translations_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_translations_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_translations_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+      DecompressSoaFloat3(
+          _keys.begin[_interp[base + 1]], _keys.begin[_interp[base + 3]],
+          _keys.begin[_interp[base + 5]], _keys.begin[_interp[base + 7]],
+          &_ranges[i * 2], &soa_translations_[i].ratio[1],
+          &soa_translations_[i].value[1]);
+#endif  // OZZ_SIMD_AVX
     }
   }
 }
 
+#if defined(OZZ_SIMD_AVX)
+// Decompresses left and right key frames of a rotation soa track at once. This
+// is the 8-wide version of DECOMPRESS_SOA_QUAT. _keys are ordered as stored in
+// the cache, alternating left and right keys.
+void DecompressSoaQuat8(const RotationKey* const* _keys,
+                        const int (*_mapping)[4],
+                        internal::InterpSoaRotation* _soa) {
+  // Left keys in the first 4 lanes, right keys in the last 4 ones.
+  const int kLanes[8] = {0, 2, 4, 6, 1, 3, 5, 7};
+
+  // Prepares an array of input values, according to the mapping required to
+  // restore quaternion largest component. Also prepares ratios, signs and
+  // largest component indices.
+  OZZ_ALIGN(32) int cmp_keys[4][8];
+  OZZ_ALIGN(32) int ratios[8];
+  OZZ_ALIGN(32) float signs[8];
+  OZZ_ALIGN(32) float largests[8];
+  for (int l = 0; l < 8; ++l) {
+    const RotationKey& key = *_keys[kLanes[l]];
+    const int* m = _mapping[key.largest];
+    cmp_keys[0][l] = key.value[m[0]];
+    cmp_keys[1][l] = key.value[m[1]];
+    cmp_keys[2][l] = key.value[m[2]];
+    cmp_keys[3][l] = key.value[m[3]];
+    cmp_keys[key.largest][l] = 0;  // Resets largest component to 0.
+    ratios[l] = key.ratio;
+    signs[l] = key.sign ? -0.f : 0.f;
+    largests[l] = static_cast<float>(key.largest);
+  }
+
+  // ratio[0] and ratio[1] are contiguous.
+  _mm256_storeu_ps(
+      reinterpret_cast<float*>(_soa->ratio),
+      _mm256_cvtepi32_ps(
+          _mm256_load_si256(reinterpret_cast<const __m256i*>(ratios))));
+
+  // Rebuilds quaternion from quantized values.
+  const __m256 kInt2Float = _mm256_set1_ps(1.f / (32767.f * math::kSqrt2));
+  __m256 cpnt[4];
+  for (int c = 0; c < 4; ++c) {
+    cpnt[c] = _mm256_mul_ps(
+        kInt2Float, _mm256_cvtepi32_ps(_mm256_load_si256(
+                        reinterpret_cast<const __m256i*>(cmp_keys[c]))));
+  }
+
+  // Get back length of 4th component. Favors performance over accuracy by
+  // using x * RSqrtEst(x) instead of Sqrt(x).
+  const __m256 dot = _mm256_add_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cpnt[0], cpnt[0]),
+                                  _mm256_mul_ps(cpnt[1], cpnt[1])),
+                    _mm256_mul_ps(cpnt[2], cpnt[2])),
+      _mm256_mul_ps(cpnt[3], cpnt[3]));
+  const __m256 ww0 = _mm256_max_ps(_mm256_set1_ps(1e-16f),
+                                   _mm256_sub_ps(_mm256_set1_ps(1.f), dot));
+  const __m256 w0 = _mm256_mul_ps(ww0, _mm256_rsqrt_ps(ww0));
+  // Re-applies 4th component's sign.
+  const __m256 restored = _mm256_or_ps(w0, _mm256_load_ps(signs));
+
+  // Re-injects the largest component inside the SoA structure.
+  const __m256 largest = _mm256_load_ps(largests);
+  for (int c = 0; c < 4; ++c) {
+    const __m256 mask = _mm256_cmp_ps(
+        largest, _mm256_set1_ps(static_cast<float>(c)), _CMP_EQ_OQ);
+    cpnt[c] = _mm256_or_ps(cpnt[c], _mm256_and_ps(restored, mask));
+  }
+
+  // Stores result.
+  Store2(cpnt[0], &_soa->value[0].x, &_soa->value[1].x);
+  Store2(cpnt[1], &_soa->value[0].y, &_soa->value[1].y);
+  Store2(cpnt[2], &_soa->value[0].z, &_soa->value[1].z);
+  Store2(cpnt[3], &_soa->value[0].w, &_soa->value[1].w);
+}
+#else  // OZZ_SIMD_AVX
 #define DECOMPRESS_SOA_QUAT(_k0, _k1, _k2, _k3, _quat)                         \
   {                                                                            \
     /* Selects proper mapping for each key.*/                                  \
@@ -1278,11 +3913,15 @@ void UpdateSoaTranslations(int _num_soa_tracks,
     _quat.w = cpnt[3];                                                         \
   \
 }
+#endif  // OZZ_SIMD_AVX
 
-void UpdateSoaRotations(int _num_soa_tracks,
+void UpdateSoaRotations(int _from, int _to,
                         ozz::Range<const RotationKey> _keys, const int* _interp,
-                        unsigned char* _outdated,
-                        internal::InterpSoaRotation* _soa_rotations) {
+                        unsigned char* _outdated, const unsigned char* _mask,
+                        const uint16_t* _soa_tracks,
+                        internal::InterpSoaRotation* _soa_rotations,
+                        SamplingStats* _stats) {
+#if !defined(OZZ_SIMD_AVX)
   // Prepares constants.
   const math::SimdFloat4 one = math::simd_float4::one();
   const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
@@ -1292,23 +3931,36 @@ void UpdateSoaRotations(int _num_soa_tracks,
   const math::SimdInt4 m0f00 = math::simd_int4::mask_0f00();
   const math::SimdInt4 m00f0 = math::simd_int4::mask_00f0();
   const math::SimdInt4 m000f = math::simd_int4::mask_000f();
+#endif  // OZZ_SIMD_AVX
 
   // Defines a mapping table that defines components assignation in the output
   // quaternion.
   const int kCpntMapping[4][4] = {
       {0, 0, 1, 2}, {0, 0, 1, 2}, {0, 1, 0, 2}, {0, 1, 2, 0}};
 
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+  const int num_outdated_flags = (_to + 7) / 8;
+  for (int j = _from / 8; j < num_outdated_flags; ++j) {
+    // Masked entries, and entries out of [_from,_to[, are not processed, so
+    // they remain outdated.
+    const unsigned char mask = RemapMask(_mask, _soa_tracks, _from, _to, j);
+    unsigned char outdated = _outdated[j] & mask;
+    _outdated[j] &= ~mask;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
+      OZZ_SAMPLING_STATS_ADD(_stats, num_decompressed_soa, 1);
 
       const int base = i * 4 * 2;  // * soa size * 2 keys per track
 
+#if defined(OZZ_SIMD_AVX)
+      const RotationKey* keys[8] = {
+          &_keys.begin[_interp[base + 0]], &_keys.begin[_interp[base + 1]],
+          &_keys.begin[_interp[base + 2]], &_keys.begin[_interp[base + 3]],
+          &_keys.begin[_interp[base + 4]], &_keys.begin[_interp[base + 5]],
+          &_keys.begin[_interp[base + 6]], &_keys.begin[_interp[base + 7]]};
+      DecompressSoaQuat8(keys, kCpntMapping, &_soa_rotations[i]);
+#else   // OZZ_SIMD_AVX
       // Decompress left side keyframes and store them in soa structures.
       {
         const RotationKey& k0 = _keys.begin[_interp[base + 0]];
@@ -1316,8 +3968,8 @@ void UpdateSoaRotations(int _num_soa_tracks,
         const RotationKey& k2 = _keys.begin[_interp[base + 4]];
         const RotationKey& k3 = _keys.begin[_interp[base + 6]];
 
-        _soa_rotations[i].time[0] =
-            math::simd_float4::Load(k0.time, k1.time, k2.time, k3.time);
+        _soa_rotations[i].ratio[0] = math::simd_float4::FromInt(
+            math::simd_int4::Load(k0.ratio, k1.ratio, k2.ratio, k3.ratio));
         math::SoaQuaternion& quat = _soa_rotations[i].value[0];
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
       }
@@ -1329,93 +3981,295 @@ void UpdateSoaRotations(int _num_soa_tracks,
         const RotationKey& k2 = _keys.begin[_interp[base + 5]];
         const RotationKey& k3 = _keys.begin[_interp[base + 7]];
 
-        _soa_rotations[i].time[1] =
-            math::simd_float4::Load(k0.time, k1.time, k2.time, k3.time);
+        _soa_rotations[i].ratio[1] = math::simd_float4::FromInt(
+            math::simd_int4::Load(k0.ratio, k1.ratio, k2.ratio, k3.ratio));
         math::SoaQuaternion& quat = _soa_rotations[i].value[1];
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
       }
+#endif  // OZZ_SIMD_AVX
     }
   }
 }
 
+#if !defined(OZZ_SIMD_AVX)
 #undef DECOMPRESS_SOA_QUAT
-
-void UpdateSoaScales(int _num_soa_tracks, ozz::Range<const ScaleKey> _keys,
-                     const int* _interp, unsigned char* _outdated,
-                     internal::InterpSoaScale* soa_scales_) {
-  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+#endif  // OZZ_SIMD_AVX
+
+void UpdateSoaScales(int _from, int _to, ozz::Range<const ScaleKey> _keys,
+                     const math::SoaFloat3* _ranges, const int* _interp,
+                     unsigned char* _outdated, const unsigned char* _mask,
+                     const uint16_t* _soa_tracks,
+                     internal::InterpSoaScale* soa_scales_,
+                     SamplingStats* _stats) {
+  const int num_outdated_flags = (_to + 7) / 8;
+  for (int j = _from / 8; j < num_outdated_flags; ++j) {
+    // Masked entries, and entries out of [_from,_to[, are not processed, so
+    // they remain outdated.
+    const unsigned char mask = RemapMask(_mask, _soa_tracks, _from, _to, j);
+    unsigned char outdated = _outdated[j] & mask;
+    _outdated[j] &= ~mask;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
+      OZZ_SAMPLING_STATS_ADD(_stats, num_decompressed_soa, 1);
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
+#if defined(OZZ_SIMD_AVX)
+      const ScaleKey* keys[8] = {
+          &_keys.begin[_interp[base + 0]], &_keys.begin[_interp[base + 1]],
+          &_keys.begin[_interp[base + 2]], &_keys.begin[_interp[base + 3]],
+          &_keys.begin[_interp[base + 4]], &_keys.begin[_interp[base + 5]],
+          &_keys.begin[_interp[base + 6]], &_keys.begin[_interp[base + 7]]};
+      DecompressSoaFloat3x8(keys, &_ranges[i * 2], &soa_scales_[i]);
+#else   // OZZ_SIMD_AVX
       // Decompress left side keyframes and store them in soa structures.
-      const ScaleKey& k00 = _keys.begin[_interp[base + 0]];
-      const ScaleKey& k10 = _keys.begin[_interp[base + 2]];
-      const ScaleKey& k20 = _keys.begin[_interp[base + 4]];
-      const ScaleKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_scales_[i].time[0] =
-          math::simd_float4::Load(k00.time, k10.time, k20.time, k30.time);
-      soa_scales_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      soa_scales_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_scales_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+      DecompressSoaFloat3(
+          _keys.begin[_interp[base + 0]], _keys.begin[_interp[base + 2]],
+          _keys.begin[_interp[base + 4]], _keys.begin[_interp[base + 6]],
+          &_ranges[i * 2], &soa_scales_[i].ratio[0], &soa_scales_[i].value[0]);
 
       // Decompress right side keyframes and store them in soa structures.
-      const ScaleKey& k01 = _keys.begin[_interp[base + 1]];
-      const ScaleKey& k11 = _keys.begin[_interp[base + 3]];
-      const ScaleKey& k21 = _keys.begin[_interp[base + 5]];
-      const ScaleKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_scales_[i].time[1] =
-          math::simd_float4::Load(k01.time, k11.time, k21.time, k31.time);
-      soa_scales_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_scales_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_scales_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+      DecompressSoaFloat3(
+          _keys.begin[_interp[base + 1]], _keys.begin[_interp[base + 3]],
+          _keys.begin[_interp[base + 5]], _keys.begin[_interp[base + 7]],
+          &_ranges[i * 2], &soa_scales_[i].ratio[1], &soa_scales_[i].value[1]);
+#endif  // OZZ_SIMD_AVX
     }
   }
 }
 
-void Interpolates(float _anim_time, int _num_soa_tracks,
-                  const internal::InterpSoaTranslation* _translations,
-                  const internal::InterpSoaRotation* _rotations,
-                  const internal::InterpSoaScale* _scales,
-                  math::SoaTransform* _output) {
-  const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
+// Interpolates translations or scales (selected by _member) of animated soa
+// tracks, and outputs them to their soa track. _output is the output of soa
+// track _first.
+template <typename _Interp>
+void InterpolatesFloat3(float _anim_ratio, int _num_soa_tracks,
+                        const uint16_t* _soa_tracks, const _Interp* _interps,
+                        const unsigned char* _mask, int _first,
+                        math::SoaFloat3 math::SoaTransform::*_member,
+                        math::SoaTransform* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+#if defined(OZZ_SIMD_AVX)
+  const __m256 anim_ratio8 = _mm256_set1_ps(_anim_ratio);
+#endif  // OZZ_SIMD_AVX
   for (int i = 0; i < _num_soa_tracks; ++i) {
-    // Prepares interpolation coefficients.
-    const math::SimdFloat4 interp_t_time =
-        (anim_time - _translations[i].time[0]) *
-        math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
-    const math::SimdFloat4 interp_r_time =
-        (anim_time - _rotations[i].time[0]) *
-        math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
-    const math::SimdFloat4 interp_s_time =
-        (anim_time - _scales[i].time[0]) *
-        math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
-
-    // Processes interpolations.
+    if (!IsSampled(_mask, _soa_tracks[i])) {
+      continue;
+    }
+
+#if defined(OZZ_SIMD_AVX)
+    // Processes 2 soa tracks at once if both are sampled.
+    if (i + 1 < _num_soa_tracks && IsSampled(_mask, _soa_tracks[i + 1])) {
+      const _Interp& i0 = _interps[i];
+      const _Interp& i1 = _interps[i + 1];
+
+      // Prepares interpolation coefficients.
+      const __m256 ratio0 = Load2(i0.ratio[0], i1.ratio[0]);
+      const __m256 interp_time = _mm256_mul_ps(
+          _mm256_sub_ps(anim_ratio8, ratio0),
+          _mm256_rcp_ps(
+              _mm256_sub_ps(Load2(i0.ratio[1], i1.ratio[1]), ratio0)));
+
+      math::SoaFloat3& o0 = _output[_soa_tracks[i] - _first].*_member;
+      math::SoaFloat3& o1 = _output[_soa_tracks[i + 1] - _first].*_member;
+      Store2(Lerp8(Load2(i0.value[0].x, i1.value[0].x),
+                   Load2(i0.value[1].x, i1.value[1].x), interp_time),
+             &o0.x, &o1.x);
+      Store2(Lerp8(Load2(i0.value[0].y, i1.value[0].y),
+                   Load2(i0.value[1].y, i1.value[1].y), interp_time),
+             &o0.y, &o1.y);
+      Store2(Lerp8(Load2(i0.value[0].z, i1.value[0].z),
+                   Load2(i0.value[1].z, i1.value[1].z), interp_time),
+             &o0.z, &o1.z);
+      ++i;
+      continue;
+    }
+#endif  // OZZ_SIMD_AVX
+
+    const _Interp& interp = _interps[i];
+    const math::SimdFloat4 interp_time =
+        (anim_ratio - interp.ratio[0]) *
+        math::RcpEst(interp.ratio[1] - interp.ratio[0]);
+    _output[_soa_tracks[i] - _first].*_member =
+        Lerp(interp.value[0], interp.value[1], interp_time);
+  }
+}
+
+// Interpolates rotations of animated soa tracks, and outputs them to their
+// soa track. _output is the output of soa track _first.
+void InterpolatesRotations(float _anim_ratio, int _num_soa_tracks,
+                           const uint16_t* _soa_tracks,
+                           const internal::InterpSoaRotation* _rotations,
+                           const unsigned char* _mask, int _first,
+                           math::SoaTransform* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+#if defined(OZZ_SIMD_AVX)
+  const __m256 anim_ratio8 = _mm256_set1_ps(_anim_ratio);
+#endif  // OZZ_SIMD_AVX
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (!IsSampled(_mask, _soa_tracks[i])) {
+      continue;
+    }
+
+#if defined(OZZ_SIMD_AVX)
+    // Processes 2 soa tracks at once if both are sampled.
+    if (i + 1 < _num_soa_tracks && IsSampled(_mask, _soa_tracks[i + 1])) {
+      const internal::InterpSoaRotation& r0 = _rotations[i];
+      const internal::InterpSoaRotation& r1 = _rotations[i + 1];
+
+      // Prepares interpolation coefficients.
+      const __m256 ratio0 = Load2(r0.ratio[0], r1.ratio[0]);
+      const __m256 interp_time = _mm256_mul_ps(
+          _mm256_sub_ps(anim_ratio8, ratio0),
+          _mm256_rcp_ps(
+              _mm256_sub_ps(Load2(r0.ratio[1], r1.ratio[1]), ratio0)));
+
+      // Interpolates rotations, see math::NLerpEst.
+      const __m256 rx = Lerp8(Load2(r0.value[0].x, r1.value[0].x),
+                              Load2(r0.value[1].x, r1.value[1].x), interp_time);
+      const __m256 ry = Lerp8(Load2(r0.value[0].y, r1.value[0].y),
+                              Load2(r0.value[1].y, r1.value[1].y), interp_time);
+      const __m256 rz = Lerp8(Load2(r0.value[0].z, r1.value[0].z),
+                              Load2(r0.value[1].z, r1.value[1].z), interp_time);
+      const __m256 rw = Lerp8(Load2(r0.value[0].w, r1.value[0].w),
+                              Load2(r0.value[1].w, r1.value[1].w), interp_time);
+      const __m256 len2 = _mm256_add_ps(
+          _mm256_add_ps(
+              _mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry)),
+              _mm256_mul_ps(rz, rz)),
+          _mm256_mul_ps(rw, rw));
+      // Uses one more Newton-Raphson step, as math::RSqrtEstNR does.
+      const __m256 nr = _mm256_rsqrt_ps(len2);
+      const __m256 muls = _mm256_mul_ps(_mm256_mul_ps(len2, nr), nr);
+      const __m256 inv_len =
+          _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(.5f), nr),
+                        _mm256_sub_ps(_mm256_set1_ps(3.f), muls));
+      math::SoaQuaternion& o0 = _output[_soa_tracks[i] - _first].rotation;
+      math::SoaQuaternion& o1 = _output[_soa_tracks[i + 1] - _first].rotation;
+      Store2(_mm256_mul_ps(rx, inv_len), &o0.x, &o1.x);
+      Store2(_mm256_mul_ps(ry, inv_len), &o0.y, &o1.y);
+      Store2(_mm256_mul_ps(rz, inv_len), &o0.z, &o1.z);
+      Store2(_mm256_mul_ps(rw, inv_len), &o0.w, &o1.w);
+      ++i;
+      continue;
+    }
+#endif  // OZZ_SIMD_AVX
+
     // The lerp of the rotation uses the shortest path, because opposed
     // quaternions were negated during animation build stage (AnimationBuilder).
-    _output[i].translation = Lerp(_translations[i].value[0],
-                                  _translations[i].value[1], interp_t_time);
-    _output[i].rotation =
-        NLerpEst(_rotations[i].value[0], _rotations[i].value[1], interp_r_time);
-    _output[i].scale =
-        Lerp(_scales[i].value[0], _scales[i].value[1], interp_s_time);
+    const internal::InterpSoaRotation& interp = _rotations[i];
+    const math::SimdFloat4 interp_time =
+        (anim_ratio - interp.ratio[0]) *
+        math::RcpEst(interp.ratio[1] - interp.ratio[0]);
+    _output[_soa_tracks[i] - _first].rotation =
+        NLerpEst(interp.value[0], interp.value[1], interp_time);
+  }
+}
+
+// Copies constant soa tracks values (selected by _member) to their output soa
+// track. _soa_tracks are the output indices of constant soa tracks, and
+// _output is the output of soa track _first.
+template <typename _Value>
+void CopyConstants(ozz::Range<const _Value> _constants,
+                   const uint16_t* _soa_tracks, const unsigned char* _mask,
+                   int _first, _Value math::SoaTransform::*_member,
+                   math::SoaTransform* _output) {
+  const int count = static_cast<int>(_constants.Count());
+  for (int i = 0; i < count; ++i) {
+    const int soa_track = _soa_tracks[i];
+    if (IsSampled(_mask, soa_track)) {
+      _output[soa_track - _first].*_member = _constants.begin[i];
+    }
+  }
+}
+
+// Sets _identity to the _count identity soa tracks that are sampled. Identity
+// soa tracks have no stored value, their output indices are _soa_tracks.
+template <typename _Value>
+void CopyIdentities(const _Value& _identity, const uint16_t* _soa_tracks,
+                    int _count, const unsigned char* _mask, int _first,
+                    _Value math::SoaTransform::*_member,
+                    math::SoaTransform* _output) {
+  for (int i = 0; i < _count; ++i) {
+    const int soa_track = _soa_tracks[i];
+    if (IsSampled(_mask, soa_track)) {
+      _output[soa_track - _first].*_member = _identity;
+    }
+  }
+}
+
+// Finds the range [*_from,*_to[ of the _count soa tracks whose output index,
+// stored by _soa_tracks in ascending order, is within [_begin,_end[.
+void FindSoaTracks(const uint16_t* _soa_tracks, int _count, int _begin,
+                   int _end, int* _from, int* _to) {
+  const uint16_t* end = _soa_tracks + _count;
+  const uint16_t* from = std::lower_bound(_soa_tracks, end, _begin);
+  *_from = static_cast<int>(from - _soa_tracks);
+  *_to = static_cast<int>(std::lower_bound(from, end, _end) - _soa_tracks);
+}
+
+// Binary searches the 2 keys to interpolate at _ratio for every track of the
+// _count soa tracks starting at soa track _first. Keys indices are output to
+// _interp, with the same layout as SamplingCache entries.
+template <typename _Key>
+void SearchKeys(float _ratio, int _first, int _count, int _num_soa_tracks,
+                ozz::Range<const _Key> _keys, ozz::Range<const int> _track_keys,
+                int* _interp) {
+  const int* offsets = _track_keys.begin;
+  const int* indices = offsets + _num_soa_tracks * 4 + 1;
+  for (int i = 0; i < _count * 4; ++i) {
+    const int track = _first * 4 + i;
+    const int* track_keys = indices + offsets[track];
+    const int num_keys = offsets[track + 1] - offsets[track];
+    assert(num_keys >= 2 && indices + offsets[track + 1] <= _track_keys.end);
+
+    // Finds the first key whose ratio is greater than _ratio, the first key
+    // being excluded as it's always at ratio 0. The last key is used if
+    // there's none, which happens when sampling the end of the animation.
+    int left = 1, right = num_keys - 1;
+    while (left < right) {
+      const int middle = (left + right) / 2;
+      if (_keys.begin[track_keys[middle]].ratio <= _ratio) {
+        left = middle + 1;
+      } else {
+        right = middle;
+      }
+    }
+    _interp[i * 2 + 0] = track_keys[left - 1];
+    _interp[i * 2 + 1] = track_keys[left];
   }
 }
 }  // namespace
 
-SamplingJob::SamplingJob() : time(0.f), animation(NULL), cache(NULL) {}
+SamplingStats::SamplingStats() { Reset(); }
+
+void SamplingStats::Reset() {
+  num_samples = 0;
+  num_cache_invalidations = 0;
+  num_cache_restarts = 0;
+  num_cache_seeks = 0;
+  num_forward_keys = 0;
+  num_backward_keys = 0;
+  num_decompressed_soa = 0;
+}
+
+void SamplingStats::Accumulate(const SamplingStats& _stats) {
+  num_samples += _stats.num_samples;
+  num_cache_invalidations += _stats.num_cache_invalidations;
+  num_cache_restarts += _stats.num_cache_restarts;
+  num_cache_seeks += _stats.num_cache_seeks;
+  num_forward_keys += _stats.num_forward_keys;
+  num_backward_keys += _stats.num_backward_keys;
+  num_decompressed_soa += _stats.num_decompressed_soa;
+}
+
+SamplingJob::SamplingJob()
+    : time(0.f),
+      animation(NULL),
+      cache(NULL),
+      begin_soa(0),
+      end_soa(std::numeric_limits<int>::max()),
+      stats(NULL) {}
 
 bool SamplingJob::Run() const {
   if (!Validate()) {
@@ -1430,35 +4284,218 @@ bool SamplingJob::Run() const {
   // Clamps time in range [0,duration].
   const float anim_time = math::Clamp(0.f, time, animation->duration());
 
-  // Step the cache to this potentially new animation and time.
+  // An empty mask samples all soa tracks.
+  const unsigned char* mask = soa_mask.begin != soa_mask.end ? soa_mask.begin
+                                                             : NULL;
+
+  // Samples soa tracks range, clamped to the animation.
+  const int end = math::Min(end_soa, num_soa_tracks);
+  if (begin_soa >= end) {
+    return true;
+  }
+
+  assert(cache->max_soa_tracks() >= num_soa_tracks);
+  cache->Sample(*animation, anim_time, mask, begin_soa, end,
+                output.begin + begin_soa, stats);
+
+  return true;
+}
+
+BatchSamplingJob::BatchSamplingJob()
+    : animation(NULL), cache(NULL), stats(NULL) {}
+
+bool BatchSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation || !cache) {
+    return false;
+  }
+
+  // Times and outputs are optional, but must match.
+  valid &= times.end >= times.begin;
+  valid &= outputs.end >= outputs.begin;
+  valid &= times.end - times.begin == outputs.end - outputs.begin;
+  if (!valid) {
+    return false;
+  }
+
+  // Tests cache size.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= cache->max_soa_tracks() >= num_soa_tracks;
+
+  // Tests mask size, if any.
+  valid &= soa_mask.begin == soa_mask.end ||
+           (soa_mask.begin != NULL &&
+            soa_mask.end - soa_mask.begin >= (num_soa_tracks + 7) / 8);
+
+  // Tests times order, and outputs ranges.
+  const ptrdiff_t count = times.end - times.begin;
+  for (ptrdiff_t i = 0; i < count; ++i) {
+    valid &= i == 0 || times.begin[i - 1] <= times.begin[i];
+    const Range<math::SoaTransform>& output = outputs.begin[i];
+    valid &= output.begin != NULL;
+    valid &= output.end - output.begin >= num_soa_tracks;
+  }
+
+  return valid;
+}
+
+bool BatchSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  // An empty mask samples all soa tracks.
+  const unsigned char* mask = soa_mask.begin != soa_mask.end ? soa_mask.begin
+                                                             : NULL;
+
+  // Times are sorted, so the cache is only stepped forward, from one time to
+  // the next. Every key frame of the sampled span is thus walked once for the
+  // whole batch, and soa values decompressed for a time are reused by the
+  // next ones as long as their keys don't change. All times were validated
+  // at once, so sampling is done directly with the cache.
   assert(cache->max_soa_tracks() >= num_soa_tracks);
-  cache->Step(*animation, anim_time);
-
-  // Fetch key frames from the animation to the cache a t = anim_time.
-  // Then updates outdated soa hot values.
-  UpdateKeys(anim_time, num_soa_tracks, animation->translations(),
-             &cache->translation_cursor_, cache->translation_keys_,
-             cache->outdated_translations_);
-  UpdateSoaTranslations(num_soa_tracks, animation->translations(),
-                        cache->translation_keys_, cache->outdated_translations_,
-                        cache->soa_translations_);
-
-  UpdateKeys(anim_time, num_soa_tracks, animation->rotations(),
-             &cache->rotation_cursor_, cache->rotation_keys_,
-             cache->outdated_rotations_);
-  UpdateSoaRotations(num_soa_tracks, animation->rotations(),
-                     cache->rotation_keys_, cache->outdated_rotations_,
-                     cache->soa_rotations_);
-
-  UpdateKeys(anim_time, num_soa_tracks, animation->scales(),
-             &cache->scale_cursor_, cache->scale_keys_,
-             cache->outdated_scales_);
-  UpdateSoaScales(num_soa_tracks, animation->scales(), cache->scale_keys_,
-                  cache->outdated_scales_, cache->soa_scales_);
-
-  // Interpolates soa hot data.
-  Interpolates(anim_time, num_soa_tracks, cache->soa_translations_,
-               cache->soa_rotations_, cache->soa_scales_, output.begin);
+  const float duration = animation->duration();
+  const ptrdiff_t count = times.end - times.begin;
+  for (ptrdiff_t i = 0; i < count; ++i) {
+    const float anim_time = math::Clamp(0.f, times.begin[i], duration);
+    cache->Sample(*animation, anim_time, mask, 0, num_soa_tracks,
+                  outputs.begin[i].begin, stats);
+  }
+
+  return true;
+}
+
+RandomAccessSamplingJob::RandomAccessSamplingJob()
+    : time(0.f), animation(NULL) {}
+
+bool RandomAccessSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation) {
+    return false;
+  }
+  valid &= output.begin != NULL;
+
+  // Keys are binary searched using per-track key indices.
+  valid &= animation->has_track_keys();
+
+  // Tests output range, implicitly tests output.end != NULL.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= output.end - output.begin >= num_soa_tracks;
+
+  // Tests mask size, if any.
+  valid &= soa_mask.begin == soa_mask.end ||
+           (soa_mask.begin != NULL &&
+            soa_mask.end - soa_mask.begin >= (num_soa_tracks + 7) / 8);
+
+  return valid;
+}
+
+bool RandomAccessSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Clamps time in range [0,duration].
+  const float anim_time = math::Clamp(0.f, time, animation->duration());
+  const float anim_ratio = TimeToRatio(*animation, anim_time);
+
+  // An empty mask samples all soa tracks.
+  const unsigned char* mask = soa_mask.begin != soa_mask.end ? soa_mask.begin
+                                                             : NULL;
+
+  // Animated soa tracks are processed by chunks of 8 (the number of soa tracks
+  // per outdated flags byte), so that SamplingJob decompression and
+  // interpolation functions can be used with stack buffers instead of a
+  // cache.
+  const int kChunkSize = 8;
+  int interp[kChunkSize * 4 * 2];
+  unsigned char outdated;
+
+  const uint16_t* translation_tracks =
+      animation->translation_soa_tracks().begin;
+  const int num_translations = animation->num_translation_soa_tracks();
+  for (int i = 0; i < num_translations; i += kChunkSize) {
+    const int count = math::Min(kChunkSize, num_translations - i);
+    internal::InterpSoaTranslation translations[kChunkSize];
+    SearchKeys(anim_ratio, i, count, num_translations,
+               animation->translations(), animation->translation_track_keys(),
+               interp);
+    outdated = 0xff >> (kChunkSize - count);
+    UpdateSoaTranslations(0, count, animation->translations(),
+                          animation->translation_ranges().begin + i * 2,
+                          interp, &outdated, mask, translation_tracks + i,
+                          translations, NULL);
+    InterpolatesFloat3(anim_ratio, count, translation_tracks + i, translations,
+                       mask, 0, &math::SoaTransform::translation,
+                       output.begin);
+  }
+  CopyConstants(animation->translation_constants(),
+                translation_tracks + num_translations, mask, 0,
+                &math::SoaTransform::translation, output.begin);
+  CopyIdentities(math::SoaFloat3::zero(),
+                 translation_tracks + num_translations +
+                     animation->translation_constants().Count(),
+                 animation->num_translation_identities(), mask, 0,
+                 &math::SoaTransform::translation, output.begin);
+
+  const uint16_t* rotation_tracks = animation->rotation_soa_tracks().begin;
+  const int num_rotations = animation->num_rotation_soa_tracks();
+  for (int i = 0; i < num_rotations; i += kChunkSize) {
+    const int count = math::Min(kChunkSize, num_rotations - i);
+    internal::InterpSoaRotation rotations[kChunkSize];
+    SearchKeys(anim_ratio, i, count, num_rotations, animation->rotations(),
+               animation->rotation_track_keys(), interp);
+    outdated = 0xff >> (kChunkSize - count);
+    UpdateSoaRotations(0, count, animation->rotations(), interp, &outdated,
+                       mask, rotation_tracks + i, rotations, NULL);
+    InterpolatesRotations(anim_ratio, count, rotation_tracks + i, rotations,
+                          mask, 0, output.begin);
+  }
+  CopyConstants(animation->rotation_constants(),
+                rotation_tracks + num_rotations, mask, 0,
+                &math::SoaTransform::rotation, output.begin);
+  CopyIdentities(math::SoaQuaternion::identity(),
+                 rotation_tracks + num_rotations +
+                     animation->rotation_constants().Count(),
+                 animation->num_rotation_identities(), mask, 0,
+                 &math::SoaTransform::rotation, output.begin);
+
+  const uint16_t* scale_tracks = animation->scale_soa_tracks().begin;
+  const int num_scales = animation->num_scale_soa_tracks();
+  for (int i = 0; i < num_scales; i += kChunkSize) {
+    const int count = math::Min(kChunkSize, num_scales - i);
+    internal::InterpSoaScale scales[kChunkSize];
+    SearchKeys(anim_ratio, i, count, num_scales, animation->scales(),
+               animation->scale_track_keys(), interp);
+    outdated = 0xff >> (kChunkSize - count);
+    UpdateSoaScales(0, count, animation->scales(),
+                    animation->scale_ranges().begin + i * 2, interp,
+                    &outdated, mask, scale_tracks + i, scales, NULL);
+    InterpolatesFloat3(anim_ratio, count, scale_tracks + i, scales, mask, 0,
+                       &math::SoaTransform::scale, output.begin);
+  }
+  CopyConstants(animation->scale_constants(), scale_tracks + num_scales, mask,
+                0, &math::SoaTransform::scale, output.begin);
+  CopyIdentities(math::SoaFloat3::one(),
+                 scale_tracks + num_scales +
+                     animation->scale_constants().Count(),
+                 animation->num_scale_identities(), mask, 0,
+                 &math::SoaTransform::scale, output.begin);
 
   return true;
 }
@@ -1476,6 +4513,9 @@ SamplingCache::SamplingCache(int _max_tracks)
       translation_cursor_(0),
       rotation_cursor_(0),
       scale_cursor_(0),
+      translation_reverse_cursor_(0),
+      rotation_reverse_cursor_(0),
+      scale_reverse_cursor_(0),
       outdated_translations_(NULL),
       outdated_rotations_(NULL),
       outdated_scales_(NULL) {
@@ -1535,17 +4575,197 @@ SamplingCache::~SamplingCache() {
   memory::default_allocator()->Deallocate(soa_translations_);
 }
 
-void SamplingCache::Step(const Animation& _animation, float _time) {
-  // The cache is invalidated if animation has changed or if it is being rewind.
-  if (animation_ != &_animation || _time < time_) {
+void SamplingCache::Step(const Animation& _animation, float _time,
+                         SamplingStats* _stats) {
+  // Selects the cheapest way to reach _time. Key frames can be walked from the
+  // current cache state, forward or backward, or the cache can be restarted
+  // from the closest seek point (or from the beginning if there's none).
+  const float interval = _animation.seek_interval();
+  const int point = FindSeekPoint(_animation, _time);
+  const float restart_time = static_cast<float>(point + 1) * interval;
+  bool restart;
+  if (animation_ != &_animation) {
+    // The cache is invalidated if animation has changed.
     animation_ = &_animation;
-    translation_cursor_ = 0;
-    rotation_cursor_ = 0;
-    scale_cursor_ = 0;
+    restart = true;
+    OZZ_SAMPLING_STATS_ADD(_stats, num_cache_invalidations, 1);
+  } else if (_time < time_) {
+    // Restarts if _time is closer to the restart point than to the current
+    // time, which is typically the case when an animation loops. Restarting is
+    // the only option if the animation has no reverse keys.
+    restart = !_animation.has_reverse_keys() ||
+              _time - restart_time < time_ - _time;
+  } else {
+    // Seeking isn't used while playing forward, as it requires to decompress
+    // all key frames again. It's only used if time is jumping forward farther
+    // than the next seek point.
+    restart = _time - time_ > interval && restart_time > time_;
+  }
+
+  if (restart) {
+    if (point >= 0) {
+      Seek(_animation.translation_seeks(), point,
+           _animation.num_translation_soa_tracks(), &translation_cursor_,
+           &translation_reverse_cursor_, translation_keys_,
+           outdated_translations_);
+      Seek(_animation.rotation_seeks(), point,
+           _animation.num_rotation_soa_tracks(), &rotation_cursor_,
+           &rotation_reverse_cursor_, rotation_keys_, outdated_rotations_);
+      Seek(_animation.scale_seeks(), point, _animation.num_scale_soa_tracks(),
+           &scale_cursor_, &scale_reverse_cursor_, scale_keys_,
+           outdated_scales_);
+      OZZ_SAMPLING_STATS_ADD(_stats, num_cache_seeks, 1);
+    } else {
+      translation_cursor_ = 0;
+      rotation_cursor_ = 0;
+      scale_cursor_ = 0;
+      OZZ_SAMPLING_STATS_ADD(_stats, num_cache_restarts, 1);
+    }
   }
   time_ = _time;
 }
 
+void SamplingCache::Update(const Animation& _animation, float _time,
+                           const unsigned char* _mask, int _begin, int _end,
+                           SamplingStats* _stats) {
+  OZZ_SAMPLING_STATS_ADD(_stats, num_samples, 1);
+
+  // Step the cache to this potentially new animation and time.
+  Step(_animation, _time, _stats);
+
+  // Key frames times are stored as ratios of the duration.
+  const float anim_ratio = TimeToRatio(_animation, _time);
+
+  // Fetch key frames from the animation to the cache a t = _time.
+  // Then updates outdated soa hot values. Only animated soa tracks are
+  // processed. Key frames are fetched for all soa tracks, as they're sorted
+  // by time, but only soa tracks within [_begin,_end[ are decompressed.
+  int from, to;
+  const int num_translations = _animation.num_translation_soa_tracks();
+  UpdateKeys(anim_ratio, num_translations, _animation.translations(),
+             _animation.reverse_translations(), &translation_cursor_,
+             &translation_reverse_cursor_, translation_keys_,
+             outdated_translations_, _stats);
+  FindSoaTracks(_animation.translation_soa_tracks().begin, num_translations,
+                _begin, _end, &from, &to);
+  UpdateSoaTranslations(from, to, _animation.translations(),
+                        _animation.translation_ranges().begin,
+                        translation_keys_, outdated_translations_, _mask,
+                        _animation.translation_soa_tracks().begin,
+                        soa_translations_, _stats);
+
+  const int num_rotations = _animation.num_rotation_soa_tracks();
+  UpdateKeys(anim_ratio, num_rotations, _animation.rotations(),
+             _animation.reverse_rotations(), &rotation_cursor_,
+             &rotation_reverse_cursor_, rotation_keys_, outdated_rotations_,
+             _stats);
+  FindSoaTracks(_animation.rotation_soa_tracks().begin, num_rotations, _begin,
+                _end, &from, &to);
+  UpdateSoaRotations(from, to, _animation.rotations(), rotation_keys_,
+                     outdated_rotations_, _mask,
+                     _animation.rotation_soa_tracks().begin, soa_rotations_,
+                     _stats);
+
+  const int num_scales = _animation.num_scale_soa_tracks();
+  UpdateKeys(anim_ratio, num_scales, _animation.scales(),
+             _animation.reverse_scales(), &scale_cursor_,
+             &scale_reverse_cursor_, scale_keys_, outdated_scales_, _stats);
+  FindSoaTracks(_animation.scale_soa_tracks().begin, num_scales, _begin, _end,
+                &from, &to);
+  UpdateSoaScales(from, to, _animation.scales(),
+                  _animation.scale_ranges().begin, scale_keys_,
+                  outdated_scales_, _mask, _animation.scale_soa_tracks().begin,
+                  soa_scales_, _stats);
+}
+
+void SamplingCache::Interpolate(const Animation& _animation, float _time,
+                                const unsigned char* _mask, int _begin,
+                                int _end, math::SoaTransform* _output) const {
+  const float anim_ratio = TimeToRatio(_animation, _time);
+
+  // Interpolates animated soa tracks within [_begin,_end[, and copies
+  // constant and identity ones.
+  int from, to;
+  const uint16_t* translation_tracks =
+      _animation.translation_soa_tracks().begin;
+  const int num_translations = _animation.num_translation_soa_tracks();
+  FindSoaTracks(translation_tracks, num_translations, _begin, _end, &from,
+                &to);
+  InterpolatesFloat3(anim_ratio, to - from, translation_tracks + from,
+                     soa_translations_ + from, _mask, _begin,
+                     &math::SoaTransform::translation, _output);
+  const ozz::Range<const math::SoaFloat3> translation_constants =
+      _animation.translation_constants();
+  FindSoaTracks(translation_tracks + num_translations,
+                static_cast<int>(translation_constants.Count()), _begin, _end,
+                &from, &to);
+  CopyConstants(ozz::Range<const math::SoaFloat3>(
+                    translation_constants.begin + from,
+                    translation_constants.begin + to),
+                translation_tracks + num_translations + from, _mask, _begin,
+                &math::SoaTransform::translation, _output);
+  const uint16_t* translation_identities =
+      translation_tracks + num_translations + translation_constants.Count();
+  FindSoaTracks(translation_identities,
+                _animation.num_translation_identities(), _begin, _end, &from,
+                &to);
+  CopyIdentities(math::SoaFloat3::zero(), translation_identities + from,
+                 to - from, _mask, _begin, &math::SoaTransform::translation,
+                 _output);
+
+  const uint16_t* rotation_tracks = _animation.rotation_soa_tracks().begin;
+  const int num_rotations = _animation.num_rotation_soa_tracks();
+  FindSoaTracks(rotation_tracks, num_rotations, _begin, _end, &from, &to);
+  InterpolatesRotations(anim_ratio, to - from, rotation_tracks + from,
+                        soa_rotations_ + from, _mask, _begin, _output);
+  const ozz::Range<const math::SoaQuaternion> rotation_constants =
+      _animation.rotation_constants();
+  FindSoaTracks(rotation_tracks + num_rotations,
+                static_cast<int>(rotation_constants.Count()), _begin, _end,
+                &from, &to);
+  CopyConstants(ozz::Range<const math::SoaQuaternion>(
+                    rotation_constants.begin + from,
+                    rotation_constants.begin + to),
+                rotation_tracks + num_rotations + from, _mask, _begin,
+                &math::SoaTransform::rotation, _output);
+  const uint16_t* rotation_identities =
+      rotation_tracks + num_rotations + rotation_constants.Count();
+  FindSoaTracks(rotation_identities, _animation.num_rotation_identities(),
+                _begin, _end, &from, &to);
+  CopyIdentities(math::SoaQuaternion::identity(), rotation_identities + from,
+                 to - from, _mask, _begin, &math::SoaTransform::rotation,
+                 _output);
+
+  const uint16_t* scale_tracks = _animation.scale_soa_tracks().begin;
+  const int num_scales = _animation.num_scale_soa_tracks();
+  FindSoaTracks(scale_tracks, num_scales, _begin, _end, &from, &to);
+  InterpolatesFloat3(anim_ratio, to - from, scale_tracks + from,
+                     soa_scales_ + from, _mask, _begin,
+                     &math::SoaTransform::scale, _output);
+  const ozz::Range<const math::SoaFloat3> scale_constants =
+      _animation.scale_constants();
+  FindSoaTracks(scale_tracks + num_scales,
+                static_cast<int>(scale_constants.Count()), _begin, _end, &from,
+                &to);
+  CopyConstants(ozz::Range<const math::SoaFloat3>(scale_constants.begin + from,
+                                                  scale_constants.begin + to),
+                scale_tracks + num_scales + from, _mask, _begin,
+                &math::SoaTransform::scale, _output);
+  const uint16_t* scale_identities =
+      scale_tracks + num_scales + scale_constants.Count();
+  FindSoaTracks(scale_identities, _animation.num_scale_identities(), _begin,
+                _end, &from, &to);
+  CopyIdentities(math::SoaFloat3::one(), scale_identities + from, to - from,
+                 _mask, _begin, &math::SoaTransform::scale, _output);
+}
+
+void SamplingCache::Sample(const Animation& _animation, float _time,
+                           const unsigned char* _mask, int _begin, int _end,
+                           math::SoaTransform* _output, SamplingStats* _stats) {
+  Update(_animation, _time, _mask, _begin, _end, _stats);
+  Interpolate(_animation, _time, _mask, _begin, _end, _output);
+}
+
 void SamplingCache::Invalidate() {
   animation_ = NULL;
   time_ = 0.f;
@@ -1644,10 +4864,12 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   OZZ_STATIC_ASSERT(
       OZZ_ALIGN_OF(math::SoaTransform) >= OZZ_ALIGN_OF(char*) &&
       OZZ_ALIGN_OF(char*) >= OZZ_ALIGN_OF(Skeleton::JointProperties) &&
-      OZZ_ALIGN_OF(Skeleton::JointProperties) >= OZZ_ALIGN_OF(char));
+      OZZ_ALIGN_OF(Skeleton::JointProperties) >= OZZ_ALIGN_OF(uint16_t) &&
+      OZZ_ALIGN_OF(uint16_t) >= OZZ_ALIGN_OF(char));
 
   assert(bind_pose_.Size() == 0 && joint_names_.Size() == 0 &&
-         joint_properties_.Size() == 0);
+         joint_properties_.Size() == 0 && level_joints_.Size() == 0 &&
+         levels_.Size() == 0);
 
   // Early out if no joint.
   if (_num_joints == 0) {
@@ -1660,8 +4882,11 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   const size_t names_size = _num_joints * sizeof(char*);
   const size_t properties_size =
       _num_joints * sizeof(Skeleton::JointProperties);
-  const size_t buffer_size =
-      names_size + _chars_size + properties_size + bind_poses_size;
+  const size_t level_joints_size = _num_joints * sizeof(uint16_t);
+  // There are at most as many levels as joints, plus the last element.
+  const size_t levels_size = (_num_joints + 1) * sizeof(uint16_t);
+  const size_t buffer_size = names_size + _chars_size + properties_size +
+                             level_joints_size + levels_size + bind_poses_size;
 
   // Allocates whole buffer.
   char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
@@ -1687,6 +4912,18 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   buffer += properties_size;
   joint_properties_.end = reinterpret_cast<Skeleton::JointProperties*>(buffer);
 
+  // Level joints.
+  level_joints_.begin = reinterpret_cast<uint16_t*>(buffer);
+  assert(math::IsAligned(level_joints_.begin, OZZ_ALIGN_OF(uint16_t)));
+  buffer += level_joints_size;
+  level_joints_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  // Levels, whose range end is set by ComputeLevels.
+  levels_.begin = reinterpret_cast<uint16_t*>(buffer);
+  assert(math::IsAligned(levels_.begin, OZZ_ALIGN_OF(uint16_t)));
+  buffer += levels_size;
+  levels_.end = reinterpret_cast<uint16_t*>(buffer);
+
   // Remaning buffer will be used to store joint names.
   return buffer;
 }
@@ -1696,6 +4933,48 @@ void Skeleton::Deallocate() {
   bind_pose_.Clear();
   joint_names_.Clear();
   joint_properties_.Clear();
+  level_joints_.Clear();
+  levels_.Clear();
+}
+
+void Skeleton::ComputeLevels() {
+  // Early out if no joint, levels buffers aren't allocated.
+  const int num_joints = this->num_joints();
+  if (num_joints == 0) {
+    return;
+  }
+  assert(level_joints_.Count() == static_cast<size_t>(num_joints) &&
+         levels_.Count() >= static_cast<size_t>(num_joints + 1));
+
+  // Computes joints depth. Parents precede their children, so a parent depth
+  // is known before its children's. levels_ is used to count joints per depth,
+  // shifted by one so that it can then be turned into offsets in place.
+  uint16_t depths[kMaxJoints];
+  std::memset(levels_.begin, 0, levels_.Size());
+  int num_levels = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = joint_properties_.begin[i].parent;
+    const int depth = parent == kNoParentIndex ? 0 : depths[parent] + 1;
+    depths[i] = static_cast<uint16_t>(depth);
+    ++levels_.begin[depth + 1];
+    num_levels = math::Max(num_levels, depth + 1);
+  }
+
+  // Converts counts to offsets.
+  for (int l = 0; l < num_levels; ++l) {
+    levels_.begin[l + 1] += levels_.begin[l];
+  }
+  levels_.end = levels_.begin + num_levels + 1;
+
+  // Distributes joints to their level, in increasing index order. Level
+  // offsets are used as insertion cursors, then restored.
+  for (int i = 0; i < num_joints; ++i) {
+    level_joints_.begin[levels_.begin[depths[i]]++] = static_cast<uint16_t>(i);
+  }
+  for (int l = num_levels; l > 0; --l) {
+    levels_.begin[l] = levels_.begin[l - 1];
+  }
+  levels_.begin[0] = 0;
 }
 
 void Skeleton::Save(ozz::io::OArchive& _archive) const {
@@ -1762,6 +5041,9 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 
   _archive >> ozz::io::MakeArray(joint_properties_);
   _archive >> ozz::io::MakeArray(bind_pose_);
+
+  // Levels aren't serialized, as they are deduced from joint properties.
+  ComputeLevels();
 }
 }  // animation
 }  // ozz
@@ -172,6 +172,16 @@ TEST(Build, AnimationBuilder) {
     Animation* anim = builder(raw_animation);
     EXPECT_TRUE(anim != NULL);
     EXPECT_EQ(anim->num_tracks(), 46);
+    // Empty tracks are identity, so they have no key frame, no quantization
+    // range nor constant value.
+    EXPECT_EQ(anim->num_translation_soa_tracks(), 0);
+    EXPECT_EQ(anim->translation_constants().Count(), 0u);
+    EXPECT_EQ(anim->num_translation_identities(), 12);
+    EXPECT_EQ(anim->num_rotation_identities(), 12);
+    EXPECT_EQ(anim->num_scale_identities(), 12);
+    EXPECT_EQ(anim->translation_ranges().Count(), 0u);
+    EXPECT_EQ(anim->scale_ranges().Count(), 0u);
+    EXPECT_TRUE(anim->translations().begin == anim->translations().end);
     ozz::memory::default_allocator()->Delete(anim);
   }
 
@@ -336,3 +346,294 @@ TEST(Sort, AnimationBuilder) {
     ozz::memory::default_allocator()->Delete(animation);
   }
 }
+
+TEST(SeekPoints, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  // Only translations of the first soa track are animated.
+  const RawAnimation::TranslationKey first = {
+      .2f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[3].translations.push_back(first);
+  const RawAnimation::TranslationKey second = {
+      .5f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[3].translations.push_back(second);
+
+  struct {
+    float interval;
+    int num_seek_points;
+  } expected[] = {{0.f, 0}, {-1.f, 0}, {2.f, 0}, {1.f, 0},
+                  {.5f, 1}, {.3f, 3},  {.1f, 9}};
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected); ++i) {
+    AnimationBuilder builder;
+    builder.seek_interval = expected[i].interval;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+
+    EXPECT_EQ(animation->num_seek_points(), expected[i].num_seek_points);
+    EXPECT_FLOAT_EQ(animation->seek_interval(),
+                    expected[i].num_seek_points ? expected[i].interval : 0.f);
+
+    // A seek point stores 2 cursors and 2 keys per animated track.
+    const size_t num_seeks = expected[i].num_seek_points;
+    EXPECT_EQ(animation->translation_seeks().Count(), num_seeks * (2 + 4 * 2));
+    EXPECT_EQ(animation->rotation_seeks().Count(), num_seeks * 2);
+    EXPECT_EQ(animation->scale_seeks().Count(), num_seeks * 2);
+
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(ReverseKeys, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  const RawAnimation::TranslationKey first = {
+      .2f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(first);
+  const RawAnimation::TranslationKey second = {
+      .5f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(second);
+
+  {  // Reverse keys aren't built by default.
+    AnimationBuilder builder;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->has_reverse_keys());
+    EXPECT_EQ(animation->reverse_translations().Count(), 0u);
+    EXPECT_EQ(animation->reverse_rotations().Count(), 0u);
+    EXPECT_EQ(animation->reverse_scales().Count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // All keys but the last of each animated track are referenced. Track 0
+     // has 4 keys once first and last keys are added, other tracks have 2.
+    AnimationBuilder builder;
+    builder.reverse_keys = true;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_TRUE(animation->has_reverse_keys());
+    EXPECT_EQ(animation->reverse_translations().Count(), 3u + 1u + 1u + 1u);
+    EXPECT_EQ(animation->reverse_rotations().Count(), 0u);
+    EXPECT_EQ(animation->reverse_scales().Count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Reverse keys can't index more than kMaxReverseKeys keys. A key per
+     // time ratio, plus the keys of the 3 other tracks, are too many.
+    raw_animation.tracks[0].translations.clear();
+    const int num_keys = Animation::kMaxReverseKeys;
+    for (int i = 0; i < num_keys; ++i) {
+      const RawAnimation::TranslationKey key = {
+          i / (num_keys - 1.f), ozz::math::Float3(i & 1 ? 1.f : 0.f, 0.f, 0.f)};
+      raw_animation.tracks[0].translations.push_back(key);
+    }
+    ASSERT_TRUE(raw_animation.Validate());
+
+    AnimationBuilder builder;
+    builder.reverse_keys = true;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->has_reverse_keys());
+    EXPECT_EQ(animation->reverse_translations().Count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(TimePrecision, AnimationBuilder) {
+  // Key times are stored as 16 bits ratios of the duration. Keys that are
+  // closer than duration / 65535 can't be distinguished, so they're merged and
+  // the value of the last one is kept.
+  RawAnimation raw_animation;
+  raw_animation.duration = 10.f;
+  raw_animation.tracks.resize(1);
+
+  const RawAnimation::TranslationKey a = {0.f,
+                                          ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(a);
+  const RawAnimation::TranslationKey b = {5.f,
+                                          ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(b);
+  const RawAnimation::TranslationKey c = {5.00001f,
+                                          ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(c);
+  const RawAnimation::TranslationKey d = {9.99999f,
+                                          ozz::math::Float3(3.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(d);
+  ASSERT_TRUE(raw_animation.Validate());
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+
+  // Value reached after the discontinuity at t = 5 is preserved.
+  job.time = 5.000005f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 2.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Previous key interpolates toward the merged key value.
+  job.time = 2.5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Last key was snapped to the duration.
+  job.time = 10.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 3.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(ConstantTracks, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(10);
+
+  // Soa track 0 translations are constant, even though keys are repeated.
+  const RawAnimation::TranslationKey constant0 = {
+      0.f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[1].translations.push_back(constant0);
+  const RawAnimation::TranslationKey constant1 = {
+      .5f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[1].translations.push_back(constant1);
+
+  // Soa track 1 translations are animated by track 6 only.
+  const RawAnimation::TranslationKey animated0 = {
+      .2f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[6].translations.push_back(animated0);
+  const RawAnimation::TranslationKey animated1 = {
+      .8f, ozz::math::Float3(4.f, 0.f, 0.f)};
+  raw_animation.tracks[6].translations.push_back(animated1);
+  raw_animation.tracks[5].translations.push_back(constant0);
+  raw_animation.tracks[5].translations.push_back(constant1);
+
+  // Soa track 2 rotations are constant.
+  const RawAnimation::RotationKey rotation = {
+      .5f, ozz::math::Quaternion(0.f, 0.f, -2.f, 0.f)};
+  raw_animation.tracks[9].rotations.push_back(rotation);
+
+  // Soa track 1 rotations are identity, once normalized.
+  const RawAnimation::RotationKey identity = {
+      .5f, ozz::math::Quaternion(0.f, 0.f, 0.f, -2.f)};
+  raw_animation.tracks[4].rotations.push_back(identity);
+
+  AnimationBuilder builder;
+  builder.reverse_keys = true;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_soa_tracks(), 3);
+
+  // Only soa track 1 translations are animated, with 2 keys per track but
+  // track 6, as constant track 5 is reduced to 2 keys. Reverse keys reference
+  // all keys but the last of each track.
+  EXPECT_EQ(animation->num_translation_soa_tracks(), 1);
+  EXPECT_EQ(animation->num_rotation_soa_tracks(), 0);
+  EXPECT_EQ(animation->num_scale_soa_tracks(), 0);
+  EXPECT_EQ(animation->reverse_translations().Count(), 4u + 2u);
+  EXPECT_TRUE(animation->rotations().begin == animation->rotations().end);
+  EXPECT_TRUE(animation->scales().begin == animation->scales().end);
+  EXPECT_EQ(animation->translation_ranges().Count(), 2u);
+  EXPECT_EQ(animation->scale_ranges().Count(), 0u);
+
+  // Animated soa tracks are listed first, then constant and identity ones.
+  // Identity soa tracks have no constant value.
+  ASSERT_EQ(animation->translation_soa_tracks().Count(), 3u);
+  EXPECT_EQ(animation->translation_soa_tracks().begin[0], 1);
+  EXPECT_EQ(animation->translation_soa_tracks().begin[1], 0);
+  EXPECT_EQ(animation->translation_soa_tracks().begin[2], 2);
+  ASSERT_EQ(animation->translation_constants().Count(), 1u);
+  EXPECT_EQ(animation->num_translation_identities(), 1);
+  EXPECT_SOAFLOAT3_EQ(animation->translation_constants().begin[0], 0.f, 1.f,
+                      0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 0.f, 3.f, 0.f, 0.f);
+
+  // Constant rotations are normalized.
+  ASSERT_EQ(animation->rotation_soa_tracks().Count(), 3u);
+  EXPECT_EQ(animation->rotation_soa_tracks().begin[0], 2);
+  EXPECT_EQ(animation->rotation_soa_tracks().begin[1], 0);
+  EXPECT_EQ(animation->rotation_soa_tracks().begin[2], 1);
+  ASSERT_EQ(animation->rotation_constants().Count(), 1u);
+  EXPECT_EQ(animation->num_rotation_identities(), 2);
+  EXPECT_SOAQUATERNION_EQ(animation->rotation_constants().begin[0], 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, -1.f, 0.f, 0.f,
+                          1.f, 0.f, 1.f, 1.f);
+  EXPECT_EQ(animation->scale_constants().Count(), 0u);
+  EXPECT_EQ(animation->num_scale_identities(), 3);
+
+  // Identity soa tracks are sampled.
+  ozz::animation::SamplingCache cache(animation->num_tracks());
+  ozz::math::SoaTransform output[3];
+  ozz::animation::SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 3;
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[2].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ(output[1].rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ(output[0].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                      1.f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(TrackKeys, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  for (int i = 0; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .5f, ozz::math::Float3(static_cast<float>(i), 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+
+  {  // Per-track key indices aren't built by default.
+    AnimationBuilder builder;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->has_track_keys());
+    EXPECT_EQ(animation->translation_track_keys().Count(), 0u);
+    EXPECT_EQ(animation->rotation_track_keys().Count(), 0u);
+    EXPECT_EQ(animation->scale_track_keys().Count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  AnimationBuilder builder;
+  builder.track_keys = true;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_TRUE(animation->has_track_keys());
+  ASSERT_EQ(animation->num_translation_soa_tracks(), 1);
+
+  // An offset per track plus one, followed by keys of every track in time
+  // order.
+  const int expected[] = {0, 3, 5, 7, 9,               // Offsets.
+                          0, 4, 8, 1, 5, 2, 6, 3, 7};  // Keys.
+  const ozz::Range<const int> track_keys = animation->translation_track_keys();
+  ASSERT_EQ(track_keys.Count(), OZZ_ARRAY_SIZE(expected));
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected); ++i) {
+    EXPECT_EQ(track_keys.begin[i], expected[i]);
+  }
+
+  // Constant rotations have no key, so only the end offset remains.
+  ASSERT_EQ(animation->rotation_track_keys().Count(), 1u);
+  EXPECT_EQ(animation->rotation_track_keys().begin[0], 0);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
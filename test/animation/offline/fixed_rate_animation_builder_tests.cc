@@ -0,0 +1,138 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/fixed_rate_animation_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+
+#include "ozz/animation/runtime/fixed_rate_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::FixedRateAnimation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::FixedRateAnimationBuilder;
+
+TEST(Error, FixedRateAnimationBuilder) {
+  // Instantiates a builder objects with default parameters.
+  FixedRateAnimationBuilder builder;
+  EXPECT_FLOAT_EQ(builder.frequency, 30.f);
+
+  {  // Building fails because animation duration must be > 0.
+    RawAnimation raw_animation;
+    raw_animation.duration = 0.f;
+    EXPECT_FALSE(raw_animation.Validate());
+    EXPECT_TRUE(!builder(raw_animation));
+  }
+
+  {  // Building an animation with too much tracks fails.
+    RawAnimation raw_animation;
+    raw_animation.tracks.resize(ozz::animation::Skeleton::kMaxJoints + 1);
+    EXPECT_FALSE(raw_animation.Validate());
+    EXPECT_TRUE(!builder(raw_animation));
+  }
+
+  {  // Building an animation with unsorted keys fails.
+    RawAnimation raw_animation;
+    raw_animation.tracks.resize(1);
+    const RawAnimation::TranslationKey first_key = {.8f,
+                                                    ozz::math::Float3::zero()};
+    raw_animation.tracks[0].translations.push_back(first_key);
+    const RawAnimation::TranslationKey second_key = {.2f,
+                                                     ozz::math::Float3::zero()};
+    raw_animation.tracks[0].translations.push_back(second_key);
+    EXPECT_FALSE(raw_animation.Validate());
+    EXPECT_TRUE(!builder(raw_animation));
+  }
+
+  {  // Building with an invalid frequency fails.
+    RawAnimation raw_animation;
+    EXPECT_TRUE(raw_animation.Validate());
+
+    FixedRateAnimationBuilder invalid_builder;
+    invalid_builder.frequency = 0.f;
+    EXPECT_TRUE(!invalid_builder(raw_animation));
+    invalid_builder.frequency = -30.f;
+    EXPECT_TRUE(!invalid_builder(raw_animation));
+  }
+
+  {  // Building default animation succeeds.
+    RawAnimation raw_animation;
+    EXPECT_TRUE(raw_animation.Validate());
+
+    FixedRateAnimation* anim = builder(raw_animation);
+    ASSERT_TRUE(anim != NULL);
+    EXPECT_EQ(anim->num_tracks(), 0);
+    EXPECT_EQ(anim->num_frames(), 31);
+    EXPECT_TRUE(anim->keys().begin == anim->keys().end);
+    ozz::memory::default_allocator()->Delete(anim);
+  }
+
+  {  // Building an animation with max joints succeeds.
+    RawAnimation raw_animation;
+    raw_animation.tracks.resize(ozz::animation::Skeleton::kMaxJoints);
+    EXPECT_TRUE(raw_animation.Validate());
+
+    FixedRateAnimation* anim = builder(raw_animation);
+    ASSERT_TRUE(anim != NULL);
+    EXPECT_EQ(anim->num_tracks(), ozz::animation::Skeleton::kMaxJoints);
+    ozz::memory::default_allocator()->Delete(anim);
+  }
+}
+
+TEST(Frames, FixedRateAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.name = "frames";
+  raw_animation.tracks.resize(5);
+
+  struct {
+    float duration;
+    float frequency;
+    int num_frames;
+  } expected[] = {{1.f, 30.f, 31},  {1.f, 1.f, 2},  {1.f, .1f, 2},
+                  {2.f, 10.f, 21}, {.5f, 15.f, 9}, {.01f, 30.f, 2}};
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected); ++i) {
+    raw_animation.duration = expected[i].duration;
+
+    FixedRateAnimationBuilder builder;
+    builder.frequency = expected[i].frequency;
+    FixedRateAnimation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+
+    EXPECT_FLOAT_EQ(animation->duration(), expected[i].duration);
+    EXPECT_EQ(animation->num_tracks(), 5);
+    EXPECT_EQ(animation->num_soa_tracks(), 2);
+    EXPECT_EQ(animation->num_frames(), expected[i].num_frames);
+    EXPECT_STREQ(animation->name(), "frames");
+
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
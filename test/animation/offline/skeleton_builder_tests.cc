@@ -830,6 +830,107 @@ TEST(TPose, SkeletonBuilder) {
   ozz::memory::default_allocator()->Delete(skeleton);
 }
 
+TEST(Levels, SkeletonBuilder) {
+  // Instantiates a builder objects with default parameters.
+  SkeletonBuilder builder;
+
+  {  // No joint.
+    RawSkeleton raw_skeleton;
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    EXPECT_EQ(skeleton->num_levels(), 0);
+    EXPECT_EQ(skeleton->levels().Count(), 0u);
+    EXPECT_EQ(skeleton->level_joints().Count(), 0u);
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  {  // Multiple roots are in the same level.
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(2);
+    raw_skeleton.roots[0].children.resize(1);
+    raw_skeleton.roots[1].children.resize(2);
+
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    ASSERT_EQ(skeleton->num_joints(), 5);
+    ASSERT_EQ(skeleton->num_levels(), 2);
+    EXPECT_EQ(skeleton->levels()[0], 0);
+    EXPECT_EQ(skeleton->levels()[1], 2);
+    EXPECT_EQ(skeleton->levels()[2], 5);
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_EQ(skeleton->level_joints()[i], i);
+    }
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  {  // Levels are depths, even though siblings subtrees aren't interleaved.
+    /*
+       *
+       |
+       a
+      / \
+     b   c
+     |   |
+     d   e
+     |
+     f
+    */
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    RawSkeleton::Joint& a = raw_skeleton.roots[0];
+    a.name = "a";
+    a.children.resize(2);
+    RawSkeleton::Joint& b = a.children[0];
+    b.name = "b";
+    b.children.resize(1);
+    b.children[0].name = "d";
+    b.children[0].children.resize(1);
+    b.children[0].children[0].name = "f";
+    RawSkeleton::Joint& c = a.children[1];
+    c.name = "c";
+    c.children.resize(1);
+    c.children[0].name = "e";
+
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    ASSERT_EQ(skeleton->num_joints(), 6);
+
+    // Joints are ordered a, b, c, d, f, e.
+    EXPECT_STREQ(skeleton->joint_names()[4], "f");
+    EXPECT_STREQ(skeleton->joint_names()[5], "e");
+
+    // Levels are a, b c, d e and f. Joint indices are unchanged.
+    ASSERT_EQ(skeleton->num_levels(), 4);
+    EXPECT_EQ(skeleton->levels()[0], 0);
+    EXPECT_EQ(skeleton->levels()[1], 1);
+    EXPECT_EQ(skeleton->levels()[2], 3);
+    EXPECT_EQ(skeleton->levels()[3], 5);
+    EXPECT_EQ(skeleton->levels()[4], 6);
+    ASSERT_EQ(skeleton->level_joints().Count(), 6u);
+    EXPECT_EQ(skeleton->level_joints()[0], 0);
+    EXPECT_EQ(skeleton->level_joints()[1], 1);
+    EXPECT_EQ(skeleton->level_joints()[2], 2);
+    EXPECT_EQ(skeleton->level_joints()[3], 3);
+    EXPECT_EQ(skeleton->level_joints()[4], 5);
+    EXPECT_EQ(skeleton->level_joints()[5], 4);
+
+    // Parents always belong to the previous level.
+    for (int l = 1; l < skeleton->num_levels(); ++l) {
+      for (int i = skeleton->levels()[l]; i < skeleton->levels()[l + 1]; ++i) {
+        const int parent =
+            skeleton->joint_properties()[skeleton->level_joints()[i]].parent;
+        bool found = false;
+        for (int j = skeleton->levels()[l - 1]; j < skeleton->levels()[l];
+             ++j) {
+          found |= skeleton->level_joints()[j] == parent;
+        }
+        EXPECT_TRUE(found);
+      }
+    }
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+}
+
 TEST(MaxJoints, SkeletonBuilder) {
   // Instantiates a builder objects with default parameters.
   SkeletonBuilder builder;
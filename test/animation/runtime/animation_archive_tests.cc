@@ -92,8 +92,12 @@ TEST(Filled, AnimationSerialize) {
     raw_animation.tracks[0].scales.push_back(s_key);
 
     AnimationBuilder builder;
+    builder.seek_interval = .3f;
+    builder.reverse_keys = true;
+    builder.track_keys = true;
     o_animation = builder(raw_animation);
     ASSERT_TRUE(o_animation != NULL);
+    ASSERT_EQ(o_animation->num_seek_points(), 3);
   }
 
   for (int e = 0; e < 2; ++e) {
@@ -114,6 +118,54 @@ TEST(Filled, AnimationSerialize) {
     ASSERT_FLOAT_EQ(o_animation->duration(), i_animation.duration());
     ASSERT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
     EXPECT_EQ(o_animation->size(), i_animation.size());
+    EXPECT_EQ(o_animation->num_translation_soa_tracks(),
+              i_animation.num_translation_soa_tracks());
+    EXPECT_EQ(o_animation->num_rotation_soa_tracks(),
+              i_animation.num_rotation_soa_tracks());
+    EXPECT_EQ(o_animation->num_scale_soa_tracks(),
+              i_animation.num_scale_soa_tracks());
+    EXPECT_EQ(memcmp(o_animation->rotation_soa_tracks().begin,
+                     i_animation.rotation_soa_tracks().begin,
+                     o_animation->rotation_soa_tracks().Size()), 0);
+    ASSERT_EQ(o_animation->translation_constants().Count(),
+              i_animation.translation_constants().Count());
+    EXPECT_EQ(memcmp(o_animation->translation_constants().begin,
+                     i_animation.translation_constants().begin,
+                     o_animation->translation_constants().Size()), 0);
+    EXPECT_TRUE(i_animation.has_reverse_keys());
+    ASSERT_EQ(o_animation->reverse_translations().Count(),
+              i_animation.reverse_translations().Count());
+    EXPECT_EQ(memcmp(o_animation->reverse_translations().begin,
+                     i_animation.reverse_translations().begin,
+                     o_animation->reverse_translations().Size()), 0);
+    ASSERT_EQ(o_animation->reverse_rotations().Count(),
+              i_animation.reverse_rotations().Count());
+    EXPECT_EQ(memcmp(o_animation->reverse_rotations().begin,
+                     i_animation.reverse_rotations().begin,
+                     o_animation->reverse_rotations().Size()), 0);
+    ASSERT_EQ(o_animation->reverse_scales().Count(),
+              i_animation.reverse_scales().Count());
+    EXPECT_EQ(memcmp(o_animation->reverse_scales().begin,
+                     i_animation.reverse_scales().begin,
+                     o_animation->reverse_scales().Size()), 0);
+
+    EXPECT_FLOAT_EQ(o_animation->seek_interval(), i_animation.seek_interval());
+    ASSERT_EQ(o_animation->num_seek_points(), i_animation.num_seek_points());
+    EXPECT_EQ(memcmp(o_animation->translation_seeks().begin,
+                     i_animation.translation_seeks().begin,
+                     o_animation->translation_seeks().Size()), 0);
+    EXPECT_EQ(memcmp(o_animation->rotation_seeks().begin,
+                     i_animation.rotation_seeks().begin,
+                     o_animation->rotation_seeks().Size()), 0);
+    EXPECT_EQ(memcmp(o_animation->scale_seeks().begin,
+                     i_animation.scale_seeks().begin,
+                     o_animation->scale_seeks().Size()), 0);
+    EXPECT_TRUE(i_animation.has_track_keys());
+    ASSERT_EQ(o_animation->translation_track_keys().Count(),
+              i_animation.translation_track_keys().Count());
+    EXPECT_EQ(memcmp(o_animation->translation_track_keys().begin,
+                     i_animation.translation_track_keys().begin,
+                     o_animation->translation_track_keys().Size()), 0);
 
     // Needs to sample to test the animation.
     ozz::animation::SamplingJob job;
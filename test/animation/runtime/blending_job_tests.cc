@@ -31,6 +31,11 @@
 #include "ozz/base/maths/gtest_math_helper.h"
 
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
 
 using ozz::animation::BlendingJob;
 
@@ -1212,3 +1217,455 @@ TEST(AdditiveJointWeight, BlendingJob) {
                             1.f/20.f, 1.f/11.f, 1.f, 1.f);
   }
 }
+
+TEST(JobValiditySoaRanges, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_poses[3] = {identity, identity, identity};
+  const ozz::math::SoaTransform input_transforms[3] = {identity, identity,
+                                                       identity};
+  ozz::math::SoaTransform output_transforms[3];
+
+  BlendingJob::Layer layers[1];
+  layers[0].transform = input_transforms;
+
+  BlendingJob job;
+  job.layers = layers;
+  job.bind_pose = bind_poses;
+  job.output = output_transforms;
+
+  {  // Valid sorted ranges.
+    const BlendingJob::SoaJointRange ranges[2] = {{0, 1}, {2, 3}};
+    layers[0].soa_ranges = ranges;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Valid empty ranges.
+    const BlendingJob::SoaJointRange ranges[2] = {{1, 1}, {1, 2}};
+    layers[0].soa_ranges = ranges;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Invalid overlapping ranges.
+    const BlendingJob::SoaJointRange ranges[2] = {{0, 2}, {1, 3}};
+    layers[0].soa_ranges = ranges;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid unsorted ranges.
+    const BlendingJob::SoaJointRange ranges[2] = {{2, 3}, {0, 1}};
+    layers[0].soa_ranges = ranges;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid reversed range.
+    const BlendingJob::SoaJointRange ranges[1] = {{2, 1}};
+    layers[0].soa_ranges = ranges;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid range exceeding bind pose.
+    const BlendingJob::SoaJointRange ranges[1] = {{2, 4}};
+    layers[0].soa_ranges = ranges;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid range end.
+    const BlendingJob::SoaJointRange ranges[1] = {{0, 1}};
+    layers[0].soa_ranges.begin = ranges;
+    layers[0].soa_ranges.end = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Valid additive layer ranges.
+    const BlendingJob::SoaJointRange ranges[1] = {{1, 3}};
+    layers[0].soa_ranges = ranges;
+    job.layers = ozz::Range<const BlendingJob::Layer>();
+    job.additive_layers = layers;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(ComputeSoaJointRanges, BlendingJob) {
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+  const ozz::math::SimdFloat4 weights[6] = {
+      zero,
+      ozz::math::simd_float4::Load(0.f, 0.f, .5f, 0.f),
+      ozz::math::simd_float4::Load(-1.f, 1.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(-1.f, 0.f, -2.f, 0.f),
+      zero,
+      ozz::math::simd_float4::one()};
+
+  BlendingJob::SoaJointRange ranges[3];
+  const ozz::Range<BlendingJob::SoaJointRange> computed =
+      ozz::animation::ComputeSoaJointRanges(
+          ozz::Range<const ozz::math::SimdFloat4>(weights),
+          ozz::Range<BlendingJob::SoaJointRange>(ranges));
+  ASSERT_EQ(computed.begin, ranges);
+  ASSERT_EQ(computed.Count(), 2u);
+  EXPECT_EQ(ranges[0].begin, 1);
+  EXPECT_EQ(ranges[0].end, 3);
+  EXPECT_EQ(ranges[1].begin, 5);
+  EXPECT_EQ(ranges[1].end, 6);
+
+  // No weight.
+  const ozz::Range<BlendingJob::SoaJointRange> none =
+      ozz::animation::ComputeSoaJointRanges(
+          ozz::Range<const ozz::math::SimdFloat4>(weights, 1),
+          ozz::Range<BlendingJob::SoaJointRange>(ranges));
+  EXPECT_EQ(none.begin, ranges);
+  EXPECT_EQ(none.Count(), 0u);
+
+  // All zero weights return an empty range, which isn't NULL as no soa joint is
+  // affected.
+  const ozz::math::SimdFloat4 zeros[3] = {zero, zero, zero};
+  const ozz::Range<BlendingJob::SoaJointRange> all_zero =
+      ozz::animation::ComputeSoaJointRanges(
+          ozz::Range<const ozz::math::SimdFloat4>(zeros),
+          ozz::Range<BlendingJob::SoaJointRange>(ranges));
+  EXPECT_TRUE(all_zero.begin != NULL);
+  EXPECT_TRUE(all_zero.begin == all_zero.end);
+
+  // Too small ranges buffer.
+  const ozz::Range<BlendingJob::SoaJointRange> too_small =
+      ozz::animation::ComputeSoaJointRanges(
+          ozz::Range<const ozz::math::SimdFloat4>(weights),
+          ozz::Range<BlendingJob::SoaJointRange>(ranges, 2));
+  EXPECT_TRUE(too_small.begin == NULL);
+  EXPECT_TRUE(too_small.end == NULL);
+}
+
+TEST(ComputeSoaJointRangesAnimation, BlendingJob) {
+  ozz::animation::offline::RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(22);
+
+  // Soa joint 0 translations are animated.
+  const ozz::animation::offline::RawAnimation::TranslationKey t0 = {
+      0.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  const ozz::animation::offline::RawAnimation::TranslationKey t1 = {
+      1.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(t0);
+  raw_animation.tracks[1].translations.push_back(t1);
+
+  // Soa joint 2 rotations are constant.
+  const ozz::animation::offline::RawAnimation::RotationKey r = {
+      0.f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+  raw_animation.tracks[9].rotations.push_back(r);
+
+  // Soa joint 3 scales are constant.
+  const ozz::animation::offline::RawAnimation::ScaleKey s = {
+      0.f, ozz::math::Float3(2.f, 2.f, 2.f)};
+  raw_animation.tracks[13].scales.push_back(s);
+
+  // Soa joint 4 keys are identity.
+  const ozz::animation::offline::RawAnimation::RotationKey identity = {
+      0.f, ozz::math::Quaternion::identity()};
+  raw_animation.tracks[17].rotations.push_back(identity);
+
+  // Soa joint 5 translations are constant.
+  raw_animation.tracks[21].translations.push_back(t0);
+
+  ozz::animation::offline::AnimationBuilder builder;
+  ozz::animation::Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_EQ(animation->num_soa_tracks(), 6);
+
+  BlendingJob::SoaJointRange ranges[3];
+  const ozz::Range<BlendingJob::SoaJointRange> computed =
+      ozz::animation::ComputeSoaJointRanges(
+          *animation, ozz::Range<BlendingJob::SoaJointRange>(ranges));
+  ASSERT_EQ(computed.begin, ranges);
+  ASSERT_EQ(computed.Count(), 3u);
+  EXPECT_EQ(ranges[0].begin, 0);
+  EXPECT_EQ(ranges[0].end, 1);
+  EXPECT_EQ(ranges[1].begin, 2);
+  EXPECT_EQ(ranges[1].end, 4);
+  EXPECT_EQ(ranges[2].begin, 5);
+  EXPECT_EQ(ranges[2].end, 6);
+
+  // Too small ranges buffer.
+  const ozz::Range<BlendingJob::SoaJointRange> too_small =
+      ozz::animation::ComputeSoaJointRanges(
+          *animation, ozz::Range<BlendingJob::SoaJointRange>(ranges, 2));
+  EXPECT_TRUE(too_small.begin == NULL);
+  EXPECT_TRUE(too_small.end == NULL);
+
+  ozz::memory::default_allocator()->Delete(animation);
+
+  // An all identity animation returns an empty range, which isn't NULL as no
+  // soa joint is affected.
+  ozz::animation::offline::RawAnimation identity_raw_animation;
+  identity_raw_animation.duration = 1.f;
+  identity_raw_animation.tracks.resize(5);
+  identity_raw_animation.tracks[2].rotations.push_back(identity);
+  ozz::animation::Animation* identity_animation =
+      builder(identity_raw_animation);
+  ASSERT_TRUE(identity_animation != NULL);
+
+  const ozz::Range<BlendingJob::SoaJointRange> all_identity =
+      ozz::animation::ComputeSoaJointRanges(
+          *identity_animation, ozz::Range<BlendingJob::SoaJointRange>(ranges));
+  EXPECT_TRUE(all_identity.begin != NULL);
+  EXPECT_TRUE(all_identity.begin == all_identity.end);
+
+  ozz::memory::default_allocator()->Delete(identity_animation);
+}
+
+namespace {
+// Expects _a and _b transforms to be equal, using a relative tolerance. Dense
+// subtractive blending of a null weight isn't exact, as it uses RcpEst.
+void ExpectSoaTransformNear(const ozz::math::SoaTransform& _a,
+                            const ozz::math::SoaTransform& _b) {
+  const float* a = reinterpret_cast<const float*>(&_a);
+  const float* b = reinterpret_cast<const float*>(&_b);
+  for (size_t i = 0; i < sizeof(_a) / sizeof(float); ++i) {
+    const float tolerance = 1e-3f * (b[i] < 0.f ? 1.f - b[i] : 1.f + b[i]);
+    EXPECT_NEAR(a[i], b[i], tolerance) << "component " << i;
+  }
+}
+}  // namespace
+
+TEST(SoaRanges, BlendingJob) {
+  const int kNumSoaJoints = 5;
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+
+  // Initialize inputs, with a different transform per layer and soa joint.
+  ozz::math::SoaTransform input_transforms[2][kNumSoaJoints];
+  ozz::math::SoaTransform bind_poses[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    for (int l = 0; l < 2; ++l) {
+      const float f = 1.f + i + l * 10.f;
+      ozz::math::SoaTransform& transform = input_transforms[l][i];
+      transform.translation = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(f, -f, 2.f * f, 0.f),
+          ozz::math::simd_float4::Load(3.f, f, -1.f, f),
+          ozz::math::simd_float4::Load(f, 0.f, f, -f));
+      const ozz::math::SimdFloat4 half_angle =
+          ozz::math::simd_float4::Load(.1f * f, .2f, -.3f * f, .4f);
+      transform.rotation = ozz::math::SoaQuaternion::Load(
+          zero, ozz::math::Sin(half_angle), zero,
+          ozz::math::Cos(half_angle));
+      transform.scale = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(1.f, 2.f, f, 1.f),
+          ozz::math::simd_float4::Load(1.f, 1.f, 3.f, f),
+          ozz::math::simd_float4::Load(f, 1.f, 1.f, 2.f));
+    }
+    bind_poses[i] = ozz::math::SoaTransform::identity();
+    bind_poses[i].translation.x = ozz::math::simd_float4::Load1(i * 2.f);
+  }
+
+  // Sparse joint weights, and the matching soa joint ranges.
+  const ozz::math::SimdFloat4 joint_weights[kNumSoaJoints] = {
+      zero, ozz::math::simd_float4::Load(1.f, .5f, 0.f, .2f),
+      ozz::math::simd_float4::one(), zero,
+      ozz::math::simd_float4::Load(0.f, 0.f, .7f, 0.f)};
+  BlendingJob::SoaJointRange ranges[(kNumSoaJoints + 1) / 2];
+  const ozz::Range<BlendingJob::SoaJointRange> soa_ranges =
+      ozz::animation::ComputeSoaJointRanges(
+          ozz::Range<const ozz::math::SimdFloat4>(joint_weights),
+          ozz::Range<BlendingJob::SoaJointRange>(ranges));
+  ASSERT_EQ(soa_ranges.Count(), 2u);
+
+  // Joint weights equivalent to ranges without joint weights.
+  ozz::math::SimdFloat4 range_weights[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    range_weights[i] = zero;
+  }
+  for (size_t r = 0; r < soa_ranges.Count(); ++r) {
+    for (int i = soa_ranges.begin[r].begin; i < soa_ranges.begin[r].end; ++i) {
+      range_weights[i] = ozz::math::simd_float4::one();
+    }
+  }
+
+  const float weights[][2] = {{1.f, .5f}, {.5f, 1.f}, {0.f, 1.f},
+                              {.01f, .02f}, {1.f, -1.f}};
+  for (size_t w = 0; w < OZZ_ARRAY_SIZE(weights); ++w) {
+    for (int sparse_layer = 0; sparse_layer < 2; ++sparse_layer) {
+      for (int use_weights = 0; use_weights < 2; ++use_weights) {
+        BlendingJob::Layer dense_layers[2];
+        BlendingJob::Layer sparse_layers[2];
+        for (int l = 0; l < 2; ++l) {
+          dense_layers[l].weight = weights[w][l];
+          dense_layers[l].transform = input_transforms[l];
+          sparse_layers[l] = dense_layers[l];
+        }
+        dense_layers[sparse_layer].joint_weights =
+            use_weights ? joint_weights : range_weights;
+        if (use_weights) {
+          sparse_layers[sparse_layer].joint_weights = joint_weights;
+        }
+        sparse_layers[sparse_layer].soa_ranges = soa_ranges;
+
+        for (int additive = 0; additive < 2; ++additive) {
+          ozz::math::SoaTransform expected[kNumSoaJoints];
+          BlendingJob dense_job;
+          dense_job.bind_pose = bind_poses;
+          dense_job.output = expected;
+
+          ozz::math::SoaTransform output[kNumSoaJoints];
+          BlendingJob sparse_job;
+          sparse_job.bind_pose = bind_poses;
+          sparse_job.output = output;
+
+          if (additive) {
+            dense_job.additive_layers = dense_layers;
+            sparse_job.additive_layers = sparse_layers;
+          } else {
+            dense_job.layers = dense_layers;
+            sparse_job.layers = sparse_layers;
+          }
+          ASSERT_TRUE(dense_job.Run());
+          ASSERT_TRUE(sparse_job.Run());
+
+          for (int i = 0; i < kNumSoaJoints; ++i) {
+            ExpectSoaTransformNear(output[i], expected[i]);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(JobValidityScratch, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_poses[3] = {identity, identity, identity};
+  ozz::math::SoaTransform output_transforms[3];
+  ozz::math::SimdFloat4 scratch[3];
+
+  BlendingJob job;
+  job.bind_pose = bind_poses;
+  job.output = output_transforms;
+
+  {  // Valid scratch.
+    job.scratch = scratch;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Invalid too small scratch.
+    job.scratch.begin = scratch;
+    job.scratch.end = scratch + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid inverted scratch.
+    job.scratch.begin = scratch + 3;
+    job.scratch.end = scratch;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid end without begin.
+    job.scratch.begin = NULL;
+    job.scratch.end = scratch + 3;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Valid without scratch.
+    job.scratch.begin = NULL;
+    job.scratch.end = NULL;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Invalid soa joints ranges.
+    job.begin_soa = -1;
+    EXPECT_FALSE(job.Validate());
+    job.begin_soa = 2;
+    job.end_soa = 1;
+    EXPECT_FALSE(job.Validate());
+    job.end_soa = 2;
+    EXPECT_TRUE(job.Validate());
+    job.end_soa = 46;  // Clamped to the bind pose size.
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Scratch, BlendingJob) {
+  // Spans more than 2 chunks of soa joints.
+  const int kNumSoaJoints = 75;
+
+  // Initialize inputs, with a different transform per layer and soa joint.
+  ozz::math::SoaTransform input_transforms[3][kNumSoaJoints];
+  ozz::math::SoaTransform bind_poses[kNumSoaJoints];
+  ozz::math::SimdFloat4 joint_weights[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    for (int l = 0; l < 3; ++l) {
+      const float f = 1.f + i + l * 100.f;
+      ozz::math::SoaTransform& transform = input_transforms[l][i];
+      transform = ozz::math::SoaTransform::identity();
+      transform.translation.x = ozz::math::simd_float4::Load(f, -f, 0.f, 2.f);
+      transform.rotation.y = ozz::math::simd_float4::Load1(.7071067f);
+      transform.rotation.w = ozz::math::simd_float4::Load1(.7071067f);
+      transform.scale.z = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, f);
+    }
+    bind_poses[i] = ozz::math::SoaTransform::identity();
+    bind_poses[i].translation.y = ozz::math::simd_float4::Load1(i * 2.f);
+    const float w = (i % 7) * .1f;
+    joint_weights[i] = ozz::math::simd_float4::Load(w, .5f - w, 0.f, w * w);
+  }
+
+  // Sparse ranges crossing chunk boundaries.
+  const BlendingJob::SoaJointRange ranges[3] = {{5, 10}, {30, 40}, {63, 70}};
+
+  BlendingJob::Layer layers[2];
+  layers[0].weight = .8f;
+  layers[0].transform = input_transforms[0];
+  layers[1].weight = .3f;
+  layers[1].transform = input_transforms[1];
+  layers[1].joint_weights = joint_weights;
+  layers[1].soa_ranges = ranges;
+
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].weight = .5f;
+  additive_layers[0].transform = input_transforms[2];
+  additive_layers[0].soa_ranges = ranges;
+
+  for (int partial = 0; partial < 2; ++partial) {
+    // Without a full layer, soa joints outside of ranges use the bind pose.
+    const ozz::Range<const BlendingJob::Layer> blend_layers(
+        partial ? layers + 1 : layers, layers + 2);
+
+    ozz::math::SoaTransform expected[kNumSoaJoints];
+    ozz::math::SimdFloat4 scratch[kNumSoaJoints];
+    BlendingJob scratch_job;
+    scratch_job.layers = blend_layers;
+    scratch_job.additive_layers = additive_layers;
+    scratch_job.bind_pose = bind_poses;
+    scratch_job.output = expected;
+    scratch_job.scratch = scratch;
+    ASSERT_TRUE(scratch_job.Run());
+
+    ozz::math::SoaTransform output[kNumSoaJoints];
+    BlendingJob chunked_job;
+    chunked_job.layers = blend_layers;
+    chunked_job.additive_layers = additive_layers;
+    chunked_job.bind_pose = bind_poses;
+    chunked_job.output = output;
+    ASSERT_TRUE(chunked_job.Run());
+
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      ExpectSoaTransformNear(output[i], expected[i]);
+    }
+
+    // Splits blending in soa joints ranges, as it would be done by multiple
+    // threads. Ranges share the scratch buffer.
+    const int splits[] = {0, 3, 40, 41, 75};
+    ozz::math::SoaTransform split_output[kNumSoaJoints];
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(splits) - 1; ++r) {
+      for (int use_scratch = 0; use_scratch < 2; ++use_scratch) {
+        BlendingJob split_job;
+        split_job.layers = blend_layers;
+        split_job.additive_layers = additive_layers;
+        split_job.bind_pose = bind_poses;
+        split_job.output = split_output;
+        if (use_scratch) {
+          split_job.scratch = scratch;
+        }
+        split_job.begin_soa = splits[r];
+        split_job.end_soa = splits[r + 1];
+        ASSERT_TRUE(split_job.Run());
+      }
+    }
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      ExpectSoaTransformNear(split_output[i], expected[i]);
+    }
+
+    // Checks some values, outside and inside ranges.
+    if (partial) {
+      EXPECT_SOAFLOAT3_EQ(output[20].translation, 0.f, 0.f, 0.f, 0.f, 40.f,
+                          40.f, 40.f, 40.f, 0.f, 0.f, 0.f, 0.f);
+    } else {
+      EXPECT_SOAFLOAT3_EQ(output[20].translation, 21.f, -21.f, 0.f, 2.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    }
+  }
+}
@@ -0,0 +1,169 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/fixed_rate_animation.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/fixed_rate_animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::FixedRateAnimation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::FixedRateAnimationBuilder;
+
+TEST(Empty, FixedRateAnimationSerialize) {
+  ozz::io::MemoryStream stream;
+
+  // Streams out.
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+
+  FixedRateAnimation o_animation;
+  o << o_animation;
+
+  // Streams in.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+
+  FixedRateAnimation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation.num_tracks(), i_animation.num_tracks());
+  EXPECT_EQ(o_animation.num_frames(), i_animation.num_frames());
+}
+
+TEST(Filled, FixedRateAnimationSerialize) {
+  // Builds a valid animation.
+  FixedRateAnimation* o_animation = NULL;
+  {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.name = "fixed";
+    raw_animation.tracks.resize(5);
+
+    RawAnimation::TranslationKey t_key0 = {0.f,
+                                           ozz::math::Float3(93.f, 58.f, 46.f)};
+    raw_animation.tracks[0].translations.push_back(t_key0);
+    RawAnimation::TranslationKey t_key1 = {.9f,
+                                           ozz::math::Float3(46.f, 58.f, 93.f)};
+    raw_animation.tracks[0].translations.push_back(t_key1);
+
+    RawAnimation::RotationKey r_key = {
+        0.7f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+    raw_animation.tracks[3].rotations.push_back(r_key);
+
+    RawAnimation::ScaleKey s_key = {0.1f, ozz::math::Float3(99.f, 26.f, 14.f)};
+    raw_animation.tracks[4].scales.push_back(s_key);
+
+    FixedRateAnimationBuilder builder;
+    builder.frequency = 10.f;
+    o_animation = builder(raw_animation);
+    ASSERT_TRUE(o_animation != NULL);
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    FixedRateAnimation i_animation;
+    i >> i_animation;
+
+    EXPECT_FLOAT_EQ(o_animation->duration(), i_animation.duration());
+    EXPECT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
+    EXPECT_EQ(o_animation->num_frames(), i_animation.num_frames());
+    EXPECT_STREQ(o_animation->name(), i_animation.name());
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+
+    // Keys type is opaque, so they are compared as raw bytes.
+    const char* o_keys =
+        reinterpret_cast<const char*>(o_animation->keys().begin);
+    const char* i_keys =
+        reinterpret_cast<const char*>(i_animation.keys().begin);
+    const ptrdiff_t keys_size =
+        reinterpret_cast<const char*>(o_animation->keys().end) - o_keys;
+    ASSERT_EQ(keys_size,
+              reinterpret_cast<const char*>(i_animation.keys().end) - i_keys);
+    EXPECT_EQ(memcmp(o_keys, i_keys, keys_size), 0);
+  }
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+TEST(AlreadyInitialized, FixedRateAnimationSerialize) {
+  ozz::io::MemoryStream stream;
+
+  {
+    ozz::io::OArchive o(&stream);
+
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(1);
+
+    FixedRateAnimationBuilder builder;
+    FixedRateAnimation* o_animation = builder(raw_animation);
+    ASSERT_TRUE(o_animation != NULL);
+    o << *o_animation;
+    ozz::memory::default_allocator()->Delete(o_animation);
+
+    raw_animation.duration = 2.f;
+    raw_animation.tracks.resize(6);
+    o_animation = builder(raw_animation);
+    ASSERT_TRUE(o_animation != NULL);
+    o << *o_animation;
+    ozz::memory::default_allocator()->Delete(o_animation);
+  }
+
+  {
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    // Reads and check the first animation.
+    FixedRateAnimation i_animation;
+    i >> i_animation;
+    EXPECT_FLOAT_EQ(i_animation.duration(), 1.f);
+    EXPECT_EQ(i_animation.num_tracks(), 1);
+    EXPECT_EQ(i_animation.num_frames(), 31);
+
+    // Reuse the animation a second time.
+    i >> i_animation;
+    EXPECT_FLOAT_EQ(i_animation.duration(), 2.f);
+    EXPECT_EQ(i_animation.num_tracks(), 6);
+    EXPECT_EQ(i_animation.num_frames(), 61);
+  }
+}
@@ -0,0 +1,273 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/fixed_rate_sampling_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/fixed_rate_animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/fixed_rate_animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::FixedRateAnimation;
+using ozz::animation::FixedRateSamplingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::FixedRateAnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+TEST(JobValidity, FixedRateSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.tracks.resize(5);
+
+  FixedRateAnimationBuilder builder;
+  FixedRateAnimation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  {  // Empty/default job
+    FixedRateSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output
+    FixedRateSamplingJob job;
+    job.animation = animation;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output range, too small.
+    ozz::math::SoaTransform output[1];
+
+    FixedRateSamplingJob job;
+    job.animation = animation;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation.
+    ozz::math::SoaTransform output[2];
+
+    FixedRateSamplingJob job;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    ozz::math::SoaTransform output[2];
+
+    FixedRateSamplingJob job;
+    job.animation = animation;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job with bigger output.
+    ozz::math::SoaTransform output[3];
+
+    FixedRateSamplingJob job;
+    job.time = 2155.f;  // Any time can be sampled.
+    job.animation = animation;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Default animation.
+    ozz::math::SoaTransform output[1];
+    FixedRateAnimation default_animation;
+
+    FixedRateSamplingJob job;
+    job.animation = &default_animation;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, FixedRateSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+
+  // Track 0 has 2 translation keys.
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 2.f, -4.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {1.f,
+                                           ozz::math::Float3(4.f, 2.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t1);
+
+  // Track 1 has opposed rotation keys, which must be interpolated along the
+  // shortest path.
+  const RawAnimation::RotationKey r0 = {
+      0.f, ozz::math::Quaternion(0.f, 0.f, 0.f, 1.f)};
+  raw_animation.tracks[1].rotations.push_back(r0);
+  const RawAnimation::RotationKey r1 = {
+      1.f, ozz::math::Quaternion(0.f, 0.f, 0.f, -1.f)};
+  raw_animation.tracks[1].rotations.push_back(r1);
+
+  // Track 1 has a constant scale.
+  const RawAnimation::ScaleKey s0 = {.5f, ozz::math::Float3(2.f, 3.f, 4.f)};
+  raw_animation.tracks[1].scales.push_back(s0);
+
+  FixedRateAnimationBuilder builder;
+  builder.frequency = 4.f;
+  FixedRateAnimation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_frames(), 5);
+
+  FixedRateSamplingJob job;
+  job.animation = animation;
+  ozz::math::SoaTransform output[1];
+  job.output = output;
+
+  // clang-format off
+  const float times[] = {-1.f, 0.f, .1f, .25f, .6f, 1.f, 2.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+
+    const float t = ozz::math::Clamp(0.f, times[i], 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                            t * 4.f, 0.f, 0.f, 0.f,
+                            2.f, 0.f, 0.f, 0.f,
+                            -4.f + t * 4.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale,
+                            1.f, 2.f, 1.f, 1.f,
+                            1.f, 3.f, 1.f, 1.f,
+                            1.f, 4.f, 1.f, 1.f);
+  }
+  // clang-format on
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Compares values with a tolerance that matches fixed-rate quantization.
+void ExpectSimdFloatNear(ozz::math::SimdFloat4 _a, ozz::math::SimdFloat4 _b) {
+  float a[4];
+  float b[4];
+  ozz::math::StorePtrU(_a, a);
+  ozz::math::StorePtrU(_b, b);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(a[i], b[i], 2e-3f);
+  }
+}
+}  // namespace
+
+TEST(SamplingAnimation, FixedRateSamplingJob) {
+  // Builds a baked animation, with a key at every frame.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(7);
+  for (int i = 0; i < raw_animation.num_tracks(); ++i) {
+    for (int f = 0; f <= 20; ++f) {
+      const float time = f * .1f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(i * time, 1.f - time, f * .5f)};
+      raw_animation.tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float4(0.f, 0.f, 1.f, time * i * .7f))};
+      raw_animation.tracks[i].rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + time, 1.f, 2.f - time * i)};
+      raw_animation.tracks[i].scales.push_back(skey);
+    }
+  }
+
+  FixedRateAnimationBuilder fixed_builder;
+  fixed_builder.frequency = 10.f;
+  FixedRateAnimation* fixed_animation = fixed_builder(raw_animation);
+  ASSERT_TRUE(fixed_animation != NULL);
+  EXPECT_EQ(fixed_animation->num_frames(), 21);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Compares with SamplingJob, in any order as no cache is involved.
+  const float times[] = {0.f,  1.3f, .05f, 2.f,  .77f, .1f,
+                         1.9f, .33f, 1.f,  .42f, 1.51f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    ozz::math::SoaTransform fixed_output[2];
+    FixedRateSamplingJob fixed_job;
+    fixed_job.time = times[i];
+    fixed_job.animation = fixed_animation;
+    fixed_job.output = fixed_output;
+    ASSERT_TRUE(fixed_job.Run());
+
+    SamplingCache cache(7);
+    ozz::math::SoaTransform output[2];
+    SamplingJob job;
+    job.time = times[i];
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    for (int s = 0; s < 2; ++s) {
+      const ozz::math::SoaTransform& f = fixed_output[s];
+      const ozz::math::SoaTransform& o = output[s];
+      ExpectSimdFloatNear(f.translation.x, o.translation.x);
+      ExpectSimdFloatNear(f.translation.y, o.translation.y);
+      ExpectSimdFloatNear(f.translation.z, o.translation.z);
+      ExpectSimdFloatNear(f.rotation.x, o.rotation.x);
+      ExpectSimdFloatNear(f.rotation.y, o.rotation.y);
+      ExpectSimdFloatNear(f.rotation.z, o.rotation.z);
+      ExpectSimdFloatNear(f.rotation.w, o.rotation.w);
+      ExpectSimdFloatNear(f.scale.x, o.scale.x);
+      ExpectSimdFloatNear(f.scale.y, o.scale.y);
+      ExpectSimdFloatNear(f.scale.z, o.scale.z);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(fixed_animation);
+}
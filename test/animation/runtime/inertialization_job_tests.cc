@@ -0,0 +1,346 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/inertialization_job.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::InertializationCaptureJob;
+using ozz::animation::InertializationJob;
+using ozz::animation::SoaInertializationOffset;
+
+TEST(JobValidity, InertializationCaptureJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform postures[2] = {identity, identity};
+  SoaInertializationOffset offsets[2];
+
+  {  // Empty/default job.
+    InertializationCaptureJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid job.
+    InertializationCaptureJob job;
+    job.delta_time = 1.f / 30.f;
+    job.previous = postures;
+    job.current = postures;
+    job.target = postures;
+    job.output = offsets;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Invalid delta time.
+    job.delta_time = 0.f;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Valid empty target.
+    InertializationCaptureJob job;
+    job.delta_time = 1.f / 30.f;
+    job.previous = postures;
+    job.current = postures;
+    job.target.begin = postures;
+    job.target.end = postures;
+    job.output = offsets;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Invalid too small buffers.
+    InertializationCaptureJob job;
+    job.delta_time = 1.f / 30.f;
+    job.previous = postures;
+    job.current.begin = postures;
+    job.current.end = postures + 1;
+    job.target = postures;
+    job.output = offsets;
+    EXPECT_FALSE(job.Validate());
+
+    job.current = postures;
+    job.output.begin = offsets;
+    job.output.end = offsets + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid NULL previous.
+    InertializationCaptureJob job;
+    job.delta_time = 1.f / 30.f;
+    job.current = postures;
+    job.target = postures;
+    job.output = offsets;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(JobValidity, InertializationJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform input[2] = {identity, identity};
+  SoaInertializationOffset offsets[2];
+  memset(offsets, 0, sizeof(offsets));
+  ozz::math::SoaTransform output[2];
+
+  {  // Empty/default job.
+    InertializationJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid job.
+    InertializationJob job;
+    job.duration = .2f;
+    job.offsets = offsets;
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Invalid duration.
+    job.duration = 0.f;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid too small buffers.
+    InertializationJob job;
+    job.duration = .2f;
+    job.offsets.begin = offsets;
+    job.offsets.end = offsets + 1;
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+
+    job.offsets = offsets;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid NULL offsets.
+    InertializationJob job;
+    job.duration = .2f;
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+namespace {
+// Builds a posture whose joints are rotated around y axis by _angle (and
+// _angle * 2, 3 and 4 for the 4 soa joints), and translated by _translation.
+ozz::math::SoaTransform MakePosture(float _angle, float _translation) {
+  const ozz::math::SimdFloat4 half_angle =
+      ozz::math::simd_float4::Load(.5f, 1.f, 1.5f, 2.f) *
+      ozz::math::simd_float4::Load1(_angle);
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+  ozz::math::SoaTransform posture = ozz::math::SoaTransform::identity();
+  posture.rotation = ozz::math::SoaQuaternion::Load(
+      zero, ozz::math::Sin(half_angle), zero, ozz::math::Cos(half_angle));
+  posture.translation.x = ozz::math::simd_float4::Load1(_translation);
+  posture.translation.y = ozz::math::simd_float4::Load(0.f, 1.f, -1.f, 2.f);
+  posture.scale.z = ozz::math::simd_float4::Load1(1.f + _translation);
+  return posture;
+}
+}  // namespace
+
+TEST(Capture, InertializationCaptureJob) {
+  const ozz::math::SoaTransform previous = MakePosture(.3f, 2.f);
+  const ozz::math::SoaTransform current = MakePosture(.4f, 1.f);
+  const ozz::math::SoaTransform target = MakePosture(0.f, 0.f);
+  SoaInertializationOffset offset;
+
+  InertializationCaptureJob job;
+  job.delta_time = .1f;
+  job.previous.begin = &previous;
+  job.previous.end = &previous + 1;
+  job.current.begin = &current;
+  job.current.end = &current + 1;
+  job.target.begin = &target;
+  job.target.end = &target + 1;
+  job.output.begin = &offset;
+  job.output.end = &offset + 1;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ(offset.translation, 1.f, 1.f, 1.f, 1.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(offset.translation_velocity, -10.f, -10.f, -10.f, -10.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(offset.scale, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ(offset.scale_velocity, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, -10.f, -10.f, -10.f, -10.f);
+
+  // Rotation offsets are scaled axis.
+  EXPECT_SOAFLOAT3_EQ_EST(offset.rotation, 0.f, 0.f, 0.f, 0.f, .4f, .8f, 1.2f,
+                          1.6f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(offset.rotation_velocity, 0.f, 0.f, 0.f, 0.f, 1.f,
+                          2.f, 3.f, 4.f, 0.f, 0.f, 0.f, 0.f);
+}
+
+TEST(Decay, InertializationJob) {
+  const ozz::math::SoaTransform previous = MakePosture(.3f, 1.1f);
+  const ozz::math::SoaTransform current = MakePosture(.4f, 1.f);
+  const ozz::math::SoaTransform target = MakePosture(0.f, 0.f);
+  SoaInertializationOffset offset;
+
+  InertializationCaptureJob capture_job;
+  capture_job.delta_time = .1f;
+  capture_job.previous.begin = &previous;
+  capture_job.previous.end = &previous + 1;
+  capture_job.current.begin = &current;
+  capture_job.current.end = &current + 1;
+  capture_job.target.begin = &target;
+  capture_job.target.end = &target + 1;
+  capture_job.output.begin = &offset;
+  capture_job.output.end = &offset + 1;
+  ASSERT_TRUE(capture_job.Run());
+
+  InertializationJob job;
+  job.duration = 1.f;
+  job.offsets.begin = &offset;
+  job.offsets.end = &offset + 1;
+  job.input.begin = &target;
+  job.input.end = &target + 1;
+  ozz::math::SoaTransform output;
+  job.output.begin = &output;
+  job.output.end = &output + 1;
+
+  // Outgoing posture is output at transition time.
+  job.time = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output.translation, 1.f, 1.f, 1.f, 1.f, 0.f, 1.f,
+                          -1.f, 2.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output.scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                          2.f, 2.f, 2.f, 2.f);
+  const ozz::math::SoaQuaternion& outgoing = current.rotation;
+  EXPECT_SOAQUATERNION_EQ_EST(
+      output.rotation, 0.f, 0.f, 0.f, 0.f, ozz::math::GetX(outgoing.y),
+      ozz::math::GetY(outgoing.y), ozz::math::GetZ(outgoing.y),
+      ozz::math::GetW(outgoing.y), 0.f, 0.f, 0.f, 0.f,
+      ozz::math::GetX(outgoing.w), ozz::math::GetY(outgoing.w),
+      ozz::math::GetZ(outgoing.w), ozz::math::GetW(outgoing.w));
+
+  // Initial velocity is continuous.
+  job.time = .001f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output.translation.x), 1.f - .001f, 1e-5f);
+
+  // Offsets decay monotonically.
+  float last = 1.f;
+  for (float time = .05f; time < 1.f; time += .05f) {
+    job.time = time;
+    ASSERT_TRUE(job.Run());
+    const float x = ozz::math::GetX(output.translation.x);
+    EXPECT_LT(x, last);
+    EXPECT_GE(x, 0.f);
+    last = x;
+  }
+
+  // Input is output once transition is over.
+  const float times[] = {1.f, 1.5f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(&output, &target, sizeof(output)), 0);
+  }
+
+  // Output can be the input buffer.
+  ozz::math::SoaTransform in_place = target;
+  job.time = .5f;
+  job.input.begin = &in_place;
+  job.input.end = &in_place + 1;
+  job.output.begin = &in_place;
+  job.output.end = &in_place + 1;
+  ASSERT_TRUE(job.Run());
+  job.input.begin = &target;
+  job.input.end = &target + 1;
+  job.output.begin = &output;
+  job.output.end = &output + 1;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(memcmp(&output, &in_place, sizeof(output)), 0);
+}
+
+TEST(DecayAxis, InertializationJob) {
+  // Rotation offset velocity isn't aligned with the offset axis.
+  SoaInertializationOffset offset;
+  const ozz::math::SoaFloat3 zero = ozz::math::SoaFloat3::zero();
+  offset.translation = zero;
+  offset.translation_velocity = zero;
+  offset.rotation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(1.f, .5f, 0.f, 2.f),
+      ozz::math::simd_float4::Load(.5f, 1.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 1.f, 1.f));
+  offset.rotation_velocity = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(-4.f, 0.f, 1.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, -4.f, 0.f, -1.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, -2.f, 0.f));
+  offset.scale = zero;
+  offset.scale_velocity = zero;
+
+  const ozz::math::SoaTransform input = ozz::math::SoaTransform::identity();
+  ozz::math::SoaTransform output;
+
+  InertializationJob job;
+  job.duration = 1.f;
+  job.offsets.begin = &offset;
+  job.offsets.end = &offset + 1;
+  job.input.begin = &input;
+  job.input.end = &input + 1;
+  job.output.begin = &output;
+  job.output.end = &output + 1;
+
+  // Outgoing rotation is output at transition time.
+  job.time = 0.f;
+  ASSERT_TRUE(job.Run());
+  const float angle = std::sqrt(1.25f);
+  const float s = std::sin(angle * .5f) / angle;
+  const float c = std::cos(angle * .5f);
+  const float angle3 = std::sqrt(5.f);
+  const float s3 = std::sin(angle3 * .5f) / angle3;
+  const float c3 = std::cos(angle3 * .5f);
+  EXPECT_SOAQUATERNION_EQ_EST(output.rotation, s, .5f * s, 0.f, 2.f * s3,
+                              .5f * s, s, 0.f, 0.f, 0.f, 0.f,
+                              std::sin(.5f), s3, c, c, std::cos(.5f), c3);
+
+  // Rotation axis remains the offset axis during the whole transition, while
+  // the angle decreases.
+  float last = 1.f;
+  for (float time = .05f; time < 1.f; time += .05f) {
+    job.time = time;
+    ASSERT_TRUE(job.Run());
+    const ozz::math::SoaQuaternion& q = output.rotation;
+    const float x = ozz::math::GetX(q.x);
+    EXPECT_NEAR(ozz::math::GetX(q.y), x * .5f, 1e-6f);
+    EXPECT_FLOAT_EQ(ozz::math::GetX(q.z), 0.f);
+    EXPECT_NEAR(ozz::math::GetY(q.x), ozz::math::GetY(q.y) * .5f, 1e-6f);
+    EXPECT_FLOAT_EQ(ozz::math::GetZ(q.x), 0.f);
+    EXPECT_FLOAT_EQ(ozz::math::GetZ(q.y), 0.f);
+    EXPECT_NEAR(ozz::math::GetW(q.x), ozz::math::GetW(q.z) * 2.f, 1e-6f);
+    EXPECT_FLOAT_EQ(ozz::math::GetW(q.y), 0.f);
+    EXPECT_LT(x, last);
+    EXPECT_GE(x, 0.f);
+    last = x;
+  }
+}
@@ -27,9 +27,13 @@
 
 #include "ozz/animation/runtime/local_to_model_job.h"
 
+#include <cmath>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_float3x4.h"
+#include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
 
@@ -39,9 +43,28 @@
 
 using ozz::animation::Skeleton;
 using ozz::animation::LocalToModelJob;
+using ozz::animation::BatchLocalToModelJob;
+using ozz::animation::LocalToModelTransformJob;
 using ozz::animation::offline::RawSkeleton;
 using ozz::animation::offline::SkeletonBuilder;
 
+namespace {
+// Expects Float3x4 _affine to be equal to the 3 first rows of _matrix.
+void ExpectAffineEq(const ozz::math::Float3x4& _affine,
+                    const ozz::math::Float4x4& _matrix) {
+  float affine[16];
+  float matrix[16];
+  for (int i = 0; i < 4; ++i) {
+    ozz::math::StorePtrU(ozz::math::ToFloat4x4(_affine).cols[i],
+                         affine + i * 4);
+    ozz::math::StorePtrU(_matrix.cols[i], matrix + i * 4);
+  }
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_NEAR(affine[i], matrix[i], 1e-5f) << "component " << i;
+  }
+}
+}  // namespace
+
 // clang-format off
 
 TEST(JobValidity, LocalToModel) {
@@ -153,6 +176,173 @@ TEST(JobValidity, LocalToModel) {
     EXPECT_TRUE(job.Validate());
     EXPECT_TRUE(job.Run());
   }
+  // Invalid affine output range: too small.
+  {
+    ozz::math::Float3x4 affine_output[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.affine_output.begin = affine_output;
+    job.affine_output.end = affine_output + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Invalid output: both output and affine output.
+  {
+    ozz::math::Float3x4 affine_output[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.affine_output = affine_output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Valid affine output.
+  {
+    ozz::math::Float3x4 affine_output[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.affine_output = affine_output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  // Invalid skinning output: no inverse bind poses.
+  {
+    ozz::math::Float4x4 skinning_output[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.skinning_output = skinning_output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Invalid inverse bind poses: no skinning output.
+  {
+    const ozz::math::Float4x4 inverse_bind_poses[2] = {
+        ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.inverse_bind_poses = inverse_bind_poses;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Invalid inverse bind poses: too small.
+  {
+    const ozz::math::Float4x4 inverse_bind_poses[2] = {
+        ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+    ozz::math::Float4x4 skinning_output[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.inverse_bind_poses.begin = inverse_bind_poses;
+    job.inverse_bind_poses.end = inverse_bind_poses + 1;
+    job.skinning_output = skinning_output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Valid skinning output.
+  {
+    const ozz::math::Float4x4 inverse_bind_poses[2] = {
+        ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+    ozz::math::Float4x4 skinning_output[2];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.skinning_output = skinning_output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  // Invalid from joint.
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    job.from = -1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Valid from joint.
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 1;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  // Invalid joints list.
+  {
+    const uint16_t joints[2] = {0, 2};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.joints = joints;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    job.joints = ozz::Range<const uint16_t>(joints, 1);
+    job.from = 0;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    const uint8_t dirty[1] = {1};
+    job.from = Skeleton::kNoParentIndex;
+    job.dirty = dirty;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Valid joints list.
+  {
+    const uint16_t joints[2] = {1, 0};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.joints = joints;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    job.joints = ozz::Range<const uint16_t>(joints, static_cast<size_t>(0));
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  // Invalid dirty mask.
+  {
+    const uint8_t dirty[1] = {1};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.dirty = ozz::Range<const uint8_t>(dirty, static_cast<size_t>(0));
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    job.dirty = dirty;
+    job.from = 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Valid dirty mask.
+  {
+    const uint8_t dirty[1] = {1};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.dirty = dirty;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
   // Valid job with empty skeleton.
   {
     LocalToModelJob job;
@@ -273,5 +463,747 @@ TEST(Transformation, LocalToModel) {
                                 0.f, -1.f, 0.f, 0.f,
                                 0.f, 0.f, -1.f, 0.f,
                                 0.f, 0.f, 0.f, 1.f);
+
+  // Affine output matches.
+  ozz::math::Float3x4 affine_output[6];
+  job.output = ozz::Range<ozz::math::Float4x4>();
+  job.affine_output = affine_output;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+  for (int i = 0; i < 6; ++i) {
+    ExpectAffineEq(affine_output[i], output[i]);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Subtree, LocalToModel) {
+  // Builds the skeleton, whose joints are stored in breadth-first order:
+  // root, j0, j2, j1, j3, j4.
+  /*
+   6 joints
+   root
+    /  \
+   j0  j2
+    |  / \
+   j1 j3 j4
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j2";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "j1";
+  root.children[1].children.resize(2);
+  root.children[1].children[0].name = "j3";
+  root.children[1].children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Every joint is translated by its index + 1 along x.
+  ozz::math::SoaTransform input[2] = {ozz::math::SoaTransform::identity(),
+                                      ozz::math::SoaTransform::identity()};
+  input[0].translation.x = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f);
+  input[1].translation.x = ozz::math::simd_float4::Load(5.f, 6.f, 0.f, 0.f);
+
+  ozz::math::Float4x4 output[6];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  // Changes j0 and j2 translations, but only updates j2 subtree.
+  input[0].translation.y = ozz::math::simd_float4::Load(0.f, 10.f, 20.f, 0.f);
+  job.from = 2;
+  ASSERT_TRUE(job.Run());
+
+  // root, j0 and j1 aren't updated.
+  EXPECT_FLOAT4x4_EQ(output[0], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                1.f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[1], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                3.f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[3], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                7.f, 0.f, 0.f, 1.f);
+
+  // j2, j3 and j4 are updated.
+  EXPECT_FLOAT4x4_EQ(output[2], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                4.f, 20.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[4], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                9.f, 20.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[5], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                10.f, 20.f, 0.f, 1.f);
+
+  // Updating from a leaf only updates the leaf.
+  input[1].translation.x = ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f);
+  job.from = 5;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT4x4_EQ(output[4], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                9.f, 20.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[5], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                4.f, 20.f, 0.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Dirty, LocalToModel) {
+  // Builds the skeleton, whose joints are stored in breadth-first order:
+  // root, j0, j2, j1, j3, j4. The first soa joint is root, j0, j2, j1, the
+  // second is j3, j4.
+  /*
+   6 joints
+   root
+    /  \
+   j0  j2
+    |  / \
+   j1 j3 j4
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.children.resize(2);
+  root.children[0].children.resize(1);
+  root.children[1].children.resize(2);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Every joint is translated by its index + 1 along x.
+  ozz::math::SoaTransform input[2] = {ozz::math::SoaTransform::identity(),
+                                      ozz::math::SoaTransform::identity()};
+  input[0].translation.x = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f);
+  input[1].translation.x = ozz::math::simd_float4::Load(5.f, 6.f, 0.f, 0.f);
+
+  ozz::math::Float4x4 output[6];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  // Changes j0 and j4 translations, but only flags j4 soa joint as dirty.
+  input[0].translation.y = ozz::math::simd_float4::Load(0.f, 10.f, 0.f, 0.f);
+  input[1].translation.y = ozz::math::simd_float4::Load(0.f, 20.f, 0.f, 0.f);
+  uint8_t dirty[1] = {2};
+  job.dirty = dirty;
+  ASSERT_TRUE(job.Run());
+
+  // j0 isn't updated.
+  EXPECT_FLOAT4x4_EQ(output[1], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                3.f, 0.f, 0.f, 1.f);
+  // j4 is updated.
+  EXPECT_FLOAT4x4_EQ(output[5], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                10.f, 20.f, 0.f, 1.f);
+
+  // Flags j0 soa joint as dirty. j0 is updated, so is its child j1, and j3
+  // and j4 which are descendants of root.
+  input[1].translation.y = ozz::math::simd_float4::Load(30.f, 0.f, 0.f, 0.f);
+  dirty[0] = 1;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT4x4_EQ(output[1], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                3.f, 10.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[3], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                7.f, 10.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[4], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                9.f, 30.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[5], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                10.f, 0.f, 0.f, 1.f);
+
+  // Nothing is updated if no soa joint is dirty.
+  input[0].translation.x = ozz::math::simd_float4::zero();
+  dirty[0] = 0;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT4x4_EQ(output[0], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 1.f, 0.f,
+                                1.f, 0.f, 0.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Levels, LocalToModel) {
+  // Builds a 13 joints skeleton with 2 roots, whose joints are stored in
+  // order: r0, r1, a, b, c, e, i, f, d, g, h, j, k.
+  /*
+      r0       r1
+     / | \      |
+    a  b  c     d
+    |     |    / \
+    e     f   g   h
+    |         |
+    i         j
+              |
+              k
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& r0 = raw_skeleton.roots[0];
+  r0.children.resize(3);
+  r0.children[0].children.resize(1);
+  r0.children[0].children[0].children.resize(1);
+  r0.children[2].children.resize(1);
+  RawSkeleton::Joint& r1 = raw_skeleton.roots[1];
+  r1.children.resize(1);
+  r1.children[0].children.resize(2);
+  r1.children[0].children[0].children.resize(1);
+  r1.children[0].children[0].children[0].children.resize(1);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 13);
+  ASSERT_EQ(skeleton->num_levels(), 5);
+
+  // Every joint is translated and scaled differently.
+  ozz::math::SoaTransform input[4];
+  for (int i = 0; i < 4; ++i) {
+    const float f = static_cast<float>(i * 4);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation.x =
+        ozz::math::simd_float4::Load(f + 1.f, f + 2.f, f + 3.f, f + 4.f);
+    input[i].translation.y = ozz::math::simd_float4::Load1(f);
+    input[i].scale.z = ozz::math::simd_float4::Load(1.f, 2.f, .5f, 3.f);
+  }
+
+  ozz::math::Float4x4 reference[13];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = reference;
+  ASSERT_TRUE(job.Run());
+
+  // Updates level after level, each level being split in 2 jobs, as if they
+  // were run concurrently.
+  ozz::math::Float4x4 output[13];
+  for (int i = 0; i < 13; ++i) {
+    output[i] = ozz::math::Float4x4::Scaling(ozz::math::simd_float4::zero());
+  }
+  job.output = output;
+  const uint16_t* level_joints = skeleton->level_joints().begin;
+  for (int l = 0; l < skeleton->num_levels(); ++l) {
+    const int begin = skeleton->levels()[l];
+    const int end = skeleton->levels()[l + 1];
+    const int half = (begin + end) / 2;
+
+    LocalToModelJob first = job;
+    first.joints = ozz::Range<const uint16_t>(level_joints + begin,
+                                              level_joints + half);
+    ASSERT_TRUE(first.Run());
+    LocalToModelJob second = job;
+    second.joints = ozz::Range<const uint16_t>(level_joints + half,
+                                               level_joints + end);
+    ASSERT_TRUE(second.Run());
+
+    // Next levels aren't updated yet.
+    if (end < 13) {
+      EXPECT_FLOAT4x4_EQ(output[level_joints[end]], 0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 1.f);
+    }
+  }
+  for (int i = 0; i < 13; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ(output[i].cols[c],
+                          ozz::math::GetX(reference[i].cols[c]),
+                          ozz::math::GetY(reference[i].cols[c]),
+                          ozz::math::GetZ(reference[i].cols[c]),
+                          ozz::math::GetW(reference[i].cols[c]));
+    }
+  }
+
+  // Updates d only, whose parent r1 is read from the output. Its child g isn't
+  // in the list, so it isn't updated.
+  input[2].translation.y = ozz::math::simd_float4::Load1(20.f);
+  const uint16_t d_joint[1] = {8};
+  job.joints = d_joint;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_FLOAT4x4_EQ(output[8], 1.f, 0.f, 0.f, 0.f,
+                                0.f, 1.f, 0.f, 0.f,
+                                0.f, 0.f, 2.f, 0.f,
+                                11.f, 20.f, 0.f, 1.f);
+  for (int c = 0; c < 4; ++c) {
+    EXPECT_SIMDFLOAT_EQ(output[9].cols[c],
+                        ozz::math::GetX(reference[9].cols[c]),
+                        ozz::math::GetY(reference[9].cols[c]),
+                        ozz::math::GetZ(reference[9].cols[c]),
+                        ozz::math::GetW(reference[9].cols[c]));
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Skinning, LocalToModel) {
+  // Builds a 5 joints skeleton, so the last soa joint is partial.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 0; i < 4; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 5);
+
+  // Every joint is translated by 1 along x, and scaled by 2.
+  const ozz::math::SoaTransform transform = {
+      {ozz::math::simd_float4::one(), ozz::math::simd_float4::zero(),
+       ozz::math::simd_float4::zero()},
+      ozz::math::SoaQuaternion::identity(),
+      ozz::math::SoaFloat3::Load(ozz::math::simd_float4::Load1(2.f),
+                                 ozz::math::simd_float4::Load1(2.f),
+                                 ozz::math::simd_float4::Load1(2.f))};
+  const ozz::math::SoaTransform input[2] = {transform, transform};
+
+  // Inverse bind poses translate by -joint index along y.
+  ozz::math::Float4x4 inverse_bind_poses[5];
+  for (int i = 0; i < 5; ++i) {
+    inverse_bind_poses[i] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(0.f, -static_cast<float>(i), 0.f, 0.f));
+  }
+
+  ozz::math::Float4x4 output[5];
+  ozz::math::Float4x4 skinning_output[5];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = output;
+  job.inverse_bind_poses = inverse_bind_poses;
+  job.skinning_output = skinning_output;
+  ASSERT_TRUE(job.Run());
+
+  // Skinning matrices are model matrices multiplied by inverse bind poses.
+  for (int i = 0; i < 5; ++i) {
+    const ozz::math::Float4x4 skinning = output[i] * inverse_bind_poses[i];
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ(skinning_output[i].cols[c],
+                          ozz::math::GetX(skinning.cols[c]),
+                          ozz::math::GetY(skinning.cols[c]),
+                          ozz::math::GetZ(skinning.cols[c]),
+                          ozz::math::GetW(skinning.cols[c]));
+    }
+  }
+  EXPECT_FLOAT4x4_EQ(skinning_output[2], 8.f, 0.f, 0.f, 0.f,
+                                         0.f, 8.f, 0.f, 0.f,
+                                         0.f, 0.f, 8.f, 0.f,
+                                         7.f, -16.f, 0.f, 1.f);
+
+  // Skinning matrices are the same with affine output.
+  ozz::math::Float3x4 affine_output[5];
+  ozz::math::Float4x4 affine_skinning_output[5];
+  job.output = ozz::Range<ozz::math::Float4x4>();
+  job.affine_output = affine_output;
+  job.skinning_output = affine_skinning_output;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 5; ++i) {
+    ExpectAffineEq(ozz::math::Float3x4::FromFloat4x4(affine_skinning_output[i]),
+                   skinning_output[i]);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(JobValidity, BatchLocalToModel) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(4);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 5);
+
+  ozz::math::SoaTransform input[2][2];
+  ozz::math::Float4x4 output[2][5];
+  ozz::math::SoaFloat4x4 scratch[5];
+  for (int i = 0; i < 2; ++i) {
+    input[i][0] = input[i][1] = ozz::math::SoaTransform::identity();
+  }
+  ozz::Range<const ozz::math::SoaTransform> inputs[2];
+  ozz::Range<ozz::math::Float4x4> outputs[2];
+  for (int i = 0; i < 2; ++i) {
+    inputs[i] = input[i];
+    outputs[i] = output[i];
+  }
+
+  {  // Default job.
+    BatchLocalToModelJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No skeleton.
+    BatchLocalToModelJob job;
+    job.inputs = inputs;
+    job.outputs = outputs;
+    job.scratch = scratch;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Inputs and outputs count mismatch.
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.inputs = inputs;
+    job.outputs = ozz::Range<const ozz::Range<ozz::math::Float4x4> >(outputs,
+                                                                      1);
+    job.scratch = scratch;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid input.
+    ozz::Range<const ozz::math::SoaTransform> small_inputs[2] = {inputs[0],
+                                                                 inputs[1]};
+    small_inputs[1].end = small_inputs[1].begin + 1;
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.inputs = small_inputs;
+    job.outputs = outputs;
+    job.scratch = scratch;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    ozz::Range<ozz::math::Float4x4> small_outputs[2] = {outputs[0],
+                                                        outputs[1]};
+    small_outputs[0].end = small_outputs[0].begin + 4;
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.inputs = inputs;
+    job.outputs = small_outputs;
+    job.scratch = scratch;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid scratch.
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.inputs = inputs;
+    job.outputs = outputs;
+    job.scratch = ozz::Range<ozz::math::SoaFloat4x4>(scratch, 4);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.inputs = inputs;
+    job.outputs = outputs;
+    job.scratch = scratch;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job without any instance.
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton;
+    job.scratch = scratch;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Batch, LocalToModel) {
+  // Builds a 6 joints skeleton with 2 branches:
+  // 0 -> 1 -> 3 -> 5
+  //   -> 2 -> 4
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.children.resize(2);
+  root.children[0].children.resize(1);
+  root.children[0].children[0].children.resize(1);
+  root.children[1].children.resize(1);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 6);
+
+  // 5 instances, so the second group of 4 instances is partial. Every instance
+  // and joint has a different local transform.
+  const int kInstances = 5;
+  ozz::math::SoaTransform input[kInstances][2];
+  ozz::Range<const ozz::math::SoaTransform> inputs[kInstances];
+  ozz::math::Float4x4 output[kInstances][6];
+  ozz::Range<ozz::math::Float4x4> outputs[kInstances];
+  for (int i = 0; i < kInstances; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      const float f = static_cast<float>(i * 2 + j);
+      float angles[4], coss[4], sins[4];
+      for (int l = 0; l < 4; ++l) {
+        angles[l] = f * .1f + l * .25f;
+        coss[l] = std::cos(angles[l]);
+        sins[l] = std::sin(angles[l]);
+      }
+      const ozz::math::SimdFloat4 angle =
+          ozz::math::simd_float4::LoadPtrU(angles);
+      const ozz::math::SimdFloat4 cos = ozz::math::simd_float4::LoadPtrU(coss);
+      const ozz::math::SimdFloat4 sin = ozz::math::simd_float4::LoadPtrU(sins);
+      const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+      const ozz::math::SoaTransform transform = {
+          ozz::math::SoaFloat3::Load(angle, ozz::math::simd_float4::Load1(f),
+                                     ozz::math::simd_float4::one()),
+          ozz::math::SoaQuaternion::Load(sin, zero, zero, cos),
+          ozz::math::SoaFloat3::Load(ozz::math::simd_float4::one(),
+                                     ozz::math::simd_float4::Load1(2.f),
+                                     ozz::math::simd_float4::one())};
+      input[i][j] = transform;
+    }
+    inputs[i] = input[i];
+    outputs[i] = output[i];
+  }
+
+  ozz::math::SoaFloat4x4 scratch[6];
+  BatchLocalToModelJob job;
+  job.skeleton = skeleton;
+  job.inputs = inputs;
+  job.outputs = outputs;
+  job.scratch = scratch;
+  ASSERT_TRUE(job.Run());
+
+  // Batched model matrices match the ones computed instance per instance.
+  for (int i = 0; i < kInstances; ++i) {
+    ozz::math::Float4x4 single[6];
+    LocalToModelJob single_job;
+    single_job.skeleton = skeleton;
+    single_job.input = input[i];
+    single_job.output = single;
+    ASSERT_TRUE(single_job.Run());
+    for (int j = 0; j < 6; ++j) {
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ(output[i][j].cols[c],
+                            ozz::math::GetX(single[j].cols[c]),
+                            ozz::math::GetY(single[j].cols[c]),
+                            ozz::math::GetZ(single[j].cols[c]),
+                            ozz::math::GetW(single[j].cols[c]));
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(JobValidity, LocalToModelTransform) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(4);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_soa_joints(), 2);
+
+  ozz::math::SoaTransform input[2] = {ozz::math::SoaTransform::identity(),
+                                      ozz::math::SoaTransform::identity()};
+  ozz::math::SoaTransform output[2];
+
+  {  // Default job.
+    LocalToModelTransformJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No skeleton.
+    LocalToModelTransformJob job;
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No input.
+    LocalToModelTransformJob job;
+    job.skeleton = skeleton;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid input.
+    LocalToModelTransformJob job;
+    job.skeleton = skeleton;
+    job.input = ozz::Range<const ozz::math::SoaTransform>(input, 1);
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    LocalToModelTransformJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = ozz::Range<ozz::math::SoaTransform>(output, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    LocalToModelTransformJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Transform, LocalToModelTransform) {
+  // Builds a 10 joints skeleton, whose joints are stored in order: root, j0,
+  // j3, j1, j2, j4, j5, j6, j7, j8. j1 parent belongs to the same soa joint,
+  // as do j5 and j6 ones.
+  /*
+      root
+      /  \
+     j0  j3
+     |    |
+     j1  j4
+     |    |
+     j2  j5
+          |
+         j6
+        /  \
+       j7  j8
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* left = &raw_skeleton.roots[0];
+  left->children.resize(2);
+  RawSkeleton::Joint* right = &left->children[1];
+  left = &left->children[0];
+  for (int i = 0; i < 2; ++i) {
+    left->children.resize(1);
+    left = &left->children[0];
+  }
+  for (int i = 0; i < 3; ++i) {
+    right->children.resize(1);
+    right = &right->children[0];
+  }
+  right->children.resize(2);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 10);
+  ASSERT_EQ(skeleton->num_soa_joints(), 3);
+
+  // Every joint is translated, rotated and uniformly scaled differently.
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    float tx[4], ty[4], qx[4], qw[4], qy[4], s[4];
+    for (int l = 0; l < 4; ++l) {
+      const float f = static_cast<float>(i * 4 + l);
+      tx[l] = f + 1.f;
+      ty[l] = f * .5f - 2.f;
+      const float angle = f * .3f;
+      qx[l] = std::sin(angle * .5f) * .6f;
+      qy[l] = std::sin(angle * .5f) * .8f;
+      qw[l] = std::cos(angle * .5f);
+      s[l] = 1.f + (l & 1) * .5f;
+    }
+    const ozz::math::SimdFloat4 scale = ozz::math::simd_float4::LoadPtrU(s);
+    const ozz::math::SoaTransform transform = {
+        ozz::math::SoaFloat3::Load(ozz::math::simd_float4::LoadPtrU(tx),
+                                   ozz::math::simd_float4::LoadPtrU(ty),
+                                   ozz::math::simd_float4::Load1(3.f)),
+        ozz::math::SoaQuaternion::Load(ozz::math::simd_float4::LoadPtrU(qx),
+                                       ozz::math::simd_float4::LoadPtrU(qy),
+                                       ozz::math::simd_float4::zero(),
+                                       ozz::math::simd_float4::LoadPtrU(qw)),
+        ozz::math::SoaFloat3::Load(scale, scale, scale)};
+    input[i] = transform;
+  }
+
+  ozz::math::SoaTransform output[3];
+  LocalToModelTransformJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  // Model-space transforms match LocalToModelJob model matrices.
+  ozz::math::Float4x4 matrices[12];
+  LocalToModelJob matrix_job;
+  matrix_job.skeleton = skeleton;
+  matrix_job.input = input;
+  matrix_job.output = matrices;
+  ASSERT_TRUE(matrix_job.Run());
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(output[i].rotation)));
+    const ozz::math::SoaFloat4x4 soa_matrices =
+        ozz::math::SoaFloat4x4::FromAffine(
+            output[i].translation, output[i].rotation, output[i].scale);
+    ozz::math::Float4x4 aos_matrices[4];
+    ozz::math::Transpose16x16(&soa_matrices.cols[0].x,
+                              &aos_matrices[0].cols[0]);
+    for (int l = 0; l < 4 && i * 4 + l < 10; ++l) {
+      const ozz::math::Float4x4& matrix = matrices[i * 4 + l];
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ_EST(aos_matrices[l].cols[c],
+                                ozz::math::GetX(matrix.cols[c]),
+                                ozz::math::GetY(matrix.cols[c]),
+                                ozz::math::GetZ(matrix.cols[c]),
+                                ozz::math::GetW(matrix.cols[c]));
+      }
+    }
+  }
+
+  // Input and output can alias.
+  job.output = input;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(ozz::math::AreAllTrue(input[i].translation ==
+                                      output[i].translation));
+    EXPECT_TRUE(
+        ozz::math::AreAllTrue(input[i].rotation == output[i].rotation));
+  }
+
   ozz::memory::default_allocator()->Delete(skeleton);
 }
@@ -0,0 +1,333 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/sample_blending_job.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::SampleBlendingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+
+TEST(JobValidity, SampleBlendingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(9);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_pose[3] = {identity, identity, identity};
+  ozz::math::SoaTransform output[3];
+  const ozz::math::SimdFloat4 joint_weights[2] = {
+      ozz::math::simd_float4::one(), ozz::math::simd_float4::one()};
+  SamplingCache cache(9);
+  SamplingCache small_cache(7);
+
+  SampleBlendingJob::Layer layers[2];
+  layers[0].animation = animation;
+  layers[0].cache = &cache;
+  layers[1].animation = animation;
+  layers[1].cache = &cache;
+
+  {  // Empty/default job.
+    SampleBlendingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job without layer.
+    SampleBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Invalid output too small.
+    SampleBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = ozz::Range<ozz::math::SoaTransform>(output, 2);
+    job.layers = layers;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid threshold.
+    SampleBlendingJob job;
+    job.threshold = 0.f;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    job.layers = layers;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation smaller than the bind pose.
+    SampleBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    SampleBlendingJob::Layer big_layers[1];
+    big_layers[0] = layers[0];
+    const ozz::math::SoaTransform big_bind_pose[4] = {identity, identity,
+                                                      identity, identity};
+    ozz::math::SoaTransform big_output[4];
+    job.bind_pose = big_bind_pose;
+    job.output = big_output;
+    job.layers = big_layers;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid NULL animation.
+    SampleBlendingJob::Layer invalid_layers[2] = {layers[0], layers[1]};
+    invalid_layers[1].animation = NULL;
+    SampleBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    job.layers = invalid_layers;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid NULL cache.
+    SampleBlendingJob::Layer invalid_layers[2] = {layers[0], layers[1]};
+    invalid_layers[1].cache = NULL;
+    SampleBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    job.layers = invalid_layers;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache too small.
+    SampleBlendingJob::Layer invalid_layers[2] = {layers[0], layers[1]};
+    invalid_layers[1].cache = &small_cache;
+    SampleBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    job.layers = invalid_layers;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid joint weights too small.
+    SampleBlendingJob::Layer invalid_layers[2] = {layers[0], layers[1]};
+    invalid_layers[1].joint_weights = joint_weights;
+    SampleBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    job.layers = invalid_layers;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job with a bigger output.
+    ozz::math::SoaTransform big_output[4];
+    SampleBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = big_output;
+    job.layers = layers;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Fills _raw_animation with _num_tracks tracks. Every 3rd track is constant,
+// so that some soa tracks are constant and interleaved with animated ones.
+void FillAnimation(int _num_tracks, float _seed, RawAnimation* _raw_animation) {
+  _raw_animation->duration = 1.f;
+  _raw_animation->tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = _raw_animation->tracks[i];
+    const int num_keys = (i / 4) % 3 == 2 ? 1 : 2 + i % 3;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = num_keys == 1 ? 0.f : k / (num_keys - 1.f);
+      const float value = _seed + i * .1f + k;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(value, -value, 1.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float4(0.f, 1.f, 0.f, value))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f, 1.f + value, 2.f)};
+      track.scales.push_back(skey);
+    }
+  }
+}
+
+// Samples and blends _layers with SamplingJob and BlendingJob, and expects
+// SampleBlendingJob output to match.
+void ExpectSameAsSamplingAndBlending(
+    ozz::Range<const SampleBlendingJob::Layer> _layers,
+    ozz::Range<const ozz::math::SoaTransform> _bind_pose) {
+  const size_t num_soa_joints = _bind_pose.Count();
+  const size_t num_layers = _layers.Count();
+  ozz::math::SoaTransform samples[3][16];
+  BlendingJob::Layer blend_layers[3];
+  ASSERT_LE(num_layers, OZZ_ARRAY_SIZE(blend_layers));
+  ASSERT_LE(num_soa_joints, OZZ_ARRAY_SIZE(samples[0]));
+
+  for (size_t i = 0; i < num_layers; ++i) {
+    const SampleBlendingJob::Layer& layer = _layers.begin[i];
+    SamplingCache cache(layer.animation->num_tracks());
+    SamplingJob sampling_job;
+    sampling_job.animation = layer.animation;
+    sampling_job.cache = &cache;
+    sampling_job.time = layer.time;
+    sampling_job.output = samples[i];
+    ASSERT_TRUE(sampling_job.Run());
+
+    blend_layers[i].weight = layer.weight;
+    blend_layers[i].transform = samples[i];
+    blend_layers[i].joint_weights = layer.joint_weights;
+  }
+
+  ozz::math::SoaTransform expected[16];
+  BlendingJob blending_job;
+  blending_job.layers =
+      ozz::Range<const BlendingJob::Layer>(blend_layers, num_layers);
+  blending_job.bind_pose = _bind_pose;
+  blending_job.output = expected;
+  ASSERT_TRUE(blending_job.Run());
+
+  ozz::math::SoaTransform output[16];
+  SampleBlendingJob job;
+  job.layers = _layers;
+  job.bind_pose = _bind_pose;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_EQ(memcmp(output, expected, sizeof(output[0]) * num_soa_joints), 0);
+}
+}  // namespace
+
+TEST(Blend, SampleBlendingJob) {
+  // Uses more soa joints than the size of a chunk processed by the job.
+  const int kNumTracks = 46;
+  const int kNumSoaTracks = (kNumTracks + 3) / 4;
+  AnimationBuilder builder;
+  Animation* animations[3];
+  for (int i = 0; i < 3; ++i) {
+    RawAnimation raw_animation;
+    FillAnimation(kNumTracks, i * 2.f, &raw_animation);
+    animations[i] = builder(raw_animation);
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+
+  ozz::math::SoaTransform bind_pose[kNumSoaTracks];
+  ozz::math::SimdFloat4 joint_weights[kNumSoaTracks];
+  for (int i = 0; i < kNumSoaTracks; ++i) {
+    const ozz::math::SoaTransform identity =
+        ozz::math::SoaTransform::identity();
+    bind_pose[i] = identity;
+    bind_pose[i].translation.x = ozz::math::simd_float4::Load1(i * 1.f);
+    joint_weights[i] = ozz::math::simd_float4::Load(0.f, .2f, i * .1f, 1.f);
+  }
+
+  SamplingCache cache0(kNumTracks);
+  SamplingCache cache1(kNumTracks);
+  SamplingCache cache2(kNumTracks);
+  SampleBlendingJob::Layer layers[3];
+  layers[0].cache = &cache0;
+  layers[1].cache = &cache1;
+  layers[2].cache = &cache2;
+  for (int i = 0; i < 3; ++i) {
+    layers[i].animation = animations[i];
+  }
+  const ozz::Range<const SampleBlendingJob::Layer> layers_range(layers);
+  const ozz::Range<const ozz::math::SoaTransform> bind_pose_range(bind_pose);
+
+  const float times[] = {0.f, .3f, .31f, .8f, 1.f, .2f, 1.1f};
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(times); ++t) {
+    for (int i = 0; i < 3; ++i) {
+      layers[i].time = times[t] + i * .1f;
+      layers[i].joint_weights = ozz::Range<const ozz::math::SimdFloat4>();
+    }
+
+    // Full layers.
+    layers[0].weight = .5f;
+    layers[1].weight = .3f;
+    layers[2].weight = .2f;
+    ExpectSameAsSamplingAndBlending(layers_range, bind_pose_range);
+
+    // Skips a layer.
+    layers[1].weight = 0.f;
+    ExpectSameAsSamplingAndBlending(layers_range, bind_pose_range);
+
+    // Accumulated weight below threshold, bind pose is blended.
+    layers[0].weight = .02f;
+    layers[2].weight = .03f;
+    ExpectSameAsSamplingAndBlending(layers_range, bind_pose_range);
+
+    // No layer, bind pose is copied.
+    layers[0].weight = 0.f;
+    layers[2].weight = -1.f;
+    ExpectSameAsSamplingAndBlending(layers_range, bind_pose_range);
+
+    // Partial blending.
+    layers[0].weight = .6f;
+    layers[1].weight = .4f;
+    layers[2].weight = 1.f;
+    layers[1].joint_weights = joint_weights;
+    ExpectSameAsSamplingAndBlending(layers_range, bind_pose_range);
+
+    // Partial blending of the first layer, with joints below threshold.
+    layers[0].joint_weights = joint_weights;
+    layers[2].weight = 0.f;
+    ExpectSameAsSamplingAndBlending(layers_range, bind_pose_range);
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    ozz::memory::default_allocator()->Delete(animations[i]);
+  }
+}
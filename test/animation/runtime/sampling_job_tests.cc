@@ -40,7 +40,10 @@
 
 using ozz::animation::Animation;
 using ozz::animation::SamplingJob;
+using ozz::animation::RandomAccessSamplingJob;
+using ozz::animation::BatchSamplingJob;
 using ozz::animation::SamplingCache;
+using ozz::animation::SamplingStats;
 using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::AnimationBuilder;
 
@@ -107,6 +110,37 @@ TEST(JobValidity, SamplingJob) {
     EXPECT_FALSE(job.Run());
   }
 
+  {  // Invalid mask size.
+    const unsigned char mask[1] = {1};
+    ozz::math::SoaTransform output[1];
+
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    job.soa_mask.begin = mask;
+    job.soa_mask.end = mask;
+    EXPECT_TRUE(job.Validate());  // Empty mask is valid.
+    job.soa_mask.begin = NULL;
+    job.soa_mask.end = mask + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid mask.
+    const unsigned char mask[1] = {0};
+    ozz::math::SoaTransform output[1];
+
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    job.soa_mask = mask;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
   {  // Invalid output range: end < begin.
     ozz::math::SoaTransform output[1];
 
@@ -688,3 +722,957 @@ TEST(SamplingCache, SamplingJob) {
   ozz::memory::default_allocator()->Delete(animations[0]);
   ozz::memory::default_allocator()->Delete(animations[1]);
 }
+
+TEST(JobValidity, BatchSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Allocates cache.
+  SamplingCache cache(1);
+
+  ozz::math::SoaTransform output0[1];
+  ozz::math::SoaTransform output1[1];
+  const ozz::Range<ozz::math::SoaTransform> outputs[] = {
+    ozz::Range<ozz::math::SoaTransform>(output0),
+    ozz::Range<ozz::math::SoaTransform>(output1)};
+  const ozz::Range<ozz::math::SoaTransform> small_outputs[] = {
+    ozz::Range<ozz::math::SoaTransform>(output0),
+    ozz::Range<ozz::math::SoaTransform>(output1, output1)};
+  const float times[] = {.2f, .5f};
+  const float unsorted_times[] = {.5f, .2f};
+
+  {  // Empty/default job
+    BatchSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation.
+    BatchSamplingJob job;
+    job.cache = &cache;
+    job.times = times;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.times = times;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache size.
+    SamplingCache zero_cache(0);
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &zero_cache;
+    job.times = times;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid number of outputs.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.times = times;
+    job.outputs.begin = outputs;
+    job.outputs.end = outputs + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output size.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.times = times;
+    job.outputs = small_outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Unsorted times.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.times = unsorted_times;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid empty job.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.times = times;
+    job.outputs = outputs;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, BatchSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  for (int i = 0; i < raw_animation.num_tracks(); ++i) {
+    for (int k = 0; k < 5; ++k) {
+      const float time = (i + k * 2.f) / 20.f;
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(i + time, k - time, 1.f)};
+      raw_animation.tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromAxisAngle(
+                ozz::math::Float4(0.f, 1.f, 0.f, time * 3.f))};
+      raw_animation.tracks[i].rotations.push_back(rkey);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Includes times out of range and duplicated times.
+  const float times[] = {-.1f, 0.f, .15f, .15f, .33f, .5f, .95f, 1.f, 1.2f};
+  const size_t kCount = OZZ_ARRAY_SIZE(times);
+  ozz::math::SoaTransform batch_outputs[kCount][2];
+  ozz::Range<ozz::math::SoaTransform> outputs[kCount];
+  for (size_t i = 0; i < kCount; ++i) {
+    outputs[i] = batch_outputs[i];
+  }
+
+  SamplingCache batch_cache(5);
+  BatchSamplingJob batch_job;
+  batch_job.animation = animation;
+  batch_job.cache = &batch_cache;
+  batch_job.times = times;
+  batch_job.outputs = outputs;
+  ASSERT_TRUE(batch_job.Run());
+
+  // Compares with individual sampling.
+  for (size_t i = 0; i < kCount; ++i) {
+    SamplingCache cache(5);
+    ozz::math::SoaTransform output[2];
+    SamplingJob job;
+    job.time = times[i];
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    EXPECT_EQ(memcmp(output, batch_outputs[i], sizeof(output)), 0);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Fills _raw_animation with 9 tracks, each one with a different number of
+// keys, so that tracks keys are interleaved.
+void FillInterleavedKeys(RawAnimation* _raw_animation) {
+  _raw_animation->duration = 2.f;
+  _raw_animation->tracks.resize(9);
+
+  for (int i = 0; i < _raw_animation->num_tracks(); ++i) {
+    for (int k = 0; k < 4 + i * 3; ++k) {
+      const float time = _raw_animation->duration * k / (4.f + i * 3.f) + .01f;
+      const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(i + time, k - time, 1.f)};
+      _raw_animation->tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromAxisAngle(
+                ozz::math::Float4(0.f, 1.f, 0.f, time * 3.f))};
+      _raw_animation->tracks[i].rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+        time, ozz::math::Float3(1.f, 1.f + time, 1.f + k)};
+      _raw_animation->tracks[i].scales.push_back(skey);
+    }
+  }
+}
+
+// Samples _animation at _time with _cache and compares the result with a
+// sampling done with a new cache.
+void ExpectSameAsNewCache(const Animation* _animation, float _time,
+                          SamplingCache* _cache) {
+  ozz::math::SoaTransform output[3];
+  SamplingJob job;
+  job.time = _time;
+  job.animation = _animation;
+  job.cache = _cache;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  SamplingCache new_cache(9);
+  ozz::math::SoaTransform expected[3];
+  job.cache = &new_cache;
+  job.output = expected;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0) << "time " << _time;
+}
+}  // namespace
+
+TEST(Backward, SamplingJob) {
+  RawAnimation raw_animation;
+  FillInterleavedKeys(&raw_animation);
+
+  // Without reverse keys, the cache is restarted when played backward.
+  for (int reverse_keys = 0; reverse_keys < 2; ++reverse_keys) {
+    AnimationBuilder builder;
+    builder.reverse_keys = reverse_keys != 0;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->has_reverse_keys(), reverse_keys != 0);
+    EXPECT_EQ(animation->reverse_translations().Count() != 0,
+              reverse_keys != 0);
+
+    SamplingCache cache(9);
+
+    // Plays backward from the end, then forward, then backward again.
+    for (float time = 2.1f; time >= -.1f; time -= .01f) {
+      ExpectSameAsNewCache(animation, time, &cache);
+    }
+    for (float time = 0.f; time <= 1.5f; time += .03f) {
+      ExpectSameAsNewCache(animation, time, &cache);
+    }
+    for (float time = 1.5f; time >= .5f; time -= .07f) {
+      ExpectSameAsNewCache(animation, time, &cache);
+    }
+
+    // Changes direction every frame, and samples key times.
+    const float times[] = {1.f,  .9f,  .95f, .5f,   .51f, .01f,  .02f, 2.f,
+                           1.99f, 2.f, 1.f,  1.01f, .99f, .244f, .234f};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+      ExpectSameAsNewCache(animation, times[i], &cache);
+    }
+
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(SoaMask, SamplingJob) {
+  RawAnimation raw_animation;
+  FillInterleavedKeys(&raw_animation);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_EQ(animation->num_soa_tracks(), 3);
+
+  SamplingCache cache(9);
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+
+  // Soa tracks 0 and 2 are sampled, 1 is masked.
+  const unsigned char mask[] = {5};
+  job.soa_mask = mask;
+
+  const float times[] = {0.f, .3f, .8f, .5f, 1.9f, 2.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    ozz::math::SoaTransform output[3];
+    memset(output, 0xcd, sizeof(output));
+    job.time = times[i];
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    // Samples without mask with a new cache.
+    SamplingCache full_cache(9);
+    ozz::math::SoaTransform expected[3];
+    SamplingJob full_job;
+    full_job.time = times[i];
+    full_job.animation = animation;
+    full_job.cache = &full_cache;
+    full_job.output = expected;
+    ASSERT_TRUE(full_job.Run());
+
+    EXPECT_EQ(memcmp(&output[0], &expected[0], sizeof(output[0])), 0);
+    EXPECT_EQ(memcmp(&output[2], &expected[2], sizeof(output[2])), 0);
+
+    // Masked soa track is left unchanged.
+    ozz::math::SoaTransform untouched;
+    memset(&untouched, 0xcd, sizeof(untouched));
+    EXPECT_EQ(memcmp(&output[1], &untouched, sizeof(output[1])), 0);
+  }
+
+  // Samples all tracks with the same cache, previously masked track must be
+  // properly updated.
+  for (float time = 1.f; time < 2.f; time += .1f) {
+    ExpectSameAsNewCache(animation, time, &cache);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SoaRange, SamplingJob) {
+  RawAnimation raw_animation;
+  FillInterleavedKeys(&raw_animation);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_EQ(animation->num_soa_tracks(), 3);
+
+  ozz::math::SoaTransform output[3];
+
+  {  // Invalid ranges.
+    SamplingCache cache(9);
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    job.begin_soa = -1;
+    EXPECT_FALSE(job.Validate());
+    job.begin_soa = 2;
+    job.end_soa = 1;
+    EXPECT_FALSE(job.Validate());
+    job.end_soa = 2;
+    EXPECT_TRUE(job.Validate());
+    job.end_soa = 46;  // Clamped to the number of soa tracks.
+    EXPECT_TRUE(job.Validate());
+  }
+
+  // Splits soa tracks in 2 ranges, each one with its own cache, as it would be
+  // done by 2 threads.
+  SamplingCache cache0(9);
+  SamplingCache cache1(9);
+  SamplingCache* caches[2] = {&cache0, &cache1};
+  const int ranges[2][2] = {{0, 1}, {1, 46}};
+
+  const float times[] = {0.f, .3f, .8f, .5f, 1.9f, 2.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    memset(output, 0xcd, sizeof(output));
+    for (int r = 0; r < 2; ++r) {
+      SamplingJob job;
+      job.time = times[i];
+      job.animation = animation;
+      job.cache = caches[r];
+      job.output = output;
+      job.begin_soa = ranges[r][0];
+      job.end_soa = ranges[r][1];
+      ASSERT_TRUE(job.Run());
+    }
+
+    // Samples all soa tracks with a new cache.
+    SamplingCache full_cache(9);
+    ozz::math::SoaTransform expected[3];
+    SamplingJob full_job;
+    full_job.time = times[i];
+    full_job.animation = animation;
+    full_job.cache = &full_cache;
+    full_job.output = expected;
+    ASSERT_TRUE(full_job.Run());
+
+    EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+  }
+
+  {  // Soa tracks out of range are left unchanged.
+    memset(output, 0xcd, sizeof(output));
+    SamplingJob job;
+    job.time = .7f;
+    job.animation = animation;
+    job.cache = caches[0];
+    job.output = output;
+    job.begin_soa = 1;
+    job.end_soa = 2;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform untouched;
+    memset(&untouched, 0xcd, sizeof(untouched));
+    EXPECT_EQ(memcmp(&output[0], &untouched, sizeof(output[0])), 0);
+    EXPECT_NE(memcmp(&output[1], &untouched, sizeof(output[1])), 0);
+    EXPECT_EQ(memcmp(&output[2], &untouched, sizeof(output[2])), 0);
+  }
+
+  // Samples all tracks with the same caches, soa tracks that weren't
+  // decompressed must be properly updated.
+  for (float time = 1.f; time < 2.f; time += .1f) {
+    ExpectSameAsNewCache(animation, time, caches[0]);
+    ExpectSameAsNewCache(animation, time, caches[1]);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SeekPoints, SamplingJob) {
+  RawAnimation raw_animation;
+  FillInterleavedKeys(&raw_animation);
+
+  // Reference animation, without seek point.
+  AnimationBuilder builder;
+  Animation* reference = builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+  EXPECT_EQ(reference->num_seek_points(), 0);
+
+  builder.seek_interval = .25f;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_seek_points(), 7);
+
+  // Forward, rewinds and jumps.
+  const float times[] = {0.f,  .1f,  .3f,  .2f,   1.9f, .25f, .5f,  .49f,
+                         .75f, 1.75f, 1.f, 2.f,   .24f, .26f, 1.3f, .8f,
+                         0.f,  2.1f,  .51f, -1.f, 1.51f, 1.52f};
+
+  SamplingCache cache(9);
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    ozz::math::SoaTransform output[3];
+    job.time = times[i];
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    // Samples reference with a new cache.
+    SamplingCache reference_cache(9);
+    ozz::math::SoaTransform expected[3];
+    SamplingJob reference_job;
+    reference_job.time = times[i];
+    reference_job.animation = reference;
+    reference_job.cache = &reference_cache;
+    reference_job.output = expected;
+    ASSERT_TRUE(reference_job.Run());
+
+    EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+  }
+
+  ozz::memory::default_allocator()->Delete(reference);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Quantization, SamplingJob) {
+  // Translation and scale keys are quantized within the range of their track,
+  // so precision doesn't depend on values magnitude.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+
+  // Times are multiples of key frames time precision (duration / 65535).
+  const float times[] = {0.f, 19661.f / 65535.f, 39321.f / 65535.f, 1.f};
+  const float root[] = {1000.f, 1003.1234f, 1006.5678f, 1010.f};
+  const float small[] = {.001f, .0012345f, .0019876f, .0011f};
+  const float scale[] = {20.f, 21.2345f, 29.8765f, 30.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    // Root motion like track, far from the origin.
+    const RawAnimation::TranslationKey root_key = {
+        times[i], ozz::math::Float3(root[i], -4000.f, -root[i])};
+    raw_animation.tracks[0].translations.push_back(root_key);
+
+    // Small and large values track.
+    const RawAnimation::TranslationKey small_key = {
+        times[i], ozz::math::Float3(small[i], 0.f, 0.f)};
+    raw_animation.tracks[1].translations.push_back(small_key);
+    const RawAnimation::ScaleKey scale_key = {
+        times[i], ozz::math::Float3(1.f, scale[i], 1.f)};
+    raw_animation.tracks[1].scales.push_back(scale_key);
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(2);
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+
+  // Samples at key times, but the last one, so that interpolation doesn't
+  // introduce any error. The remaining error is bounded by half of a
+  // quantization step.
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times) - 1; ++i) {
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+
+    OZZ_ALIGN(16) float values[4];
+    ozz::math::StorePtr(output[0].translation.x, values);
+    EXPECT_NEAR(values[0], root[i], 10.f / 65535.f * .5f);
+    EXPECT_NEAR(values[1], small[i], .0009876f / 65535.f * .5f);
+    ozz::math::StorePtr(output[0].translation.y, values);
+    EXPECT_FLOAT_EQ(values[0], -4000.f);
+    EXPECT_FLOAT_EQ(values[1], 0.f);
+    ozz::math::StorePtr(output[0].translation.z, values);
+    EXPECT_NEAR(values[0], -root[i], 10.f / 65535.f * .5f);
+    ozz::math::StorePtr(output[0].scale.y, values);
+    EXPECT_FLOAT_EQ(values[0], 1.f);
+    EXPECT_NEAR(values[1], scale[i], 10.f / 65535.f * .5f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(ConstantTracks, SamplingJob) {
+  // Soa track 0 translations and soa track 1 rotations are constant, so they
+  // are copied to the output without any key frame.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(8);
+
+  for (int i = 0; i < 4; ++i) {
+    const RawAnimation::TranslationKey constant = {
+        .5f, ozz::math::Float3(static_cast<float>(i), 1.f, 2.f)};
+    raw_animation.tracks[i].translations.push_back(constant);
+  }
+  const RawAnimation::RotationKey rotation = {
+      .5f, ozz::math::Quaternion(0.f, .70710677f, 0.f, .70710677f)};
+  raw_animation.tracks[6].rotations.push_back(rotation);
+
+  const RawAnimation::TranslationKey first = {0.f,
+                                              ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[5].translations.push_back(first);
+  const RawAnimation::TranslationKey last = {1.f,
+                                             ozz::math::Float3(1.f, 2.f, 1.f)};
+  raw_animation.tracks[5].translations.push_back(last);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_translation_soa_tracks(), 1);
+  EXPECT_EQ(animation->num_rotation_soa_tracks(), 0);
+  EXPECT_EQ(animation->num_scale_soa_tracks(), 0);
+
+  SamplingCache cache(8);
+  ozz::math::SoaTransform output[2];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+
+  const float times[] = {0.f, .5f, .75f, .25f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    memset(output, 0xcd, sizeof(output));
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+
+    const float t = times[i];
+    EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 1.f, 2.f, 3.f, 1.f, 1.f,
+                        1.f, 1.f, 2.f, 2.f, 2.f, 2.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 0.f, t, 0.f, 0.f, 0.f,
+                            2.f * t, 0.f, 0.f, 0.f, t, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                                1.f, 1.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[1].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                0.f, .70710677f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                                1.f, .70710677f, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output[1].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f, 1.f);
+  }
+
+  // Masked constant soa tracks are left unchanged.
+  const unsigned char mask[] = {2};
+  job.soa_mask = mask;
+  memset(output, 0xcd, sizeof(output));
+  ASSERT_TRUE(job.Run());
+  ozz::math::SoaTransform untouched;
+  memset(&untouched, 0xcd, sizeof(untouched));
+  EXPECT_EQ(memcmp(&output[0], &untouched, sizeof(output[0])), 0);
+  EXPECT_SOAFLOAT3_EQ(output[1].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                      1.f, 1.f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(JobValidity, RandomAccessSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(9);
+
+  AnimationBuilder builder;
+  builder.track_keys = true;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::math::SoaTransform output[3];
+
+  {  // Invalid animation, without per-track key indices.
+    AnimationBuilder default_builder;
+    Animation* no_track_keys = default_builder(raw_animation);
+    ASSERT_TRUE(no_track_keys != NULL);
+    RandomAccessSamplingJob job;
+    job.animation = no_track_keys;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    ozz::memory::default_allocator()->Delete(no_track_keys);
+  }
+
+  {  // Empty/default job
+    RandomAccessSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    RandomAccessSamplingJob job;
+    job.animation = animation;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output range, smaller than the animation.
+    RandomAccessSamplingJob job;
+    job.animation = animation;
+    job.output = ozz::Range<ozz::math::SoaTransform>(output, 2);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid mask, too small.
+    RandomAccessSamplingJob job;
+    job.animation = animation;
+    job.output = output;
+    const unsigned char mask[1] = {0xff};
+    job.soa_mask = ozz::Range<const unsigned char>(mask, mask);
+    EXPECT_TRUE(job.Validate());
+    job.soa_mask = ozz::Range<const unsigned char>(NULL, mask + 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    RandomAccessSamplingJob job;
+    job.time = 2.f;  // Time is clamped.
+    job.animation = animation;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, RandomAccessSamplingJob) {
+  // Uses more than 8 animated soa tracks, as they are processed by chunks of
+  // 8.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(41);
+  for (int i = 0; i < raw_animation.num_tracks(); ++i) {
+    const int num_keys = 2 + (i * 7) % 11;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = raw_animation.duration * k / num_keys + .01f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(i + time, k - time, 1.f)};
+      raw_animation.tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float4(0.f, 1.f, 0.f, time * i))};
+      raw_animation.tracks[i].rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f, 1.f + time, 1.f + k)};
+      raw_animation.tracks[i].scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.track_keys = true;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_EQ(animation->num_translation_soa_tracks(), 11);
+
+  // Soa tracks 1 and 9 are masked.
+  const unsigned char full_mask[] = {0xff, 0xff};
+  const unsigned char partial_mask[] = {0xfd, 0xfd};
+  const ozz::Range<const unsigned char> masks[] = {
+      ozz::Range<const unsigned char>(),
+      ozz::Range<const unsigned char>(full_mask),
+      ozz::Range<const unsigned char>(partial_mask)};
+
+  SamplingCache cache(41);
+  const float times[] = {0.f,  1.3f, .2f, 2.f,   .01f,
+                         1.9f, .5f,  3.f, -1.f, 1.05f};
+  for (size_t m = 0; m < OZZ_ARRAY_SIZE(masks); ++m) {
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+      ozz::math::SoaTransform output[11];
+      memset(output, 0xcd, sizeof(output));
+      RandomAccessSamplingJob job;
+      job.time = times[i];
+      job.animation = animation;
+      job.soa_mask = masks[m];
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+
+      // Random access sampling must match cached sampling.
+      ozz::math::SoaTransform expected[11];
+      memset(expected, 0xcd, sizeof(expected));
+      SamplingJob cached_job;
+      cached_job.time = times[i];
+      cached_job.animation = animation;
+      cached_job.cache = &cache;
+      cached_job.soa_mask = masks[m];
+      cached_job.output = expected;
+      ASSERT_TRUE(cached_job.Run());
+
+      EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0)
+          << "time " << times[i] << ", mask " << m;
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Frames, BatchSamplingJob) {
+  // Samples the same animation at several future times every frame, like
+  // motion matching does. Times are farther apart than seek interval, so the
+  // cache is also restored from seek points within a batch.
+  RawAnimation raw_animation;
+  FillInterleavedKeys(&raw_animation);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .2f;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache batch_cache(9);
+  const float offsets[] = {0.f, .1f, .35f, .7f, 1.1f};
+  const size_t kCount = OZZ_ARRAY_SIZE(offsets);
+  for (float frame = 0.f; frame < 3.f; frame += .3f) {
+    // Loops the animation at t = 2, so the batch starts behind the cache.
+    const float start = frame < 2.f ? frame : frame - 2.f;
+    float times[kCount];
+    ozz::math::SoaTransform batch_outputs[kCount][3];
+    ozz::Range<ozz::math::SoaTransform> outputs[kCount];
+    for (size_t i = 0; i < kCount; ++i) {
+      times[i] = start + offsets[i];
+      outputs[i] = batch_outputs[i];
+    }
+
+    BatchSamplingJob batch_job;
+    batch_job.animation = animation;
+    batch_job.cache = &batch_cache;
+    batch_job.times = times;
+    batch_job.outputs = outputs;
+    ASSERT_TRUE(batch_job.Run());
+
+    for (size_t i = 0; i < kCount; ++i) {
+      SamplingCache cache(9);
+      ozz::math::SoaTransform output[3];
+      SamplingJob job;
+      job.time = times[i];
+      job.animation = animation;
+      job.cache = &cache;
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+
+      EXPECT_EQ(memcmp(output, batch_outputs[i], sizeof(output)), 0)
+          << "time " << times[i];
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sharing, BatchSamplingJob) {
+  // Samples a crowd of instances playing the same animation, whose times are
+  // spread over the animation and advanced every frame. Compares with
+  // sampling every instance with its own SamplingJob and cache.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(4);
+  for (int i = 0; i < raw_animation.num_tracks(); ++i) {
+    for (int k = 0; k <= 10; ++k) {
+      const float time = k / 10.f;
+      const RawAnimation::TranslationKey key = {
+          time, ozz::math::Float3(time * i, 1.f - time, static_cast<float>(k))};
+      raw_animation.tracks[i].translations.push_back(key);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  const int kCount = 64;
+  SamplingCache* caches[kCount];
+  ozz::math::SoaTransform outputs[kCount][1];
+  ozz::Range<ozz::math::SoaTransform> batch_outputs[kCount];
+  ozz::math::SoaTransform batch_transforms[kCount][1];
+  for (int i = 0; i < kCount; ++i) {
+    caches[i] = ozz::memory::default_allocator()->New<SamplingCache>(4);
+    batch_outputs[i] = batch_transforms[i];
+  }
+  SamplingCache batch_cache(4);
+
+  SamplingStats stats;
+  SamplingStats batch_stats;
+  for (int frame = 0; frame < 2; ++frame) {
+    // Statistics of the first frame, which fills the caches, are ignored.
+    stats.Reset();
+    batch_stats.Reset();
+
+    float times[kCount];
+    for (int i = 0; i < kCount; ++i) {
+      times[i] = i / static_cast<float>(kCount) + frame * .05f;
+
+      SamplingJob job;
+      job.time = times[i];
+      job.animation = animation;
+      job.cache = caches[i];
+      job.output = outputs[i];
+      job.stats = &stats;
+      ASSERT_TRUE(job.Run());
+    }
+
+    BatchSamplingJob batch_job;
+    batch_job.animation = animation;
+    batch_job.cache = &batch_cache;
+    batch_job.times = times;
+    batch_job.outputs = batch_outputs;
+    batch_job.stats = &batch_stats;
+    ASSERT_TRUE(batch_job.Run());
+
+    for (int i = 0; i < kCount; ++i) {
+      EXPECT_EQ(memcmp(outputs[i], batch_transforms[i], sizeof(outputs[i])), 0)
+          << "time " << times[i];
+    }
+  }
+
+#if defined(OZZ_BUILD_SAMPLING_STATS)
+  // Instances outnumber key frames, so a single sweep walks and decompresses
+  // less keys than instances do independently, despite the batch restarting
+  // from the beginning of the animation.
+  EXPECT_EQ(batch_stats.num_samples, stats.num_samples);
+  EXPECT_EQ(batch_stats.num_cache_restarts, 1u);
+  EXPECT_LT(batch_stats.num_forward_keys, stats.num_forward_keys);
+  EXPECT_LT(batch_stats.num_decompressed_soa, stats.num_decompressed_soa);
+#endif  // OZZ_BUILD_SAMPLING_STATS
+
+  for (int i = 0; i < kCount; ++i) {
+    ozz::memory::default_allocator()->Delete(caches[i]);
+  }
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Accumulate, SamplingStats) {
+  SamplingStats stats;
+  EXPECT_EQ(stats.num_samples, 0u);
+  EXPECT_EQ(stats.num_cache_invalidations, 0u);
+  EXPECT_EQ(stats.num_cache_restarts, 0u);
+  EXPECT_EQ(stats.num_cache_seeks, 0u);
+  EXPECT_EQ(stats.num_forward_keys, 0u);
+  EXPECT_EQ(stats.num_backward_keys, 0u);
+  EXPECT_EQ(stats.num_decompressed_soa, 0u);
+
+  SamplingStats other;
+  other.num_samples = 1;
+  other.num_cache_invalidations = 2;
+  other.num_cache_restarts = 3;
+  other.num_cache_seeks = 4;
+  other.num_forward_keys = 5;
+  other.num_backward_keys = 6;
+  other.num_decompressed_soa = 7;
+  stats.Accumulate(other);
+  stats.Accumulate(other);
+  EXPECT_EQ(stats.num_samples, 2u);
+  EXPECT_EQ(stats.num_cache_invalidations, 4u);
+  EXPECT_EQ(stats.num_cache_restarts, 6u);
+  EXPECT_EQ(stats.num_cache_seeks, 8u);
+  EXPECT_EQ(stats.num_forward_keys, 10u);
+  EXPECT_EQ(stats.num_backward_keys, 12u);
+  EXPECT_EQ(stats.num_decompressed_soa, 14u);
+
+  stats.Reset();
+  EXPECT_EQ(stats.num_samples, 0u);
+  EXPECT_EQ(stats.num_cache_invalidations, 0u);
+  EXPECT_EQ(stats.num_cache_restarts, 0u);
+  EXPECT_EQ(stats.num_cache_seeks, 0u);
+  EXPECT_EQ(stats.num_forward_keys, 0u);
+  EXPECT_EQ(stats.num_backward_keys, 0u);
+  EXPECT_EQ(stats.num_decompressed_soa, 0u);
+}
+
+TEST(Stats, SamplingJob) {
+  RawAnimation raw_animation;
+  FillInterleavedKeys(&raw_animation);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .25f;
+  builder.reverse_keys = true;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(9);
+  ozz::math::SoaTransform output[3];
+  SamplingStats stats;
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+  job.stats = &stats;
+
+  // Samples with a new cache.
+  job.time = .1f;
+  ASSERT_TRUE(job.Run());
+
+#if defined(OZZ_BUILD_SAMPLING_STATS)
+  EXPECT_EQ(stats.num_samples, 1u);
+  EXPECT_EQ(stats.num_cache_invalidations, 1u);
+  EXPECT_EQ(stats.num_cache_restarts, 1u);
+  EXPECT_EQ(stats.num_cache_seeks, 0u);
+  EXPECT_GT(stats.num_forward_keys, 0u);
+  EXPECT_EQ(stats.num_backward_keys, 0u);
+  EXPECT_EQ(stats.num_decompressed_soa, 9u);  // 3 soa per transform type.
+
+  // Samples the same time again, nothing needs to be decompressed.
+  const SamplingStats first = stats;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.num_samples, 2u);
+  EXPECT_EQ(stats.num_cache_invalidations, 1u);
+  EXPECT_EQ(stats.num_forward_keys, first.num_forward_keys);
+  EXPECT_EQ(stats.num_decompressed_soa, first.num_decompressed_soa);
+
+  // Jumps forward, restoring the cache from a seek point.
+  job.time = 1.5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.num_cache_seeks, 1u);
+  EXPECT_EQ(stats.num_cache_restarts, 1u);
+
+  // Plays slightly backward.
+  job.time = 1.45f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_GT(stats.num_backward_keys, 0u);
+  EXPECT_EQ(stats.num_cache_seeks, 1u);
+  EXPECT_EQ(stats.num_cache_restarts, 1u);
+
+  // Aggregates with a second job using a NULL stats.
+  SamplingCache other_cache(9);
+  job.cache = &other_cache;
+  job.stats = NULL;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.num_samples, 4u);
+  EXPECT_EQ(stats.num_cache_invalidations, 1u);
+#else   // OZZ_BUILD_SAMPLING_STATS
+  // Stats aren't filled when disabled at compile time.
+  EXPECT_EQ(stats.num_samples, 0u);
+  EXPECT_EQ(stats.num_decompressed_soa, 0u);
+#endif  // OZZ_BUILD_SAMPLING_STATS
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
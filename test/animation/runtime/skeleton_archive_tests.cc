@@ -111,6 +111,11 @@ TEST(Filled, SkeletonSerialize) {
       EXPECT_EQ(i_skeleton.joint_properties().begin[i].is_leaf,
                 o_skeleton->joint_properties().begin[i].is_leaf);
       EXPECT_STREQ(i_skeleton.joint_names()[i], o_skeleton->joint_names()[i]);
+      EXPECT_EQ(i_skeleton.level_joints()[i], o_skeleton->level_joints()[i]);
+    }
+    ASSERT_EQ(o_skeleton->num_levels(), i_skeleton.num_levels());
+    for (int i = 0; i <= i_skeleton.num_levels(); ++i) {
+      EXPECT_EQ(i_skeleton.levels()[i], o_skeleton->levels()[i]);
     }
     for (int i = 0; i < (i_skeleton.num_joints() + 3) / 4; ++i) {
       EXPECT_TRUE(
@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/simd_float3x4.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::math::SimdFloat4;
+using ozz::math::Float3x4;
+using ozz::math::Float4x4;
+
+// clang-format off
+
+TEST(Constant, Float3x4) {
+  const Float3x4 identity = Float3x4::identity();
+  EXPECT_FLOAT3x4_EQ(identity, 1.f, 0.f, 0.f, 0.f,
+                               0.f, 1.f, 0.f, 0.f,
+                               0.f, 0.f, 1.f, 0.f);
+}
+
+TEST(Conversion, Float3x4) {
+  const Float4x4 m0 = {{ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 0.f),
+                        ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 0.f),
+                        ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 0.f),
+                        ozz::math::simd_float4::Load(12.f, 13.f, 14.f, 1.f)}};
+
+  const Float3x4 m1 = Float3x4::FromFloat4x4(m0);
+  EXPECT_FLOAT3x4_EQ(m1, 0.f, 4.f, 8.f, 12.f,
+                         1.f, 5.f, 9.f, 13.f,
+                         2.f, 6.f, 10.f, 14.f);
+
+  const Float4x4 m2 = ToFloat4x4(m1);
+  EXPECT_FLOAT4x4_EQ(m2, 0.f, 1.f, 2.f, 0.f,
+                         4.f, 5.f, 6.f, 0.f,
+                         8.f, 9.f, 10.f, 0.f,
+                         12.f, 13.f, 14.f, 1.f);
+}
+
+TEST(Arithmetic, Float3x4) {
+  const Float4x4 m0 = Float4x4::FromAffine(ozz::math::simd_float4::Load(-12.f, 46.f, 12.f, 0.f),
+                                           ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .70710677f),
+                                           ozz::math::simd_float4::Load(2.f, 46.f, 3.f, 0.f));
+  const Float4x4 m1 = Float4x4::FromAffine(ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f),
+                                           ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .70710677f),
+                                           ozz::math::simd_float4::Load(-1.f, 2.f, 1.f, 0.f));
+  const Float3x4 a0 = Float3x4::FromFloat4x4(m0);
+  const Float3x4 a1 = Float3x4::FromFloat4x4(m1);
+  const SimdFloat4 v = ozz::math::simd_float4::Load(-1.f, 2.f, -3.f, 99.f);
+
+  // Matches Float4x4 results.
+  const SimdFloat4 transform_point = TransformPoint(a0, v);
+  EXPECT_SIMDFLOAT_EQ(transform_point, -21.f, 138.f, 14.f, 1.f);
+  const SimdFloat4 expected_point = TransformPoint(m0, v);
+  EXPECT_SIMDFLOAT_EQ(transform_point, ozz::math::GetX(expected_point),
+                      ozz::math::GetY(expected_point),
+                      ozz::math::GetZ(expected_point), 1.f);
+
+  const SimdFloat4 transform_vector = TransformVector(a0, v);
+  EXPECT_SIMDFLOAT_EQ(transform_vector, -9.f, 92.f, 2.f, 0.f);
+
+  const Float3x4 mul_mat = a0 * a1;
+  const Float4x4 expected_mul_mat = m0 * m1;
+  EXPECT_FLOAT4x4_EQ(ToFloat4x4(mul_mat),
+                     ozz::math::GetX(expected_mul_mat.cols[0]), ozz::math::GetY(expected_mul_mat.cols[0]), ozz::math::GetZ(expected_mul_mat.cols[0]), 0.f,
+                     ozz::math::GetX(expected_mul_mat.cols[1]), ozz::math::GetY(expected_mul_mat.cols[1]), ozz::math::GetZ(expected_mul_mat.cols[1]), 0.f,
+                     ozz::math::GetX(expected_mul_mat.cols[2]), ozz::math::GetY(expected_mul_mat.cols[2]), ozz::math::GetZ(expected_mul_mat.cols[2]), 0.f,
+                     ozz::math::GetX(expected_mul_mat.cols[3]), ozz::math::GetY(expected_mul_mat.cols[3]), ozz::math::GetZ(expected_mul_mat.cols[3]), 1.f);
+  EXPECT_FLOAT3x4_EQ(mul_mat, 0.f, 6.f, 0.f, -3.f,
+                              0.f, 0.f, -46.f, 138.f,
+                              2.f, 0.f, 0.f, 10.f);
+
+  const Float3x4 mul_identity = a0 * Float3x4::identity();
+  EXPECT_FLOAT3x4_EQ(mul_identity, 0.f, 0.f, 3.f, -12.f,
+                                   0.f, 46.f, 0.f, 46.f,
+                                   -2.f, 0.f, 0.f, 12.f);
+}
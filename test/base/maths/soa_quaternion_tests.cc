@@ -180,3 +180,20 @@ TEST(QuaternionArithmetic, ozz_math) {
                                            .70710677f, .70710677f, .70710677f, .97047764f);
   EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(nlerp_est_m)));
 }
+
+TEST(QuaternionTransformVector, ozz_math) {
+  // 0 is a rotation of pi/2 around x, 1 is identity, 2 is a rotation of pi/2
+  // around y and 3 is a rotation of pi/4 around x.
+  const SoaQuaternion q = SoaQuaternion::Load(
+    ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .382683432f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(.70710677f, 1.f, .70710677f, .9238795f));
+  const ozz::math::SoaFloat3 v = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load1(1.f),
+    ozz::math::simd_float4::Load1(2.f),
+    ozz::math::simd_float4::Load1(3.f));
+  EXPECT_SOAFLOAT3_EQ(TransformVector(q, v), 1.f, 1.f, 3.f, 1.f,
+                                             -3.f, 2.f, 2.f, -.70710677f,
+                                             2.f, 3.f, -1.f, 3.5355339f);
+}